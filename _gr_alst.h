@@ -6,6 +6,8 @@
 //    (See accompanying file LICENSE_1_0.txt or copy at
 //          https://www.boost.org/LICENSE_1_0.txt).
 
+#include "_gr_pool.h"
+
 __DGRAPH_BEGIN_NAMESPACE
 
 // Allocator sets for dgraphs.
@@ -176,6 +178,23 @@ struct _allocator_set_safe
   }
 };    
 
+// Safe allocator set with path nodes drawn from the per-thread pool ( _gr_pool.h ):
+template <  class t_TyAllocatorGraphNode,
+            class t_TyAllocatorGraphLink = t_TyAllocatorGraphNode >
+struct _allocator_set_safe_pooled
+  : public _allocator_set_safe< t_TyAllocatorGraphNode, t_TyAllocatorGraphLink,
+                                _graph_pool_allocator< char >, _graph_pool_allocator< char > >
+{
+  typedef _allocator_set_safe< t_TyAllocatorGraphNode, t_TyAllocatorGraphLink,
+                                _graph_pool_allocator< char >, _graph_pool_allocator< char > > _TyBase;
+
+  _allocator_set_safe_pooled( t_TyAllocatorGraphNode _allocGraphNode = t_TyAllocatorGraphNode(),
+                              t_TyAllocatorGraphLink _allocGraphLink = t_TyAllocatorGraphLink() )
+    : _TyBase( _allocGraphNode, _allocGraphLink )
+  {
+  }
+};
+
 __DGRAPH_END_NAMESPACE
 
 #endif //__GR_ALST
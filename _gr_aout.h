@@ -0,0 +1,313 @@
+#pragma once
+
+//          Copyright David Lawrence Bien 1997 - 2021.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt).
+
+// _gr_aout.h
+// graph output through a ring of buffers flushed to a file by a writer thread - the
+//  traversal of the graph overlaps the file I/O.
+
+#include <fcntl.h>
+#ifndef WIN32
+#include <unistd.h>
+#endif //!WIN32
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <vector>
+#include "_compat.h"
+#include "_gr_inc.h"
+
+__DGRAPH_BEGIN_NAMESPACE
+
+// Element output uses the same interface as the memory mapped output object ( i.e. _mm_RawElIO ):
+//  StWrite() returns the space needed and only writes if that space is available.
+// Seeking: the output iterator only ever seeks back to a position that it obtained from
+//  the next-to-last TellP() ( the start of the current record ) - so when a write doesn't fit
+//  in the current buffer we hand off the data before the next-to-last TellP() to the writer and
+//  continue in the next buffer. A buffer grows only if a record doesn't fit in it.
+//  This keeps the output iterator throw-state-safe. An attempt to seek before data that
+//  was handed off throws bad_graph.
+template <  class t_TyOutputNodeEl,
+            class t_TyOutputLinkEl = t_TyOutputNodeEl,
+            size_t t_kstBufferBytes = 1 << 20,
+            unsigned t_knBuffers = 4 >
+struct _async_file_out_object
+{
+private:
+  typedef _async_file_out_object< t_TyOutputNodeEl, t_TyOutputLinkEl, t_kstBufferBytes, t_knBuffers > _TyThis;
+public:
+  typedef vtyFileHandle _TyInitArg;
+  typedef vtySeekOffset _TyStreamPos;
+  typedef t_TyOutputNodeEl _TyIONodeEl;
+  typedef t_TyOutputLinkEl _TyIOLinkEl;
+  static const size_t s_kstBufferBytes = t_kstBufferBytes;
+  static const unsigned s_knBuffers = t_knBuffers;
+  static_assert( t_knBuffers >= 2, "Need at least two buffers to overlap traversal and writing." );
+
+  vtyFileHandle m_hFile{vkhInvalidFileHandle}; // This object doesn't own the lifetime of the open file.
+  t_TyOutputNodeEl  m_one;
+  t_TyOutputLinkEl  m_ole;
+
+  typedef vector< uint8_t > _TyBuffer;
+  _TyBuffer m_rgBuffers[ t_knBuffers ];
+  size_t    m_rgstSubmitted[ t_knBuffers ]; // The number of bytes to write from each submitted buffer.
+
+  // Producer state - only accessed by the traversing thread:
+  unsigned      m_iCur{0};      // The buffer being filled.
+  size_t        m_stCur{0};     // The current position within m_iCur.
+  size_t        m_stEnd{0};     // The end of the data in m_iCur ( we may have seeked back ).
+  size_t        m_stLastTell{0};// The position of the last TellP() within m_iCur.
+  size_t        m_stPrevTell{0};// The position of the next-to-last TellP() - data before it may be handed off.
+  _TyStreamPos  m_spBase{0};    // The stream position of the start of m_iCur.
+  bool          m_fClosed{false};
+
+  // Shared with the writer:
+  mutex m_mtx;
+  condition_variable m_cvWriter;   // Signalled when a buffer is submitted or we are closing.
+  condition_variable m_cvProducer; // Signalled when a buffer has been written.
+  unsigned m_iWrite{0};   // The next buffer to be written.
+  unsigned m_nPending{0}; // The number of submitted buffers not yet written.
+  bool m_fStop{false};
+  exception_ptr m_xpWrite;
+
+  _graph_workers m_workers; // The writer - declared last - started once everything else is initialized.
+
+  _async_file_out_object( _async_file_out_object const & ) = delete;
+  _async_file_out_object() = delete;
+  _async_file_out_object( vtyFileHandle _hFile,
+                          t_TyOutputNodeEl const & _rone,
+                          t_TyOutputLinkEl const & _role )
+    : m_hFile( _hFile ),
+      m_one( _rone ),
+      m_ole( _role )
+  {
+    _Init();
+  }
+  _async_file_out_object( vtyFileHandle _hFile,
+                          t_TyOutputNodeEl && _rrone,
+                          t_TyOutputLinkEl && _rrole )
+    : m_hFile( _hFile ),
+      m_one( std::move( _rrone ) ),
+      m_ole( std::move( _rrole ) )
+  {
+    _Init();
+  }
+  ~_async_file_out_object() noexcept(false)
+  {
+    bool fInUnwinding = !!std::uncaught_exceptions();
+    if ( !fInUnwinding && !m_fClosed )
+    {
+      Close(); // throws.
+    }
+    else
+    {
+      _StopWriter();
+    }
+  }
+
+  // Submit the remaining data and wait for the writer to complete - throws any write error.
+  void Close()
+  {
+    Assert( !m_fClosed );
+    m_fClosed = true;
+    _BIEN_TRY
+    {
+      if ( m_stEnd )
+      {
+        _Submit( m_stEnd );
+      }
+      unique_lock< mutex > lock( m_mtx );
+      while ( m_nPending && !m_xpWrite )
+        m_cvProducer.wait( lock );
+    }
+    _BIEN_UNWIND( _StopWriter() );
+    _StopWriter();
+    if ( m_xpWrite )
+      rethrow_exception( m_xpWrite );
+  }
+
+  _TyStreamPos TellP() _BIEN_NOTHROW
+  {
+    m_stPrevTell = min( m_stLastTell, m_stCur );
+    m_stLastTell = m_stCur;
+    return m_spBase + m_stCur;
+  }
+  void SeekP( _TyStreamPos _sp )
+  {
+    __THROWPT( e_ttFileOutput );
+    if ( ( _sp < m_spBase ) || ( _sp > m_spBase + m_stEnd ) )
+    {
+      throw bad_graph( "_async_file_out_object::SeekP(): Seek outside of the unwritten data." );
+    }
+    m_stCur = size_t( _sp - m_spBase );
+    m_stLastTell = min( m_stLastTell, m_stCur );
+    m_stPrevTell = min( m_stPrevTell, m_stCur );
+  }
+  void Write( const void * _pv, size_t _st )
+  {
+    _Reserve( _st );
+    memcpy( &m_rgBuffers[ m_iCur ][ m_stCur ], _pv, _st );
+    _Advance( _st );
+  }
+  template < class t_TyEl >
+  void WriteNodeEl( t_TyEl const & _rel )
+  {
+    _Advance( _StWriteEl( m_one, _rel ) );
+  }
+  template < class t_TyEl >
+  void WriteLinkEl( t_TyEl const & _rel )
+  {
+    _Advance( _StWriteEl( m_ole, _rel ) );
+  }
+
+protected:
+
+  void _Init()
+  {
+    __THROWPT( e_ttMemory );
+    for ( unsigned iBuffer = 0; iBuffer < t_knBuffers; ++iBuffer )
+    {
+      m_rgBuffers[ iBuffer ].resize( t_kstBufferBytes );
+      m_rgstSubmitted[ iBuffer ] = 0;
+    }
+    if ( !m_workers.start( 1, [this]( unsigned, unsigned ) { _WriterThread(); } ) )
+    {
+      throw bad_graph( "_async_file_out_object::_Init(): Couldn't start the writer thread." );
+    }
+  }
+
+  template < class t_TyElIO, class t_TyEl >
+  size_t _StWriteEl( t_TyElIO & _rio, t_TyEl const & _rel )
+  {
+    ssize_t sstLeft = m_rgBuffers[ m_iCur ].size() - m_stCur;
+    size_t stNeed = _rio.StWrite( &m_rgBuffers[ m_iCur ][ 0 ] + m_stCur, sstLeft, _rel );
+    if ( ssize_t( stNeed ) > sstLeft )
+    {
+      _Reserve( stNeed ); // May move to the next buffer.
+      _TyBuffer & rbuf = m_rgBuffers[ m_iCur ];
+      size_t stNeed2 = _rio.StWrite( &rbuf[ 0 ] + m_stCur, rbuf.size() - m_stCur, _rel );
+      Assert( stNeed == stNeed2 );
+    }
+    return stNeed;
+  }
+
+  void _Reserve( size_t _st )
+  {
+    if ( m_stCur + _st > m_rgBuffers[ m_iCur ].size() )
+    {
+      if ( m_stPrevTell )
+      {
+        _HandOff( m_stPrevTell );
+      }
+      _TyBuffer & rbuf = m_rgBuffers[ m_iCur ];
+      if ( m_stCur + _st > rbuf.size() )
+      {
+        __THROWPT( e_ttMemory );
+        rbuf.resize( max( m_stCur + _st, 2 * rbuf.size() ) ); // A record may exceed the buffer size.
+      }
+    }
+  }
+  void _Advance( size_t _st ) _BIEN_NOTHROW
+  {
+    m_stCur += _st;
+    m_stEnd = max( m_stEnd, m_stCur );
+  }
+
+  // Hand off [0,_stFlush) of the current buffer to the writer, the remainder moves to the next buffer:
+  void _HandOff( size_t _stFlush )
+  {
+    unsigned iNext = ( m_iCur + 1 ) % t_knBuffers;
+    {
+      unique_lock< mutex > lock( m_mtx );
+      while ( ( m_nPending == t_knBuffers - 1 ) && !m_xpWrite )
+        m_cvProducer.wait( lock );
+      if ( m_xpWrite )
+        rethrow_exception( m_xpWrite );
+    }
+    _TyBuffer & rbufNext = m_rgBuffers[ iNext ];
+    size_t stTail = m_stEnd - _stFlush;
+    if ( stTail > rbufNext.size() )
+    {
+      __THROWPT( e_ttMemory );
+      rbufNext.resize( stTail );
+    }
+    if ( stTail )
+    {
+      memcpy( &rbufNext[ 0 ], &m_rgBuffers[ m_iCur ][ _stFlush ], stTail );
+    }
+    _Submit( _stFlush ); // no throw after this.
+    m_iCur = iNext;
+    m_spBase += _stFlush;
+    m_stCur -= _stFlush;
+    m_stEnd = stTail;
+    m_stLastTell -= _stFlush;
+    m_stPrevTell = 0;
+  }
+
+  void _Submit( size_t _st )
+  {
+    {
+      unique_lock< mutex > lock( m_mtx );
+      if ( m_xpWrite )
+        rethrow_exception( m_xpWrite );
+      m_rgstSubmitted[ m_iCur ] = _st;
+      ++m_nPending;
+    }
+    m_cvWriter.notify_one();
+  }
+
+  void _StopWriter() _BIEN_NOTHROW
+  {
+    {
+      unique_lock< mutex > lock( m_mtx );
+      m_fStop = true;
+    }
+    m_cvWriter.notify_one();
+    m_workers.join();
+  }
+
+  void _WriterThread() _BIEN_NOTHROW
+  {
+    for ( ; ; )
+    {
+      unsigned iWrite;
+      {
+        unique_lock< mutex > lock( m_mtx );
+        while ( !m_nPending && !m_fStop )
+          m_cvWriter.wait( lock );
+        if ( !m_nPending )
+          return;
+        iWrite = m_iWrite;
+      }
+      _BIEN_TRY
+      {
+        size_t st = m_rgstSubmitted[ iWrite ];
+        uint64_t u64Written;
+        int iWriteResult = FileWrite( m_hFile, &m_rgBuffers[ iWrite ][ 0 ], st, &u64Written );
+        if ( !!iWriteResult || ( u64Written != st ) )
+          THROWNAMEDEXCEPTIONERRNO( GetLastErrNo(), ( u64Written != st ) ? "Didn't write all the data? WTF?" : "FileWrite() failed." );
+      }
+      catch( ... )
+      {
+        {
+          unique_lock< mutex > lock( m_mtx );
+          m_xpWrite = current_exception();
+          m_nPending = 0; // Nothing more will be written.
+        }
+        m_cvProducer.notify_one();
+        return;
+      }
+      {
+        unique_lock< mutex > lock( m_mtx );
+        m_iWrite = ( m_iWrite + 1 ) % t_knBuffers;
+        --m_nPending;
+      }
+      m_cvProducer.notify_one();
+    }
+  }
+};
+
+__DGRAPH_END_NAMESPACE
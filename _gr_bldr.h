@@ -0,0 +1,285 @@
+#ifndef __GR_BLDR_H
+#define __GR_BLDR_H
+
+//          Copyright David Lawrence Bien 1997 - 2021.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt).
+
+// _gr_bldr.h
+
+// Concurrent graph builder.
+// Each building thread gets its own local ( get_local() ) through which it creates nodes and links
+//  and queues relations - none of this touches the relation lists of any node so the threads
+//  need not synchronize. commit() then connects every queued relation in parallel: the nodes are
+//  partitioned by address and each worker owns the child lists of the parents and the parent lists
+//  of the children in its partition ( these are distinct fields of a link - so a link may be
+//  threaded into both of its lists at once by different workers ).
+// Queued relations are appended to the existing relation lists - in the order queued on a local,
+//  and in order of local creation between locals.
+// Nodes and links are allocated with the graph's allocators - these must be safe to call from many
+//  threads. Use _graph_pool_allocator<> ( _gr_pool.h ) for the node and link allocators to have each
+//  thread allocate from its own cache.
+// The root of the graph is not set by the builder - set it after commit(). Until commit() the
+//  builder owns the nodes and links created through it - abort() ( or destruction ) destroys them.
+
+#include <stddef.h>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <algorithm>
+#include <unordered_map>
+
+__DGRAPH_BEGIN_NAMESPACE
+
+template < class t_TyGraph >
+class _graph_concurrent_builder
+{
+  typedef _graph_concurrent_builder< t_TyGraph > _TyThis;
+public:
+
+  typedef t_TyGraph                                     _TyGraph;
+  typedef typename t_TyGraph::_TyGraphNode              _TyGraphNode;
+  typedef typename t_TyGraph::_TyGraphLink              _TyGraphLink;
+  typedef typename t_TyGraph::_TyNodeEl                 _TyNodeEl;
+  typedef typename t_TyGraph::_TyLinkEl                 _TyLinkEl;
+  typedef typename _TyGraphNode::_TyGraphLinkBaseBase   _TyGraphLinkBaseBase;
+
+protected:
+  struct _relation
+  {
+    _TyGraphNode *  m_pgnParent;
+    _TyGraphNode *  m_pgnChild;
+    _TyGraphLink *  m_pgl;
+  };
+  typedef vector< _relation > _TyRelations;
+
+public:
+
+  // Used by one thread at a time:
+  class _TyLocal
+  {
+    friend class _graph_concurrent_builder< t_TyGraph >;
+    _TyGraph &                m_rg;
+    vector< _TyGraphNode * >  m_rgpgnCreated;
+    vector< _TyGraphLink * >  m_rgpglCreated;
+    _TyRelations              m_rgrel;
+    vector< vector< size_t > > m_rgrgstByParent;  // commit() partitions.
+    vector< vector< size_t > > m_rgrgstByChild;
+
+    explicit _TyLocal( _TyGraph & _rg )
+      : m_rg( _rg )
+    {
+    }
+  public:
+    _TyGraphNode *  create_node( _TyNodeEl const & _rel = _TyNodeEl() )
+    {
+      m_rgpgnCreated.reserve( m_rgpgnCreated.size() + 1 );
+      _TyGraphNode * pgn = m_rg.template create_node1< _TyNodeEl const & >( _rel );
+      m_rgpgnCreated.push_back( pgn );
+      return pgn;
+    }
+    _TyGraphLink *  create_link( _TyLinkEl const & _rel = _TyLinkEl() )
+    {
+      m_rgpglCreated.reserve( m_rgpglCreated.size() + 1 );
+      _TyGraphLink * pgl = m_rg.template create_link1< _TyLinkEl const & >( _rel );
+      m_rgpglCreated.push_back( pgl );
+      return pgl;
+    }
+    // Queue the relation _pgnParent->_pgnChild through _pgl - which must have been created by
+    //  this builder and not yet used:
+    void  add_child( _TyGraphNode * _pgnParent, _TyGraphNode * _pgnChild, _TyGraphLink * _pgl )
+    {
+      _relation rel = { _pgnParent, _pgnChild, _pgl };
+      m_rgrel.push_back( rel );
+      _pgl->SetParentNode( _pgnParent );
+      _pgl->SetChildNode( _pgnChild );
+    }
+    _TyGraphLink *  add_child( _TyGraphNode * _pgnParent, _TyGraphNode * _pgnChild,
+                               _TyLinkEl const & _rel = _TyLinkEl() )
+    {
+      m_rgrel.reserve( m_rgrel.size() + 1 );
+      _TyGraphLink * pgl = create_link( _rel );
+      add_child( _pgnParent, _pgnChild, pgl );
+      return pgl;
+    }
+    size_t  StQueued() const _BIEN_NOTHROW
+    {
+      return m_rgrel.size();
+    }
+  };
+
+  explicit _graph_concurrent_builder( _TyGraph & _rg )
+    : m_rg( _rg )
+  {
+  }
+  ~_graph_concurrent_builder() _BIEN_NOTHROW
+  {
+    abort();
+  }
+
+  // The local of the calling thread:
+  _TyLocal &  get_local()
+  {
+    lock_guard< mutex > lock( m_mtx );
+    typename _TyLocalMap::iterator it = m_mapLocals.find( this_thread::get_id() );
+    if ( it != m_mapLocals.end() )
+    {
+      return *m_rgplocal[ it->second ];
+    }
+    __THROWPT( e_ttMemory );
+    m_rgplocal.push_back( unique_ptr< _TyLocal >( new _TyLocal( m_rg ) ) );
+    _BIEN_TRY
+    {
+      m_mapLocals[ this_thread::get_id() ] = m_rgplocal.size() - 1;
+    }
+    _BIEN_UNWIND( m_rgplocal.pop_back() );
+    return *m_rgplocal.back();
+  }
+
+  // Connect all queued relations using up to _uThreads threads ( 0 - hardware concurrency ).
+  // No local may be in use during commit(). If this throws nothing has been connected and all
+  //  remains owned by the builder.
+  void  commit( unsigned _uThreads = 0 )
+  {
+    _uThreads = _graph_workers::UThreads( _uThreads );
+    size_t stPartitions = _uThreads;
+
+    // 1) Partition each local's relations by parent and by child:
+    _graph_workers::parallel_for( _uThreads, m_rgplocal.size(), [this,stPartitions]( size_t _stLocal )
+      {
+        _TyLocal & rl = *m_rgplocal[ _stLocal ];
+        rl.m_rgrgstByParent.assign( stPartitions, vector< size_t >() );
+        rl.m_rgrgstByChild.assign( stPartitions, vector< size_t >() );
+        for ( size_t st = 0; st < rl.m_rgrel.size(); ++st )
+        {
+          rl.m_rgrgstByParent[ _StPartition( rl.m_rgrel[ st ].m_pgnParent, stPartitions ) ].push_back( st );
+          rl.m_rgrgstByChild[ _StPartition( rl.m_rgrel[ st ].m_pgnChild, stPartitions ) ].push_back( st );
+        }
+      } );
+
+    // 2) Gather each partition - grouped by node, stably so queued order is kept:
+    vector< vector< const _relation * > > rgrgprelByParent( stPartitions );
+    vector< vector< const _relation * > > rgrgprelByChild( stPartitions );
+    _graph_workers::parallel_for( _uThreads, stPartitions, [this,&rgrgprelByParent,&rgrgprelByChild]( size_t _stPartition )
+      {
+        _Gather( _stPartition, rgrgprelByParent[ _stPartition ], &_TyLocal::m_rgrgstByParent, &_relation::m_pgnParent );
+        _Gather( _stPartition, rgrgprelByChild[ _stPartition ], &_TyLocal::m_rgrgstByChild, &_relation::m_pgnChild );
+      } );
+
+    // 3) Connect - this cannot fail:
+    _graph_workers::parallel_for( _uThreads, stPartitions, [&rgrgprelByParent,&rgrgprelByChild]( size_t _stPartition ) _BIEN_NOTHROW
+      {
+        _ConnectChildren( rgrgprelByParent[ _stPartition ] );
+        _ConnectParents( rgrgprelByChild[ _stPartition ] );
+      } );
+
+    // The graph now owns everything:
+    m_rgplocal.clear();
+    m_mapLocals.clear();
+  }
+
+  // Destroy every node and link created through this builder since the last commit():
+  void  abort() _BIEN_NOTHROW
+  {
+    for ( size_t stLocal = 0; stLocal < m_rgplocal.size(); ++stLocal )
+    {
+      _TyLocal & rl = *m_rgplocal[ stLocal ];
+      for ( size_t st = 0; st < rl.m_rgpglCreated.size(); ++st )
+      {
+        m_rg.destroy_link( rl.m_rgpglCreated[ st ] );
+      }
+      for ( size_t st = 0; st < rl.m_rgpgnCreated.size(); ++st )
+      {
+        m_rg.destroy_single_node( rl.m_rgpgnCreated[ st ] );
+      }
+    }
+    m_rgplocal.clear();
+    m_mapLocals.clear();
+  }
+
+protected:
+
+  typedef unordered_map< thread::id, size_t > _TyLocalMap;
+
+  _TyGraph &                        m_rg;
+  mutex                             m_mtx;      // Guards the locals.
+  vector< unique_ptr< _TyLocal > >  m_rgplocal;
+  _TyLocalMap                       m_mapLocals;
+
+  static size_t _StPartition( const _TyGraphNode * _pgn, size_t _stPartitions ) _BIEN_NOTHROW
+  {
+    size_t st = reinterpret_cast< size_t >( _pgn ) >> 4;
+    st ^= st >> 17;
+    return ( st * size_t( 0x9E3779B97F4A7C15ull ) >> 8 ) % _stPartitions;
+  }
+
+  void  _Gather( size_t _stPartition, vector< const _relation * > & _rrgprel,
+                 vector< vector< size_t > > _TyLocal::* _pmrgrgst,
+                 _TyGraphNode * _relation::* _pmpgn ) const
+  {
+    size_t stTotal = 0;
+    for ( size_t stLocal = 0; stLocal < m_rgplocal.size(); ++stLocal )
+    {
+      stTotal += ( (*m_rgplocal[ stLocal ]).*_pmrgrgst )[ _stPartition ].size();
+    }
+    _rrgprel.reserve( stTotal );
+    for ( size_t stLocal = 0; stLocal < m_rgplocal.size(); ++stLocal )
+    {
+      _TyLocal const & rl = *m_rgplocal[ stLocal ];
+      vector< size_t > const & rrgst = ( rl.*_pmrgrgst )[ _stPartition ];
+      for ( size_t st = 0; st < rrgst.size(); ++st )
+      {
+        _rrgprel.push_back( &rl.m_rgrel[ rrgst[ st ] ] );
+      }
+    }
+    std::stable_sort( _rrgprel.begin(), _rrgprel.end(),
+      [_pmpgn]( const _relation * _prelL, const _relation * _prelR )
+      {
+        return std::less< _TyGraphNode * >()( _prelL->*_pmpgn, _prelR->*_pmpgn );
+      } );
+  }
+
+  // Append each run of relations of the same parent to its child list:
+  static void _ConnectChildren( vector< const _relation * > const & _rrgprel ) _BIEN_NOTHROW
+  {
+    _TyGraphNode * pgnCur = 0;
+    _TyGraphLinkBaseBase ** ppglbTail = 0;
+    for ( size_t st = 0; st < _rrgprel.size(); ++st )
+    {
+      const _relation & rrel = *_rrgprel[ st ];
+      if ( rrel.m_pgnParent != pgnCur )
+      {
+        pgnCur = rrel.m_pgnParent;
+        for ( ppglbTail = pgnCur->PPGLBChildHead(); *ppglbTail; ppglbTail = (*ppglbTail)->PPGLBGetNextChild() )
+          ;
+      }
+      _TyGraphLinkBaseBase * pglb = rrel.m_pgl;
+      pglb->InsertChild( ppglbTail );
+      ppglbTail = pglb->PPGLBGetNextChild();
+    }
+  }
+  static void _ConnectParents( vector< const _relation * > const & _rrgprel ) _BIEN_NOTHROW
+  {
+    _TyGraphNode * pgnCur = 0;
+    _TyGraphLinkBaseBase ** ppglbTail = 0;
+    for ( size_t st = 0; st < _rrgprel.size(); ++st )
+    {
+      const _relation & rrel = *_rrgprel[ st ];
+      if ( rrel.m_pgnChild != pgnCur )
+      {
+        pgnCur = rrel.m_pgnChild;
+        for ( ppglbTail = pgnCur->PPGLBParentHead(); *ppglbTail; ppglbTail = (*ppglbTail)->PPGLBGetNextParent() )
+          ;
+      }
+      _TyGraphLinkBaseBase * pglb = rrel.m_pgl;
+      pglb->InsertParent( ppglbTail );
+      ppglbTail = pglb->PPGLBGetNextParent();
+    }
+  }
+};
+
+__DGRAPH_END_NAMESPACE
+
+#endif //__GR_BLDR_H
@@ -0,0 +1,470 @@
+#ifndef __GR_BULK_H
+#define __GR_BULK_H
+
+//          Copyright David Lawrence Bien 1997 - 2021.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt).
+
+// _gr_bulk.h
+
+// Bulk construction of graphs from arrays.
+// The graph is given as an array of node elements ( node ids are indices into this array ) and an
+//  array of edges ( parent id, child id, link element ). The child list of each node is in the order
+//  its edges appear in the edge array, as is the parent list of each node.
+// All allocation happens up front - the edges are bucketed by parent ( a stable counting sort ) so
+//  that the links of a node are created together - then every relation list is built in a single
+//  pass over the edges without any searching of the lists.
+// Every node must be connected to the root ( ignoring direction ) - as the graph owns only what
+//  it can reach from the root.
+// Export is the inverse - _graph_edge_list_exporter numbers the nodes and fills arrays of node
+//  elements, link elements and ( parent id, child id, position ) edges - or CSR arrays.
+
+#include <stddef.h>
+#include <vector>
+#include <algorithm>
+#include <type_traits>
+#include <unordered_map>
+
+__DGRAPH_BEGIN_NAMESPACE
+
+template < class t_TyLinkEl >
+struct _graph_edge
+{
+  size_t      m_stParent;
+  size_t      m_stChild;
+  t_TyLinkEl  m_el;
+};
+
+// Exported edge - m_uPosition is the position of the link in the child list of the parent:
+struct _graph_edge_pos
+{
+  size_t      m_stParent;
+  size_t      m_stChild;
+  _TyGNIndex  m_uPosition;
+};
+
+template < class t_TyGraph >
+struct _graph_edge_list_loader
+{
+private:
+  typedef _graph_edge_list_loader< t_TyGraph > _TyThis;
+public:
+  typedef typename t_TyGraph::_TyGraphNode              _TyGraphNode;
+  typedef typename t_TyGraph::_TyGraphLink              _TyGraphLink;
+  typedef typename t_TyGraph::_TyNodeEl                 _TyNodeEl;
+  typedef typename t_TyGraph::_TyLinkEl                 _TyLinkEl;
+  typedef typename _TyGraphNode::_TyGraphLinkBaseBase   _TyGraphLinkBaseBase;
+  typedef _graph_edge< _TyLinkEl >                      _TyEdge;
+
+  t_TyGraph &             m_rg;
+  const _TyNodeEl *       m_pNodeEls;
+  size_t                  m_stNodes;
+  const _TyEdge *         m_pEdges;
+  size_t                  m_stEdges;
+  size_t                  m_stRoot;
+
+  vector< _TyGraphNode * >  m_rgpgn;
+  vector< _TyGraphLink * >  m_rgpgl;      // In edge array order.
+  vector< size_t >          m_rgstByParent; // Edge indices - bucketed by parent.
+
+  _TyGraphNode *  m_pgnNewRoot;
+
+  _graph_edge_list_loader(  t_TyGraph & _rg,
+                            const _TyNodeEl * _pNodeEls, size_t _stNodes,
+                            const _TyEdge * _pEdges, size_t _stEdges,
+                            size_t _stRoot )
+    : m_rg( _rg ),
+      m_pNodeEls( _pNodeEls ),
+      m_stNodes( _stNodes ),
+      m_pEdges( _pEdges ),
+      m_stEdges( _stEdges ),
+      m_stRoot( _stRoot ),
+      m_pgnNewRoot( 0 )
+  {
+    if ( !m_stNodes )
+    {
+      if ( m_stEdges )
+      {
+        throw bad_graph( "_graph_edge_list_loader: Edges without nodes." );
+      }
+      return;
+    }
+    _check();
+    _sort();
+    _BIEN_TRY
+    {
+      _create();
+    }
+    _BIEN_UNWIND( _destroy_unconnected() );
+    _connect();
+    m_pgnNewRoot = m_rgpgn[ m_stRoot ];
+  }
+
+  ~_graph_edge_list_loader()
+  {
+    if ( m_pgnNewRoot )
+    {
+      m_rg.destroy_node( m_pgnNewRoot );
+    }
+  }
+
+  _TyGraphNode *  PGNTransferNewRoot()
+  {
+    _TyGraphNode * _pgn = m_pgnNewRoot;
+    m_pgnNewRoot = 0;
+    m_rgpgn.clear();
+    m_rgpgl.clear();
+    return _pgn;
+  }
+
+protected:
+
+  void  _destroy_unconnected() _BIEN_NOTHROW
+  {
+    for ( size_t st = 0; st < m_rgpgl.size(); ++st )
+    {
+      if ( m_rgpgl[ st ] )
+      {
+        m_rg.destroy_link( m_rgpgl[ st ] );
+      }
+    }
+    for ( size_t st = 0; st < m_rgpgn.size(); ++st )
+    {
+      m_rg.destroy_single_node( m_rgpgn[ st ] );
+    }
+    m_rgpgl.clear();
+    m_rgpgn.clear();
+  }
+
+  static size_t _StFind( vector< size_t > & _rrgst, size_t _st ) _BIEN_NOTHROW
+  {
+    while ( _rrgst[ _st ] != _st )
+    {
+      _st = _rrgst[ _st ] = _rrgst[ _rrgst[ _st ] ];
+    }
+    return _st;
+  }
+
+  // Check ids and that all nodes are connected to the root:
+  void  _check()
+  {
+    if ( m_stRoot >= m_stNodes )
+    {
+      throw bad_graph( "_graph_edge_list_loader: Root id out of range." );
+    }
+    vector< size_t > rgstSet( m_stNodes );
+    for ( size_t st = 0; st < m_stNodes; ++st )
+    {
+      rgstSet[ st ] = st;
+    }
+    size_t stSets = m_stNodes;
+    for ( size_t st = 0; st < m_stEdges; ++st )
+    {
+      if ( ( m_pEdges[ st ].m_stParent >= m_stNodes ) || ( m_pEdges[ st ].m_stChild >= m_stNodes ) )
+      {
+        throw bad_graph( "_graph_edge_list_loader: Node id out of range." );
+      }
+      size_t stP = _StFind( rgstSet, m_pEdges[ st ].m_stParent );
+      size_t stC = _StFind( rgstSet, m_pEdges[ st ].m_stChild );
+      if ( stP != stC )
+      {
+        rgstSet[ stP ] = stC;
+        --stSets;
+      }
+    }
+    if ( stSets != 1 )
+    {
+      throw bad_graph( "_graph_edge_list_loader: Not all nodes are connected to the root." );
+    }
+  }
+
+  // Stable counting sort of the edges by parent:
+  void  _sort()
+  {
+    vector< size_t > rgstStart( m_stNodes + 1, 0 );
+    for ( size_t st = 0; st < m_stEdges; ++st )
+    {
+      ++rgstStart[ m_pEdges[ st ].m_stParent + 1 ];
+    }
+    for ( size_t st = 1; st <= m_stNodes; ++st )
+    {
+      rgstStart[ st ] += rgstStart[ st - 1 ];
+    }
+    m_rgstByParent.resize( m_stEdges );
+    for ( size_t st = 0; st < m_stEdges; ++st )
+    {
+      m_rgstByParent[ rgstStart[ m_pEdges[ st ].m_stParent ]++ ] = st;
+    }
+  }
+
+  void  _create()
+  {
+    m_rgpgn.reserve( m_stNodes );
+    for ( size_t st = 0; st < m_stNodes; ++st )
+    {
+      m_rgpgn.push_back( m_rg.template create_node1< _TyNodeEl const & >( m_pNodeEls[ st ] ) );
+    }
+    // Create the links of each parent together:
+    m_rgpgl.resize( m_stEdges, (_TyGraphLink*)0 );
+    for ( size_t st = 0; st < m_stEdges; ++st )
+    {
+      size_t stEdge = m_rgstByParent[ st ];
+      m_rgpgl[ stEdge ] = m_rg.template create_link1< _TyLinkEl const & >( m_pEdges[ stEdge ].m_el );
+    }
+  }
+
+  void  _connect() _BIEN_NOTHROW
+  {
+    // Child lists - the edges of each parent are contiguous in m_rgstByParent:
+    _TyGraphLinkBaseBase ** ppglbTail = 0;
+    size_t stParentCur = m_stNodes;
+    for ( size_t st = 0; st < m_stEdges; ++st )
+    {
+      size_t stEdge = m_rgstByParent[ st ];
+      _TyEdge const & re = m_pEdges[ stEdge ];
+      if ( re.m_stParent != stParentCur )
+      {
+        stParentCur = re.m_stParent;
+        ppglbTail = m_rgpgn[ stParentCur ]->PPGLBChildHead();
+      }
+      _TyGraphLinkBaseBase * pglb = m_rgpgl[ stEdge ];
+      pglb->SetParentNode( m_rgpgn[ re.m_stParent ] );
+      pglb->SetChildNode( m_rgpgn[ re.m_stChild ] );
+      pglb->InsertChild( ppglbTail );
+      ppglbTail = pglb->PPGLBGetNextChild();
+    }
+    // Parent lists - in edge order - by inserting at the head in reverse edge order:
+    for ( size_t st = m_stEdges; st--; )
+    {
+      _TyGraphLinkBaseBase * pglb = m_rgpgl[ st ];
+      pglb->InsertParent( m_rgpgn[ m_pEdges[ st ].m_stChild ]->PPGLBParentHead() );
+    }
+  }
+};
+
+// Number the nodes of a graph and export it to arrays.
+// Node ids are stable for a given graph structure: breadth first from the root - visiting the
+//  children of a node in order and then its parents in order. The links are numbered by parent id
+//  and then position in the parent's child list - so link i is edge i and the edges are in CSR order.
+// The child id of each link is recorded as the nodes are numbered - the exports make no node lookups.
+// The graph must not be modified while the exporter is in use.
+template < class t_TyGraph >
+class _graph_edge_list_exporter
+{
+  typedef _graph_edge_list_exporter< t_TyGraph > _TyThis;
+public:
+  typedef typename t_TyGraph::_TyGraphNode              _TyGraphNode;
+  typedef typename t_TyGraph::_TyGraphLink              _TyGraphLink;
+  typedef typename t_TyGraph::_TyNodeEl                 _TyNodeEl;
+  typedef typename t_TyGraph::_TyLinkEl                 _TyLinkEl;
+  typedef typename _TyGraphNode::_TyGraphLinkBaseBase   _TyGraphLinkBaseBase;
+
+  static const size_t s_kstNull = size_t( -1 );
+
+  explicit _graph_edge_list_exporter( t_TyGraph const & _rg )
+  {
+    const _TyGraphNode * pgnRoot = _rg.get_root();
+    if ( !pgnRoot )
+    {
+      return;
+    }
+    _Number( pgnRoot );
+    for ( size_t stCur = 0; stCur < m_rgpgn.size(); ++stCur )
+    {
+      const _TyGraphNode * pgn = m_rgpgn[ stCur ];
+      m_rgstOffsets.push_back( m_rgstChildren.size() );
+      for ( const _TyGraphLinkBaseBase * pglb = *pgn->PPGLBChildHead(); pglb; pglb = pglb->PGLBGetNextChild() )
+      {
+        // Nodes are visited in id order - the child ids are recorded in CSR order:
+        m_rgstChildren.push_back( _Number( static_cast< const _TyGraphNode * >( pglb->PGNBChild() ) ) );
+      }
+      for ( const _TyGraphLinkBaseBase * pglb = *pgn->PPGLBParentHead(); pglb; pglb = pglb->PGLBGetNextParent() )
+      {
+        _Number( static_cast< const _TyGraphNode * >( pglb->PGNBParent() ) );
+      }
+    }
+    m_rgstOffsets.push_back( m_rgstChildren.size() );
+  }
+
+  // Empty - a numbering is then swapped in:
+  _graph_edge_list_exporter()
+  {
+  }
+
+  void  swap( _TyThis & _r ) _BIEN_NOTHROW
+  {
+    m_rgpgn.swap( _r.m_rgpgn );
+    m_mapIds.swap( _r.m_mapIds );
+    m_rgstOffsets.swap( _r.m_rgstOffsets );
+    m_rgstChildren.swap( _r.m_rgstChildren );
+  }
+
+  size_t  StNodes() const _BIEN_NOTHROW
+  {
+    return m_rgpgn.size();
+  }
+  size_t  StLinks() const _BIEN_NOTHROW
+  {
+    return m_rgstChildren.size();
+  }
+  const _TyGraphNode *  PGNNode( size_t _stNode ) const _BIEN_NOTHROW
+  {
+    return m_rgpgn[ _stNode ];
+  }
+  // s_kstNull if the node is not in the graph:
+  size_t  StNodeId( const _TyGraphNode * _pgn ) const
+  {
+    typename _TyMapIds::const_iterator it = m_mapIds.find( _pgn );
+    return ( it == m_mapIds.end() ) ? s_kstNull : it->second;
+  }
+
+  // Each of these writes StNodes() or StLinks() items ( CopyCSR() writes StNodes()+1 offsets ) -
+  //  and returns the output iterator past the last written:
+  template < class t_TyOutIter >
+  t_TyOutIter CopyNodeEls( t_TyOutIter _oit ) const
+  {
+    for ( size_t st = 0; st < m_rgpgn.size(); ++st, ++_oit )
+    {
+      *_oit = m_rgpgn[ st ]->RElConst();
+    }
+    return _oit;
+  }
+  template < class t_TyOutIter >
+  t_TyOutIter CopyLinkEls( t_TyOutIter _oit ) const
+  {
+    for ( size_t st = 0; st < m_rgpgn.size(); ++st )
+    {
+      for ( const _TyGraphLinkBaseBase * pglb = *m_rgpgn[ st ]->PPGLBChildHead(); pglb; pglb = pglb->PGLBGetNextChild(), ++_oit )
+      {
+        *_oit = static_cast< const _TyGraphLink * >( pglb )->RElConst();
+      }
+    }
+    return _oit;
+  }
+  template < class t_TyOutIter >
+  t_TyOutIter CopyEdges( t_TyOutIter _oit ) const
+  {
+    size_t stLink = 0;
+    for ( size_t st = 0; st < m_rgpgn.size(); ++st )
+    {
+      _TyGNIndex u = 0;
+      for ( const _TyGraphLinkBaseBase * pglb = *m_rgpgn[ st ]->PPGLBChildHead(); pglb; pglb = pglb->PGLBGetNextChild(), ++_oit, ++u, ++stLink )
+      {
+        _graph_edge_pos ep = { st, m_rgstChildren[ stLink ], u };
+        *_oit = ep;
+      }
+    }
+    return _oit;
+  }
+  // The edges with their elements - suitable for dgraph::replace_edge_list():
+  template < class t_TyOutIter >
+  t_TyOutIter CopyEdgesWithEls( t_TyOutIter _oit ) const
+  {
+    size_t stLink = 0;
+    for ( size_t st = 0; st < m_rgpgn.size(); ++st )
+    {
+      for ( const _TyGraphLinkBaseBase * pglb = *m_rgpgn[ st ]->PPGLBChildHead(); pglb; pglb = pglb->PGLBGetNextChild(), ++_oit, ++stLink )
+      {
+        _graph_edge< _TyLinkEl > e = { st, m_rgstChildren[ stLink ], static_cast< const _TyGraphLink * >( pglb )->RElConst() };
+        *_oit = e;
+      }
+    }
+    return _oit;
+  }
+  // CSR - the children of node i are _oitChildren[ offset[i] .. offset[i+1] ):
+  template < class t_TyOutIterOffsets, class t_TyOutIterChildren >
+  void  CopyCSR( t_TyOutIterOffsets _oitOffsets, t_TyOutIterChildren _oitChildren ) const
+  {
+    if ( m_rgstOffsets.empty() )
+    {
+      *_oitOffsets = 0;
+      return;
+    }
+    copy( m_rgstOffsets.begin(), m_rgstOffsets.end(), _oitOffsets );
+    copy( m_rgstChildren.begin(), m_rgstChildren.end(), _oitChildren );
+  }
+
+protected:
+
+  typedef unordered_map< const void *, size_t > _TyMapIds;
+
+  vector< const _TyGraphNode * >  m_rgpgn;
+  _TyMapIds                       m_mapIds;
+  vector< size_t >                m_rgstOffsets;  // CSR - recorded while numbering.
+  vector< size_t >                m_rgstChildren;
+
+  // The id of the node - numbering it if new:
+  size_t  _Number( const _TyGraphNode * _pgn )
+  {
+    pair< typename _TyMapIds::iterator, bool > pib = m_mapIds.insert( typename _TyMapIds::value_type( _pgn, m_rgpgn.size() ) );
+    if ( pib.second )
+    {
+      _BIEN_TRY
+      {
+        m_rgpgn.push_back( _pgn );
+      }
+      _BIEN_UNWIND( m_mapIds.erase( pib.first ) );
+    }
+    return pib.first->second;
+  }
+};
+
+template < class t_TyGraph >
+const size_t _graph_edge_list_exporter< t_TyGraph >::s_kstNull;
+
+// The default element of a node of a derived graph ( _graph_scc::condensation(),
+//  _graph_dominators::dominator_tree() ) - constructed from the node or component id. A graph whose
+//  node element is not constructible from an id passes its own functor:
+template < class t_TyNodeEl >
+struct _graph_el_from_id
+{
+  static_assert( is_constructible< t_TyNodeEl, size_t >::value,
+                  "Node element is not constructible from an id - pass an element functor." );
+  t_TyNodeEl  operator ()( size_t _st ) const
+  {
+    return static_cast< t_TyNodeEl >( _st );
+  }
+};
+
+// The reverse of a CSR ( _graph_edge_list_exporter::CopyCSR() ) by counting sort - no node lookups.
+//  The parents of node i are _rrgstParents[ _rrgstParentOffsets[i] .. _rrgstParentOffsets[i+1] ) in
+//  increasing parent id. <_prgstEdges>, if given, receives the CSR edge index of each:
+__INLINE void
+_ReverseCSR(  vector< size_t > const & _rrgstOffsets, vector< size_t > const & _rrgstChildren,
+              vector< size_t > & _rrgstParentOffsets, vector< size_t > & _rrgstParents,
+              vector< size_t > * _prgstEdges = 0 )
+{
+  size_t stNodes = _rrgstOffsets.size() - 1;
+  _rrgstParentOffsets.assign( stNodes + 1, 0 );
+  for ( size_t stEdge = 0; stEdge < _rrgstChildren.size(); ++stEdge )
+  {
+    ++_rrgstParentOffsets[ _rrgstChildren[ stEdge ] + 1 ];
+  }
+  for ( size_t st = 0; st < stNodes; ++st )
+  {
+    _rrgstParentOffsets[ st + 1 ] += _rrgstParentOffsets[ st ];
+  }
+  _rrgstParents.resize( _rrgstChildren.size() );
+  if ( _prgstEdges )
+  {
+    _prgstEdges->resize( _rrgstChildren.size() );
+  }
+  vector< size_t > rgstAt( _rrgstParentOffsets.begin(), _rrgstParentOffsets.end() - 1 );
+  for ( size_t stParent = 0; stParent < stNodes; ++stParent )
+  {
+    for ( size_t stEdge = _rrgstOffsets[ stParent ]; stEdge < _rrgstOffsets[ stParent + 1 ]; ++stEdge )
+    {
+      size_t stAt = rgstAt[ _rrgstChildren[ stEdge ] ]++;
+      _rrgstParents[ stAt ] = stParent;
+      if ( _prgstEdges )
+      {
+        ( *_prgstEdges )[ stAt ] = stEdge;
+      }
+    }
+  }
+}
+
+__DGRAPH_END_NAMESPACE
+
+#endif //__GR_BULK_H
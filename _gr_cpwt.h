@@ -16,20 +16,46 @@
 //  elements are generally small. This also necessates no knowledge of the allocator.
 // If larger elements ( than say 64 bytes ) are needed then a new implementation which allocates
 //  dynamic elements can be created.
+// _cpwt_element<> ( below ) is such an implementation for use as the element type of an ordinary
+//  graph - the element is shared between copies and copied on the first non-const access. With it
+//  the versions of a _versioned_graph ( _gr_vers.h ) share elements as well as structure.
+// A dgraph itself has no structure sharing snapshot: its nodes and links are threaded onto
+//  intrusive lists that are updated in place, so a copy that shared them would see every later
+//  write. Readers that need snapshots read versions - and the writer writes to the _versioned_graph.
+
+#include <atomic>
+#include <utility>
 
 __DGRAPH_BEGIN_NAMESPACE
 
+// Thrown when copy-on-write fails while the shadowed graph is being destroyed:
+class inconsistent_graph : public _t__Named_exception< __DGRAPH_DEFAULT_ALLOCATOR >
+{
+  typedef inconsistent_graph _TyThis;
+  typedef _t__Named_exception< __DGRAPH_DEFAULT_ALLOCATOR > _TyBase;
+public:
+  inconsistent_graph( const char * _pc )
+    : _TyBase( _pc ) 
+  {
+  }
+  inconsistent_graph( const string_type & __s ) 
+    : _TyBase( __s ) 
+  {
+  }
+};
+
 template < class t_TyShadowObjectSafe, int t_iSizeOfElement >
 struct _cpwt_graph_element_base
 {
 private:
-  typedef _cpwt_graph_element_base< t_TyShadowObjectSafe >  _TyThis;
+  typedef _cpwt_graph_element_base< t_TyShadowObjectSafe, t_iSizeOfElement >  _TyThis;
 public:
+  typedef typename t_TyShadowObjectSafe::_TyGraphConnectionLink  _TyGraphConnectionLink;
 
   t_TyShadowObjectSafe *  m_psos; // If this is null then we have an element.
   struct
   {
-    _TyConnectionLink       m_gcl;
+    _TyGraphConnectionLink  m_gcl;
     char                    m_cpEl[ t_iSizeOfElement ];
   };
   
@@ -99,24 +125,31 @@ public:
   explicit _cpwt_graph_element( _TyThis const & _r )
     : _TyBase( _r )
   {
-    if ( !m_psos )
+    if ( !this->m_psos )
     {
       // Then we need to call the copy constuctor on the element -
       //  we can't shadow a shadow element ( unless it is also shadowed ):
       // REVIEW: Perhaps we could - if all elements in the graph were shadowed.
-      _RElInt()._TyShadowElement::_TyShadowElement( _r._RElInt() );
+      new ( this->m_cpEl ) _TyShadowElement( _r._RElInt() );
     }
   }
 
   explicit _cpwt_graph_element( _TyShadowElement const & _r )
     : _TyBase()
   {
-    _RElInt()._TyShadowElement::_TyShadowElement( _r );
+    new ( this->m_cpEl ) _TyShadowElement( _r );
+  }
+  ~_cpwt_graph_element()
+  {
+    if ( !this->m_psos )
+    {
+      _RElInt().~_TyShadowElement();
+    }
   }
 
   t_TyShadowObject *  PSO() const noexcept(true)
   {
-    return static_cast< t_TyShadowObject* >( m_psos );
+    return static_cast< t_TyShadowObject* >( this->m_psos );
   }
 
   // Shadow element access:
@@ -131,16 +164,16 @@ public:
 
   _TyShadowElement &  RElNonConst()
   {
-    if ( m_psos )
+    if ( this->m_psos )
     {
       _CopyOnWrite();
     }
     return _RElInt();
   }
 
-  _TyShadowElement &  RElConst() const
+  const _TyShadowElement &  RElConst() const
   {
-    return m_psos ? PSO()->RElConst() : _RElInt();
+    return this->m_psos ? PSO()->RElConst() : _RElInt();
   }
 
   // REVIEW: Since we are a destructor we are not expected to throw - but
@@ -170,18 +203,128 @@ public:
 protected:
   _TyShadowElement & _RElInt() const noexcept(true)
   {
-    return *((_TyShadowElement*)m_cpEl);
+    return *((_TyShadowElement*)this->m_cpEl);
   }
   void _CopyOnWrite()
   {
-    Assert( m_psos );
-    m_gcl.remove_link();  // Disconnect from graph element - we are overwriting {m_gcl}.
+    Assert( this->m_psos );
+    this->m_gcl.remove_link();  // Disconnect from the shadowed element - we are about to hold our own copy.
     _BIEN_TRY
     {
-      _RElInt()._TyShadowElement::_TyShadowElement( RElConst() );
+      new ( this->m_cpEl ) _TyShadowElement( PSO()->RElConst() );
+    }
+    _BIEN_UNWIND( this->_Connect() ); // Re-connect if we throw while copying.
+    this->m_psos = 0;
+  }
+};
+
+// Copy-on-write element for ordinary graphs: copies of a _cpwt_element<> share one reference-counted
+//  instance of the element - the first non-const access through a copy that is shared gives
+//  that copy its own instance. The reference count is atomic so copies may be used on different
+//  threads ( e.g. versions of a _versioned_graph ) - but any one copy must be used by one thread at a time.
+template < class t_TyEl >
+class _cpwt_element
+{
+  typedef _cpwt_element< t_TyEl > _TyThis;
+  struct _rep
+  {
+    std::atomic< size_t > m_stRefs;
+    t_TyEl m_el;
+
+    _rep()
+      : m_stRefs( 1 ), m_el()
+    {
+    }
+    template < class t_TyP1 >
+    explicit _rep( t_TyP1 && _p1 )
+      : m_stRefs( 1 ), m_el( std::forward< t_TyP1 >( _p1 ) )
+    {
+    }
+  };
+  _rep * m_prep;
+
+public:
+  typedef t_TyEl _TyElement;
+
+  _cpwt_element()
+    : m_prep( _PRepNew() )
+  {
+  }
+  _cpwt_element( t_TyEl const & _rel )
+    : m_prep( _PRepNew( _rel ) )
+  {
+  }
+  _cpwt_element( _TyThis const & _r ) _BIEN_NOTHROW
+    : m_prep( _r.m_prep )
+  {
+    m_prep->m_stRefs.fetch_add( 1, std::memory_order_relaxed );
+  }
+  ~_cpwt_element() _BIEN_NOTHROW
+  {
+    _Release( m_prep );
+  }
+  _TyThis & operator = ( _TyThis const & _r ) _BIEN_NOTHROW
+  {
+    _r.m_prep->m_stRefs.fetch_add( 1, std::memory_order_relaxed );
+    _Release( m_prep );
+    m_prep = _r.m_prep;
+    return *this;
+  }
+  _TyThis & operator = ( t_TyEl const & _rel )
+  {
+    RElNonConst() = _rel;
+    return *this;
+  }
+
+  const t_TyEl & RElConst() const _BIEN_NOTHROW
+  {
+    return m_prep->m_el;
+  }
+  const t_TyEl & REl() const _BIEN_NOTHROW
+  {
+    return m_prep->m_el;
+  }
+  t_TyEl & RElNonConst()
+  {
+    if ( FShared() )
+    {
+      _rep * prep = _PRepNew( m_prep->m_el );
+      _Release( m_prep );
+      m_prep = prep;
+    }
+    return m_prep->m_el;
+  }
+  t_TyEl & REl()
+  {
+    return RElNonConst();
+  }
+  operator const t_TyEl & () const _BIEN_NOTHROW
+  {
+    return m_prep->m_el;
+  }
+
+  bool FShared() const _BIEN_NOTHROW
+  {
+    return m_prep->m_stRefs.load( std::memory_order_acquire ) > 1;
+  }
+
+protected:
+  static _rep * _PRepNew()
+  {
+    __THROWPT( e_ttMemory );
+    return new _rep();
+  }
+  static _rep * _PRepNew( t_TyEl const & _rel )
+  {
+    __THROWPT( e_ttMemory );
+    return new _rep( _rel );
+  }
+  static void _Release( _rep * _prep ) _BIEN_NOTHROW
+  {
+    if ( 1 == _prep->m_stRefs.fetch_sub( 1, std::memory_order_acq_rel ) )
+    {
+      delete _prep;
     }
-    _BIEN_UNWIND( _TyBase::_TyBase( m_psos ) ); // Re-connect if we throw while copying.
-    m_psos = 0;
   }
 };
 
@@ -0,0 +1,520 @@
+#ifndef __GR_CRC_H
+#define __GR_CRC_H
+
+//          Copyright David Lawrence Bien 1997 - 2021.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt).
+
+// _gr_crc.h
+
+// Checksummed graph streams.
+// A checksummed stream is a normal binary graph stream followed by a trailer containing the
+//  CRC32C of each block of the stream. The graph readers stop at the graph footer so they never
+//  see the trailer. A stream can be validated without constructing a graph.
+// Trailer layout ( all little-endian ):
+//  uint32_t  rgCrc[ nBlocks ];   // nBlocks = ceil( data bytes / block bytes ).
+//  uint32_t  magic;              // s_kuCrcTrailerMagic
+//  uint32_t  version;
+//  uint32_t  block bytes;
+//  uint32_t  CRC32C of rgCrc.
+//  uint64_t  data bytes;
+//  uint32_t  CRC32C of the preceding 24 bytes of the footer.
+//  uint32_t  magic;
+
+#include <streambuf>
+#include <istream>
+#include <ostream>
+#include <vector>
+#include <string>
+#include <string.h>
+
+// SSE4.2 is used if the compiler targets it - else on x86 it is chosen at runtime by CPU detection:
+#if defined( __SSE4_2__ )
+#include <nmmintrin.h>
+#define __GR_CRC32C_SSE42
+#define __GR_CRC32C_SSE42_TARGET
+#elif ( defined( __x86_64__ ) || defined( __i386__ ) ) && defined( __GNUC__ )
+#include <nmmintrin.h>
+#define __GR_CRC32C_SSE42
+#define __GR_CRC32C_SSE42_DISPATCH
+#define __GR_CRC32C_SSE42_TARGET __attribute__(( target( "sse4.2" ) ))
+#elif defined( _MSC_VER ) && ( defined( _M_X64 ) || defined( _M_IX86 ) )
+#include <nmmintrin.h>
+#include <intrin.h>
+#define __GR_CRC32C_SSE42
+#define __GR_CRC32C_SSE42_DISPATCH
+#define __GR_CRC32C_SSE42_TARGET
+#elif defined( __ARM_FEATURE_CRC32 )
+#include <arm_acle.h>
+#define __GR_CRC32C_ARMV8
+#endif
+
+__DGRAPH_BEGIN_NAMESPACE
+
+static const uint32_t s_kuCrcTrailerMagic = 0x4b434744; // "DGCK"
+static const uint32_t s_kuCrcTrailerVersion = 1;
+static const size_t s_kstCrcFooterBytes = 32;
+static const size_t s_kstCrcDefaultBlockBytes = 1 << 16;
+
+// Tables for the portable slicing-by-8 implementation:
+struct _crc32c_tables
+{
+  uint32_t m_rgrgu[ 8 ][ 256 ];
+
+  _crc32c_tables() _BIEN_NOTHROW
+  {
+    for ( uint32_t u = 0; u < 256; ++u )
+    {
+      uint32_t uCrc = u;
+      for ( int iBit = 0; iBit < 8; ++iBit )
+        uCrc = ( uCrc >> 1 ) ^ ( 0x82f63b78 & ( 0 - ( uCrc & 1 ) ) );
+      m_rgrgu[ 0 ][ u ] = uCrc;
+    }
+    for ( uint32_t u = 0; u < 256; ++u )
+    {
+      for ( int iTable = 1; iTable < 8; ++iTable )
+      {
+        uint32_t uPrev = m_rgrgu[ iTable - 1 ][ u ];
+        m_rgrgu[ iTable ][ u ] = ( uPrev >> 8 ) ^ m_rgrgu[ 0 ][ uPrev & 0xff ];
+      }
+    }
+  }
+  static const _crc32c_tables & RGet() _BIEN_NOTHROW
+  {
+    static const _crc32c_tables s_tables;
+    return s_tables;
+  }
+};
+
+// The implementations continue the inverted CRC <_uCrc>:
+__INLINE uint32_t
+_UCrc32cPortable( uint32_t _uCrc, const uint8_t * _pby, size_t _st ) _BIEN_NOTHROW
+{
+  const _crc32c_tables & rt = _crc32c_tables::RGet();
+  for ( ; _st >= 8; _st -= 8, _pby += 8 )
+  {
+    uint32_t uLo = _uCrc ^ ( uint32_t( _pby[0] ) | ( uint32_t( _pby[1] ) << 8 ) |
+                            ( uint32_t( _pby[2] ) << 16 ) | ( uint32_t( _pby[3] ) << 24 ) );
+    _uCrc = rt.m_rgrgu[ 7 ][ uLo & 0xff ] ^ rt.m_rgrgu[ 6 ][ ( uLo >> 8 ) & 0xff ] ^
+            rt.m_rgrgu[ 5 ][ ( uLo >> 16 ) & 0xff ] ^ rt.m_rgrgu[ 4 ][ uLo >> 24 ] ^
+            rt.m_rgrgu[ 3 ][ _pby[4] ] ^ rt.m_rgrgu[ 2 ][ _pby[5] ] ^
+            rt.m_rgrgu[ 1 ][ _pby[6] ] ^ rt.m_rgrgu[ 0 ][ _pby[7] ];
+  }
+  for ( ; _st; --_st )
+    _uCrc = ( _uCrc >> 8 ) ^ rt.m_rgrgu[ 0 ][ ( _uCrc ^ *_pby++ ) & 0xff ];
+  return _uCrc;
+}
+
+#if defined( __GR_CRC32C_SSE42 )
+__GR_CRC32C_SSE42_TARGET __INLINE uint32_t
+_UCrc32cSse42( uint32_t _uCrc, const uint8_t * _pby, size_t _st ) _BIEN_NOTHROW
+{
+  for ( ; _st && ( uintptr_t( _pby ) & 7 ); --_st )
+    _uCrc = _mm_crc32_u8( _uCrc, *_pby++ );
+#if defined( __x86_64__ ) || defined( _M_X64 )
+  uint64_t u64Crc = _uCrc;
+  for ( ; _st >= 8; _st -= 8, _pby += 8 )
+  {
+    uint64_t u64;
+    memcpy( &u64, _pby, 8 );
+    u64Crc = _mm_crc32_u64( u64Crc, u64 );
+  }
+  _uCrc = uint32_t( u64Crc );
+#else //__x86_64__
+  for ( ; _st >= 4; _st -= 4, _pby += 4 )
+  {
+    uint32_t u32;
+    memcpy( &u32, _pby, 4 );
+    _uCrc = _mm_crc32_u32( _uCrc, u32 );
+  }
+#endif //__x86_64__
+  for ( ; _st; --_st )
+    _uCrc = _mm_crc32_u8( _uCrc, *_pby++ );
+  return _uCrc;
+}
+#endif //__GR_CRC32C_SSE42
+
+#if defined( __GR_CRC32C_SSE42_DISPATCH )
+// Whether this CPU has the SSE4.2 crc32 instruction - detected once:
+__INLINE bool
+FCrc32cSse42() _BIEN_NOTHROW
+{
+  struct _detect
+  {
+    static bool FDetect() _BIEN_NOTHROW
+    {
+#if defined( _MSC_VER )
+      int rgi[ 4 ];
+      __cpuid( rgi, 1 );
+      return !!( rgi[ 2 ] & ( 1 << 20 ) );
+#else //_MSC_VER
+      __builtin_cpu_init();
+      return !!__builtin_cpu_supports( "sse4.2" );
+#endif //_MSC_VER
+    }
+  };
+  static const bool s_kfSse42 = _detect::FDetect();
+  return s_kfSse42;
+}
+#endif //__GR_CRC32C_SSE42_DISPATCH
+
+// Continue the CRC32C <_uCrc> ( 0 to start ) over [_pv,_pv+_st):
+__INLINE uint32_t
+UCrc32c( uint32_t _uCrc, const void * _pv, size_t _st ) _BIEN_NOTHROW
+{
+  const uint8_t * pby = (const uint8_t *)_pv;
+  uint32_t uCrc = ~_uCrc;
+#if defined( __GR_CRC32C_SSE42_DISPATCH )
+  uCrc = FCrc32cSse42() ? _UCrc32cSse42( uCrc, pby, _st ) : _UCrc32cPortable( uCrc, pby, _st );
+#elif defined( __GR_CRC32C_SSE42 )
+  uCrc = _UCrc32cSse42( uCrc, pby, _st );
+#elif defined( __GR_CRC32C_ARMV8 )
+  for ( ; _st && ( uintptr_t( pby ) & 7 ); --_st )
+    uCrc = __crc32cb( uCrc, *pby++ );
+  for ( ; _st >= 8; _st -= 8, pby += 8 )
+  {
+    uint64_t u64;
+    memcpy( &u64, pby, 8 );
+    uCrc = __crc32cd( uCrc, u64 );
+  }
+  for ( ; _st; --_st )
+    uCrc = __crc32cb( uCrc, *pby++ );
+#else // portable.
+  uCrc = _UCrc32cPortable( uCrc, pby, _st );
+#endif
+  return ~uCrc;
+}
+
+__INLINE void
+_CrcPutLE32( uint8_t * _pby, uint32_t _u ) _BIEN_NOTHROW
+{
+  for ( int i = 0; i < 4; ++i, _u >>= 8 )
+    _pby[ i ] = uint8_t( _u );
+}
+__INLINE void
+_CrcPutLE64( uint8_t * _pby, uint64_t _u ) _BIEN_NOTHROW
+{
+  for ( int i = 0; i < 8; ++i, _u >>= 8 )
+    _pby[ i ] = uint8_t( _u );
+}
+__INLINE uint32_t
+_CrcGetLE32( const uint8_t * _pby ) _BIEN_NOTHROW
+{
+  return uint32_t( _pby[0] ) | ( uint32_t( _pby[1] ) << 8 ) |
+         ( uint32_t( _pby[2] ) << 16 ) | ( uint32_t( _pby[3] ) << 24 );
+}
+__INLINE uint64_t
+_CrcGetLE64( const uint8_t * _pby ) _BIEN_NOTHROW
+{
+  return uint64_t( _CrcGetLE32( _pby ) ) | ( uint64_t( _CrcGetLE32( _pby + 4 ) ) << 32 );
+}
+
+// streambuf that passes output through to another streambuf and checksums it in blocks.
+// The graph output iterator seeks back to rewrite, but only ever to a position obtained from
+//  the next-to-last tellp() - so at each tellp() the complete blocks before the previous tellp()
+//  are final and are checksummed. A seek before checksummed data fails ( and Finish() throws ).
+class _graph_crc_ostreambuf : public streambuf
+{
+  typedef _graph_crc_ostreambuf _TyThis;
+  typedef streambuf _TyBase;
+public:
+
+  _graph_crc_ostreambuf( _graph_crc_ostreambuf const & ) = delete;
+  _graph_crc_ostreambuf( streambuf * _psbOut, size_t _stBlockBytes = s_kstCrcDefaultBlockBytes )
+    : m_psbOut( _psbOut ),
+      m_stBlock( _stBlockBytes )
+  {
+    if ( !m_stBlock || ( m_stBlock > UINT32_MAX ) )
+    {
+      throw bad_graph( "_graph_crc_ostreambuf: Bad block size." );
+    }
+    m_posBase = m_psbOut->pubseekoff( 0, ios_base::cur, ios_base::out );
+    if ( pos_type( off_type( -1 ) ) == m_posBase )
+    {
+      throw bad_graph( "_graph_crc_ostreambuf: Output must be seekable." );
+    }
+  }
+
+  // Checksum the remaining data and write the trailer after the end of the data.
+  void Finish()
+  {
+    if ( m_fSeekError )
+    {
+      throw bad_graph( "_graph_crc_ostreambuf::Finish(): Seek into checksummed data." );
+    }
+    _Checksum( m_posEnd, true );
+    if ( pos_type( off_type( -1 ) ) == m_psbOut->pubseekpos( m_posBase + off_type( m_posEnd ), ios_base::out ) )
+    {
+      throw bad_graph( "_graph_crc_ostreambuf::Finish(): Seek failed." );
+    }
+    vector< uint8_t > rgbyTrailer( m_rgCrc.size() * 4 + s_kstCrcFooterBytes );
+    uint8_t * pby = &rgbyTrailer[ 0 ];
+    for ( size_t st = 0; st < m_rgCrc.size(); ++st, pby += 4 )
+      _CrcPutLE32( pby, m_rgCrc[ st ] );
+    uint8_t * pbyFooter = pby;
+    _CrcPutLE32( pby, s_kuCrcTrailerMagic );
+    _CrcPutLE32( pby + 4, s_kuCrcTrailerVersion );
+    _CrcPutLE32( pby + 8, uint32_t( m_stBlock ) );
+    _CrcPutLE32( pby + 12, UCrc32c( 0, &rgbyTrailer[ 0 ], m_rgCrc.size() * 4 ) );
+    _CrcPutLE64( pby + 16, m_posEnd );
+    _CrcPutLE32( pby + 24, UCrc32c( 0, pbyFooter, 24 ) );
+    _CrcPutLE32( pby + 28, s_kuCrcTrailerMagic );
+    streamsize stWrite = streamsize( rgbyTrailer.size() );
+    if ( ( m_psbOut->sputn( (const char*)&rgbyTrailer[ 0 ], stWrite ) != stWrite ) ||
+         ( -1 == m_psbOut->pubsync() ) )
+    {
+      throw bad_graph( "_graph_crc_ostreambuf::Finish(): Writing the trailer failed." );
+    }
+  }
+
+protected:
+
+  streambuf *       m_psbOut;
+  size_t            m_stBlock;
+  pos_type          m_posBase;        // Position of the start of the data in m_psbOut.
+  vector< uint32_t > m_rgCrc;         // CRCs of the checksummed blocks.
+  vector< char >    m_rgcWindow;      // Data from m_posWindow that is not yet checksummed.
+  uint64_t          m_posWindow{0};   // All positions are relative to m_posBase.
+  uint64_t          m_posCur{0};
+  uint64_t          m_posEnd{0};
+  uint64_t          m_posLastTell{0};
+  bool              m_fSeekError{false};
+
+  void _Checksum( uint64_t _pos, bool _fPartial )
+  {
+    size_t stDone = 0;
+    while ( ( _pos - ( m_posWindow + stDone ) >= m_stBlock ) ||
+            ( _fPartial && ( _pos > m_posWindow + stDone ) ) )
+    {
+      size_t st = size_t( min< uint64_t >( m_stBlock, _pos - ( m_posWindow + stDone ) ) );
+      m_rgCrc.push_back( UCrc32c( 0, &m_rgcWindow[ stDone ], st ) );
+      stDone += st;
+    }
+    if ( stDone )
+    {
+      m_rgcWindow.erase( m_rgcWindow.begin(), m_rgcWindow.begin() + stDone );
+      m_posWindow += stDone;
+    }
+  }
+
+  pos_type _Seek( off_type _off )
+  {
+    if ( ( _off < off_type( m_posWindow ) ) || ( _off > off_type( m_posEnd ) ) )
+    {
+      m_fSeekError = true;
+      return pos_type( off_type( -1 ) );
+    }
+    pos_type pos = m_psbOut->pubseekpos( m_posBase + _off, ios_base::out );
+    if ( pos_type( off_type( -1 ) ) != pos )
+    {
+      m_posCur = uint64_t( _off );
+      m_posLastTell = min( m_posLastTell, m_posCur );
+    }
+    return pos;
+  }
+
+  pos_type seekoff( off_type _off, ios_base::seekdir _way, ios_base::openmode _which ) override
+  {
+    if ( !( _which & ios_base::out ) )
+    {
+      return pos_type( off_type( -1 ) );
+    }
+    if ( ios_base::cur == _way )
+    {
+      if ( !_off )
+      {
+        // tellp(): data before the previous tellp() won't be rewritten:
+        _Checksum( min( m_posLastTell, m_posCur ), false );
+        m_posLastTell = m_posCur;
+        return m_posBase + off_type( m_posCur );
+      }
+      return _Seek( off_type( m_posCur ) + _off );
+    }
+    if ( ios_base::end == _way )
+    {
+      return _Seek( off_type( m_posEnd ) + _off );
+    }
+    return _Seek( _off - off_type( m_posBase ) );
+  }
+  pos_type seekpos( pos_type _pos, ios_base::openmode _which ) override
+  {
+    return seekoff( off_type( _pos ), ios_base::beg, _which );
+  }
+
+  streamsize xsputn( const char * _pc, streamsize _n ) override
+  {
+    streamsize nWritten = m_psbOut->sputn( _pc, _n );
+    if ( nWritten > 0 )
+    {
+      size_t stOffset = size_t( m_posCur - m_posWindow );
+      if ( stOffset + nWritten > m_rgcWindow.size() )
+      {
+        m_rgcWindow.resize( stOffset + nWritten );
+      }
+      memcpy( &m_rgcWindow[ stOffset ], _pc, size_t( nWritten ) );
+      m_posCur += nWritten;
+      m_posEnd = max( m_posEnd, m_posCur );
+    }
+    return nWritten;
+  }
+  int_type overflow( int_type _c ) override
+  {
+    if ( traits_type::eq_int_type( _c, traits_type::eof() ) )
+    {
+      return traits_type::not_eof( _c );
+    }
+    char c = traits_type::to_char_type( _c );
+    return ( 1 == xsputn( &c, 1 ) ) ? _c : traits_type::eof();
+  }
+  int sync() override
+  {
+    return m_psbOut->pubsync();
+  }
+};
+
+// Validate the checksums of the checksummed stream in the memory image [_pvImage,_pvImage+_stImage).
+// On failure returns false and sets *_pstrError if passed.
+__INLINE bool
+FValidateGraphChecksums( const void * _pvImage, size_t _stImage, string * _pstrError = 0 )
+{
+  const uint8_t * pbyImage = (const uint8_t *)_pvImage;
+  const char * pcError = 0;
+  do
+  {
+    if ( _stImage < s_kstCrcFooterBytes )
+    {
+      pcError = "Too short to contain a checksum trailer.";
+      break;
+    }
+    const uint8_t * pbyFooter = pbyImage + _stImage - s_kstCrcFooterBytes;
+    if ( ( s_kuCrcTrailerMagic != _CrcGetLE32( pbyFooter ) ) ||
+         ( s_kuCrcTrailerMagic != _CrcGetLE32( pbyFooter + 28 ) ) )
+    {
+      pcError = "No checksum trailer.";
+      break;
+    }
+    if ( _CrcGetLE32( pbyFooter + 24 ) != UCrc32c( 0, pbyFooter, 24 ) )
+    {
+      pcError = "Checksum trailer footer is corrupt.";
+      break;
+    }
+    if ( s_kuCrcTrailerVersion != _CrcGetLE32( pbyFooter + 4 ) )
+    {
+      pcError = "Unsupported checksum trailer version.";
+      break;
+    }
+    uint64_t stBlock = _CrcGetLE32( pbyFooter + 8 );
+    uint64_t stData = _CrcGetLE64( pbyFooter + 16 );
+    uint64_t nBlocks = stBlock ? ( stData + stBlock - 1 ) / stBlock : 0;
+    if ( !stBlock || ( stData > _stImage ) || ( stData + nBlocks * 4 + s_kstCrcFooterBytes != _stImage ) )
+    {
+      pcError = "Checksum trailer doesn't match the stream length - truncated?";
+      break;
+    }
+    const uint8_t * pbyCrc = pbyImage + stData;
+    if ( _CrcGetLE32( pbyFooter + 12 ) != UCrc32c( 0, pbyCrc, size_t( nBlocks * 4 ) ) )
+    {
+      pcError = "Checksum table is corrupt.";
+      break;
+    }
+    for ( uint64_t uBlock = 0; uBlock < nBlocks; ++uBlock, pbyCrc += 4 )
+    {
+      uint64_t stOffset = uBlock * stBlock;
+      size_t st = size_t( min( stBlock, stData - stOffset ) );
+      if ( _CrcGetLE32( pbyCrc ) != UCrc32c( 0, pbyImage + stOffset, st ) )
+      {
+        pcError = "Block checksum mismatch.";
+        break;
+      }
+    }
+  }
+  while ( false );
+
+  if ( pcError && _pstrError )
+  {
+    *_pstrError = pcError;
+  }
+  return !pcError;
+}
+
+// Validate a checksummed stream read from <_ris> - which must be seekable. The stream is left at
+//  the start of the graph data so it can be passed directly to dgraph::replace_load().
+__INLINE bool
+FValidateGraphChecksums( istream & _ris, string * _pstrError = 0 )
+{
+  const char * pcError = 0;
+  istream::pos_type posBase = _ris.tellg();
+  do
+  {
+    uint8_t rgbyFooter[ s_kstCrcFooterBytes ];
+    _ris.seekg( 0, ios_base::end );
+    istream::pos_type posEnd = _ris.tellg();
+    if ( _ris.fail() || ( posEnd - posBase < streamoff( s_kstCrcFooterBytes ) ) )
+    {
+      pcError = "Too short to contain a checksum trailer.";
+      break;
+    }
+    uint64_t stImage = uint64_t( posEnd - posBase );
+    _ris.seekg( posEnd - streamoff( s_kstCrcFooterBytes ) );
+    _ris.read( (char*)rgbyFooter, s_kstCrcFooterBytes );
+    if ( _ris.fail() ||
+         ( s_kuCrcTrailerMagic != _CrcGetLE32( rgbyFooter ) ) ||
+         ( s_kuCrcTrailerMagic != _CrcGetLE32( rgbyFooter + 28 ) ) )
+    {
+      pcError = "No checksum trailer.";
+      break;
+    }
+    if ( _CrcGetLE32( rgbyFooter + 24 ) != UCrc32c( 0, rgbyFooter, 24 ) )
+    {
+      pcError = "Checksum trailer footer is corrupt.";
+      break;
+    }
+    if ( s_kuCrcTrailerVersion != _CrcGetLE32( rgbyFooter + 4 ) )
+    {
+      pcError = "Unsupported checksum trailer version.";
+      break;
+    }
+    uint64_t stBlock = _CrcGetLE32( rgbyFooter + 8 );
+    uint64_t stData = _CrcGetLE64( rgbyFooter + 16 );
+    uint64_t nBlocks = stBlock ? ( stData + stBlock - 1 ) / stBlock : 0;
+    if ( !stBlock || ( stData > stImage ) || ( stData + nBlocks * 4 + s_kstCrcFooterBytes != stImage ) )
+    {
+      pcError = "Checksum trailer doesn't match the stream length - truncated?";
+      break;
+    }
+    vector< uint8_t > rgbyCrc( size_t( nBlocks * 4 ) + 1 );
+    _ris.seekg( posBase + streamoff( stData ) );
+    _ris.read( (char*)&rgbyCrc[ 0 ], streamsize( nBlocks * 4 ) );
+    if ( _ris.fail() || ( _CrcGetLE32( rgbyFooter + 12 ) != UCrc32c( 0, &rgbyCrc[ 0 ], size_t( nBlocks * 4 ) ) ) )
+    {
+      pcError = "Checksum table is corrupt.";
+      break;
+    }
+    vector< char > rgcBlock( static_cast< size_t >( stBlock ) );
+    _ris.seekg( posBase );
+    for ( uint64_t uBlock = 0; uBlock < nBlocks; ++uBlock )
+    {
+      size_t st = size_t( min( stBlock, stData - uBlock * stBlock ) );
+      _ris.read( &rgcBlock[ 0 ], streamsize( st ) );
+      if ( _ris.fail() || ( _CrcGetLE32( &rgbyCrc[ uBlock * 4 ] ) != UCrc32c( 0, &rgcBlock[ 0 ], st ) ) )
+      {
+        pcError = "Block checksum mismatch.";
+        break;
+      }
+    }
+  }
+  while ( false );
+
+  _ris.clear();
+  _ris.seekg( posBase );
+  if ( pcError && _pstrError )
+  {
+    *_pstrError = pcError;
+  }
+  return !pcError;
+}
+
+__DGRAPH_END_NAMESPACE
+
+#endif //__GR_CRC_H
@@ -0,0 +1,327 @@
+#ifndef __GR_DAGX_H
+#define __GR_DAGX_H
+
+//          Copyright David Lawrence Bien 1997 - 2021.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt).
+
+// _gr_dagx.h
+
+// Parallel DAG executor.
+// Runs a functor on every node of an acyclic graph once all of the node's parents have completed.
+//  The one functor is called concurrently from all of the workers.
+// Each node has an atomic count of parents remaining - initialized from its parent list - the
+//  completion of a node decrements the counts of its children and a child whose count reaches
+//  zero is pushed on the completing worker's queue. Workers take from the back of their own queue
+//  and steal from the front of the others'. A worker that finds nothing sleeps until a node is
+//  pushed or the last running node completes.
+// cancel() ( from any thread - including the functor ) stops the start of further nodes - run()
+//  then returns false. If the functor throws, the run is cancelled and the exception is rethrown
+//  from run(). A cycle is reported by bad_graph - its nodes can never become ready.
+// The start time ( from the start of the run ) and duration of each node that ran are recorded.
+// The structure is captured at construction - the graph's structure must not be modified while
+//  the executor exists ( elements may be ).
+
+#include <stddef.h>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <exception>
+
+__DGRAPH_BEGIN_NAMESPACE
+
+template < class t_TyGraph >
+class _graph_dag_executor
+{
+  typedef _graph_dag_executor< t_TyGraph > _TyThis;
+public:
+  typedef t_TyGraph                                     _TyGraph;
+  typedef typename t_TyGraph::_TyGraphNode              _TyGraphNode;
+  typedef typename _TyGraphNode::_TyGraphLinkBaseBase   _TyGraphLinkBaseBase;
+  typedef _graph_edge_list_exporter< t_TyGraph >        _TyNumbering;
+  typedef chrono::steady_clock                          _TyClock;
+  typedef _TyClock::duration                            _TyDuration;
+
+  explicit _graph_dag_executor( t_TyGraph const & _rg )
+    : m_gele( _rg ),
+      m_fCancel( false )
+  {
+    size_t stNodes = m_gele.StNodes();
+    m_rgstOffsets.resize( stNodes + 1 );
+    m_rgstChildren.resize( m_gele.StLinks() );
+    m_gele.CopyCSR( m_rgstOffsets.begin(), m_rgstChildren.begin() );
+    m_rgstParents.resize( stNodes );
+    for ( size_t st = 0; st < stNodes; ++st )
+    {
+      size_t stIn = 0;
+      for ( const _TyGraphLinkBaseBase * pglb = *m_gele.PGNNode( st )->PPGLBParentHead(); pglb; pglb = pglb->PGLBGetNextParent() )
+      {
+        ++stIn;
+      }
+      m_rgstParents[ st ] = stIn;
+    }
+    m_rgdurStart.resize( stNodes );
+    m_rgdurRun.resize( stNodes );
+    m_rgfRan.resize( stNodes );
+  }
+
+  _TyNumbering const &  RNumbering() const _BIEN_NOTHROW
+  {
+    return m_gele;
+  }
+
+  // Run _rf( const _TyGraphNode *, size_t _stNode ) on each node using up to _uThreads threads
+  //  ( 0 - hardware concurrency ). Returns false if cancelled. May be called again.
+  template < class t_TyF >
+  bool  run( t_TyF _rf, unsigned _uThreads = 0 )
+  {
+    _uThreads = _graph_workers::UThreads( _uThreads );
+    size_t stNodes = m_gele.StNodes();
+    _run_state rs( stNodes, _uThreads );
+    m_fCancel.store( false );
+    for ( size_t st = 0; st < stNodes; ++st )
+    {
+      rs.m_rgatParents[ st ].store( m_rgstParents[ st ], memory_order_relaxed );
+      m_rgfRan[ st ] = false;
+      m_rgdurStart[ st ] = m_rgdurRun[ st ] = _TyDuration::zero();
+    }
+    // Seed the queues round robin:
+    for ( size_t st = 0, stQueue = 0; st < stNodes; ++st )
+    {
+      if ( !m_rgstParents[ st ] )
+      {
+        rs.m_rgpq[ stQueue ]->m_dq.push_back( st );
+        rs.m_atQueued.fetch_add( 1, memory_order_relaxed );
+        stQueue = ( stQueue + 1 ) % _uThreads;
+      }
+    }
+
+    // The queues of workers that could not be started are drained by stealing:
+    _graph_workers::run( _uThreads, [this,&rs,&_rf]( unsigned _u, unsigned ) { _Worker( rs, _rf, _u ); } );
+
+    if ( rs.m_ep )
+    {
+      rethrow_exception( rs.m_ep );
+    }
+    if ( m_fCancel.load() )
+    {
+      return false;
+    }
+    if ( rs.m_atCompleted.load() != stNodes )
+    {
+      throw bad_graph( "_graph_dag_executor::run(): Graph has a cycle." );
+    }
+    return true;
+  }
+
+  // Stop starting nodes - callable from any thread:
+  void  cancel() _BIEN_NOTHROW
+  {
+    m_fCancel.store( true );
+  }
+  bool  FCancelled() const _BIEN_NOTHROW
+  {
+    return m_fCancel.load();
+  }
+
+  // Timing of the last run - by node id:
+  bool  FRan( size_t _stNode ) const _BIEN_NOTHROW
+  {
+    return m_rgfRan[ _stNode ];
+  }
+  _TyDuration DurStart( size_t _stNode ) const _BIEN_NOTHROW
+  {
+    return m_rgdurStart[ _stNode ];
+  }
+  _TyDuration DurRun( size_t _stNode ) const _BIEN_NOTHROW
+  {
+    return m_rgdurRun[ _stNode ];
+  }
+
+protected:
+
+  struct _queue
+  {
+    mutex           m_mtx;
+    deque< size_t > m_dq;
+  };
+
+  struct _run_state
+  {
+    vector< atomic< size_t > >    m_rgatParents;
+    vector< unique_ptr< _queue > > m_rgpq;
+    atomic< size_t >              m_atQueued;     // Nodes in queues.
+    atomic< size_t >              m_atRunning;    // Nodes being run.
+    atomic< size_t >              m_atCompleted;
+    mutex                         m_mtxIdle;
+    condition_variable            m_cvIdle;
+    atomic< size_t >              m_atSignals;    // Pushes and the last completion - changed under m_mtxIdle.
+    mutex                         m_mtxEp;
+    exception_ptr                 m_ep;
+    _TyClock::time_point          m_tpStart;
+
+    _run_state( size_t _stNodes, unsigned _uQueues )
+      : m_rgatParents( _stNodes ),
+        m_atQueued( 0 ),
+        m_atRunning( 0 ),
+        m_atCompleted( 0 ),
+        m_atSignals( 0 ),
+        m_tpStart( _TyClock::now() )
+    {
+      m_rgpq.reserve( _uQueues );
+      for ( unsigned u = 0; u < _uQueues; ++u )
+      {
+        m_rgpq.push_back( unique_ptr< _queue >( new _queue ) );
+      }
+    }
+  };
+
+  _TyNumbering                  m_gele;
+  vector< size_t >              m_rgstOffsets;  // CSR children.
+  vector< size_t >              m_rgstChildren;
+  vector< size_t >              m_rgstParents;  // Parent count of each node.
+  atomic< bool >                m_fCancel;
+  vector< _TyDuration >         m_rgdurStart;
+  vector< _TyDuration >         m_rgdurRun;
+  vector< char >                m_rgfRan;
+
+  static bool _FPop( _queue & _rq, size_t & _rstNode, bool _fBack )
+  {
+    lock_guard< mutex > lock( _rq.m_mtx );
+    if ( _rq.m_dq.empty() )
+    {
+      return false;
+    }
+    if ( _fBack )
+    {
+      _rstNode = _rq.m_dq.back();
+      _rq.m_dq.pop_back();
+    }
+    else
+    {
+      _rstNode = _rq.m_dq.front();
+      _rq.m_dq.pop_front();
+    }
+    return true;
+  }
+
+  // Wake idle workers - _fAll on the last completion, else one for a push:
+  static void _Signal( _run_state & _rrs, bool _fAll ) _BIEN_NOTHROW
+  {
+    {
+      lock_guard< mutex > lock( _rrs.m_mtxIdle );
+      _rrs.m_atSignals.fetch_add( 1 );
+    }
+    if ( _fAll )
+      _rrs.m_cvIdle.notify_all();
+    else
+      _rrs.m_cvIdle.notify_one();
+  }
+  static bool _FDone( _run_state const & _rrs ) _BIEN_NOTHROW
+  {
+    return !_rrs.m_atQueued.load() && !_rrs.m_atRunning.load();
+  }
+
+  template < class t_TyF >
+  void  _Worker( _run_state & _rrs, t_TyF & _rf, unsigned _uSelf ) _BIEN_NOTHROW
+  {
+    size_t stQueues = _rrs.m_rgpq.size();
+    for ( ; ; )
+    {
+      // Read the signal count before looking - a push after the look changes it:
+      size_t stSignals = _rrs.m_atSignals.load();
+      size_t stNode;
+      bool fGot = _FPop( *_rrs.m_rgpq[ _uSelf ], stNode, true );
+      for ( size_t st = 1; !fGot && ( st < stQueues ); ++st )
+      {
+        fGot = _FPop( *_rrs.m_rgpq[ ( _uSelf + st ) % stQueues ], stNode, false );
+      }
+      if ( !fGot )
+      {
+        // Done when nothing is queued or running - otherwise wait for a push or the last completion:
+        unique_lock< mutex > lock( _rrs.m_mtxIdle );
+        _rrs.m_cvIdle.wait( lock, [&_rrs,stSignals]{ return _FDone( _rrs ) || ( stSignals != _rrs.m_atSignals.load() ); } );
+        if ( _FDone( _rrs ) )
+        {
+          return;
+        }
+        continue;
+      }
+      // Count as running before no longer queued - so the idle test never sees neither:
+      _rrs.m_atRunning.fetch_add( 1 );
+      _rrs.m_atQueued.fetch_sub( 1 );
+      if ( !m_fCancel.load( memory_order_relaxed ) )
+      {
+        _RunNode( _rrs, _rf, _uSelf, stNode );
+      }
+      if ( ( 1 == _rrs.m_atRunning.fetch_sub( 1 ) ) && !_rrs.m_atQueued.load() )
+      {
+        _Signal( _rrs, true );
+      }
+    }
+  }
+
+  template < class t_TyF >
+  void  _RunNode( _run_state & _rrs, t_TyF & _rf, unsigned _uSelf, size_t _stNode ) _BIEN_NOTHROW
+  {
+    _TyClock::time_point tpStart = _TyClock::now();
+    try
+    {
+      _rf( m_gele.PGNNode( _stNode ), _stNode );
+    }
+    catch( ... )
+    {
+      {
+        lock_guard< mutex > lock( _rrs.m_mtxEp );
+        if ( !_rrs.m_ep )
+        {
+          _rrs.m_ep = current_exception();
+        }
+      }
+      cancel();
+      return;
+    }
+    m_rgdurStart[ _stNode ] = tpStart - _rrs.m_tpStart;
+    m_rgdurRun[ _stNode ] = _TyClock::now() - tpStart;
+    m_rgfRan[ _stNode ] = true;
+    _rrs.m_atCompleted.fetch_add( 1 );
+
+    // Release the children:
+    _queue & rq = *_rrs.m_rgpq[ _uSelf ];
+    for ( size_t stEdge = m_rgstOffsets[ _stNode ]; stEdge < m_rgstOffsets[ _stNode + 1 ]; ++stEdge )
+    {
+      size_t stChild = m_rgstChildren[ stEdge ];
+      if ( 1 == _rrs.m_rgatParents[ stChild ].fetch_sub( 1, memory_order_acq_rel ) )
+      {
+        _rrs.m_atQueued.fetch_add( 1 );
+        try
+        {
+          {
+            lock_guard< mutex > lock( rq.m_mtx );
+            rq.m_dq.push_back( stChild );
+          }
+          _Signal( _rrs, false );
+        }
+        catch( ... )
+        {
+          _rrs.m_atQueued.fetch_sub( 1 );
+          lock_guard< mutex > lock( _rrs.m_mtxEp );
+          if ( !_rrs.m_ep )
+          {
+            _rrs.m_ep = current_exception();
+          }
+          cancel();
+        }
+      }
+    }
+  }
+};
+
+__DGRAPH_END_NAMESPACE
+
+#endif //__GR_DAGX_H
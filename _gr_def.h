@@ -590,11 +590,12 @@ public:
     _TyGraphLinkBase ** _ppglbRemove = 
       _TyGraphLinkBase::PPGLBGetNthParent( &m_pglbParents, _uRemove );
     _TyGraphLinkBase ** _ppglbInsert = 
-      _TyGraphLinkBase::PPGLBGetNthParent( _ppglbRemove, _uInsert - _uRemove );
-    if ( *_ppglbRemove )
+      _TyGraphLinkBase::PPGLBGetNthParent( _ppglbRemove, _uInsert - _uRemove + 1 );
+    _TyGraphLinkBase * pglbRemove = *_ppglbRemove;
+    if ( pglbRemove )
     {
-      (*_ppglbRemove)->RemoveParentAssume();
-      (*_ppglbRemove)->InsertParent( _ppglbInsert );
+      pglbRemove->RemoveParentAssume();
+      pglbRemove->InsertParent( _ppglbInsert );
     }
     else
     {
@@ -604,12 +605,13 @@ public:
   void  MoveParentDown( _TyGNIndex _uRemove, _TyGNIndex _uInsert )
   {
     Assert( _uInsert < _uRemove );
-    _TyGraphLinkBase ** _ppglbInsert = _TyGraphLinkBase::PPGLBGetNthParent( &m_pglbParents, _uRemove );
+    _TyGraphLinkBase ** _ppglbInsert = _TyGraphLinkBase::PPGLBGetNthParent( &m_pglbParents, _uInsert );
     _TyGraphLinkBase ** _ppglbRemove = _TyGraphLinkBase::PPGLBGetNthParent( _ppglbInsert, _uRemove - _uInsert );
-    if ( *_ppglbRemove )
+    _TyGraphLinkBase * pglbRemove = *_ppglbRemove;
+    if ( pglbRemove )
     {
-      (*_ppglbRemove)->RemoveParent();
-      (*_ppglbRemove)->InsertParentAssume( _ppglbInsert );
+      pglbRemove->RemoveParent();
+      pglbRemove->InsertParentAssume( _ppglbInsert );
     }
     else
     {
@@ -698,11 +700,12 @@ public:
     Assert( _uRemove < _uInsert );
     Assert( _uRemove < UChildren()-1 ); // no-op otherwise.
     _TyGraphLinkBase ** _ppglbRemove = _TyGraphLinkBase::PPGLBGetNthChild( &m_pglbChildren, _uRemove );
-    _TyGraphLinkBase ** _ppglbInsert = _TyGraphLinkBase::PPGLBGetNthChild( _ppglbRemove, _uInsert - _uRemove );
-    if ( *_ppglbRemove )
+    _TyGraphLinkBase ** _ppglbInsert = _TyGraphLinkBase::PPGLBGetNthChild( _ppglbRemove, _uInsert - _uRemove + 1 );
+    _TyGraphLinkBase * pglbRemove = *_ppglbRemove;
+    if ( pglbRemove )
     {
-      (*_ppglbRemove)->RemoveChildAssume();
-      (*_ppglbRemove)->InsertChild( _ppglbInsert );
+      pglbRemove->RemoveChildAssume();
+      pglbRemove->InsertChild( _ppglbInsert );
     }
     else
     {
@@ -712,12 +715,13 @@ public:
   void  MoveChildDown( _TyGNIndex _uRemove, _TyGNIndex _uInsert )
   {
     Assert( _uInsert < _uRemove );
-    _TyGraphLinkBase ** _ppglbInsert = _TyGraphLinkBase::PPGLBGetNthChild( &m_pglbChildren, _uRemove );
+    _TyGraphLinkBase ** _ppglbInsert = _TyGraphLinkBase::PPGLBGetNthChild( &m_pglbChildren, _uInsert );
     _TyGraphLinkBase ** _ppglbRemove = _TyGraphLinkBase::PPGLBGetNthChild( _ppglbInsert, _uRemove - _uInsert );
-    if ( *_ppglbRemove )
+    _TyGraphLinkBase * pglbRemove = *_ppglbRemove;
+    if ( pglbRemove )
     {
-      (*_ppglbRemove)->RemoveChild();
-      (*_ppglbRemove)->InsertChildAssume( _ppglbInsert );
+      pglbRemove->RemoveChild();
+      pglbRemove->InsertChildAssume( _ppglbInsert );
     }
     else
     {
@@ -1014,6 +1018,9 @@ protected:
   static __INLINE void  _deinit_link( _TyGraphLinkBase * ) _BIEN_NOTHROW
   {
   }
+  static __INLINE void  _deinit_subgraph( _TyGraphNodeBase * ) _BIEN_NOTHROW
+  {
+  }
 
 public:
 
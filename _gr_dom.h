@@ -0,0 +1,375 @@
+#ifndef __GR_DOM_H
+#define __GR_DOM_H
+
+//          Copyright David Lawrence Bien 1997 - 2021.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt).
+
+// _gr_dom.h
+
+// Dominators and post-dominators ( Cooper, Harvey, Kennedy - iterative over reverse postorder ).
+// The nodes are numbered with _graph_edge_list_exporter ( _gr_bulk.h ) - the root is node 0 - and
+//  the child and parent lists are copied to CSR arrays once at construction.
+//  compute()       - dominators: the entry is the root and the search follows the child lists.
+//  compute_post()  - post-dominators: the search follows the parent lists from the exit given or,
+//                    if none is given, from a virtual exit ( id StNodes() ) that is the parent of
+//                    every node without children.
+// A node not reached from the entry has no immediate dominator ( s_kstNull ) - as has the entry.
+//  The last computation is kept - dominance queries are answered in constant time from intervals
+//  of the dominator tree. dominator_tree() builds the tree as a dgraph.
+// The graph must not be modified while the object is in use.
+
+#include <stddef.h>
+#include <vector>
+#include <utility>
+
+__DGRAPH_BEGIN_NAMESPACE
+
+template < class t_TyGraph >
+class _graph_dominators
+{
+  typedef _graph_dominators< t_TyGraph > _TyThis;
+public:
+  typedef t_TyGraph                                     _TyGraph;
+  typedef typename t_TyGraph::_TyGraphNode              _TyGraphNode;
+  typedef _graph_edge_list_exporter< t_TyGraph >        _TyNumbering;
+
+  static const size_t s_kstNull = size_t( -1 );
+
+  explicit _graph_dominators( t_TyGraph const & _rg )
+    : m_gele( _rg ),
+      m_stEntry( s_kstNull ),
+      m_fPost( false )
+  {
+    size_t stNodes = m_gele.StNodes();
+    m_rgstOffsets.resize( stNodes + 1 );
+    m_rgstChildren.resize( m_gele.StLinks() );
+    m_gele.CopyCSR( m_rgstOffsets.begin(), m_rgstChildren.begin() );
+    _ReverseCSR( m_rgstOffsets, m_rgstChildren, m_rgstParentOffsets, m_rgstParents );
+  }
+
+  _TyNumbering const &  RNumbering() const _BIEN_NOTHROW
+  {
+    return m_gele;
+  }
+  size_t  StNodes() const _BIEN_NOTHROW
+  {
+    return m_gele.StNodes();
+  }
+
+  void  compute()
+  {
+    m_fPost = false;
+    if ( !StNodes() )
+    {
+      _Clear();
+      return;
+    }
+    _Compute( 0, m_rgstOffsets, m_rgstChildren, m_rgstParentOffsets, m_rgstParents );
+  }
+
+  void  compute_post( const _TyGraphNode * _pgnExit = 0 )
+  {
+    m_fPost = true;
+    if ( !StNodes() )
+    {
+      _Clear();
+      return;
+    }
+    if ( _pgnExit )
+    {
+      size_t stExit = m_gele.StNodeId( _pgnExit );
+      if ( s_kstNull == stExit )
+      {
+        throw _graph_nav_except( "_graph_dominators::compute_post(): Node not in graph." );
+      }
+      _Compute( stExit, m_rgstParentOffsets, m_rgstParents, m_rgstOffsets, m_rgstChildren );
+      return;
+    }
+    // The reversed graph with the virtual exit - node StNodes():
+    size_t stNodes = StNodes();
+    vector< size_t > rgstSuccOffsets( m_rgstParentOffsets );
+    vector< size_t > rgstSucc( m_rgstParents );
+    vector< size_t > rgstPredOffsets( stNodes + 2 );
+    vector< size_t > rgstPred;
+    rgstPred.reserve( m_rgstChildren.size() + stNodes );
+    for ( size_t st = 0; st < stNodes; ++st )
+    {
+      rgstPredOffsets[ st ] = rgstPred.size();
+      rgstPred.insert( rgstPred.end(), m_rgstChildren.begin() + m_rgstOffsets[ st ], m_rgstChildren.begin() + m_rgstOffsets[ st + 1 ] );
+      if ( m_rgstOffsets[ st ] == m_rgstOffsets[ st + 1 ] )
+      {
+        rgstPred.push_back( stNodes );
+        rgstSucc.push_back( st );
+      }
+    }
+    rgstPredOffsets[ stNodes ] = rgstPredOffsets[ stNodes + 1 ] = rgstPred.size();
+    rgstSuccOffsets.push_back( rgstSucc.size() );
+    _Compute( stNodes, rgstSuccOffsets, rgstSucc, rgstPredOffsets, rgstPred );
+  }
+
+  bool  FPost() const _BIEN_NOTHROW
+  {
+    return m_fPost;
+  }
+  // The entry of the last computation - StNodes() for the virtual exit:
+  size_t  StEntry() const _BIEN_NOTHROW
+  {
+    return m_stEntry;
+  }
+  // By node id ( RNumbering() ):
+  size_t  StIDom( size_t _stNode ) const _BIEN_NOTHROW
+  {
+    return m_rgstIDom[ _stNode ];
+  }
+  vector< size_t > const &  RgstIDom() const _BIEN_NOTHROW
+  {
+    return m_rgstIDom;
+  }
+  // 0 for the entry, an unreached node or the virtual exit:
+  const _TyGraphNode *  PGNIDom( const _TyGraphNode * _pgn ) const
+  {
+    size_t stIDom = m_rgstIDom[ _StIdChecked( _pgn ) ];
+    return ( ( s_kstNull == stIDom ) || ( stIDom == StNodes() ) ) ? 0 : m_gele.PGNNode( stIDom );
+  }
+  bool  FReached( size_t _stNode ) const _BIEN_NOTHROW
+  {
+    return s_kstNull != m_rgstPre[ _stNode ];
+  }
+  // Every node ( post- )dominates itself:
+  bool  FDominates( size_t _stDom, size_t _stNode ) const _BIEN_NOTHROW
+  {
+    return FReached( _stNode ) && FReached( _stDom ) &&
+            ( m_rgstPre[ _stDom ] <= m_rgstPre[ _stNode ] ) && ( m_rgstPost[ _stNode ] <= m_rgstPost[ _stDom ] );
+  }
+  bool  FDominates( const _TyGraphNode * _pgnDom, const _TyGraphNode * _pgn ) const
+  {
+    return FDominates( _StIdChecked( _pgnDom ), _StIdChecked( _pgn ) );
+  }
+
+  // Build the dominator tree of the last computation in _rgTree - replacing its contents. The tree
+  //  has the reached nodes - the element of each is _rf( node id ), by default constructed from the
+  //  id ( StNodes() for the virtual exit ) - and a link from each immediate dominator to the nodes
+  //  it dominates. The root is the entry.
+  template < class t_TyTreeGraph >
+  void  dominator_tree( t_TyTreeGraph & _rgTree ) const
+  {
+    dominator_tree( _rgTree, _graph_el_from_id< typename t_TyTreeGraph::_TyNodeEl >() );
+  }
+  template < class t_TyTreeGraph, class t_TyF >
+  void  dominator_tree( t_TyTreeGraph & _rgTree, t_TyF _rf ) const
+  {
+    typedef typename t_TyTreeGraph::_TyNodeEl _TyTreeNodeEl;
+    typedef typename t_TyTreeGraph::_TyLinkEl _TyTreeLinkEl;
+    if ( s_kstNull == m_stEntry )
+    {
+      _rgTree.destroy();
+      return;
+    }
+    // Tree node i is the node with preorder number i:
+    vector< size_t > rgstByPre( m_rgstPre.size() );
+    size_t stReached = 0;
+    for ( size_t st = 0; st < m_rgstPre.size(); ++st )
+    {
+      if ( FReached( st ) )
+      {
+        rgstByPre[ m_rgstPre[ st ] ] = st;
+        ++stReached;
+      }
+    }
+    vector< _TyTreeNodeEl > rgNodeEls;
+    rgNodeEls.reserve( stReached );
+    vector< _graph_edge< _TyTreeLinkEl > > rgEdges( stReached - 1 );
+    for ( size_t st = 0; st < stReached; ++st )
+    {
+      size_t stNode = rgstByPre[ st ];
+      rgNodeEls.push_back( _rf( stNode ) );
+      if ( st )
+      {
+        rgEdges[ st - 1 ].m_stParent = m_rgstPre[ m_rgstIDom[ stNode ] ];
+        rgEdges[ st - 1 ].m_stChild = st;
+      }
+    }
+    _rgTree.replace_edge_list( &rgNodeEls[ 0 ], rgNodeEls.size(),
+                               rgEdges.empty() ? 0 : &rgEdges[ 0 ], rgEdges.size(), 0 );
+  }
+
+protected:
+
+  _TyNumbering      m_gele;
+  vector< size_t >  m_rgstOffsets;        // CSR children.
+  vector< size_t >  m_rgstChildren;
+  vector< size_t >  m_rgstParentOffsets;  // CSR parents.
+  vector< size_t >  m_rgstParents;
+  size_t            m_stEntry;
+  bool              m_fPost;
+  vector< size_t >  m_rgstIDom;
+  vector< size_t >  m_rgstPre;            // Intervals in the dominator tree.
+  vector< size_t >  m_rgstPost;
+
+  size_t  _StIdChecked( const _TyGraphNode * _pgn ) const
+  {
+    size_t stNode = m_gele.StNodeId( _pgn );
+    if ( s_kstNull == stNode )
+    {
+      throw _graph_nav_except( "_graph_dominators: Node not in graph." );
+    }
+    return stNode;
+  }
+
+  void  _Clear() _BIEN_NOTHROW
+  {
+    m_stEntry = s_kstNull;
+    m_rgstIDom.clear();
+    m_rgstPre.clear();
+    m_rgstPost.clear();
+  }
+
+  void  _Compute( size_t _stEntry,
+                  vector< size_t > const & _rrgstSuccOffsets, vector< size_t > const & _rrgstSucc,
+                  vector< size_t > const & _rrgstPredOffsets, vector< size_t > const & _rrgstPred )
+  {
+    size_t stNodes = _rrgstSuccOffsets.size() - 1;
+
+    // Postorder of the nodes reached from the entry:
+    vector< size_t > rgstOrder;
+    rgstOrder.reserve( stNodes );
+    vector< size_t > rgstRpo( stNodes, s_kstNull );
+    {
+      vector< char > rgfSeen( stNodes, false );
+      vector< pair< size_t, size_t > > rgprStack;
+      rgfSeen[ _stEntry ] = true;
+      rgprStack.push_back( make_pair( _stEntry, _rrgstSuccOffsets[ _stEntry ] ) );
+      while ( !rgprStack.empty() )
+      {
+        size_t stV = rgprStack.back().first;
+        size_t & rstEdge = rgprStack.back().second;
+        if ( rstEdge < _rrgstSuccOffsets[ stV + 1 ] )
+        {
+          size_t stW = _rrgstSucc[ rstEdge++ ];
+          if ( !rgfSeen[ stW ] )
+          {
+            rgfSeen[ stW ] = true;
+            rgprStack.push_back( make_pair( stW, _rrgstSuccOffsets[ stW ] ) );
+          }
+        }
+        else
+        {
+          rgstOrder.push_back( stV );
+          rgprStack.pop_back();
+        }
+      }
+    }
+    size_t stReached = rgstOrder.size();
+    for ( size_t st = 0; st < stReached; ++st )
+    {
+      rgstRpo[ rgstOrder[ st ] ] = stReached - 1 - st;
+    }
+
+    vector< size_t > rgstIDom( stNodes, s_kstNull );
+    rgstIDom[ _stEntry ] = _stEntry;
+    for ( bool fChanged = true; fChanged; )
+    {
+      fChanged = false;
+      // Reverse postorder - skipping the entry:
+      for ( size_t st = stReached - 1; st--; )
+      {
+        size_t stV = rgstOrder[ st ];
+        size_t stNew = s_kstNull;
+        for ( size_t stEdge = _rrgstPredOffsets[ stV ]; stEdge < _rrgstPredOffsets[ stV + 1 ]; ++stEdge )
+        {
+          size_t stP = _rrgstPred[ stEdge ];
+          if ( s_kstNull == rgstIDom[ stP ] )
+          {
+            continue;
+          }
+          if ( s_kstNull == stNew )
+          {
+            stNew = stP;
+            continue;
+          }
+          // Intersect - walk up the tree by reverse postorder number:
+          while ( stP != stNew )
+          {
+            while ( rgstRpo[ stP ] > rgstRpo[ stNew ] )
+            {
+              stP = rgstIDom[ stP ];
+            }
+            while ( rgstRpo[ stNew ] > rgstRpo[ stP ] )
+            {
+              stNew = rgstIDom[ stNew ];
+            }
+          }
+        }
+        if ( rgstIDom[ stV ] != stNew )
+        {
+          rgstIDom[ stV ] = stNew;
+          fChanged = true;
+        }
+      }
+    }
+    rgstIDom[ _stEntry ] = s_kstNull;
+
+    // Intervals of the dominator tree - children in CSR then depth-first:
+    vector< size_t > rgstTreeOffsets( stNodes + 1, 0 );
+    vector< size_t > rgstTree( stReached ? stReached - 1 : 0 );
+    for ( size_t st = 0; st < stNodes; ++st )
+    {
+      if ( s_kstNull != rgstIDom[ st ] )
+      {
+        ++rgstTreeOffsets[ rgstIDom[ st ] + 1 ];
+      }
+    }
+    for ( size_t st = 0; st < stNodes; ++st )
+    {
+      rgstTreeOffsets[ st + 1 ] += rgstTreeOffsets[ st ];
+    }
+    {
+      vector< size_t > rgstFill( rgstTreeOffsets.begin(), rgstTreeOffsets.end() - 1 );
+      for ( size_t st = 0; st < stNodes; ++st )
+      {
+        if ( s_kstNull != rgstIDom[ st ] )
+        {
+          rgstTree[ rgstFill[ rgstIDom[ st ] ]++ ] = st;
+        }
+      }
+    }
+    vector< size_t > rgstPre( stNodes, s_kstNull );
+    vector< size_t > rgstPost( stNodes, s_kstNull );
+    {
+      size_t stPre = 0, stPost = 0;
+      vector< pair< size_t, size_t > > rgprStack;
+      rgstPre[ _stEntry ] = stPre++;
+      rgprStack.push_back( make_pair( _stEntry, rgstTreeOffsets[ _stEntry ] ) );
+      while ( !rgprStack.empty() )
+      {
+        size_t stV = rgprStack.back().first;
+        size_t & rstEdge = rgprStack.back().second;
+        if ( rstEdge < rgstTreeOffsets[ stV + 1 ] )
+        {
+          size_t stW = rgstTree[ rstEdge++ ];
+          rgstPre[ stW ] = stPre++;
+          rgprStack.push_back( make_pair( stW, rgstTreeOffsets[ stW ] ) );
+        }
+        else
+        {
+          rgstPost[ stV ] = stPost++;
+          rgprStack.pop_back();
+        }
+      }
+    }
+
+    m_stEntry = _stEntry;
+    m_rgstIDom.swap( rgstIDom );
+    m_rgstPre.swap( rgstPre );
+    m_rgstPost.swap( rgstPost );
+  }
+};
+
+template < class t_TyGraph >
+const size_t _graph_dominators< t_TyGraph >::s_kstNull;
+
+__DGRAPH_END_NAMESPACE
+
+#endif //__GR_DOM_H
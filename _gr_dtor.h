@@ -47,23 +47,23 @@ protected:
   void  _DeallocateNode( _TyGraphNodeBaseBase * _pgnb )
   { 
     Assert( _pgnb );
-    m_rg._deallocate_node( static_cast< _TyGraphNode* >( _pgnb ) );
+    m_rg._epoch_deallocate_node( static_cast< _TyGraphNode* >( _pgnb ) );
   }
   void  _DestructNode( _TyGraphNodeBaseBase * _pgnb )
   {
     Assert( _pgnb );
-    m_rg._destruct_node( static_cast< _TyGraphNode* >( _pgnb ) );
+    m_rg._epoch_destruct_node( static_cast< _TyGraphNode* >( _pgnb ) );
   }
 
   void  _DeallocateLink( _TyGraphLinkBaseBase * _pglb )
   {
     Assert( _pglb );
-    m_rg._deallocate_link( static_cast< _TyGraphLink* >( _pglb ) );
+    m_rg._epoch_deallocate_link( static_cast< _TyGraphLink* >( _pglb ) );
   }
   void  _DestructLink( _TyGraphLinkBaseBase * _pglb )
   {
     Assert( _pglb );
-    m_rg._destruct_link( static_cast< _TyGraphLink* >( _pglb ) );
+    m_rg._epoch_destruct_link( static_cast< _TyGraphLink* >( _pglb ) );
   }
 };
 
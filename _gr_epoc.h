@@ -0,0 +1,288 @@
+#ifndef __GR_EPOC_H
+#define __GR_EPOC_H
+
+//          Copyright David Lawrence Bien 1997 - 2021.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt).
+
+// _gr_epoc.h
+
+// Epoch based reclamation for concurrent reading of a dgraph.
+// Model: Any number of reader threads traverse the graph with non-safe iterators while a
+//  single writer thread mutates it. A graph with an epoch domain set ( dgraph::set_epoch_domain() )
+//  does not destruct elements or deallocate nodes and links when they are destroyed - it retires
+//  them to the domain. Retired objects are reclaimed once every reader that might have seen them
+//  has left its read section. So a reader never touches freed memory.
+// Usage:
+//  Writer: graph.set_epoch_domain( &ged ); ... mutate ...; ged.reclaim() periodically ( retire()
+//    does this every s_kstReclaimPeriod retirements ).
+//  Reader: a _graph_epoch_reader per thread per domain; hold a _graph_epoch_read_lock while
+//    any pointer into the graph is held.
+// synchronize() waits for every read section to end - so the writer must not call it ( or retire()
+//  while out of memory ) from within its own read section. Nothing else the writer does waits.
+// Note: This guarantees memory safety only - it defers frees, nothing more. The intrusive node/link
+//  pointers are plain ( non-atomic ) data and the writer updates them in place, so a reader loading
+//  a pointer the writer is storing is a data race. Readers must exclude the writer's relinking for
+//  each navigation step ( e.g. a shared_mutex held shared per step by readers and exclusive by the
+//  writer while it links/unlinks ) - the read section then keeps what they have reached allocated
+//  across steps. Such a reader can still observe the graph partly before and partly after a
+//  structural change - readers that need a consistent view should read a version of a
+//  _versioned_graph ( _gr_vers.h ) instead.
+// Set the root node before starting readers.
+
+#include <stdint.h>
+#include <atomic>
+#include <mutex>
+#include <deque>
+#include <thread>
+
+__DGRAPH_BEGIN_NAMESPACE
+
+class _graph_epoch_domain;
+
+// Per-thread reader record - must be used only by the thread that owns it:
+class _graph_epoch_reader
+{
+  typedef _graph_epoch_reader _TyThis;
+  friend class _graph_epoch_domain;
+
+  _graph_epoch_domain & m_rged;
+  atomic< uint64_t > m_uEpoch;      // Epoch at entry to the read section - 0 when quiescent.
+  unsigned m_uNest;                 // Allow nested read sections.
+  _TyThis * m_pgerNext;             // Next in the domain's registry.
+  thread::id m_idThread;            // The owning thread.
+
+  _graph_epoch_reader( _TyThis const & ) = delete;
+  _TyThis & operator =( _TyThis const & ) = delete;
+
+public:
+  explicit _graph_epoch_reader( _graph_epoch_domain & _rged );
+  ~_graph_epoch_reader();
+
+  void enter() _BIEN_NOTHROW;
+  void leave() _BIEN_NOTHROW
+  {
+    Assert( m_uNest );
+    if ( !--m_uNest )
+    {
+      m_uEpoch.store( 0, memory_order_release );
+    }
+  }
+  bool FInReadSection() const _BIEN_NOTHROW
+  {
+    return !!m_uNest;
+  }
+};
+
+// Read section:
+class _graph_epoch_read_lock
+{
+  _graph_epoch_reader & m_rger;
+  _graph_epoch_read_lock( _graph_epoch_read_lock const & ) = delete;
+  _graph_epoch_read_lock & operator =( _graph_epoch_read_lock const & ) = delete;
+public:
+  explicit _graph_epoch_read_lock( _graph_epoch_reader & _rger ) _BIEN_NOTHROW
+    : m_rger( _rger )
+  {
+    m_rger.enter();
+  }
+  ~_graph_epoch_read_lock() _BIEN_NOTHROW
+  {
+    m_rger.leave();
+  }
+};
+
+class _graph_epoch_domain
+{
+  typedef _graph_epoch_domain _TyThis;
+  friend class _graph_epoch_reader;
+public:
+
+  typedef void ( * _TyPfnReclaim )( void * _pv, void * _pvContext );
+
+  static const size_t s_kstReclaimPeriod = 256; // Attempt reclamation every this many retirements.
+
+  _graph_epoch_domain() _BIEN_NOTHROW
+    : m_uEpoch( 1 ),
+      m_pgerHead( 0 ),
+      m_stSinceReclaim( 0 )
+  {
+  }
+  ~_graph_epoch_domain()
+  {
+    Assert( !m_pgerHead ); // All readers should be gone.
+    _ReclaimBefore( UINT64_MAX );
+  }
+
+  // Writer: Retire an object that is no longer reachable from the graph - _pfnReclaim( _pv, _pvContext )
+  //  will be called once no reader can be referencing it. Objects are reclaimed in retirement order.
+  void retire( void * _pv, _TyPfnReclaim _pfnReclaim, void * _pvContext ) _BIEN_NOTHROW
+  {
+    try
+    {
+      __THROWPT( e_ttMemory );
+      m_dqRetired.push_back( _retired( _pv, _pfnReclaim, _pvContext,
+                                       m_uEpoch.load( memory_order_relaxed ) ) );
+    }
+    catch( ... )
+    {
+      // No memory to defer - wait out the readers and reclaim everything now:
+      Assert( !_FCallerReading() );
+      synchronize();
+      (*_pfnReclaim)( _pv, _pvContext );
+      return;
+    }
+    if ( ++m_stSinceReclaim >= s_kstReclaimPeriod )
+    {
+      reclaim();
+    }
+  }
+
+  // Writer: Reclaim those retired objects that no reader can be referencing. Returns the number reclaimed.
+  size_t reclaim() _BIEN_NOTHROW
+  {
+    m_stSinceReclaim = 0;
+    // Readers that enter from here on will see no object retired before the advance:
+    m_uEpoch.fetch_add( 1, memory_order_seq_cst );
+    return _ReclaimBefore( _UMinReaderEpoch() );
+  }
+
+  // Writer: Wait for all current read sections to end and reclaim all retired objects.
+  // Must not be called from within a read section of this domain - it would wait for itself.
+  void synchronize() _BIEN_NOTHROW
+  {
+    Assert( !_FCallerReading() );
+    uint64_t uEpoch = m_uEpoch.fetch_add( 1, memory_order_seq_cst );
+    for ( unsigned uSpin = 0; _UMinReaderEpoch() <= uEpoch; )
+    {
+      if ( !( ++uSpin % 64 ) )
+      {
+        this_thread::yield();
+      }
+    }
+    m_stSinceReclaim = 0;
+    _ReclaimBefore( UINT64_MAX );
+  }
+
+  size_t NRetired() const _BIEN_NOTHROW
+  {
+    return m_dqRetired.size();
+  }
+
+protected:
+
+  struct _retired
+  {
+    void * m_pv;
+    _TyPfnReclaim m_pfnReclaim;
+    void * m_pvContext;
+    uint64_t m_uEpoch;
+
+    _retired( void * _pv, _TyPfnReclaim _pfnReclaim, void * _pvContext, uint64_t _uEpoch )
+      : m_pv( _pv ), m_pfnReclaim( _pfnReclaim ), m_pvContext( _pvContext ), m_uEpoch( _uEpoch )
+    {
+    }
+  };
+  typedef deque< _retired > _TyDequeRetired;
+
+  atomic< uint64_t > m_uEpoch;   // Global epoch.
+  mutex m_mtxReaders;            // Guards the reader registry - not the read sections.
+  _graph_epoch_reader * m_pgerHead;   // Registered readers.
+  _TyDequeRetired m_dqRetired;        // Writer only - in order of nondecreasing epoch.
+  size_t m_stSinceReclaim;
+
+  // True if a reader owned by the calling thread is in a read section ( debug check ):
+  bool _FCallerReading() _BIEN_NOTHROW
+  {
+    lock_guard< mutex > lock( m_mtxReaders );
+    for ( _graph_epoch_reader * pger = m_pgerHead; pger; pger = pger->m_pgerNext )
+    {
+      if ( ( pger->m_idThread == this_thread::get_id() ) && pger->FInReadSection() )
+      {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // The minimum epoch of any reader in a read section - UINT64_MAX if none are:
+  uint64_t _UMinReaderEpoch() _BIEN_NOTHROW
+  {
+    uint64_t uMin = UINT64_MAX;
+    lock_guard< mutex > lock( m_mtxReaders );
+    for ( _graph_epoch_reader * pger = m_pgerHead; pger; pger = pger->m_pgerNext )
+    {
+      uint64_t u = pger->m_uEpoch.load( memory_order_seq_cst );
+      if ( u && ( u < uMin ) )
+      {
+        uMin = u;
+      }
+    }
+    return uMin;
+  }
+
+  // An object retired in epoch E may be referenced only by readers that entered in epoch <= E:
+  size_t _ReclaimBefore( uint64_t _uMinReaderEpoch ) _BIEN_NOTHROW
+  {
+    size_t stReclaimed = 0;
+    while ( !m_dqRetired.empty() && ( m_dqRetired.front().m_uEpoch < _uMinReaderEpoch ) )
+    {
+      _retired r = m_dqRetired.front();
+      m_dqRetired.pop_front();
+      (*r.m_pfnReclaim)( r.m_pv, r.m_pvContext );
+      ++stReclaimed;
+    }
+    return stReclaimed;
+  }
+
+  void _Register( _graph_epoch_reader * _pger )
+  {
+    lock_guard< mutex > lock( m_mtxReaders );
+    _pger->m_pgerNext = m_pgerHead;
+    m_pgerHead = _pger;
+  }
+  void _Unregister( _graph_epoch_reader * _pger ) _BIEN_NOTHROW
+  {
+    lock_guard< mutex > lock( m_mtxReaders );
+    _graph_epoch_reader ** ppger = &m_pgerHead;
+    for ( ; *ppger != _pger; ppger = &(*ppger)->m_pgerNext )
+    {
+      Assert( *ppger );
+    }
+    *ppger = _pger->m_pgerNext;
+  }
+};
+
+inline
+_graph_epoch_reader::_graph_epoch_reader( _graph_epoch_domain & _rged )
+  : m_rged( _rged ),
+    m_uEpoch( 0 ),
+    m_uNest( 0 ),
+    m_pgerNext( 0 ),
+    m_idThread( this_thread::get_id() )
+{
+  m_rged._Register( this );
+}
+
+inline
+_graph_epoch_reader::~_graph_epoch_reader()
+{
+  Assert( !m_uNest );
+  m_rged._Unregister( this );
+}
+
+inline void
+_graph_epoch_reader::enter() _BIEN_NOTHROW
+{
+  if ( !m_uNest++ )
+  {
+    // Publish our epoch before reading any graph pointer - the seq_cst store orders this against
+    //  the writer's advance and scan of the reader epochs:
+    m_uEpoch.store( m_rged.m_uEpoch.load( memory_order_seq_cst ), memory_order_seq_cst );
+  }
+}
+
+__DGRAPH_END_NAMESPACE
+
+#endif //__GR_EPOC_H
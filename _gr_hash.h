@@ -0,0 +1,225 @@
+#ifndef __GR_HASH_H
+#define __GR_HASH_H
+
+//          Copyright David Lawrence Bien 1997 - 2021.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt).
+
+// _gr_hash.h
+
+// Structural hashing and equality of graphs.
+// The relations of a node are ordered, so a breadth-first walk from the root that takes each
+//  node's child list and then its parent list in order numbers the nodes and links of a graph
+//  canonically: two graphs are equal ( in structure and values ) exactly when their walks meet the
+//  same elements and the same node and link numbers at every step. Nodes and links are numbered
+//  at first encounter.
+// _graph_structural_hash hashes the walk - the element hashes combined with the numbers in
+//  relation order - in one pass. _graph_structure_equal() makes the two walks in step and stops at
+//  the first difference. Equal graphs have equal hashes, so cached hashes that differ settle
+//  inequality without a walk ( dgraph::equal_structure() ).
+
+#include <stddef.h>
+#include <vector>
+#include <unordered_map>
+#include <functional>
+#include <utility>
+#include <type_traits>
+
+__DGRAPH_BEGIN_NAMESPACE
+
+// Numbering at first encounter for the canonical walk:
+template < class t_TyGraph >
+struct _graph_canonical_numbering
+{
+  typedef typename t_TyGraph::_TyGraphNode              _TyGraphNode;
+  typedef typename t_TyGraph::_TyGraphLink              _TyGraphLink;
+  typedef unordered_map< const void *, size_t >         _TyMapIds;
+
+  _TyMapIds                       m_mapNodes;
+  _TyMapIds                       m_mapLinks;
+  vector< const _TyGraphNode * >  m_rgpgn;      // The walk's queue - by node number.
+
+  // Returns the number and whether it was just assigned:
+  pair< size_t, bool >  PrNode( const _TyGraphNode * _pgn )
+  {
+    pair< typename _TyMapIds::iterator, bool > pib = m_mapNodes.insert( typename _TyMapIds::value_type( _pgn, m_rgpgn.size() ) );
+    if ( pib.second )
+    {
+      _BIEN_TRY
+      {
+        m_rgpgn.push_back( _pgn );
+      }
+      _BIEN_UNWIND( m_mapNodes.erase( pib.first ) );
+    }
+    return make_pair( pib.first->second, pib.second );
+  }
+  pair< size_t, bool >  PrLink( const _TyGraphLink * _pgl )
+  {
+    pair< typename _TyMapIds::iterator, bool > pib = m_mapLinks.insert( typename _TyMapIds::value_type( _pgl, m_mapLinks.size() ) );
+    return make_pair( pib.first->second, pib.second );
+  }
+};
+
+template <  class t_TyGraph,
+            class t_TyNodeElHash = hash< typename t_TyGraph::_TyNodeEl >,
+            class t_TyLinkElHash = hash< typename t_TyGraph::_TyLinkEl > >
+struct _graph_structural_hash
+{
+  typedef typename t_TyGraph::_TyGraphNode              _TyGraphNode;
+  typedef typename t_TyGraph::_TyGraphLink              _TyGraphLink;
+  typedef typename _TyGraphNode::_TyGraphLinkBaseBase   _TyGraphLinkBaseBase;
+
+  static size_t compute(  t_TyGraph const & _rg,
+                          t_TyNodeElHash const & _rnh = t_TyNodeElHash(),
+                          t_TyLinkElHash const & _rlh = t_TyLinkElHash() )
+  {
+    size_t stHash = 0;
+    const _TyGraphNode * pgnRoot = _rg.get_root();
+    if ( !pgnRoot )
+    {
+      return stHash;
+    }
+    _graph_canonical_numbering< t_TyGraph > gcn;
+    gcn.PrNode( pgnRoot );
+    for ( size_t stCur = 0; stCur < gcn.m_rgpgn.size(); ++stCur )
+    {
+      const _TyGraphNode * pgn = gcn.m_rgpgn[ stCur ];
+      _Combine( stHash, _rnh( pgn->RElConst() ) );
+      size_t stRelations = 0;
+      for ( const _TyGraphLinkBaseBase * pglb = *pgn->PPGLBChildHead(); pglb; pglb = pglb->PGLBGetNextChild(), ++stRelations )
+      {
+        _Link( stHash, gcn, _rlh, static_cast< const _TyGraphLink * >( pglb ), pglb->PGNBChild() );
+      }
+      _Combine( stHash, stRelations );
+      stRelations = 0;
+      for ( const _TyGraphLinkBaseBase * pglb = *pgn->PPGLBParentHead(); pglb; pglb = pglb->PGLBGetNextParent(), ++stRelations )
+      {
+        _Link( stHash, gcn, _rlh, static_cast< const _TyGraphLink * >( pglb ), pglb->PGNBParent() );
+      }
+      _Combine( stHash, stRelations );
+    }
+    return stHash;
+  }
+
+protected:
+
+  static void _Combine( size_t & _rstHash, size_t _st ) _BIEN_NOTHROW
+  {
+    _rstHash ^= _st + size_t( 0x9e3779b97f4a7c15ull ) + ( _rstHash << 6 ) + ( _rstHash >> 2 );
+  }
+
+  static void _Link(  size_t & _rstHash, _graph_canonical_numbering< t_TyGraph > & _rgcn,
+                      t_TyLinkElHash const & _rlh, const _TyGraphLink * _pgl,
+                      const typename _TyGraphLinkBaseBase::_TyGraphNodeBase * _pgnbOther )
+  {
+    pair< size_t, bool > prLink = _rgcn.PrLink( _pgl );
+    _Combine( _rstHash, prLink.first );
+    if ( prLink.second )
+    {
+      _Combine( _rstHash, _rlh( _pgl->RElConst() ) );
+    }
+    _Combine( _rstHash, _rgcn.PrNode( static_cast< const _TyGraphNode * >( _pgnbOther ) ).first );
+  }
+};
+
+// Structure and value equality - elements are compared with ==:
+template < class t_TyGraph, class t_TyGraphOther >
+bool  _graph_structure_equal( t_TyGraph const & _rg, t_TyGraphOther const & _rgOther )
+{
+  typedef typename t_TyGraph::_TyGraphNode                      _TyGraphNode;
+  typedef typename t_TyGraph::_TyGraphLink                      _TyGraphLink;
+  typedef typename _TyGraphNode::_TyGraphLinkBaseBase           _TyGraphLinkBaseBase;
+  typedef typename t_TyGraphOther::_TyGraphNode                 _TyGraphNodeOther;
+  typedef typename t_TyGraphOther::_TyGraphLink                 _TyGraphLinkOther;
+  typedef typename _TyGraphNodeOther::_TyGraphLinkBaseBase      _TyGraphLinkBaseBaseOther;
+
+  const _TyGraphNode * pgnRoot = _rg.get_root();
+  const _TyGraphNodeOther * pgnRootOther = _rgOther.get_root();
+  if ( !pgnRoot || !pgnRootOther )
+  {
+    return !pgnRoot && !pgnRootOther;
+  }
+  if ( (const void*)&_rg == (const void*)&_rgOther )
+  {
+    return true;
+  }
+  _graph_canonical_numbering< t_TyGraph > gcn;
+  _graph_canonical_numbering< t_TyGraphOther > gcnOther;
+  gcn.PrNode( pgnRoot );
+  gcnOther.PrNode( pgnRootOther );
+  // The numbers are assigned in step - so equal numbers mean the same encounter:
+  for ( size_t stCur = 0; stCur < gcn.m_rgpgn.size(); ++stCur )
+  {
+    const _TyGraphNode * pgn = gcn.m_rgpgn[ stCur ];
+    const _TyGraphNodeOther * pgnOther = gcnOther.m_rgpgn[ stCur ];
+    if ( !( pgn->RElConst() == pgnOther->RElConst() ) )
+    {
+      return false;
+    }
+    for ( int iChildren = 1; iChildren >= 0; --iChildren )
+    {
+      const _TyGraphLinkBaseBase * pglb = iChildren ? *pgn->PPGLBChildHead() : *pgn->PPGLBParentHead();
+      const _TyGraphLinkBaseBaseOther * pglbOther = iChildren ? *pgnOther->PPGLBChildHead() : *pgnOther->PPGLBParentHead();
+      for ( ; pglb && pglbOther;
+            pglb = iChildren ? pglb->PGLBGetNextChild() : pglb->PGLBGetNextParent(),
+            pglbOther = iChildren ? pglbOther->PGLBGetNextChild() : pglbOther->PGLBGetNextParent() )
+      {
+        const _TyGraphLink * pgl = static_cast< const _TyGraphLink * >( pglb );
+        const _TyGraphLinkOther * pglOther = static_cast< const _TyGraphLinkOther * >( pglbOther );
+        pair< size_t, bool > prLink = gcn.PrLink( pgl );
+        if ( prLink.first != gcnOther.PrLink( pglOther ).first )
+        {
+          return false;
+        }
+        if ( prLink.second && !( pgl->RElConst() == pglOther->RElConst() ) )
+        {
+          return false;
+        }
+        const _TyGraphNode * pgnRel = static_cast< const _TyGraphNode * >( iChildren ? pglb->PGNBChild() : pglb->PGNBParent() );
+        const _TyGraphNodeOther * pgnRelOther = static_cast< const _TyGraphNodeOther * >( iChildren ? pglbOther->PGNBChild() : pglbOther->PGNBParent() );
+        if ( gcn.PrNode( pgnRel ).first != gcnOther.PrNode( pgnRelOther ).first )
+        {
+          return false;
+        }
+      }
+      if ( pglb || pglbOther )
+      {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// As above - but graphs of the same type whose elements have a hash are first compared by their
+//  structural hashes, unequal hashes deciding without the paired walk:
+template < class t_TyGraph, class t_TyGraphOther >
+bool  _graph_structure_equal_hashed( t_TyGraph const & _rg, t_TyGraphOther const & _rgOther )
+{
+  return _graph_structure_equal( _rg, _rgOther );
+}
+template < class t_TyGraph >
+bool  _graph_structure_equal_hashed( t_TyGraph const & _rg, t_TyGraph const & _rgOther, false_type )
+{
+  return _graph_structure_equal( _rg, _rgOther );
+}
+template < class t_TyGraph >
+bool  _graph_structure_equal_hashed( t_TyGraph const & _rg, t_TyGraph const & _rgOther, true_type )
+{
+  return ( &_rg == &_rgOther ) ||
+          ( ( _graph_structural_hash< t_TyGraph >::compute( _rg ) == _graph_structural_hash< t_TyGraph >::compute( _rgOther ) ) &&
+            _graph_structure_equal( _rg, _rgOther ) );
+}
+template < class t_TyGraph >
+bool  _graph_structure_equal_hashed( t_TyGraph const & _rg, t_TyGraph const & _rgOther )
+{
+  typedef integral_constant< bool,
+    is_default_constructible< hash< typename t_TyGraph::_TyNodeEl > >::value &&
+    is_default_constructible< hash< typename t_TyGraph::_TyLinkEl > >::value > _TyFHashable;
+  return _graph_structure_equal_hashed( _rg, _rgOther, _TyFHashable() );
+}
+
+__DGRAPH_END_NAMESPACE
+
+#endif //__GR_HASH_H
@@ -100,6 +100,23 @@ __DGRAPH_END_NAMESPACE
 #include "_gr_copy.h"
 #include "_gr_dtor.h"
 #include "_gr_rndm.h"
+#include "_gr_bulk.h"
+#include "_gr_hash.h"
+#include "_gr_epoc.h"
 #include "_graph.h"
+#include "_gr_mlog.h"
+#include "_gr_shmt.h"
+#include "_gr_vers.h"
+#include "_gr_cpwt.h"
+#include "_gr_bldr.h"
+#include "_gr_scc.h"
+#include "_gr_topo.h"
+#include "_gr_dagx.h"
+#include "_gr_spth.h"
+#include "_gr_rech.h"
+#include "_gr_tcls.h"
+#include "_gr_dom.h"
+#include "_gr_lca.h"
+#include "_gr_rank.h"
 
 #endif //__GR_INC_H
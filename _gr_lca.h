@@ -0,0 +1,300 @@
+#ifndef __GR_LCA_H
+#define __GR_LCA_H
+
+//          Copyright David Lawrence Bien 1997 - 2021.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt).
+
+// _gr_lca.h
+
+// Lowest common ancestor index.
+// A depth-first spanning tree is taken from the root over the child lists and its Euler tour is
+//  indexed by a sparse table of minimum depth - the LCA of two tree nodes is then the shallowest
+//  node of the tour between their first occurrences - O(1) per query, O(N log N) space.
+// The tree answers exactly for "tree exact" nodes - nodes that, as all of their tree ancestors,
+//  have only their tree parent ( the root: no parent ) - their ancestors in the graph are exactly
+//  their ancestors in the tree. Queries involving any other node fall back to intersecting the
+//  ancestor sets found through the parent lists: the lowest common ancestors are the common
+//  ancestors none of whose children is a common ancestor - there may be several, StLca() returns
+//  the deepest in the tree ( for a common ancestry that is wholly cyclic - the deepest common
+//  ancestor ).
+// The child and parent lists are copied to CSR arrays by node id when the index is built - the
+//  search and the fallback mark ancestors in vectors by node id, there are no node lookups.
+// Node ids are those of RNumbering(). The graph must not be modified while the index is in use.
+
+#include <stddef.h>
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+__DGRAPH_BEGIN_NAMESPACE
+
+template < class t_TyGraph >
+class _graph_lca_index
+{
+  typedef _graph_lca_index< t_TyGraph > _TyThis;
+public:
+  typedef t_TyGraph                                     _TyGraph;
+  typedef typename t_TyGraph::_TyGraphNode              _TyGraphNode;
+  typedef typename _TyGraphNode::_TyGraphLinkBaseBase   _TyGraphLinkBaseBase;
+  typedef _graph_edge_list_exporter< t_TyGraph >        _TyNumbering;
+
+  static const size_t s_kstNull = size_t( -1 );
+
+  explicit _graph_lca_index( t_TyGraph const & _rg )
+    : m_gele( _rg )
+  {
+    size_t stNodes = m_gele.StNodes();
+    m_rgstDepth.assign( stNodes, s_kstNull );
+    m_rgstFirst.assign( stNodes, s_kstNull );
+    m_rgstLast.assign( stNodes, s_kstNull );
+    m_rgfExact.assign( stNodes, false );
+    if ( !stNodes )
+    {
+      return;
+    }
+    m_rgstOffsets.resize( stNodes + 1 );
+    m_rgstChildren.resize( m_gele.StLinks() );
+    m_gele.CopyCSR( m_rgstOffsets.begin(), m_rgstChildren.begin() );
+    _ReverseCSR( m_rgstOffsets, m_rgstChildren, m_rgstParentOffsets, m_rgstParents );
+    m_rgstTour.reserve( 2 * stNodes - 1 );
+
+    // Depth-first over the child lists - the root is node 0:
+    vector< pair< size_t, size_t > > rgprStack; // ( node, next edge ).
+    m_rgstDepth[ 0 ] = 0;
+    m_rgfExact[ 0 ] = ( m_rgstParentOffsets[ 0 ] == m_rgstParentOffsets[ 1 ] );
+    m_rgstFirst[ 0 ] = 0;
+    m_rgstTour.push_back( 0 );
+    rgprStack.push_back( make_pair( size_t( 0 ), m_rgstOffsets[ 0 ] ) );
+    while ( !rgprStack.empty() )
+    {
+      size_t stV = rgprStack.back().first;
+      size_t & rstEdge = rgprStack.back().second;
+      if ( rstEdge < m_rgstOffsets[ stV + 1 ] )
+      {
+        size_t stW = m_rgstChildren[ rstEdge++ ];
+        if ( s_kstNull == m_rgstDepth[ stW ] )
+        {
+          m_rgstDepth[ stW ] = m_rgstDepth[ stV ] + 1;
+          m_rgfExact[ stW ] = m_rgfExact[ stV ] && ( m_rgstParentOffsets[ stW + 1 ] - m_rgstParentOffsets[ stW ] == 1 );
+          m_rgstFirst[ stW ] = m_rgstTour.size();
+          m_rgstTour.push_back( stW );
+          rgprStack.push_back( make_pair( stW, m_rgstOffsets[ stW ] ) );
+        }
+      }
+      else
+      {
+        m_rgstLast[ stV ] = m_rgstTour.size() - 1;
+        rgprStack.pop_back();
+        if ( !rgprStack.empty() )
+        {
+          m_rgstTour.push_back( rgprStack.back().first );
+        }
+      }
+    }
+
+    // Sparse table - level k holds the shallowest node of each run of 2^k tour entries:
+    size_t stTour = m_rgstTour.size();
+    m_rgstLog.assign( stTour + 1, 0 );
+    for ( size_t st = 2; st <= stTour; ++st )
+    {
+      m_rgstLog[ st ] = m_rgstLog[ st / 2 ] + 1;
+    }
+    size_t stLevels = m_rgstLog[ stTour ] + 1;
+    m_rgstSparse.resize( stLevels * stTour );
+    copy( m_rgstTour.begin(), m_rgstTour.end(), m_rgstSparse.begin() );
+    for ( size_t stLevel = 1; stLevel < stLevels; ++stLevel )
+    {
+      size_t * pstPrev = &m_rgstSparse[ ( stLevel - 1 ) * stTour ];
+      size_t * pstCur = &m_rgstSparse[ stLevel * stTour ];
+      size_t stHalf = size_t( 1 ) << ( stLevel - 1 );
+      for ( size_t st = 0; st + ( stHalf << 1 ) <= stTour; ++st )
+      {
+        pstCur[ st ] = _StShallower( pstPrev[ st ], pstPrev[ st + stHalf ] );
+      }
+    }
+  }
+
+  _TyNumbering const &  RNumbering() const _BIEN_NOTHROW
+  {
+    return m_gele;
+  }
+  // Depth in the spanning tree - s_kstNull if not reached from the root through child lists:
+  size_t  StDepth( size_t _stNode ) const _BIEN_NOTHROW
+  {
+    return m_rgstDepth[ _stNode ];
+  }
+  bool  FTreeExact( size_t _stNode ) const _BIEN_NOTHROW
+  {
+    return !!m_rgfExact[ _stNode ];
+  }
+
+  // A lowest common ancestor - s_kstNull if there is no common ancestor. A node is its own ancestor:
+  size_t  StLca( size_t _stA, size_t _stB ) const
+  {
+    if ( m_rgfExact[ _stA ] && m_rgfExact[ _stB ] )
+    {
+      return _StTreeLca( _stA, _stB );
+    }
+    vector< size_t > rgstLcas;
+    GetLcas( _stA, _stB, rgstLcas );
+    size_t stBest = s_kstNull;
+    for ( size_t st = 0; st < rgstLcas.size(); ++st )
+    {
+      if ( ( s_kstNull == stBest ) || _FDeeper( rgstLcas[ st ], stBest ) )
+      {
+        stBest = rgstLcas[ st ];
+      }
+    }
+    return stBest;
+  }
+  const _TyGraphNode *  PGNLca( const _TyGraphNode * _pgnA, const _TyGraphNode * _pgnB ) const
+  {
+    size_t stLca = StLca( _StIdChecked( _pgnA ), _StIdChecked( _pgnB ) );
+    return ( s_kstNull == stLca ) ? 0 : m_gele.PGNNode( stLca );
+  }
+
+  // All lowest common ancestors:
+  void  GetLcas( size_t _stA, size_t _stB, vector< size_t > & _rrgstLcas ) const
+  {
+    _rrgstLcas.clear();
+    if ( m_rgfExact[ _stA ] && m_rgfExact[ _stB ] )
+    {
+      _rrgstLcas.push_back( _StTreeLca( _stA, _stB ) );
+      return;
+    }
+    // Ancestors of A are marked 1, of B 2 - common ancestors 3:
+    vector< unsigned char > rgbMark( m_gele.StNodes(), 0 );
+    vector< size_t > rgstA;
+    _Ancestors( _stA, 1, rgbMark, rgstA );
+    vector< size_t > rgstB;
+    _Ancestors( _stB, 2, rgbMark, rgstB );
+    vector< size_t > rgstCommon;
+    for ( size_t st = 0; st < rgstB.size(); ++st )
+    {
+      if ( 3 == rgbMark[ rgstB[ st ] ] )
+      {
+        rgstCommon.push_back( rgstB[ st ] );
+      }
+    }
+    for ( size_t st = 0; st < rgstCommon.size(); ++st )
+    {
+      size_t stEdge = m_rgstOffsets[ rgstCommon[ st ] ];
+      size_t stEnd = m_rgstOffsets[ rgstCommon[ st ] + 1 ];
+      for ( ; ( stEdge < stEnd ) && ( 3 != rgbMark[ m_rgstChildren[ stEdge ] ] ); ++stEdge )
+        ;
+      if ( stEdge == stEnd )
+      {
+        _rrgstLcas.push_back( rgstCommon[ st ] );
+      }
+    }
+    if ( _rrgstLcas.empty() && !rgstCommon.empty() )
+    {
+      // Every common ancestor has a common ancestor child - they are in cycles:
+      size_t stBest = rgstCommon[ 0 ];
+      for ( size_t st = 1; st < rgstCommon.size(); ++st )
+      {
+        if ( _FDeeper( rgstCommon[ st ], stBest ) )
+        {
+          stBest = rgstCommon[ st ];
+        }
+      }
+      _rrgstLcas.push_back( stBest );
+    }
+    sort( _rrgstLcas.begin(), _rrgstLcas.end() );
+  }
+
+  // Is _stAncestor an ancestor of _stNode ( or the node itself ):
+  bool  FAncestor( size_t _stAncestor, size_t _stNode ) const
+  {
+    if ( m_rgfExact[ _stNode ] )
+    {
+      return ( s_kstNull != m_rgstFirst[ _stAncestor ] ) &&
+              ( m_rgstFirst[ _stAncestor ] <= m_rgstFirst[ _stNode ] ) &&
+              ( m_rgstLast[ _stNode ] <= m_rgstLast[ _stAncestor ] );
+    }
+    vector< unsigned char > rgbMark( m_gele.StNodes(), 0 );
+    vector< size_t > rgst;
+    _Ancestors( _stNode, 1, rgbMark, rgst );
+    return !!rgbMark[ _stAncestor ];
+  }
+
+protected:
+
+  _TyNumbering      m_gele;
+  vector< size_t >  m_rgstOffsets;        // CSR children.
+  vector< size_t >  m_rgstChildren;
+  vector< size_t >  m_rgstParentOffsets;  // CSR parents.
+  vector< size_t >  m_rgstParents;
+  vector< size_t >  m_rgstDepth;
+  vector< char >    m_rgfExact;
+  vector< size_t >  m_rgstFirst;  // First and last occurrence in the tour.
+  vector< size_t >  m_rgstLast;
+  vector< size_t >  m_rgstTour;
+  vector< size_t >  m_rgstLog;    // floor( log2( i ) ).
+  vector< size_t >  m_rgstSparse; // Levels of m_rgstTour.size() entries.
+
+  size_t  _StIdChecked( const _TyGraphNode * _pgn ) const
+  {
+    size_t stNode = m_gele.StNodeId( _pgn );
+    if ( s_kstNull == stNode )
+    {
+      throw _graph_nav_except( "_graph_lca_index: Node not in graph." );
+    }
+    return stNode;
+  }
+  size_t  _StShallower( size_t _stA, size_t _stB ) const _BIEN_NOTHROW
+  {
+    return ( m_rgstDepth[ _stB ] < m_rgstDepth[ _stA ] ) ? _stB : _stA;
+  }
+  // Deeper in the tree - nodes not in the tree are the shallowest - ties to the lesser id:
+  bool  _FDeeper( size_t _stA, size_t _stB ) const _BIEN_NOTHROW
+  {
+    size_t stDepthA = m_rgstDepth[ _stA ] + 1;
+    size_t stDepthB = m_rgstDepth[ _stB ] + 1;
+    return ( stDepthA > stDepthB ) || ( ( stDepthA == stDepthB ) && ( _stA < _stB ) );
+  }
+
+  size_t  _StTreeLca( size_t _stA, size_t _stB ) const _BIEN_NOTHROW
+  {
+    size_t stL = m_rgstFirst[ _stA ];
+    size_t stR = m_rgstFirst[ _stB ];
+    if ( stL > stR )
+    {
+      swap( stL, stR );
+    }
+    size_t stLevel = m_rgstLog[ stR - stL + 1 ];
+    const size_t * pst = &m_rgstSparse[ stLevel * m_rgstTour.size() ];
+    return _StShallower( pst[ stL ], pst[ stR + 1 - ( size_t( 1 ) << stLevel ) ] );
+  }
+
+  // The node and all of its ancestors - through the parent lists - are or-ed with _bMark and
+  //  appended to _rrgst ( used as the queue ):
+  void  _Ancestors( size_t _stNode, unsigned char _bMark, vector< unsigned char > & _rrgbMark, vector< size_t > & _rrgst ) const
+  {
+    size_t stHead = _rrgst.size();
+    _rrgbMark[ _stNode ] |= _bMark;
+    _rrgst.push_back( _stNode );
+    for ( ; stHead < _rrgst.size(); ++stHead )
+    {
+      size_t stV = _rrgst[ stHead ];
+      for ( size_t stEdge = m_rgstParentOffsets[ stV ]; stEdge < m_rgstParentOffsets[ stV + 1 ]; ++stEdge )
+      {
+        size_t stP = m_rgstParents[ stEdge ];
+        if ( !( _rrgbMark[ stP ] & _bMark ) )
+        {
+          _rrgbMark[ stP ] |= _bMark;
+          _rrgst.push_back( stP );
+        }
+      }
+    }
+  }
+};
+
+template < class t_TyGraph >
+const size_t _graph_lca_index< t_TyGraph >::s_kstNull;
+
+__DGRAPH_END_NAMESPACE
+
+#endif //__GR_LCA_H
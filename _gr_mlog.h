@@ -0,0 +1,821 @@
+#ifndef __GR_MLOG_H
+#define __GR_MLOG_H
+
+//          Copyright David Lawrence Bien 1997 - 2021.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt).
+
+// _gr_mlog.h
+
+// Graph mutation log - incremental persistence of a graph.
+// The log is a sequence of compact records describing the mutations made to a graph since
+//  a full snapshot ( dgraph::save() ) was written. Replaying the log onto the loaded snapshot
+//  reproduces the graph. Compaction writes a new full snapshot and starts a new log.
+// Nodes and links are identified in the log by ids: at attach time ( and after compaction ) the
+//  ids are the order of first visit during a forward iteration from the root - this order is
+//  reproduced exactly by a graph loaded from the snapshot. New objects get the next id, ids are
+//  never reused.
+// The graph has no mutation hooks - mutations to be logged must be made through this object.
+// A link created through this object has null parent and child nodes until add_relation() and
+//  again after remove_relation() - this is how a connected link is detected.
+// Durability: by default the log is flushed after each record - each logged mutation is in the
+//  log before the graph is changed. With e_mlfCommit records are only flushed by commit() - the
+//  caller groups mutations into batches and a crash loses at most the uncommitted batch ( replay()
+//  ignores the truncated final record ).
+
+#include <istream>
+#include <ostream>
+#include <vector>
+#include <unordered_map>
+#include <type_traits>
+
+__DGRAPH_BEGIN_NAMESPACE
+
+enum EMutationLogRecord
+{
+  e_mlrNodeCreate = 0x01,   // node id, node element.
+  e_mlrLinkCreate,          // link id, link element.
+  e_mlrNodeDestroy,         // node id.
+  e_mlrLinkDestroy,         // link id.
+  e_mlrRelationInsert,      // link id, parent id, child id, index in parent's children, index in child's parents.
+  e_mlrRelationRemove,      // link id.
+  e_mlrChildMove,           // node id, remove index, insert index.
+  e_mlrParentMove,          // node id, remove index, insert index.
+  e_mlrNodeUpdate,          // node id, node element.
+  e_mlrLinkUpdate,          // link id, link element.
+  e_mlrSetRoot,             // node id + 1 ( 0 for no root ).
+  e_mlrMutationLogRecordCount
+};
+
+enum EMutationLogFlush
+{
+  e_mlfRecord,  // Flush the log after each record.
+  e_mlfCommit   // Flush only on commit() ( and on start_log()/compact() ).
+};
+
+template <  class t_TyGraph,
+            class t_TyNodeElIO = _iostream_RawElIO,
+            class t_TyLinkElIO = t_TyNodeElIO >
+class _graph_mutation_log
+{
+  typedef _graph_mutation_log< t_TyGraph, t_TyNodeElIO, t_TyLinkElIO > _TyThis;
+public:
+
+  typedef t_TyGraph                                     _TyGraph;
+  typedef typename t_TyGraph::_TyGraphNode              _TyGraphNode;
+  typedef typename t_TyGraph::_TyGraphLink              _TyGraphLink;
+  typedef typename t_TyGraph::_TyNodeEl                 _TyNodeEl;
+  typedef typename t_TyGraph::_TyLinkEl                 _TyLinkEl;
+  typedef typename _TyGraphNode::_TyGraphLinkBaseBase   _TyGraphLinkBaseBase;
+  typedef uint64_t                                      _TyId;
+
+  static const uint32_t s_kuMagic = 0x4c4d4744; // "DGML" - written little-endian.
+  static const uint32_t s_kuVersion = 1;
+
+  _graph_mutation_log( _graph_mutation_log const & ) = delete;
+  _graph_mutation_log & operator = ( _graph_mutation_log const & ) = delete;
+
+  // Attach to the graph <_rg> - which must be exactly the state of a snapshot, either
+  //  freshly saved or freshly loaded. Ids are assigned to the graph's objects.
+  _graph_mutation_log(  t_TyGraph & _rg,
+                        t_TyNodeElIO const & _rnio = t_TyNodeElIO(),
+                        t_TyLinkElIO const & _rlio = t_TyLinkElIO(),
+                        EMutationLogFlush _emlf = e_mlfRecord )
+    : m_rg( _rg ),
+      m_nio( _rnio ),
+      m_lio( _rlio ),
+      m_emlf( _emlf )
+  {
+    _Number();
+  }
+
+  EMutationLogFlush GetFlush() const _BIEN_NOTHROW
+  {
+    return m_emlf;
+  }
+  // Changing to e_mlfRecord doesn't flush the current batch - commit() first.
+  void SetFlush( EMutationLogFlush _emlf ) _BIEN_NOTHROW
+  {
+    m_emlf = _emlf;
+  }
+
+  // Flush the records written so far - under e_mlfCommit the mutations since the last commit()
+  //  are durable only after this returns.
+  void commit()
+  {
+    if ( !m_pros )
+    {
+      throw bad_graph( "_graph_mutation_log::commit(): No log has been started." );
+    }
+    _Flush();
+  }
+
+  // Start a new log against the snapshot - the log header is written immediately.
+  void start_log( ostream & _rosLog )
+  {
+    if ( ( m_rgpgnNodes.size() != m_nBaseNodes ) || ( m_rgpglLinks.size() != m_nBaseLinks ) )
+    {
+      throw bad_graph( "_graph_mutation_log::start_log(): Graph has been modified since the snapshot." );
+    }
+    m_pros = &_rosLog;
+    _WriteHeader();
+  }
+  // Continue writing records to an existing log - e.g. the log just replayed, opened for append.
+  void continue_log( ostream & _rosLog )
+  {
+    m_pros = &_rosLog;
+  }
+
+  _TyId NodeId( const _TyGraphNode * _pgn ) const
+  {
+    typename _TyIdMap::const_iterator it = m_mapNodeIds.find( _pgn );
+    if ( m_mapNodeIds.end() == it )
+    {
+      throw bad_graph( "_graph_mutation_log::NodeId(): Node not tracked by the mutation log." );
+    }
+    return it->second;
+  }
+  _TyId LinkId( const _TyGraphLink * _pgl ) const
+  {
+    typename _TyIdMap::const_iterator it = m_mapLinkIds.find( _pgl );
+    if ( m_mapLinkIds.end() == it )
+    {
+      throw bad_graph( "_graph_mutation_log::LinkId(): Link not tracked by the mutation log." );
+    }
+    return it->second;
+  }
+
+// Logged mutations:
+  _TyGraphNode * create_node()
+  {
+    return _LogNodeCreate( m_rg.create_node() );
+  }
+  template < class t_TyP1 >
+  _TyGraphNode * create_node1( t_TyP1 _p1 )
+  {
+    return _LogNodeCreate( m_rg.template create_node1< t_TyP1 >( _p1 ) );
+  }
+  _TyGraphLink * create_link()
+  {
+    return _LogLinkCreate( m_rg.create_link() );
+  }
+  template < class t_TyP1 >
+  _TyGraphLink * create_link1( t_TyP1 _p1 )
+  {
+    return _LogLinkCreate( m_rg.template create_link1< t_TyP1 >( _p1 ) );
+  }
+
+  // Destroy a single node - it must be unconnected and not the root.
+  void destroy_node( _TyGraphNode * _pgn )
+  {
+    if ( _pgn->FParents() || _pgn->FChildren() || ( _pgn == m_rg.get_root() ) )
+    {
+      throw bad_graph( "_graph_mutation_log::destroy_node(): Node is connected or is the root." );
+    }
+    _TyId id = NodeId( _pgn );
+    _WriteRecord( e_mlrNodeDestroy, id );
+    _EndRecord();
+    _ForgetNode( _pgn, id );
+    m_rg.destroy_single_node( _pgn );
+  }
+  // Destroy a single link - it must have been removed from its relations.
+  void destroy_link( _TyGraphLink * _pgl )
+  {
+    if ( _FLinkConnected( _pgl ) )
+    {
+      throw bad_graph( "_graph_mutation_log::destroy_link(): Link is connected." );
+    }
+    _TyId id = LinkId( _pgl );
+    _WriteRecord( e_mlrLinkDestroy, id );
+    _EndRecord();
+    _ForgetLink( _pgl, id );
+    m_rg.destroy_link( _pgl );
+  }
+
+  // Insert <_pgl> as the <_uChild>th child of <_pgnParent> and the <_uParent>th parent of <_pgnChild>.
+  void add_relation(  _TyGraphNode * _pgnParent, _TyGraphNode * _pgnChild, _TyGraphLink * _pgl,
+                      _TyGNIndex _uChild, _TyGNIndex _uParent )
+  {
+    _TyId idLink = LinkId( _pgl );
+    _TyId idParent = NodeId( _pgnParent );
+    _TyId idChild = NodeId( _pgnChild );
+    if ( _FLinkConnected( _pgl ) )
+    {
+      throw bad_graph( "_graph_mutation_log::add_relation(): Link is connected." );
+    }
+    _CheckInsert( _pgnParent, _pgnChild, _uChild, _uParent );
+    _WriteToken( e_mlrRelationInsert );
+    _WriteId( idLink );
+    _WriteId( idParent );
+    _WriteId( idChild );
+    _WriteId( _uChild );
+    _WriteId( _uParent );
+    _EndRecord();
+    _Insert( _pgnParent, _pgnChild, _pgl, _uChild, _uParent );
+  }
+  // Remove <_pgl> from both its parent's child list and its child's parent list.
+  void remove_relation( _TyGraphLink * _pgl )
+  {
+    if ( !_FLinkConnected( _pgl ) )
+    {
+      throw bad_graph( "_graph_mutation_log::remove_relation(): Link is not connected." );
+    }
+    _WriteRecord( e_mlrRelationRemove, LinkId( _pgl ) );
+    _EndRecord();
+    _Remove( _pgl );
+  }
+  void move_child( _TyGraphNode * _pgn, _TyGNIndex _uRemove, _TyGNIndex _uInsert )
+  {
+    _LogMove( e_mlrChildMove, _pgn, _uRemove, _uInsert, _pgn->UChildren() );
+    _pgn->MoveChild( _uRemove, _uInsert );
+  }
+  void move_parent( _TyGraphNode * _pgn, _TyGNIndex _uRemove, _TyGNIndex _uInsert )
+  {
+    _LogMove( e_mlrParentMove, _pgn, _uRemove, _uInsert, _pgn->UParents() );
+    _pgn->MoveParent( _uRemove, _uInsert );
+  }
+
+  // The caller has modified the element of <_pgn>/<_pgl> - record its current value:
+  void update_node( const _TyGraphNode * _pgn )
+  {
+    _WriteRecord( e_mlrNodeUpdate, NodeId( _pgn ) );
+    m_nio.Write( *m_pros, _pgn->REl() );
+    _EndRecord();
+  }
+  void update_link( const _TyGraphLink * _pgl )
+  {
+    _WriteRecord( e_mlrLinkUpdate, LinkId( _pgl ) );
+    m_lio.Write( *m_pros, _pgl->REl() );
+    _EndRecord();
+  }
+
+  void set_root( _TyGraphNode * _pgn )
+  {
+    _WriteRecord( e_mlrSetRoot, _pgn ? NodeId( _pgn ) + 1 : 0 );
+    _EndRecord();
+    m_rg.set_root_node( _pgn );
+  }
+
+// Replay:
+  // Apply the records in <_risLog> to the graph - which must be the loaded snapshot the log was
+  //  written against, i.e. this object was just attached to the loaded graph. Afterwards either
+  //  continue_log() on the same log or compact().
+  // A truncated final record ( e.g. from a crash during a write ) is ignored - <*_pspEnd> receives
+  //  the end of the last complete record, the log should be truncated there before continue_log().
+  // Returns the number of records applied.
+  size_t replay( istream & _risLog, streampos * _pspEnd = 0 )
+  {
+    _ReadHeader( _risLog );
+    size_t nRecords = 0;
+    for ( ; ; ++nRecords )
+    {
+      if ( _pspEnd )
+      {
+        *_pspEnd = _risLog.tellg();
+      }
+      int iToken = _risLog.get();
+      if ( istream::traits_type::eof() == iToken )
+      {
+        break;
+      }
+      if ( !_FReplayRecord( _risLog, iToken ) )
+      {
+        break;
+      }
+    }
+    return nRecords;
+  }
+
+// Compaction:
+  // Write a full snapshot of the current graph to <_rosSnapshot> and start a new log against it
+  //  on <_rosNewLog>. Objects not reachable from the root are not in the snapshot - they are no
+  //  longer tracked.
+  void compact( ostream & _rosSnapshot, ostream & _rosNewLog )
+  {
+    m_rg.save( _rosSnapshot );
+    if ( _rosSnapshot.fail() )
+    {
+      throw bad_graph( "_graph_mutation_log::compact(): Writing the snapshot failed." );
+    }
+    _Number();
+    start_log( _rosNewLog );
+  }
+
+protected:
+
+  typedef unordered_map< const void *, _TyId > _TyIdMap;
+  typedef vector< _TyGraphNode * > _TyNodeTable;
+  typedef vector< _TyGraphLink * > _TyLinkTable;
+
+  t_TyGraph &   m_rg;
+  ostream *     m_pros{0}; // The current log - null until start_log() or continue_log().
+  t_TyNodeElIO  m_nio;
+  t_TyLinkElIO  m_lio;
+  EMutationLogFlush m_emlf;
+
+  _TyIdMap      m_mapNodeIds;
+  _TyIdMap      m_mapLinkIds;
+  _TyNodeTable  m_rgpgnNodes; // Indexed by id - null once destroyed.
+  _TyLinkTable  m_rgpglLinks;
+  _TyId         m_nBaseNodes{0}; // The number of ids assigned from the snapshot.
+  _TyId         m_nBaseLinks{0};
+
+  // Assign ids in forward iteration order from the root - nodes and links independently:
+  void _Number()
+  {
+    _TyIdMap mapNodeIds;
+    _TyIdMap mapLinkIds;
+    _TyNodeTable rgpgnNodes;
+    _TyLinkTable rgpglLinks;
+    if ( m_rg.get_root() )
+    {
+      typename t_TyGraph::iterator it( m_rg.begin() );
+      for ( ; !it.FAtEnd(); ++it )
+      {
+        _TyGraphLink * pgl = it.PGLCur();
+        if ( pgl )
+        {
+          if ( mapLinkIds.insert( typename _TyIdMap::value_type( pgl, rgpglLinks.size() ) ).second )
+          {
+            rgpglLinks.push_back( pgl );
+          }
+        }
+        else
+        {
+          _TyGraphNode * pgn = it.PGNCur();
+          if ( mapNodeIds.insert( typename _TyIdMap::value_type( pgn, rgpgnNodes.size() ) ).second )
+          {
+            rgpgnNodes.push_back( pgn );
+          }
+        }
+      }
+    }
+    // no throw after this.
+    m_mapNodeIds.swap( mapNodeIds );
+    m_mapLinkIds.swap( mapLinkIds );
+    m_rgpgnNodes.swap( rgpgnNodes );
+    m_rgpglLinks.swap( rgpglLinks );
+    m_nBaseNodes = m_rgpgnNodes.size();
+    m_nBaseLinks = m_rgpglLinks.size();
+  }
+
+  _TyId _TrackNode( _TyGraphNode * _pgn )
+  {
+    __THROWPT( e_ttMemory );
+    _TyId id = m_rgpgnNodes.size();
+    m_rgpgnNodes.push_back( _pgn );
+    _BIEN_TRY
+    {
+      m_mapNodeIds.insert( typename _TyIdMap::value_type( _pgn, id ) );
+    }
+    _BIEN_UNWIND( m_rgpgnNodes.pop_back() );
+    return id;
+  }
+  _TyId _TrackLink( _TyGraphLink * _pgl )
+  {
+    __THROWPT( e_ttMemory );
+    _TyId id = m_rgpglLinks.size();
+    m_rgpglLinks.push_back( _pgl );
+    _BIEN_TRY
+    {
+      m_mapLinkIds.insert( typename _TyIdMap::value_type( _pgl, id ) );
+    }
+    _BIEN_UNWIND( m_rgpglLinks.pop_back() );
+    return id;
+  }
+  void _ForgetNode( _TyGraphNode * _pgn, _TyId _id ) _BIEN_NOTHROW
+  {
+    m_mapNodeIds.erase( _pgn );
+    m_rgpgnNodes[ _id ] = 0;
+  }
+  void _ForgetLink( _TyGraphLink * _pgl, _TyId _id ) _BIEN_NOTHROW
+  {
+    m_mapLinkIds.erase( _pgl );
+    m_rgpglLinks[ _id ] = 0;
+  }
+  void _UntrackNode( _TyGraphNode * _pgn ) _BIEN_NOTHROW
+  {
+    m_mapNodeIds.erase( _pgn );
+    m_rgpgnNodes.pop_back();
+  }
+  void _UntrackLink( _TyGraphLink * _pgl ) _BIEN_NOTHROW
+  {
+    m_mapLinkIds.erase( _pgl );
+    m_rgpglLinks.pop_back();
+  }
+
+  _TyGraphNode * _LogNodeCreate( _TyGraphNode * _pgn )
+  {
+    _BIEN_TRY
+    {
+      _TyId id = _TrackNode( _pgn );
+      _BIEN_TRY
+      {
+        _WriteRecord( e_mlrNodeCreate, id );
+        m_nio.Write( *m_pros, _pgn->REl() );
+        _EndRecord();
+      }
+      _BIEN_UNWIND( _UntrackNode( _pgn ) );
+    }
+    _BIEN_UNWIND( m_rg.destroy_single_node( _pgn ) );
+    return _pgn;
+  }
+  _TyGraphLink * _LogLinkCreate( _TyGraphLink * _pgl )
+  {
+    _SetUnconnected( _pgl );
+    _BIEN_TRY
+    {
+      _TyId id = _TrackLink( _pgl );
+      _BIEN_TRY
+      {
+        _WriteRecord( e_mlrLinkCreate, id );
+        m_lio.Write( *m_pros, _pgl->REl() );
+        _EndRecord();
+      }
+      _BIEN_UNWIND( _UntrackLink( _pgl ) );
+    }
+    _BIEN_UNWIND( m_rg.destroy_link( _pgl ) );
+    return _pgl;
+  }
+
+  void _LogMove(  EMutationLogRecord _emlr, _TyGraphNode * _pgn,
+                  _TyGNIndex _uRemove, _TyGNIndex _uInsert, _TyGNIndex _uRelations )
+  {
+    _TyId id = NodeId( _pgn );
+    if ( ( _uRemove >= _uRelations ) || ( _uInsert >= _uRelations ) || ( _uRemove == _uInsert ) )
+    {
+      throw _graph_nav_except( "_graph_mutation_log::_LogMove(): bad indices." );
+    }
+    _WriteRecord( _emlr, id );
+    _WriteId( _uRemove );
+    _WriteId( _uInsert );
+    _EndRecord();
+  }
+
+  static void _CheckInsert( _TyGraphNode * _pgnParent, _TyGraphNode * _pgnChild,
+                            _TyGNIndex _uChild, _TyGNIndex _uParent )
+  {
+    if ( ( _uChild > _pgnParent->UChildren() ) || ( _uParent > _pgnChild->UParents() ) )
+    {
+      throw _graph_nav_except( "_graph_mutation_log::_CheckInsert(): index beyond end." );
+    }
+  }
+  static void _Insert(  _TyGraphNode * _pgnParent, _TyGraphNode * _pgnChild, _TyGraphLink * _pgl,
+                        _TyGNIndex _uChild, _TyGNIndex _uParent ) _BIEN_NOTHROW
+  {
+    _TyGraphLinkBaseBase ** ppglbChild = _TyGraphLinkBaseBase::PPGLBGetNthChild( _pgnParent->PPGLBChildHead(), _uChild );
+    _TyGraphLinkBaseBase ** ppglbParent = _TyGraphLinkBaseBase::PPGLBGetNthParent( _pgnChild->PPGLBParentHead(), _uParent );
+    _pgnParent->AddChild( *_pgnChild, *_pgl, *ppglbChild, *ppglbParent );
+  }
+  static void _Remove( _TyGraphLink * _pgl ) _BIEN_NOTHROW
+  {
+    _pgl->RemoveChild();
+    _pgl->RemoveParent();
+    _SetUnconnected( _pgl );
+  }
+  static void _SetUnconnected( _TyGraphLink * _pgl ) _BIEN_NOTHROW
+  {
+    _pgl->SetParentNode( 0 );
+    _pgl->SetChildNode( 0 );
+  }
+  static bool _FLinkConnected( const _TyGraphLink * _pgl ) _BIEN_NOTHROW
+  {
+    return _pgl->PGNBParent() || _pgl->PGNBChild();
+  }
+
+// Record writing:
+  void _WriteToken( EMutationLogRecord _emlr )
+  {
+    if ( !m_pros )
+    {
+      throw bad_graph( "_graph_mutation_log: No log has been started." );
+    }
+    m_pros->put( char( _emlr ) );
+  }
+  // ids and indices are written as unsigned LEB128:
+  void _WriteId( _TyId _id )
+  {
+    char rgc[ 10 ];
+    size_t st = 0;
+    do
+    {
+      uint8_t b = uint8_t( _id & 0x7f );
+      _id >>= 7;
+      rgc[ st++ ] = char( _id ? ( b | 0x80 ) : b );
+    }
+    while ( _id );
+    m_pros->write( rgc, st );
+  }
+  void _WriteRecord( EMutationLogRecord _emlr, _TyId _id )
+  {
+    __THROWPT( e_ttFileOutput );
+    _WriteToken( _emlr );
+    _WriteId( _id );
+  }
+  // A record is complete in the stream before the graph is changed - flushed according to the
+  //  policy. Under e_mlfCommit a failure may not show until commit():
+  void _EndRecord()
+  {
+    if ( e_mlfRecord == m_emlf )
+    {
+      _Flush();
+    }
+    else
+    if ( m_pros->fail() )
+    {
+      throw bad_graph( "_graph_mutation_log: Writing to the log failed." );
+    }
+  }
+  void _Flush()
+  {
+    m_pros->flush();
+    if ( m_pros->fail() )
+    {
+      throw bad_graph( "_graph_mutation_log: Writing to the log failed." );
+    }
+  }
+  void _WriteHeader()
+  {
+    char rgc[ sizeof( s_kuMagic ) ];
+    for ( size_t st = 0; st < sizeof( s_kuMagic ); ++st )
+    {
+      rgc[ st ] = char( uint8_t( s_kuMagic >> ( 8 * st ) ) );
+    }
+    m_pros->write( rgc, sizeof( rgc ) );
+    _WriteId( s_kuVersion );
+    _WriteId( m_nBaseNodes );
+    _WriteId( m_nBaseLinks );
+    _Flush();
+  }
+
+// Record reading:
+  // Returns false at a truncated id.
+  static bool _FReadId( istream & _ris, _TyId & _rid )
+  {
+    _rid = 0;
+    for ( unsigned uShift = 0; uShift < 64; uShift += 7 )
+    {
+      int i = _ris.get();
+      if ( istream::traits_type::eof() == i )
+      {
+        return false;
+      }
+      _rid |= _TyId( i & 0x7f ) << uShift;
+      if ( !( i & 0x80 ) )
+      {
+        return true;
+      }
+    }
+    throw bad_graph_stream( "_graph_mutation_log: Bad id encoding." );
+  }
+  void _ReadHeader( istream & _ris )
+  {
+    uint8_t rgby[ sizeof( s_kuMagic ) ];
+    _ris.read( (char*)rgby, sizeof( rgby ) );
+    uint32_t u = 0;
+    for ( size_t st = 0; st < sizeof( s_kuMagic ); ++st )
+    {
+      u |= uint32_t( rgby[ st ] ) << ( 8 * st );
+    }
+    _TyId uVersion, nNodes, nLinks;
+    if ( _ris.fail() || ( s_kuMagic != u ) ||
+         !_FReadId( _ris, uVersion ) || !_FReadId( _ris, nNodes ) || !_FReadId( _ris, nLinks ) )
+    {
+      throw bad_graph_stream( "_graph_mutation_log::replay(): Bad log header." );
+    }
+    if ( s_kuVersion != uVersion )
+    {
+      throw bad_graph_stream( "_graph_mutation_log::replay(): Unsupported log version." );
+    }
+    if ( ( nNodes != m_nBaseNodes ) || ( nLinks != m_nBaseLinks ) ||
+         ( m_rgpgnNodes.size() != m_nBaseNodes ) || ( m_rgpglLinks.size() != m_nBaseLinks ) )
+    {
+      throw bad_graph_stream( "_graph_mutation_log::replay(): Log does not match the graph's snapshot." );
+    }
+  }
+  _TyGraphNode * _PGNRead( istream & _ris, bool & _rfOk ) const
+  {
+    _TyId id;
+    if ( !( _rfOk = _FReadId( _ris, id ) ) )
+      return 0;
+    if ( ( id >= m_rgpgnNodes.size() ) || !m_rgpgnNodes[ id ] )
+    {
+      throw bad_graph_stream( "_graph_mutation_log::replay(): Bad node id." );
+    }
+    return m_rgpgnNodes[ id ];
+  }
+  _TyGraphLink * _PGLRead( istream & _ris, bool & _rfOk ) const
+  {
+    _TyId id;
+    if ( !( _rfOk = _FReadId( _ris, id ) ) )
+      return 0;
+    if ( ( id >= m_rgpglLinks.size() ) || !m_rgpglLinks[ id ] )
+    {
+      throw bad_graph_stream( "_graph_mutation_log::replay(): Bad link id." );
+    }
+    return m_rgpglLinks[ id ];
+  }
+  // The id of a created object must be the next id:
+  static bool _FReadNewId( istream & _ris, _TyId _idExpected )
+  {
+    _TyId id;
+    if ( !_FReadId( _ris, id ) )
+      return false;
+    if ( id != _idExpected )
+    {
+      throw bad_graph_stream( "_graph_mutation_log::replay(): Unexpected id for created object." );
+    }
+    return true;
+  }
+
+  // Apply a single record - returns false if the record was truncated - in which case the graph
+  //  is not changed.
+  bool _FReplayRecord( istream & _ris, int _iToken )
+  {
+    bool fOk = true;
+    switch( _iToken )
+    {
+      case e_mlrNodeCreate:
+      {
+        if ( !_FReadNewId( _ris, m_rgpgnNodes.size() ) )
+          return false;
+        _TyGraphNode * pgn = m_rg._allocate_node();
+        _BIEN_TRY
+        {
+          pgn->Init();
+          m_nio.Read( _ris, pgn->RElNonConst() );
+        }
+        _BIEN_UNWIND( m_rg._deallocate_node( pgn ) );
+        if ( _ris.fail() )
+        {
+          // The element IO constructed the element - destruct it even though partially read:
+          t_TyGraph::_destruct_node_el( pgn );
+          m_rg._deallocate_node( pgn );
+          return false;
+        }
+        _BIEN_TRY
+        {
+          (void)_TrackNode( pgn );
+        }
+        _BIEN_UNWIND( m_rg.destroy_single_node( pgn ) );
+      }
+      break;
+      case e_mlrLinkCreate:
+      {
+        if ( !_FReadNewId( _ris, m_rgpglLinks.size() ) )
+          return false;
+        _TyGraphLink * pgl = m_rg._allocate_link();
+        _BIEN_TRY
+        {
+          pgl->Init();
+          m_lio.Read( _ris, pgl->RElNonConst() );
+        }
+        _BIEN_UNWIND( m_rg._deallocate_link( pgl ) );
+        if ( _ris.fail() )
+        {
+          t_TyGraph::_destruct_link_el( pgl );
+          m_rg._deallocate_link( pgl );
+          return false;
+        }
+        _SetUnconnected( pgl );
+        _BIEN_TRY
+        {
+          (void)_TrackLink( pgl );
+        }
+        _BIEN_UNWIND( m_rg.destroy_link( pgl ) );
+      }
+      break;
+      case e_mlrNodeDestroy:
+      {
+        _TyGraphNode * pgn = _PGNRead( _ris, fOk );
+        if ( !fOk )
+          return false;
+        if ( pgn->FParents() || pgn->FChildren() || ( pgn == m_rg.get_root() ) )
+        {
+          throw bad_graph_stream( "_graph_mutation_log::replay(): Destroying a connected node." );
+        }
+        _ForgetNode( pgn, NodeId( pgn ) );
+        m_rg.destroy_single_node( pgn );
+      }
+      break;
+      case e_mlrLinkDestroy:
+      {
+        _TyGraphLink * pgl = _PGLRead( _ris, fOk );
+        if ( !fOk )
+          return false;
+        if ( _FLinkConnected( pgl ) )
+        {
+          throw bad_graph_stream( "_graph_mutation_log::replay(): Destroying a connected link." );
+        }
+        _ForgetLink( pgl, LinkId( pgl ) );
+        m_rg.destroy_link( pgl );
+      }
+      break;
+      case e_mlrRelationInsert:
+      {
+        _TyGraphLink * pgl = _PGLRead( _ris, fOk );
+        _TyGraphNode * pgnParent = fOk ? _PGNRead( _ris, fOk ) : 0;
+        _TyGraphNode * pgnChild = fOk ? _PGNRead( _ris, fOk ) : 0;
+        _TyId uChild, uParent;
+        if ( !fOk || !_FReadId( _ris, uChild ) || !_FReadId( _ris, uParent ) )
+          return false;
+        if ( _FLinkConnected( pgl ) )
+        {
+          throw bad_graph_stream( "_graph_mutation_log::replay(): Inserting a connected link." );
+        }
+        _CheckInsert( pgnParent, pgnChild, _TyGNIndex( uChild ), _TyGNIndex( uParent ) );
+        _Insert( pgnParent, pgnChild, pgl, _TyGNIndex( uChild ), _TyGNIndex( uParent ) );
+      }
+      break;
+      case e_mlrRelationRemove:
+      {
+        _TyGraphLink * pgl = _PGLRead( _ris, fOk );
+        if ( !fOk )
+          return false;
+        if ( !_FLinkConnected( pgl ) )
+        {
+          throw bad_graph_stream( "_graph_mutation_log::replay(): Removing an unconnected link." );
+        }
+        _Remove( pgl );
+      }
+      break;
+      case e_mlrChildMove:
+      case e_mlrParentMove:
+      {
+        _TyGraphNode * pgn = _PGNRead( _ris, fOk );
+        _TyId uRemove, uInsert;
+        if ( !fOk || !_FReadId( _ris, uRemove ) || !_FReadId( _ris, uInsert ) )
+          return false;
+        bool fChild = ( e_mlrChildMove == _iToken );
+        _TyGNIndex uRelations = pgn->URelations( fChild );
+        if ( ( uRemove >= uRelations ) || ( uInsert >= uRelations ) || ( uRemove == uInsert ) )
+        {
+          throw bad_graph_stream( "_graph_mutation_log::replay(): Bad move indices." );
+        }
+        fChild ?  pgn->MoveChild( _TyGNIndex( uRemove ), _TyGNIndex( uInsert ) ) :
+                  pgn->MoveParent( _TyGNIndex( uRemove ), _TyGNIndex( uInsert ) );
+      }
+      break;
+      case e_mlrNodeUpdate:
+      {
+        _TyGraphNode * pgn = _PGNRead( _ris, fOk );
+        if ( !fOk )
+          return false;
+        return _FReadAssign( _ris, m_nio, pgn->RElNonConst() );
+      }
+      break;
+      case e_mlrLinkUpdate:
+      {
+        _TyGraphLink * pgl = _PGLRead( _ris, fOk );
+        if ( !fOk )
+          return false;
+        return _FReadAssign( _ris, m_lio, pgl->RElNonConst() );
+      }
+      break;
+      case e_mlrSetRoot:
+      {
+        _TyId idRoot;
+        if ( !_FReadId( _ris, idRoot ) )
+          return false;
+        if ( idRoot && ( ( idRoot > m_rgpgnNodes.size() ) || !m_rgpgnNodes[ idRoot - 1 ] ) )
+        {
+          throw bad_graph_stream( "_graph_mutation_log::replay(): Bad root node id." );
+        }
+        m_rg.set_root_node( idRoot ? m_rgpgnNodes[ idRoot - 1 ] : 0 );
+      }
+      break;
+      default:
+      {
+        throw bad_graph_stream( "_graph_mutation_log::replay(): Bad record token." );
+      }
+      break;
+    }
+    return true;
+  }
+
+  // Read an element into temporary storage ( the element IO constructs it ) and then assign:
+  template < class t_TyElIO, class t_TyEl >
+  static bool _FReadAssign( istream & _ris, t_TyElIO & _rio, t_TyEl & _rel )
+  {
+    typename aligned_storage< sizeof( t_TyEl ), alignment_of< t_TyEl >::value >::type elTemp;
+    t_TyEl & relTemp = *reinterpret_cast< t_TyEl * >( &elTemp );
+    _rio.Read( _ris, relTemp );
+    if ( _ris.fail() )
+    {
+      relTemp.~t_TyEl();
+      return false;
+    }
+    _BIEN_TRY
+    {
+      _rel = std::move( relTemp );
+    }
+    _BIEN_UNWIND( relTemp.~t_TyEl() );
+    relTemp.~t_TyEl();
+    return true;
+  }
+};
+
+__DGRAPH_END_NAMESPACE
+
+#endif //__GR_MLOG_H
@@ -48,6 +48,18 @@ _StRawReadGraphEl( const void * _pvRead, ssize_t _sstLeft, t_TyRead & _rEl )
 	}
 }
 
+// Specialize for mmin - default version just skips the raw memory - this allows the
+//  parallel loader ( _gr_pldr.h ) to find the payload boundaries without deserializing:
+template < class t_TyRead >
+__INLINE size_t
+_StRawSkipGraphEl( const void * _pvRead, ssize_t _sstLeft, t_TyRead const * )
+{
+  __THROWPT( e_ttFileInput );
+  if ( _sstLeft < ssize_t( sizeof( t_TyRead ) ) )
+    THROWNAMEDEXCEPTION( "EOF skipping element." );
+  return sizeof( t_TyRead );
+}
+
 struct _mm_RawElIO
 {
   template < class t_TyEl >
@@ -60,6 +72,43 @@ struct _mm_RawElIO
   {
     return _StRawReadGraphEl( _pvRead, _sstLeft, _rel );
   }
+  template < class t_TyEl >
+  size_t StSkip( const void * _pvRead, ssize_t _sstLeft, t_TyEl const * _pel )
+  {
+    return _StRawSkipGraphEl( _pvRead, _sstLeft, _pel );
+  }
+};
+
+// Portable element IO - fixed width little-endian ( see _gr_port.h ):
+struct _mm_PortableElIO
+{
+  template < class t_TyEl >
+  size_t StWrite( void * _pvWrite, ssize_t _sstLeft, t_TyEl const & _rel )
+  {
+    typedef _portable_el_io< t_TyEl > _TyPortableIO;
+    if ( ssize_t( _TyPortableIO::s_kstSize ) <= _sstLeft )
+      _TyPortableIO::Store( _pvWrite, _rel );
+    return _TyPortableIO::s_kstSize;
+  }
+  template < class t_TyEl >
+  size_t StRead( const void * _pvRead, ssize_t _sstLeft, t_TyEl & _rel )
+  {
+    typedef _portable_el_io< t_TyEl > _TyPortableIO;
+    __THROWPT( e_ttFileInput );
+    if ( _sstLeft < ssize_t( _TyPortableIO::s_kstSize ) )
+      THROWNAMEDEXCEPTION( "EOF reading element." );
+    _TyPortableIO::Load( _pvRead, _rel );
+    return _TyPortableIO::s_kstSize;
+  }
+  template < class t_TyEl >
+  size_t StSkip( const void * _pvRead, ssize_t _sstLeft, t_TyEl const * )
+  {
+    typedef _portable_el_io< t_TyEl > _TyPortableIO;
+    __THROWPT( e_ttFileInput );
+    if ( _sstLeft < ssize_t( _TyPortableIO::s_kstSize ) )
+      THROWNAMEDEXCEPTION( "EOF skipping element." );
+    return _TyPortableIO::s_kstSize;
+  }
 };
 
 template <  class t_TyOutputNodeEl,
@@ -119,14 +119,18 @@ template <  class t_TyGraphNodeBase, class t_TyGraphLinkBase,
             // Setting this to true allows the writer to write unconstucted links.
             //  If it is false and the writer encounters an unconstucted link it will throw
             //  a bad_graph exception.
-            bool t_fAllowUnconstructedLinks = false > 
+            bool t_fAllowUnconstructedLinks = false,
+            // Write the portable format ( see _gr_port.h ) - names are little-endian ids rather than
+            //  pointers. The stream object's element IO should be portable as well.
+            bool t_fPortable = false > 
 struct _binary_output_base
 {
 private:
   typedef _binary_output_base<  t_TyGraphNodeBase, t_TyGraphLinkBase,
                                 t_TyStreamObject,
                                 t_fWriteExtraInformation, 
-                                t_fAllowUnconstructedLinks >  _TyThis;
+                                t_fAllowUnconstructedLinks,
+                                t_fPortable >  _TyThis;
 public:
 
   typedef t_TyGraphLinkBase _TyGraphLinkBase;
@@ -141,6 +145,8 @@ public:
   bool              m_fDirectionDown; // The current direction of the iteration.
   bool              m_fOutputOn;      // Allow caller to turn off output 
                                       //  ( dangerous - if you want to read it in again ).
+  typedef typename conditional< t_fPortable, _portable_name_map, _native_name_map >::type _TyNameMap;
+  _TyNameMap        m_nm;             // Names the nodes and links in the portable format.
 
   AssertStatement( bool m_fSetDirection )
 
@@ -174,8 +180,20 @@ public:
   void _WritePtr( void * _pv )
   {
     __THROWPT( e_ttFileOutput );
+    _WritePtr( _pv, std::integral_constant< bool, t_fPortable >() );
+  }
+  void _WritePtr( void * _pv, std::false_type )
+  {
     m_ros.Write( &_pv, sizeof( _pv ) );
   }
+  void _WritePtr( void * _pv, std::true_type )
+  {
+    static_assert( 1 == sizeof( _TyToken ), "Portable tokens are single bytes." );
+    _TyPortableName uName = m_nm.UGetName( _pv );
+    uint8_t rgby[ s_kstPortableNameBytes ];
+    _PortableCopyLE( rgby, &uName, s_kstPortableNameBytes );
+    m_ros.Write( rgby, s_kstPortableNameBytes );
+  }
 
   void _WriteContext( bool _fPush )
   {
@@ -347,24 +365,28 @@ public:
 template <  class t_TyGraphNode, class t_TyGraphLink,
             class t_TyStreamObject, class t_TyAllocator,
             bool t_fWriteExtraInformation,
-            bool t_fAllowUnconstructedLinks = false >
+            bool t_fAllowUnconstructedLinks = false,
+            bool t_fPortable = false >
 struct _binary_output_object
   : public _binary_output_base< typename t_TyGraphNode::_TyGraphNodeBaseBase,
                                 typename t_TyGraphLink::_TyGraphLinkBaseBase,
                                 t_TyStreamObject,
                                 t_fWriteExtraInformation,
-                                t_fAllowUnconstructedLinks >
+                                t_fAllowUnconstructedLinks,
+                                t_fPortable >
 {
 private:
   typedef _binary_output_object<  t_TyGraphNode, t_TyGraphLink, 
                                   t_TyStreamObject, t_TyAllocator,
                                   t_fWriteExtraInformation, 
-                                  t_fAllowUnconstructedLinks >                  _TyThis;
+                                  t_fAllowUnconstructedLinks,
+                                  t_fPortable >                                 _TyThis;
   typedef _binary_output_base<  typename t_TyGraphNode::_TyGraphNodeBaseBase,
                                 typename t_TyGraphLink::_TyGraphLinkBaseBase,
                                 t_TyStreamObject,
                                 t_fWriteExtraInformation,
-                                t_fAllowUnconstructedLinks >                    _TyBase;
+                                t_fAllowUnconstructedLinks,
+                                t_fPortable >                                   _TyBase;
 public:
 
   typedef _TyBase _TyOutputStreamBase;
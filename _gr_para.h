@@ -0,0 +1,222 @@
+#ifndef __GR_PARA_H
+#define __GR_PARA_H
+
+//          Copyright David Lawrence Bien 1997 - 2021.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt).
+
+// _gr_para.h
+
+// Worker threads - shared by the parallel algorithms and the background I/O of the graph.
+// _graph_workers starts a group of threads that each call one functor with their worker number and
+//  the number of workers in the group. A thread that cannot be created is left out of the group -
+//  the workers are released only once the group is complete, so all of them see the same count.
+//  An exception escaping a worker is kept and rethrown by join() - the first in worker order.
+// run() makes the calling thread worker 0 of a group and returns when all are done. parallel_for()
+//  distributes items round robin over run(). Both fail only if the functor does.
+// _graph_barrier: the workers of a group wait in it until all have arrived.
+
+#include <stddef.h>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <exception>
+#include <algorithm>
+
+__DGRAPH_BEGIN_NAMESPACE
+
+class _graph_workers
+{
+  typedef _graph_workers _TyThis;
+public:
+  typedef function< void( unsigned, unsigned ) > _TyWorkerFn; // ( worker, workers ).
+
+  _graph_workers()
+    : m_uWorkers( 0 ),
+      m_fRelease( false )
+  {
+  }
+  _graph_workers( _TyThis const & ) = delete;
+  ~_graph_workers() _BIEN_NOTHROW
+  {
+    _Join();
+  }
+
+  // The number of threads to use for a request - zero is one per hardware thread:
+  static unsigned UThreads( unsigned _uThreads ) _BIEN_NOTHROW
+  {
+    if ( !_uThreads )
+    {
+      _uThreads = thread::hardware_concurrency();
+    }
+    return max( 1u, _uThreads );
+  }
+
+  // Start up to _uThreads threads calling _rf( worker, workers ). Workers are numbered from
+  //  _uFirst - lower numbers are left to the caller ( see run() ). Returns the threads started.
+  unsigned  start( unsigned _uThreads, _TyWorkerFn _rf, unsigned _uFirst = 0 ) _BIEN_NOTHROW
+  {
+    Assert( m_rgthr.empty() );
+    m_fRelease = false;
+    m_uWorkers = _uFirst;
+    try
+    {
+      m_rf = std::move( _rf );
+      m_rgep.assign( _uThreads, exception_ptr() );
+      m_rgthr.reserve( _uThreads );
+    }
+    catch( ... )
+    {
+      _uThreads = 0;
+    }
+    for ( unsigned u = 0; u < _uThreads; ++u )
+    {
+      try
+      {
+        m_rgthr.push_back( thread( &_TyThis::_Worker, this, u, _uFirst + u ) );
+      }
+      catch( ... )
+      {
+        break; // Run with the threads we have.
+      }
+    }
+    {
+      lock_guard< mutex > lock( m_mtx );
+      m_uWorkers = _uFirst + unsigned( m_rgthr.size() );
+      m_fRelease = true;
+    }
+    m_cv.notify_all();
+    return unsigned( m_rgthr.size() );
+  }
+
+  // The size of the group - valid after start():
+  unsigned  UWorkers() const _BIEN_NOTHROW
+  {
+    return m_uWorkers;
+  }
+
+  // Wait for the threads - rethrows the first exception that escaped a worker:
+  void  join()
+  {
+    _Join();
+    for ( size_t st = 0; st < m_rgep.size(); ++st )
+    {
+      if ( m_rgep[ st ] )
+      {
+        exception_ptr ep = m_rgep[ st ];
+        m_rgep.clear();
+        rethrow_exception( ep );
+      }
+    }
+  }
+
+  // Call _rf( worker, workers ) on up to _uThreads threads ( 0 - hardware concurrency ) - the calling
+  //  thread is worker 0:
+  template < class t_TyF >
+  static void run( unsigned _uThreads, t_TyF const & _rf )
+  {
+    _TyThis gw;
+    gw.start( UThreads( _uThreads ) - 1, [&_rf]( unsigned _u, unsigned _uWorkers ) { _rf( _u, _uWorkers ); }, 1 );
+    _BIEN_TRY
+    {
+      _rf( 0, gw.UWorkers() );
+    }
+    _BIEN_UNWIND( gw._Join() );
+    gw.join();
+  }
+
+  // Call _rf( item ) for each of [0,_stItems) on up to _uThreads threads:
+  template < class t_TyF >
+  static void parallel_for( unsigned _uThreads, size_t _stItems, t_TyF const & _rf )
+  {
+    if ( !_stItems )
+    {
+      return;
+    }
+    run( unsigned( min( size_t( UThreads( _uThreads ) ), _stItems ) ),
+      [&_rf,_stItems]( unsigned _u, unsigned _uWorkers )
+      {
+        for ( size_t st = _u; st < _stItems; st += _uWorkers )
+        {
+          _rf( st );
+        }
+      } );
+  }
+
+protected:
+
+  _TyWorkerFn             m_rf;
+  vector< thread >        m_rgthr;
+  vector< exception_ptr > m_rgep;   // By thread.
+  unsigned                m_uWorkers;
+  mutex                   m_mtx;
+  condition_variable      m_cv;
+  bool                    m_fRelease;
+
+  void  _Join() _BIEN_NOTHROW
+  {
+    for ( size_t st = 0; st < m_rgthr.size(); ++st )
+    {
+      m_rgthr[ st ].join();
+    }
+    m_rgthr.clear();
+  }
+
+  void  _Worker( unsigned _uThread, unsigned _uWorker ) _BIEN_NOTHROW
+  {
+    {
+      unique_lock< mutex > lock( m_mtx );
+      m_cv.wait( lock, [this]{ return m_fRelease; } );
+    }
+    try
+    {
+      m_rf( _uWorker, m_uWorkers );
+    }
+    catch( ... )
+    {
+      m_rgep[ _uThread ] = current_exception();
+    }
+  }
+};
+
+class _graph_barrier
+{
+  typedef _graph_barrier _TyThis;
+public:
+
+  _graph_barrier()
+    : m_stWaiting( 0 ),
+      m_stGeneration( 0 )
+  {
+  }
+  _graph_barrier( _TyThis const & ) = delete;
+
+  // All _stParties callers must pass the same count:
+  void  wait( size_t _stParties ) _BIEN_NOTHROW
+  {
+    unique_lock< mutex > lock( m_mtx );
+    size_t stGeneration = m_stGeneration;
+    if ( ++m_stWaiting == _stParties )
+    {
+      m_stWaiting = 0;
+      ++m_stGeneration;
+      m_cv.notify_all();
+      return;
+    }
+    m_cv.wait( lock, [this,stGeneration]{ return stGeneration != m_stGeneration; } );
+  }
+
+protected:
+
+  mutex               m_mtx;
+  condition_variable  m_cv;
+  size_t              m_stWaiting;
+  size_t              m_stGeneration;
+};
+
+__DGRAPH_END_NAMESPACE
+
+#endif //__GR_PARA_H
@@ -0,0 +1,653 @@
+#ifndef __GR_PLDR_H
+#define __GR_PLDR_H
+
+//          Copyright David Lawrence Bien 1997 - 2021.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt).
+
+// _gr_pldr.h
+
+// This module implements a parallel loader for graphs written by the binary output iterator
+//  into a contiguous memory image ( i.e. a memory mapped file ).
+// Three things happen at once:
+//  1) The scanner ( a worker thread ) walks the token stream. It constructs nothing - it just
+//     records the position and length of each element payload. Payloads are grouped into regions
+//     of a fixed number of elements and each completed region is queued for decoding.
+//  2) The decoders ( the other worker threads ) deserialize the payloads of queued regions into
+//     region storage.
+//  3) The linking pass ( the calling thread ) runs the normal input iterator ( _gr_inpt.h ) over the
+//     image from the start - it links the structure and validates the stream. Element payloads are
+//     not decoded again - they are moved out of the region storage - so the linking pass waits only
+//     when it reaches a region that is not yet decoded.
+//  The scan reads only the tokens and names - it stays ahead of the linking pass, which does the
+//  allocation and linking, so the linking pass is the critical path: the load takes about as long
+//  as a serial load without element decoding.
+// Allocation of nodes and links remains on the calling thread - the graph's allocators
+//  needn't be thread-safe. The element IO object must support StSkip() ( see _mm_RawElIO )
+//  and must be copyable - each decoder uses its own copy.
+
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <vector>
+#include <exception>
+#include <type_traits>
+
+__DGRAPH_BEGIN_NAMESPACE
+
+// A region of element payloads - filled by the scanner, decoded by a worker, consumed
+//  by the linking pass.
+template < class t_TyEl, class t_TyAllocator >
+struct _gpl_payload_region
+{
+private:
+  typedef _gpl_payload_region< t_TyEl, t_TyAllocator > _TyThis;
+public:
+
+  typedef typename aligned_storage< sizeof( t_TyEl ), alignment_of< t_TyEl >::value >::type _TyElStorage;
+  typedef pair< size_t, size_t > _TyPayload; // ( offset, length ) within the image.
+  typedef typename _Alloc_traits< _TyPayload, t_TyAllocator >::allocator_type _TyAllocatorPayload;
+  typedef typename _Alloc_traits< _TyElStorage, t_TyAllocator >::allocator_type _TyAllocatorElStorage;
+
+  vector< _TyPayload, _TyAllocatorPayload > m_rgPayload;
+  vector< _TyElStorage, _TyAllocatorElStorage > m_rgElStorage;
+  size_t m_stConsumed;  // The elements in [m_stConsumed,m_stDecoded) are constructed.
+  size_t m_stDecoded;
+  bool m_fReady;        // Decoding is done - set under the loader's mutex.
+  exception_ptr m_xpDecode; // The exception thrown by the worker that decoded this region ( if any ).
+
+  _gpl_payload_region( size_t _stEls, t_TyAllocator const & _rAlloc )
+    : m_rgPayload( _rAlloc ),
+      m_rgElStorage( _rAlloc ),
+      m_stConsumed( 0 ),
+      m_stDecoded( 0 ),
+      m_fReady( false )
+  {
+    m_rgPayload.reserve( _stEls );
+  }
+  _gpl_payload_region( _TyThis const & ) = delete;
+  ~_gpl_payload_region() _BIEN_NOTHROW
+  {
+    for ( ; m_stConsumed < m_stDecoded; ++m_stConsumed )
+    {
+      REl( m_stConsumed ).~t_TyEl();
+    }
+  }
+
+  t_TyEl & REl( size_t _st ) _BIEN_NOTHROW
+  {
+    return *reinterpret_cast< t_TyEl * >( &m_rgElStorage[ _st ] );
+  }
+  bool FFull() const _BIEN_NOTHROW
+  {
+    return m_rgPayload.size() == m_rgPayload.capacity();
+  }
+  bool FAtEnd() const _BIEN_NOTHROW
+  {
+    return m_stConsumed == m_rgPayload.size();
+  }
+
+  template < class t_TyElIO >
+  void Decode( const uint8_t * _pbyImage, t_TyElIO & _rio ) _BIEN_NOTHROW
+  {
+    _BIEN_TRY
+    {
+      m_rgElStorage.resize( m_rgPayload.size() );
+      for ( ; m_stDecoded < m_rgPayload.size(); ++m_stDecoded )
+      {
+        _TyPayload const & rpl = m_rgPayload[ m_stDecoded ];
+        size_t stRead = _rio.StRead( _pbyImage + rpl.first, rpl.second, REl( m_stDecoded ) );
+        if ( stRead != rpl.second )
+        {
+          REl( m_stDecoded ).~t_TyEl();
+          throw bad_graph_stream( "_gpl_payload_region::Decode(): Element read a different length than was skipped." );
+        }
+      }
+    }
+    catch( ... )
+    {
+      m_xpDecode = current_exception();
+    }
+  }
+
+  // Move the next element into the ( unconstructed ) element <_rel> - it must be at <_stPos>:
+  size_t StConsume( size_t _stPos, t_TyEl & _rel )
+  {
+    Assert( m_stConsumed < m_stDecoded );
+    _TyPayload const & rpl = m_rgPayload[ m_stConsumed ];
+    if ( rpl.first != _stPos )
+    {
+      throw bad_graph_stream( "_gpl_payload_region::StConsume(): Element payload out of sequence." );
+    }
+    new( &_rel ) t_TyEl( std::move( REl( m_stConsumed ) ) );
+    REl( m_stConsumed ).~t_TyEl();
+    ++m_stConsumed;
+    return rpl.second;
+  }
+};
+
+// The stream object used by the linking pass - token data is read directly from the image,
+//  elements are obtained from the parallel loader.
+template < class t_TyLoader >
+struct _gpl_link_in_object
+{
+  typedef t_TyLoader * _TyInitArg;
+  typedef size_t _TyStreamPos;
+  typedef typename t_TyLoader::_TyInputNodeEl _TyIONodeEl;
+  typedef typename t_TyLoader::_TyInputLinkEl _TyIOLinkEl;
+
+  t_TyLoader * m_pgpl;
+  const uint8_t * m_pbyCur;
+
+  _gpl_link_in_object( _gpl_link_in_object const & ) = delete;
+  _gpl_link_in_object( t_TyLoader * _pgpl, _TyIONodeEl const &, _TyIOLinkEl const & )
+    : m_pgpl( _pgpl ),
+      m_pbyCur( _pgpl->m_pbyBegin )
+  {
+  }
+
+  _TyStreamPos TellG() const
+  {
+    return m_pbyCur - m_pgpl->m_pbyBegin;
+  }
+  void SeekG( _TyStreamPos _sp )
+  {
+    m_pbyCur = m_pgpl->m_pbyBegin + _sp;
+  }
+  void Read( void * _pv, size_t _st )
+  {
+    __THROWPT( e_ttFileInput );
+    if ( ssize_t( _st ) > ( m_pgpl->m_pbyEnd - m_pbyCur ) )
+      THROWNAMEDEXCEPTION( "EOF." );
+    memcpy( _pv, m_pbyCur, _st );
+    m_pbyCur += _st;
+  }
+  template < class t_TyEl >
+  void ReadNodeEl( t_TyEl & _rel )
+  {
+    m_pbyCur += m_pgpl->_StConsumeNode( TellG(), _rel );
+  }
+  template < class t_TyEl >
+  void ReadLinkEl( t_TyEl & _rel )
+  {
+    m_pbyCur += m_pgpl->_StConsumeLink( TellG(), _rel );
+  }
+};
+
+template <  class t_TyGraph,
+            class t_TyInputNodeEl,
+            class t_TyInputLinkEl = t_TyInputNodeEl,
+            // The "extra information" and "unconstructed links" attributes must correspond to those of the writer:
+            bool t_fReadExtraInformation = false,
+            bool t_fAllowUnconstructedLinks = false,
+            size_t t_kstRegionEls = 4096 >
+class _graph_parallel_loader
+{
+private:
+  typedef _graph_parallel_loader< t_TyGraph, t_TyInputNodeEl, t_TyInputLinkEl,
+                                  t_fReadExtraInformation, t_fAllowUnconstructedLinks,
+                                  t_kstRegionEls >                  _TyThis;
+  friend struct _gpl_link_in_object< _TyThis >;
+public:
+
+  typedef t_TyInputNodeEl _TyInputNodeEl;
+  typedef t_TyInputLinkEl _TyInputLinkEl;
+  typedef typename t_TyGraph::_TyGraphTraits _TyGraphTraits;
+  typedef typename t_TyGraph::_TyGraphNode _TyGraphNode;
+  typedef typename t_TyGraph::_TyGraphLink _TyGraphLink;
+  typedef typename t_TyGraph::_TyNodeEl _TyNodeEl;
+  typedef typename t_TyGraph::_TyLinkEl _TyLinkEl;
+  typedef typename t_TyGraph::_TyGraphBase::_TyPathNodeBaseAllocatorAsPassed _TyAllocatorAsPassed;
+
+  // The types for the linking pass:
+  typedef _gpl_link_in_object< _TyThis > _TyLinkInObject;
+  typedef _binary_input_object< _TyGraphNode, _TyGraphLink,
+                                _TyLinkInObject,
+                                t_fReadExtraInformation >                   _TyBinaryInput;
+  typedef typename _TyBinaryInput::_TyInputObjectBase                       _TyBinaryInputBase;
+  typedef _graph_input_iter_base< _TyBinaryInputBase, typename _TyGraphTraits::_TyGraphBaseBase,
+                                  _TyAllocatorAsPassed,
+                                  true, t_fAllowUnconstructedLinks >        _TyBinaryInputIterBase;
+  typedef typename _TyGraphTraits:: template _get_input_iterator< t_TyGraph,
+    _TyBinaryInput, _TyBinaryInputIterBase >::_TyBinaryInputIterNonConst    _TyBinaryInputIterNonConst;
+
+  typedef typename _TyBinaryInputBase::_TyGraphNodeBaseReadPtr _TyGraphNodeBaseReadPtr;
+  typedef typename _TyBinaryInputBase::_TyGraphLinkBaseReadPtr _TyGraphLinkBaseReadPtr;
+  typedef typename _binary_rep_tokens< std::false_type >::_TyToken _TyToken;
+
+  typedef _gpl_payload_region< _TyNodeEl, _TyAllocatorAsPassed > _TyNodeRegion;
+  typedef _gpl_payload_region< _TyLinkEl, _TyAllocatorAsPassed > _TyLinkRegion;
+  typedef typename _Alloc_traits< _TyNodeRegion, _TyAllocatorAsPassed >::allocator_type _TyAllocatorNodeRegion;
+  typedef typename _Alloc_traits< _TyLinkRegion, _TyAllocatorAsPassed >::allocator_type _TyAllocatorLinkRegion;
+  // deque - regions don't move when more are added:
+  typedef deque< _TyNodeRegion, _TyAllocatorNodeRegion > _TyNodeRegions;
+  typedef deque< _TyLinkRegion, _TyAllocatorLinkRegion > _TyLinkRegions;
+
+  static const size_t ms_kstRegionEls = t_kstRegionEls;
+
+protected:
+
+  const uint8_t * m_pbyBegin;
+  const uint8_t * m_pbyEnd;
+  t_TyInputNodeEl m_ine;
+  t_TyInputLinkEl m_ile;
+  _TyAllocatorAsPassed m_alloc;
+
+  // The regions are appended by the scanner under m_mtx - the deques don't move their elements:
+  _TyNodeRegions m_nodeRegions;
+  _TyLinkRegions m_linkRegions;
+  size_t m_stNodeRegionCur; // The region being consumed by the linking pass.
+  size_t m_stLinkRegionCur;
+  _TyNodeRegion * m_pnrCur;
+  _TyLinkRegion * m_plrCur;
+
+  // Regions waiting for a decoder - one of each pair is null:
+  typedef pair< _TyNodeRegion *, _TyLinkRegion * > _TyJob;
+  typedef typename _Alloc_traits< _TyJob, _TyAllocatorAsPassed >::allocator_type _TyAllocatorJob;
+  deque< _TyJob, _TyAllocatorJob > m_jobs;
+  mutex m_mtx;
+  condition_variable m_cvJobs;  // A region was queued, or the scan is done.
+  condition_variable m_cvReady; // A region was decoded, or the scan is done.
+  bool m_fScanDone;
+  exception_ptr m_xpScan;       // The exception that stopped the scan ( if any ).
+  atomic< bool > m_fCancel;     // The linking pass failed - stop scanning and decoding.
+  bool m_fDecodeInline;         // Scanner only - there are no decoders.
+  unsigned m_nDecoders;
+  _graph_workers m_workers;
+
+public:
+
+  // <_nWorkers> is the number of decoding threads - if zero then we use one per hardware thread.
+  _graph_parallel_loader( const void * _pvImage, size_t _stImage,
+                          unsigned _nWorkers = 0,
+                          _TyAllocatorAsPassed const & _rAlloc = _TyAllocatorAsPassed(),
+                          t_TyInputNodeEl const & _rine = t_TyInputNodeEl(),
+                          t_TyInputLinkEl const & _rile = t_TyInputLinkEl() )
+    : m_pbyBegin( (const uint8_t*)_pvImage ),
+      m_pbyEnd( (const uint8_t*)_pvImage + _stImage ),
+      m_ine( _rine ),
+      m_ile( _rile ),
+      m_alloc( _rAlloc ),
+      m_nodeRegions( _rAlloc ),
+      m_linkRegions( _rAlloc ),
+      m_stNodeRegionCur( 0 ),
+      m_stLinkRegionCur( 0 ),
+      m_pnrCur( 0 ),
+      m_plrCur( 0 ),
+      m_jobs( _rAlloc ),
+      m_fScanDone( false ),
+      m_fCancel( false ),
+      m_fDecodeInline( false ),
+      m_nDecoders( _graph_workers::UThreads( _nWorkers ) )
+  {
+  }
+  _graph_parallel_loader( _TyThis const & ) = delete;
+  ~_graph_parallel_loader() _BIEN_NOTHROW
+  {
+    _JoinWorkers( true ); // Workers must be done with the regions before they are destroyed.
+  }
+
+  // Load the graph into <_rg>'s allocators - return the new root, which is owned by the caller.
+  // On throw nothing remains allocated.
+  _TyGraphNode * PGNLoad( t_TyGraph & _rg )
+  {
+    // Worker 0 scans - if it alone could be started it decodes as well. If no worker could be
+    //  started we scan and decode here before linking:
+    if ( !m_workers.start( m_nDecoders + 1, [this]( unsigned _u, unsigned _uWorkers )
+          {
+            if ( !_u )
+              _ScanThread( 1 == _uWorkers );
+            else
+              _DecodeThread();
+          } ) )
+    {
+      _ScanThread( true );
+    }
+    _BIEN_TRY
+    {
+      _TyBinaryInputIterNonConst bii( _rg, this, m_alloc, m_ine, m_ile );
+      do
+      {
+        ++bii;
+      }
+      while( !bii.FAtEnd() );
+
+      _JoinWorkers( false );
+      if ( m_xpScan )
+        rethrow_exception( m_xpScan );
+      if ( !_FAllConsumed( m_nodeRegions ) || !_FAllConsumed( m_linkRegions ) )
+      {
+        throw bad_graph_stream( "_graph_parallel_loader::PGNLoad(): Not all element payloads were consumed." );
+      }
+      return bii.PGNTransferNewRoot();
+    }
+    _BIEN_UNWIND( _JoinWorkers( true ) );
+  }
+
+protected:
+
+  void _JoinWorkers( bool _fCancel ) _BIEN_NOTHROW
+  {
+    if ( _fCancel )
+    {
+      m_fCancel = true;
+      {
+        lock_guard< mutex > lock( m_mtx ); // Don't notify between a worker's test and its wait.
+      }
+      m_cvJobs.notify_all();
+    }
+    m_workers.join();
+  }
+
+  void _ScanThread( bool _fDecodeInline ) _BIEN_NOTHROW
+  {
+    m_fDecodeInline = _fDecodeInline;
+    exception_ptr xpScan;
+    try
+    {
+      _Scan();
+    }
+    catch( ... )
+    {
+      xpScan = current_exception();
+    }
+    {
+      lock_guard< mutex > lock( m_mtx );
+      m_xpScan = xpScan;
+      m_fScanDone = true;
+    }
+    m_cvJobs.notify_all();
+    m_cvReady.notify_all();
+  }
+
+  void _DecodeThread() _BIEN_NOTHROW
+  {
+    t_TyInputNodeEl ine( m_ine );
+    t_TyInputLinkEl ile( m_ile );
+    for ( ; ; )
+    {
+      _TyJob job;
+      {
+        unique_lock< mutex > lock( m_mtx );
+        while ( m_jobs.empty() && !m_fScanDone && !m_fCancel )
+          m_cvJobs.wait( lock );
+        if ( m_jobs.empty() || m_fCancel )
+          return;
+        job = m_jobs.front();
+        m_jobs.pop_front();
+      }
+      _Decode( job, ine, ile );
+    }
+  }
+
+  void _Decode( _TyJob const & _rjob, t_TyInputNodeEl & _rine, t_TyInputLinkEl & _rile ) _BIEN_NOTHROW
+  {
+    if ( _rjob.first )
+      _rjob.first->Decode( m_pbyBegin, _rine );
+    else
+      _rjob.second->Decode( m_pbyBegin, _rile );
+    {
+      lock_guard< mutex > lock( m_mtx );
+      if ( _rjob.first )
+        _rjob.first->m_fReady = true;
+      else
+        _rjob.second->m_fReady = true;
+    }
+    m_cvReady.notify_all();
+  }
+
+  void _Dispatch( _TyJob const & _rjob )
+  {
+    if ( m_fDecodeInline )
+    {
+      _Decode( _rjob, m_ine, m_ile );
+      return;
+    }
+    {
+      unique_lock< mutex > lock( m_mtx );
+      __THROWPT( e_ttMemory );
+      m_jobs.push_back( _rjob );
+    }
+    m_cvJobs.notify_one();
+  }
+
+  template < class t_TyRegions >
+  typename t_TyRegions::value_type & _RRegionForPayload( t_TyRegions & _rregions )
+  {
+    if ( _rregions.empty() || _rregions.back().FFull() )
+    {
+      if ( m_fCancel )
+      {
+        throw bad_graph_stream( "_graph_parallel_loader::_Scan(): Load abandoned." );
+      }
+      lock_guard< mutex > lock( m_mtx );
+      __THROWPT( e_ttMemory );
+      _rregions.emplace_back( ms_kstRegionEls, m_alloc );
+    }
+    return _rregions.back();
+  }
+
+  void _ScanSkip( const uint8_t *& _rpbyCur, size_t _st )
+  {
+    __THROWPT( e_ttFileInput );
+    if ( ssize_t( _st ) > ( m_pbyEnd - _rpbyCur ) )
+      throw bad_graph_stream( "_graph_parallel_loader::_Scan(): Unexpected end of image." );
+    _rpbyCur += _st;
+  }
+  template < class t_TyRead >
+  void _ScanRead( const uint8_t *& _rpbyCur, t_TyRead * _pr )
+  {
+    const uint8_t * pbyRead = _rpbyCur;
+    _ScanSkip( _rpbyCur, sizeof( *_pr ) );
+    memcpy( _pr, pbyRead, sizeof( *_pr ) );
+  }
+
+  void _ScanNodePayload( const uint8_t *& _rpbyCur )
+  {
+    _TyNodeRegion & rrgn = _RRegionForPayload( m_nodeRegions );
+    size_t stPayload = m_ine.StSkip( _rpbyCur, m_pbyEnd - _rpbyCur, (const _TyNodeEl*)0 );
+    rrgn.m_rgPayload.push_back( typename _TyNodeRegion::_TyPayload( _rpbyCur - m_pbyBegin, stPayload ) );
+    _rpbyCur += stPayload;
+    if ( rrgn.FFull() )
+      _Dispatch( _TyJob( &rrgn, 0 ) );
+  }
+  void _ScanLinkPayload( const uint8_t *& _rpbyCur )
+  {
+    _TyLinkRegion & rrgn = _RRegionForPayload( m_linkRegions );
+    size_t stPayload = m_ile.StSkip( _rpbyCur, m_pbyEnd - _rpbyCur, (const _TyLinkEl*)0 );
+    rrgn.m_rgPayload.push_back( typename _TyLinkRegion::_TyPayload( _rpbyCur - m_pbyBegin, stPayload ) );
+    _rpbyCur += stPayload;
+    if ( rrgn.FFull() )
+      _Dispatch( _TyJob( 0, &rrgn ) );
+  }
+
+  // Walk the tokens recording the element payloads - the grammar is that of _binary_input_base,
+  //  but the structure itself is validated by the linking pass:
+  void _Scan()
+  {
+    typedef _binary_rep_tokens< std::false_type > _TyTokens;
+    const uint8_t * pbyCur = m_pbyBegin;
+    for ( bool fGraphFooter = false; !fGraphFooter; )
+    {
+      _TyToken uc;
+      _ScanRead( pbyCur, &uc );
+      switch ( uc )
+      {
+      case _TyTokens::ms_ucDirectionUp:
+      case _TyTokens::ms_ucDirectionDown:
+      case _TyTokens::ms_ucContextPush:
+      case _TyTokens::ms_ucContextPop:
+      break;
+
+      case _TyTokens::ms_ucNode:
+      {
+        if ( t_fReadExtraInformation )
+        {
+          _ScanSkip( pbyCur, sizeof( _TyGraphNodeBaseReadPtr ) );
+        }
+        _ScanNodePayload( pbyCur );
+#ifdef __GR_BINARY_WRITENODEFOOTER
+        _ScanRead( pbyCur, &uc );
+        if ( _TyTokens::ms_ucNodeFooter != uc )
+        {
+          throw bad_graph_stream( "_graph_parallel_loader::_Scan(): Expected node footer token." );
+        }
+#endif //__GR_BINARY_WRITENODEFOOTER
+      }
+      break;
+
+      case _TyTokens::ms_ucUnfinishedNode:
+      {
+        _ScanSkip( pbyCur, sizeof( _TyGraphNodeBaseReadPtr ) + sizeof( _TyGraphLinkBaseReadPtr ) );
+        _ScanNodePayload( pbyCur );
+        // Null-terminated list of link names:
+        _TyGraphLinkBaseReadPtr pglbrRead;
+        do
+        {
+          _ScanRead( pbyCur, &pglbrRead );
+        }
+        while ( !!pglbrRead );
+      }
+      break;
+
+      case _TyTokens::ms_ucLink:
+      case _TyTokens::ms_ucLinkFromUnfinished:
+      {
+        bool fReadLinkName = t_fReadExtraInformation;
+        if ( _TyTokens::ms_ucLinkFromUnfinished == uc )
+        {
+          _ScanSkip( pbyCur, sizeof( _TyGraphLinkBaseReadPtr ) );
+          fReadLinkName = true;
+          if ( t_fReadExtraInformation )
+          {
+            _ScanSkip( pbyCur, sizeof( _TyGraphNodeBaseReadPtr ) );
+          }
+        }
+        else
+        if ( t_fReadExtraInformation )
+        {
+          _ScanSkip( pbyCur, sizeof( _TyGraphLinkBaseReadPtr ) );
+        }
+
+        bool fConstructed = true;
+        if ( t_fAllowUnconstructedLinks )
+        {
+          _ScanRead( pbyCur, &uc );
+          if ( _TyTokens::ms_ucLinkConstructed != uc && _TyTokens::ms_ucLinkEmpty != uc )
+          {
+            throw bad_graph_stream( "_graph_parallel_loader::_Scan(): Bad construction token." );
+          }
+          fConstructed = _TyTokens::ms_ucLinkConstructed == uc;
+        }
+        if ( fConstructed )
+        {
+          _ScanLinkPayload( pbyCur );
+        }
+
+        _ScanRead( pbyCur, &uc );
+        if ( _TyTokens::ms_ucUnfinishedLinkFooter == uc )
+        {
+          _ScanSkip( pbyCur, sizeof( _TyGraphNodeBaseReadPtr ) );
+          if ( !fReadLinkName )
+          {
+            _ScanSkip( pbyCur, sizeof( _TyGraphLinkBaseReadPtr ) );
+          }
+        }
+        else
+        if ( _TyTokens::ms_ucNormalLinkFooter != uc )
+        {
+          throw bad_graph_stream( "_graph_parallel_loader::_Scan(): Found bad link footer token." );
+        }
+      }
+      break;
+
+      case _TyTokens::ms_ucGraphFooter:
+      {
+        fGraphFooter = true;
+      }
+      break;
+
+      default:
+      {
+        char cpError[ 256 ];
+        snprintf( cpError, sizeof(cpError), "_graph_parallel_loader::_Scan(): Encountered bogus token [%d].", uc );
+        throw bad_graph_stream( cpError );
+      }
+      break;
+      }
+    }
+
+    // Hand off the last partial regions:
+    if ( !m_nodeRegions.empty() && !m_nodeRegions.back().FFull() )
+      _Dispatch( _TyJob( &m_nodeRegions.back(), 0 ) );
+    if ( !m_linkRegions.empty() && !m_linkRegions.back().FFull() )
+      _Dispatch( _TyJob( 0, &m_linkRegions.back() ) );
+  }
+
+  // Called by the linking pass:
+  // Wait for region _stRegion to be decoded - returns null if the scan found no such region:
+  template < class t_TyRegions >
+  typename t_TyRegions::value_type * _PRegionReady( t_TyRegions & _rregions, size_t _stRegion )
+  {
+    unique_lock< mutex > lock( m_mtx );
+    for ( ; ; )
+    {
+      if ( ( _stRegion < _rregions.size() ) && _rregions[ _stRegion ].m_fReady )
+        return &_rregions[ _stRegion ];
+      if ( m_xpScan )
+        rethrow_exception( m_xpScan );
+      if ( m_fScanDone && ( _stRegion >= _rregions.size() ) )
+        return 0;
+      m_cvReady.wait( lock );
+    }
+  }
+  template < class t_TyRegions, class t_TyEl >
+  size_t _StConsume( t_TyRegions & _rregions, size_t & _rstRegionCur, typename t_TyRegions::value_type *& _rprgnCur,
+                     size_t _stPos, t_TyEl & _rel )
+  {
+    while ( !_rprgnCur || _rprgnCur->FAtEnd() )
+    {
+      if ( _rprgnCur )
+        ++_rstRegionCur;
+      _rprgnCur = _PRegionReady( _rregions, _rstRegionCur );
+      if ( !_rprgnCur )
+      {
+        throw bad_graph_stream( "_graph_parallel_loader::_StConsume(): Element payload not found by scan." );
+      }
+      if ( _rprgnCur->m_xpDecode )
+        rethrow_exception( _rprgnCur->m_xpDecode );
+    }
+    return _rprgnCur->StConsume( _stPos, _rel );
+  }
+  size_t _StConsumeNode( size_t _stPos, _TyNodeEl & _rel )
+  {
+    return _StConsume( m_nodeRegions, m_stNodeRegionCur, m_pnrCur, _stPos, _rel );
+  }
+  size_t _StConsumeLink( size_t _stPos, _TyLinkEl & _rel )
+  {
+    return _StConsume( m_linkRegions, m_stLinkRegionCur, m_plrCur, _stPos, _rel );
+  }
+
+  // After the workers are joined:
+  template < class t_TyRegions >
+  static bool _FAllConsumed( t_TyRegions & _rregions ) _BIEN_NOTHROW
+  {
+    for ( typename t_TyRegions::iterator it = _rregions.begin(); _rregions.end() != it; ++it )
+    {
+      if ( !it->FAtEnd() )
+        return false;
+    }
+    return true;
+  }
+};
+
+template <  class t_TyGraph, class t_TyInputNodeEl, class t_TyInputLinkEl,
+            bool t_fReadExtraInformation, bool t_fAllowUnconstructedLinks, size_t t_kstRegionEls >
+const size_t _graph_parallel_loader< t_TyGraph, t_TyInputNodeEl, t_TyInputLinkEl,
+  t_fReadExtraInformation, t_fAllowUnconstructedLinks, t_kstRegionEls >::ms_kstRegionEls;
+
+__DGRAPH_END_NAMESPACE
+
+#endif //__GR_PLDR_H
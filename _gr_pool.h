@@ -0,0 +1,271 @@
+#ifndef __GR_POOL_H
+#define __GR_POOL_H
+
+//          Copyright David Lawrence Bien 1997 - 2021.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt).
+
+// _gr_pool.h
+
+// Pooled allocation for the small, short-lived objects of graph iteration - path nodes ( safe and
+//  base ) and the connection links they contain. Freed blocks are kept on a per-thread free list
+//  for their size class and reused by the next allocation of that size on the thread - so creating
+//  and dropping iterators in a loop does not reach the general heap.
+// Blocks are individually allocated from ::operator new - so a block may be freed on any thread and
+//  a thread's cached blocks are simply deleted when it exits. Each size class caches at most
+//  s_kstMaxCachedPerClass blocks. Sizes beyond s_kstMaxPooledSize go straight to ::operator new.
+// Once a thread's cache has been destroyed - objects destroyed later in thread exit, or by static
+//  destruction on the main thread - the thread allocates from and frees to a shared free list
+//  under a spin lock instead. That list is constant initialized and never destroyed.
+// Use _graph_traits_safe_pooled<> ( _gr_trt.h ) or pass _graph_pool_allocator<> for the path node
+//  allocators of an allocator set.
+
+#include <stddef.h>
+#include <new>
+#include <atomic>
+#include <thread>
+
+__DGRAPH_BEGIN_NAMESPACE
+
+class _graph_pool_cache
+{
+  typedef _graph_pool_cache _TyThis;
+public:
+  static const size_t s_kstGranularity = 16;
+  static const size_t s_kstMaxPooledSize = 512;
+  static const size_t s_kstSizeClasses = s_kstMaxPooledSize / s_kstGranularity;
+  static const size_t s_kstMaxCachedPerClass = 1024;
+
+  _graph_pool_cache() _BIEN_NOTHROW
+  {
+    for ( size_t st = 0; st < s_kstSizeClasses; ++st )
+    {
+      m_rgpfbHead[ st ] = 0;
+      m_rgstCached[ st ] = 0;
+    }
+  }
+  ~_graph_pool_cache()
+  {
+    _RfThreadCacheDestroyed() = true;
+    for ( size_t st = 0; st < s_kstSizeClasses; ++st )
+    {
+      while ( m_rgpfbHead[ st ] )
+      {
+        _free_block * pfb = m_rgpfbHead[ st ];
+        m_rgpfbHead[ st ] = pfb->m_pfbNext;
+        ::operator delete( (void*)pfb );
+      }
+    }
+  }
+
+  // The cache of the calling thread - null once it has been destroyed:
+  static _TyThis * PGetThreadCache() _BIEN_NOTHROW
+  {
+    if ( _RfThreadCacheDestroyed() )
+    {
+      return 0;
+    }
+    static thread_local _TyThis s_gpc;
+    return &s_gpc;
+  }
+
+  // Allocate/deallocate through the calling thread's cache - or the shared list once it is gone:
+  static void * Allocate( size_t _st )
+  {
+    _TyThis * pgpc = PGetThreadCache();
+    return pgpc ? pgpc->allocate( _st ) : _SharedAllocate( _st );
+  }
+  static void Deallocate( void * _pv, size_t _st ) _BIEN_NOTHROW
+  {
+    _TyThis * pgpc = PGetThreadCache();
+    pgpc ? pgpc->deallocate( _pv, _st ) : _SharedDeallocate( _pv, _st );
+  }
+
+  void * allocate( size_t _st )
+  {
+    if ( !_st || ( _st > s_kstMaxPooledSize ) )
+    {
+      __THROWPT( e_ttMemory );
+      return ::operator new( _st );
+    }
+    size_t stClass = _StClass( _st );
+    _free_block * pfb = m_rgpfbHead[ stClass ];
+    if ( pfb )
+    {
+      m_rgpfbHead[ stClass ] = pfb->m_pfbNext;
+      --m_rgstCached[ stClass ];
+      return pfb;
+    }
+    __THROWPT( e_ttMemory );
+    return ::operator new( ( stClass + 1 ) * s_kstGranularity );
+  }
+  void deallocate( void * _pv, size_t _st ) _BIEN_NOTHROW
+  {
+    if ( !_st || ( _st > s_kstMaxPooledSize ) )
+    {
+      ::operator delete( _pv );
+      return;
+    }
+    size_t stClass = _StClass( _st );
+    if ( m_rgstCached[ stClass ] >= s_kstMaxCachedPerClass )
+    {
+      ::operator delete( _pv );
+      return;
+    }
+    _free_block * pfb = static_cast< _free_block * >( _pv );
+    pfb->m_pfbNext = m_rgpfbHead[ stClass ];
+    m_rgpfbHead[ stClass ] = pfb;
+    ++m_rgstCached[ stClass ];
+  }
+
+protected:
+  struct _free_block
+  {
+    _free_block * m_pfbNext;
+  };
+
+  static size_t _StClass( size_t _st ) _BIEN_NOTHROW
+  {
+    return ( _st - 1 ) / s_kstGranularity;
+  }
+
+  // Trivially destructible - so still readable after the thread's cache is destroyed:
+  static bool & _RfThreadCacheDestroyed() _BIEN_NOTHROW
+  {
+    static thread_local bool s_fDestroyed = false;
+    return s_fDestroyed;
+  }
+
+  // The shared free list - constant initialized with no destructor, so it is usable throughout
+  //  thread exit and static destruction. Its blocks are never returned to the heap:
+  struct _shared_list
+  {
+    atomic_flag   m_afLock;
+    _free_block * m_rgpfbHead[ s_kstSizeClasses ];
+    size_t        m_rgstCached[ s_kstSizeClasses ];
+
+    void  _Lock() _BIEN_NOTHROW
+    {
+      while ( m_afLock.test_and_set( memory_order_acquire ) )
+      {
+        this_thread::yield();
+      }
+    }
+    void  _Unlock() _BIEN_NOTHROW
+    {
+      m_afLock.clear( memory_order_release );
+    }
+  };
+  static _shared_list & _RGetSharedList() _BIEN_NOTHROW
+  {
+    static _shared_list s_sl = { ATOMIC_FLAG_INIT, { 0 }, { 0 } };
+    return s_sl;
+  }
+  static void * _SharedAllocate( size_t _st )
+  {
+    if ( _st && ( _st <= s_kstMaxPooledSize ) )
+    {
+      size_t stClass = _StClass( _st );
+      _shared_list & rsl = _RGetSharedList();
+      rsl._Lock();
+      _free_block * pfb = rsl.m_rgpfbHead[ stClass ];
+      if ( pfb )
+      {
+        rsl.m_rgpfbHead[ stClass ] = pfb->m_pfbNext;
+        --rsl.m_rgstCached[ stClass ];
+      }
+      rsl._Unlock();
+      if ( pfb )
+      {
+        return pfb;
+      }
+      _st = ( stClass + 1 ) * s_kstGranularity;
+    }
+    __THROWPT( e_ttMemory );
+    return ::operator new( _st );
+  }
+  static void _SharedDeallocate( void * _pv, size_t _st ) _BIEN_NOTHROW
+  {
+    if ( _st && ( _st <= s_kstMaxPooledSize ) )
+    {
+      size_t stClass = _StClass( _st );
+      _shared_list & rsl = _RGetSharedList();
+      rsl._Lock();
+      bool fCache = rsl.m_rgstCached[ stClass ] < s_kstMaxCachedPerClass;
+      if ( fCache )
+      {
+        _free_block * pfb = static_cast< _free_block * >( _pv );
+        pfb->m_pfbNext = rsl.m_rgpfbHead[ stClass ];
+        rsl.m_rgpfbHead[ stClass ] = pfb;
+        ++rsl.m_rgstCached[ stClass ];
+      }
+      rsl._Unlock();
+      if ( fCache )
+      {
+        return;
+      }
+    }
+    ::operator delete( _pv );
+  }
+
+  _free_block * m_rgpfbHead[ s_kstSizeClasses ];
+  size_t m_rgstCached[ s_kstSizeClasses ];
+};
+
+// Stateless allocator drawing from the calling thread's _graph_pool_cache:
+template < class t_Ty >
+class _graph_pool_allocator
+{
+  typedef _graph_pool_allocator< t_Ty > _TyThis;
+public:
+  typedef t_Ty value_type;
+  typedef t_Ty * pointer;
+  typedef const t_Ty * const_pointer;
+  typedef t_Ty & reference;
+  typedef const t_Ty & const_reference;
+  typedef size_t size_type;
+  typedef ptrdiff_t difference_type;
+
+  template < class t_TyOther >
+  struct rebind
+  {
+    typedef _graph_pool_allocator< t_TyOther > other;
+  };
+
+  _graph_pool_allocator() _BIEN_NOTHROW
+  {
+  }
+  template < class t_TyOther >
+  _graph_pool_allocator( _graph_pool_allocator< t_TyOther > const & ) _BIEN_NOTHROW
+  {
+  }
+
+  t_Ty * allocate( size_t _n, const void * = 0 )
+  {
+    return static_cast< t_Ty * >( _graph_pool_cache::Allocate( _n * sizeof( t_Ty ) ) );
+  }
+  void deallocate( t_Ty * _p, size_t _n ) _BIEN_NOTHROW
+  {
+    _graph_pool_cache::Deallocate( _p, _n * sizeof( t_Ty ) );
+  }
+  size_t max_size() const _BIEN_NOTHROW
+  {
+    return size_t( -1 ) / sizeof( t_Ty );
+  }
+
+  template < class t_TyOther >
+  bool operator == ( _graph_pool_allocator< t_TyOther > const & ) const _BIEN_NOTHROW
+  {
+    return true;
+  }
+  template < class t_TyOther >
+  bool operator != ( _graph_pool_allocator< t_TyOther > const & ) const _BIEN_NOTHROW
+  {
+    return false;
+  }
+};
+
+__DGRAPH_END_NAMESPACE
+
+#endif //__GR_POOL_H
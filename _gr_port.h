@@ -0,0 +1,109 @@
+#ifndef __GR_PORT_H
+#define __GR_PORT_H
+
+//          Copyright David Lawrence Bien 1997 - 2021.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt).
+
+// _gr_port.h
+
+// Support for the portable binary graph format - selected by the t_fPortable flag on
+//  _binary_output_base/_binary_input_base. In the portable format:
+//  1) Node and link names are ids ( 1, 2, ... in order of first write, 0 for null ) written as
+//     little-endian uint64_t - rather than native pointers.
+//  2) Elements are written through _portable_el_io<> - fixed width and little-endian. This is
+//     defined for arithmetic and enum types and arrays of them and is a straight memcpy on
+//     little-endian hosts. Specialize _portable_el_io<> for other element types.
+// Note that the width of an arithmetic type is its width on the writing machine - use the
+//  fixed-width types ( int32_t, etc. ) for elements shared between word sizes.
+
+#include <string.h>
+#include <stdint.h>
+#include <type_traits>
+#include <unordered_map>
+
+#if defined( __BYTE_ORDER__ ) && defined( __ORDER_BIG_ENDIAN__ ) && ( __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__ )
+#define __GR_HOST_BIG_ENDIAN
+#endif
+
+__DGRAPH_BEGIN_NAMESPACE
+
+// Store/load the bytes of a scalar in little-endian order:
+__INLINE void
+_PortableCopyLE( void * _pvTo, const void * _pvFrom, size_t _st ) _BIEN_NOTHROW
+{
+#ifdef __GR_HOST_BIG_ENDIAN
+  const uint8_t * pbyFrom = (const uint8_t *)_pvFrom + _st;
+  for ( uint8_t * pbyTo = (uint8_t *)_pvTo; _st--; )
+    *pbyTo++ = *--pbyFrom;
+#else //__GR_HOST_BIG_ENDIAN
+  memcpy( _pvTo, _pvFrom, _st );
+#endif //__GR_HOST_BIG_ENDIAN
+}
+
+template < class t_TyEl, class t_TyEnable = void >
+struct _portable_el_io; // Specialize for element types that are not scalar.
+
+// Arithmetic and enum types:
+template < class t_TyEl >
+struct _portable_el_io< t_TyEl, typename enable_if< is_arithmetic< t_TyEl >::value || is_enum< t_TyEl >::value >::type >
+{
+  static const size_t s_kstSize = sizeof( t_TyEl );
+  static void Store( void * _pv, t_TyEl const & _rel ) _BIEN_NOTHROW
+  {
+    _PortableCopyLE( _pv, &_rel, sizeof( t_TyEl ) );
+  }
+  static void Load( const void * _pv, t_TyEl & _rel ) _BIEN_NOTHROW
+  {
+    _PortableCopyLE( &_rel, _pv, sizeof( t_TyEl ) );
+  }
+};
+
+// Arrays of portable types:
+template < class t_TyEl, size_t t_kN >
+struct _portable_el_io< t_TyEl[ t_kN ], void >
+{
+  typedef _portable_el_io< t_TyEl > _TyElIO;
+  static const size_t s_kstSize = _TyElIO::s_kstSize * t_kN;
+  static void Store( void * _pv, const t_TyEl (&_rel)[ t_kN ] ) _BIEN_NOTHROW
+  {
+    for ( size_t st = 0; st < t_kN; ++st )
+      _TyElIO::Store( (uint8_t *)_pv + st * _TyElIO::s_kstSize, _rel[ st ] );
+  }
+  static void Load( const void * _pv, t_TyEl (&_rel)[ t_kN ] ) _BIEN_NOTHROW
+  {
+    for ( size_t st = 0; st < t_kN; ++st )
+      _TyElIO::Load( (const uint8_t *)_pv + st * _TyElIO::s_kstSize, _rel[ st ] );
+  }
+};
+
+// Names are written as this many little-endian bytes on every host:
+typedef uint64_t _TyPortableName;
+static const size_t s_kstPortableNameBytes = 8;
+static_assert( sizeof( _TyPortableName ) == s_kstPortableNameBytes, "Portable names are 8 bytes." );
+
+// Map node and link pointers to portable names:
+class _portable_name_map
+{
+  typedef unordered_map< const void *, _TyPortableName > _TyMap;
+  _TyMap m_map;
+public:
+  _TyPortableName UGetName( const void * _pv )
+  {
+    if ( !_pv )
+    {
+      return 0;
+    }
+    __THROWPT( e_ttMemory );
+    return m_map.insert( _TyMap::value_type( _pv, m_map.size() + 1 ) ).first->second;
+  }
+};
+// The native format writes pointers - it has no name map:
+struct _native_name_map
+{
+};
+
+__DGRAPH_END_NAMESPACE
+
+#endif //__GR_PORT_H
@@ -0,0 +1,318 @@
+#ifndef __GR_RANK_H
+#define __GR_RANK_H
+
+//          Copyright David Lawrence Bien 1997 - 2021.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt).
+
+// _gr_rank.h
+
+// Frozen graph view and ranking kernels.
+// _graph_frozen_view: a contiguous snapshot of a graph - node ids ( _graph_edge_list_exporter,
+//  _gr_bulk.h ) with the child and parent lists as offset arrays - the parents are the reverse of
+//  the children ( _ReverseCSR() ), not read from the parent lists - taken once and then used by
+//  any number of batch computations without touching the links again. Degree statistics come
+//  straight from the offsets. Results by node id may be written back into the node elements.
+// _graph_pagerank: PageRank and personalized PageRank over a view. The ranks are pulled through the
+//  parent offsets: each iteration first computes the contribution ( rank / children ) of every node
+//  and then sums the contributions of the parents of every node - both are plain loops over
+//  contiguous arrays. The mass of nodes without children is redistributed by the teleport vector.
+//  The nodes are split into contiguous blocks - one per thread - and the threads meet at a barrier
+//  between the phases. Every thread reaches the same convergence decision from the same sums so
+//  all stop in the same iteration.
+// The graph must not be modified while a view of it is in use ( elements may be ).
+
+#include <stddef.h>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+__DGRAPH_BEGIN_NAMESPACE
+
+struct _graph_degree_stats
+{
+  size_t  m_stNodes;
+  size_t  m_stLinks;
+  size_t  m_stMaxChildren;
+  size_t  m_stMaxParents;
+  size_t  m_stSources;      // Nodes without parents.
+  size_t  m_stSinks;        // Nodes without children.
+  double  m_dblMeanDegree;  // Links per node.
+};
+
+template < class t_TyGraph >
+class _graph_frozen_view
+{
+  typedef _graph_frozen_view< t_TyGraph > _TyThis;
+public:
+  typedef t_TyGraph                                     _TyGraph;
+  typedef typename t_TyGraph::_TyGraphNode              _TyGraphNode;
+  typedef typename _TyGraphNode::_TyGraphLinkBaseBase   _TyGraphLinkBaseBase;
+  typedef _graph_edge_list_exporter< t_TyGraph >        _TyNumbering;
+
+  explicit _graph_frozen_view( t_TyGraph const & _rg )
+    : m_gele( _rg )
+  {
+    size_t stNodes = m_gele.StNodes();
+    m_rgstChildOffsets.resize( stNodes + 1 );
+    m_rgstChildren.resize( m_gele.StLinks() );
+    m_gele.CopyCSR( m_rgstChildOffsets.begin(), m_rgstChildren.begin() );
+    _ReverseCSR( m_rgstChildOffsets, m_rgstChildren, m_rgstParentOffsets, m_rgstParents );
+  }
+
+  _TyNumbering const &  RNumbering() const _BIEN_NOTHROW
+  {
+    return m_gele;
+  }
+  size_t  StNodes() const _BIEN_NOTHROW
+  {
+    return m_rgstChildOffsets.size() - 1;
+  }
+  size_t  StLinks() const _BIEN_NOTHROW
+  {
+    return m_rgstChildren.size();
+  }
+  const _TyGraphNode *  PGNNode( size_t _stNode ) const _BIEN_NOTHROW
+  {
+    return m_gele.PGNNode( _stNode );
+  }
+  // The children of node i are RgstChildren()[ RgstChildOffsets()[ i ] .. RgstChildOffsets()[ i+1 ] ) - in
+  //  child list order - likewise the parents, but in increasing parent id:
+  vector< size_t > const &  RgstChildOffsets() const _BIEN_NOTHROW
+  {
+    return m_rgstChildOffsets;
+  }
+  vector< size_t > const &  RgstChildren() const _BIEN_NOTHROW
+  {
+    return m_rgstChildren;
+  }
+  vector< size_t > const &  RgstParentOffsets() const _BIEN_NOTHROW
+  {
+    return m_rgstParentOffsets;
+  }
+  vector< size_t > const &  RgstParents() const _BIEN_NOTHROW
+  {
+    return m_rgstParents;
+  }
+  size_t  StChildren( size_t _stNode ) const _BIEN_NOTHROW
+  {
+    return m_rgstChildOffsets[ _stNode + 1 ] - m_rgstChildOffsets[ _stNode ];
+  }
+  size_t  StParents( size_t _stNode ) const _BIEN_NOTHROW
+  {
+    return m_rgstParentOffsets[ _stNode + 1 ] - m_rgstParentOffsets[ _stNode ];
+  }
+
+  void  GetDegreeStats( _graph_degree_stats & _rgds ) const _BIEN_NOTHROW
+  {
+    size_t stNodes = StNodes();
+    _rgds.m_stNodes = stNodes;
+    _rgds.m_stLinks = StLinks();
+    _rgds.m_stMaxChildren = _rgds.m_stMaxParents = 0;
+    _rgds.m_stSources = _rgds.m_stSinks = 0;
+    for ( size_t st = 0; st < stNodes; ++st )
+    {
+      size_t stChildren = StChildren( st );
+      size_t stParents = StParents( st );
+      _rgds.m_stMaxChildren = max( _rgds.m_stMaxChildren, stChildren );
+      _rgds.m_stMaxParents = max( _rgds.m_stMaxParents, stParents );
+      _rgds.m_stSinks += !stChildren;
+      _rgds.m_stSources += !stParents;
+    }
+    _rgds.m_dblMeanDegree = stNodes ? double( StLinks() ) / double( stNodes ) : 0.0;
+  }
+
+  // Write results back - _fa( node element &, value ) for each node. _rg must be the viewed graph:
+  template < class t_TyValue, class t_TyAssign >
+  void  assign_to_elements( t_TyGraph & _rg, vector< t_TyValue > const & _rrgv, t_TyAssign _fa ) const
+  {
+    Assert( !StNodes() || ( _rg.get_root() == PGNNode( 0 ) ) );
+    for ( size_t st = 0; st < StNodes(); ++st )
+    {
+      _fa( const_cast< _TyGraphNode * >( PGNNode( st ) )->RElNonConst(), _rrgv[ st ] );
+    }
+  }
+
+protected:
+
+  _TyNumbering      m_gele;
+  vector< size_t >  m_rgstChildOffsets;
+  vector< size_t >  m_rgstChildren;
+  vector< size_t >  m_rgstParentOffsets;
+  vector< size_t >  m_rgstParents;
+};
+
+template < class t_TyGraph >
+class _graph_pagerank
+{
+  typedef _graph_pagerank< t_TyGraph > _TyThis;
+public:
+  typedef _graph_frozen_view< t_TyGraph > _TyView;
+
+  explicit _graph_pagerank( _TyView const & _rgfv )
+    : m_rgfv( _rgfv ),
+      m_dblDamping( 0.85 ),
+      m_dblTolerance( 1.0e-10 ),
+      m_stMaxIterations( 100 ),
+      m_uThreads( 0 )
+  {
+  }
+
+  // Damping factor, L1 change at which to stop, iteration limit and threads ( 0 - hardware concurrency ):
+  void  set_parameters( double _dblDamping, double _dblTolerance, size_t _stMaxIterations, unsigned _uThreads = 0 ) _BIEN_NOTHROW
+  {
+    m_dblDamping = _dblDamping;
+    m_dblTolerance = _dblTolerance;
+    m_stMaxIterations = _stMaxIterations;
+    m_uThreads = _uThreads;
+  }
+
+  // Ranks by node id into _rrgdblRank - summing to 1. Returns the iterations run:
+  size_t  pagerank( vector< double > & _rrgdblRank )
+  {
+    size_t stNodes = m_rgfv.StNodes();
+    vector< double > rgdblTeleport( stNodes, stNodes ? 1.0 / double( stNodes ) : 0.0 );
+    return _Run( rgdblTeleport, _rrgdblRank );
+  }
+  // Personalized - teleporting by the non-negative weights _rrgdblWeights ( by node id, not all zero ):
+  size_t  personalized_pagerank( vector< double > const & _rrgdblWeights, vector< double > & _rrgdblRank )
+  {
+    size_t stNodes = m_rgfv.StNodes();
+    Assert( _rrgdblWeights.size() == stNodes );
+    double dblSum = 0.0;
+    for ( size_t st = 0; st < stNodes; ++st )
+    {
+      dblSum += _rrgdblWeights[ st ];
+    }
+    if ( !( dblSum > 0.0 ) )
+    {
+      throw bad_graph( "_graph_pagerank::personalized_pagerank(): Weights sum to zero." );
+    }
+    vector< double > rgdblTeleport( stNodes );
+    for ( size_t st = 0; st < stNodes; ++st )
+    {
+      rgdblTeleport[ st ] = _rrgdblWeights[ st ] / dblSum;
+    }
+    return _Run( rgdblTeleport, _rrgdblRank );
+  }
+
+protected:
+
+  _TyView const & m_rgfv;
+  double          m_dblDamping;
+  double          m_dblTolerance;
+  size_t          m_stMaxIterations;
+  unsigned        m_uThreads;
+
+  // State shared by the workers of a run:
+  struct _run_state
+  {
+    vector< double > const &  m_rrgdblTeleport;
+    vector< double >          m_rgdblRank[ 2 ];   // By iteration parity.
+    vector< double >          m_rgdblContrib;
+    vector< double >          m_rgdblDangling;    // Partial sums by worker.
+    vector< double >          m_rgdblDelta;
+    size_t                    m_stIterations;
+    _graph_barrier            m_barrier;
+
+    explicit _run_state( vector< double > const & _rrgdblTeleport )
+      : m_rrgdblTeleport( _rrgdblTeleport ),
+        m_stIterations( 0 )
+    {
+    }
+  };
+
+  size_t  _Run( vector< double > const & _rrgdblTeleport, vector< double > & _rrgdblRank )
+  {
+    size_t stNodes = m_rgfv.StNodes();
+    if ( !stNodes )
+    {
+      _rrgdblRank.clear();
+      return 0;
+    }
+    size_t stThreads = min( size_t( _graph_workers::UThreads( m_uThreads ) ), stNodes );
+
+    _run_state rs( _rrgdblTeleport );
+    rs.m_rgdblRank[ 0 ] = _rrgdblTeleport;
+    rs.m_rgdblRank[ 1 ].resize( stNodes );
+    rs.m_rgdblContrib.resize( stNodes );
+    rs.m_rgdblDangling.resize( stThreads );
+    rs.m_rgdblDelta.resize( stThreads );
+
+    _graph_workers::run( unsigned( stThreads ), [this,&rs]( unsigned _u, unsigned _uWorkers ) { _Worker( rs, _u, _uWorkers ); } );
+    _rrgdblRank.swap( rs.m_rgdblRank[ rs.m_stIterations & 1 ] );
+    return rs.m_stIterations;
+  }
+
+  void  _Worker( _run_state & _rrs, size_t _stWorker, size_t _stWorkers ) _BIEN_NOTHROW
+  {
+    size_t stNodes = m_rgfv.StNodes();
+    size_t stBegin = stNodes * _stWorker / _stWorkers;
+    size_t stEnd = stNodes * ( _stWorker + 1 ) / _stWorkers;
+    const size_t * pstChildOffsets = &m_rgfv.RgstChildOffsets()[ 0 ];
+    const size_t * pstParentOffsets = &m_rgfv.RgstParentOffsets()[ 0 ];
+    const size_t * pstParents = m_rgfv.RgstParents().empty() ? 0 : &m_rgfv.RgstParents()[ 0 ];
+    const double * pdblTeleport = &_rrs.m_rrgdblTeleport[ 0 ];
+    double * pdblContrib = &_rrs.m_rgdblContrib[ 0 ];
+    double dblDamping = m_dblDamping;
+
+    size_t stIteration = 0;
+    for ( ; stIteration < m_stMaxIterations; ++stIteration )
+    {
+      const double * pdblRank = &_rrs.m_rgdblRank[ stIteration & 1 ][ 0 ];
+      double * pdblNext = &_rrs.m_rgdblRank[ ( stIteration + 1 ) & 1 ][ 0 ];
+
+      // 1) Contributions and the mass of the nodes without children:
+      double dblDangling = 0.0;
+      for ( size_t st = stBegin; st < stEnd; ++st )
+      {
+        size_t stChildren = pstChildOffsets[ st + 1 ] - pstChildOffsets[ st ];
+        pdblContrib[ st ] = stChildren ? pdblRank[ st ] / double( stChildren ) : 0.0;
+        dblDangling += stChildren ? 0.0 : pdblRank[ st ];
+      }
+      _rrs.m_rgdblDangling[ _stWorker ] = dblDangling;
+      _rrs.m_barrier.wait( _stWorkers );
+
+      // 2) Pull from the parents:
+      dblDangling = 0.0;
+      for ( size_t st = 0; st < _stWorkers; ++st )
+      {
+        dblDangling += _rrs.m_rgdblDangling[ st ];
+      }
+      double dblDelta = 0.0;
+      for ( size_t st = stBegin; st < stEnd; ++st )
+      {
+        double dblSum = 0.0;
+        for ( size_t stEdge = pstParentOffsets[ st ]; stEdge < pstParentOffsets[ st + 1 ]; ++stEdge )
+        {
+          dblSum += pdblContrib[ pstParents[ stEdge ] ];
+        }
+        double dblNext = ( 1.0 - dblDamping + dblDamping * dblDangling ) * pdblTeleport[ st ] + dblDamping * dblSum;
+        dblDelta += fabs( dblNext - pdblRank[ st ] );
+        pdblNext[ st ] = dblNext;
+      }
+      _rrs.m_rgdblDelta[ _stWorker ] = dblDelta;
+      _rrs.m_barrier.wait( _stWorkers );
+
+      dblDelta = 0.0;
+      for ( size_t st = 0; st < _stWorkers; ++st )
+      {
+        dblDelta += _rrs.m_rgdblDelta[ st ];
+      }
+      if ( dblDelta < m_dblTolerance )
+      {
+        ++stIteration;
+        break;
+      }
+    }
+    if ( !_stWorker )
+    {
+      _rrs.m_stIterations = stIteration;
+    }
+  }
+};
+
+__DGRAPH_END_NAMESPACE
+
+#endif //__GR_RANK_H
@@ -0,0 +1,356 @@
+#ifndef __GR_RECH_H
+#define __GR_RECH_H
+
+//          Copyright David Lawrence Bien 1997 - 2021.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt).
+
+// _gr_rech.h
+
+// Reachability index - answers "is B a descendant of A" without iterating the graph.
+// The strongly connected components are found ( _graph_scc, _gr_scc.h ) and the index is built on
+//  the DAG of components - Tarjan numbers the components in reverse topological order so a
+//  component can only reach components with smaller ids. A depth-first spanning forest of the DAG
+//  gives each component:
+//  - a tree interval [ pre, post ] - a component within the interval of another is reachable from it,
+//  - a descendant range [ low, post ] - low being the least post number of any descendant - a
+//    component whose post number is outside the range is not reachable.
+// Most queries are answered by these labels alone. The rest are answered exactly by a search of the
+//  DAG from A that is pruned by the same labels at every step.
+// The graph has no mutation hooks - the owner informs the index of structural mutations:
+//  link_added() keeps the index valid when the new link adds no reachability ( its parent already
+//  reached its child ), any other mutation makes it stale. A stale index is rebuilt by the next
+//  query made through the non-const methods - the const methods instead search the graph itself
+//  until rebuild() is called. Element changes need not be reported.
+// The non-const query methods use scratch space within the index - concurrent readers use the
+//  const methods each with its own _query_scratch.
+
+#include <stddef.h>
+#include <vector>
+#include <deque>
+#include <algorithm>
+#include <unordered_set>
+
+__DGRAPH_BEGIN_NAMESPACE
+
+template < class t_TyGraph >
+class _graph_reachability_index
+{
+  typedef _graph_reachability_index< t_TyGraph > _TyThis;
+public:
+  typedef t_TyGraph                                     _TyGraph;
+  typedef typename t_TyGraph::_TyGraphNode              _TyGraphNode;
+  typedef typename _TyGraphNode::_TyGraphLinkBaseBase   _TyGraphLinkBaseBase;
+  typedef _graph_scc< t_TyGraph >                       _TyScc;
+
+  static const size_t s_kstNull = size_t( -1 );
+
+  // Scratch space for a query - one per concurrent reader:
+  struct _query_scratch
+  {
+    vector< unsigned >  m_rguStamp;
+    unsigned            m_uStamp;
+    vector< size_t >    m_rgstStack;
+
+    _query_scratch()
+      : m_uStamp( 0 )
+    {
+    }
+  };
+
+  explicit _graph_reachability_index( t_TyGraph const & _rg )
+    : m_rg( _rg ),
+      m_fStale( true )
+  {
+    rebuild();
+  }
+  _graph_reachability_index( _TyThis const & ) = delete;
+  _TyThis & operator =( _TyThis const & ) = delete;
+
+  void  rebuild()
+  {
+    // The components are found in a local - only the component of each node is kept:
+    _TyScc scc( m_rg );
+    scc.compute();
+    size_t stNodes = scc.StNodes();
+    size_t stComps = scc.StComponents();
+
+    vector< size_t > rgstOffsets( stNodes + 1 );
+    vector< size_t > rgstChildren( scc.RNumbering().StLinks() );
+    scc.RNumbering().CopyCSR( rgstOffsets.begin(), rgstChildren.begin() );
+    vector< size_t > rgstComp( stNodes );
+    for ( size_t st = 0; st < stNodes; ++st )
+    {
+      rgstComp[ st ] = scc.StComponent( st );
+    }
+
+    // The DAG of components - sorted and unique children:
+    vector< pair< size_t, size_t > > rgprEdges;
+    for ( size_t st = 0; st < stNodes; ++st )
+    {
+      for ( size_t stEdge = rgstOffsets[ st ]; stEdge < rgstOffsets[ st + 1 ]; ++stEdge )
+      {
+        size_t stChildComp = rgstComp[ rgstChildren[ stEdge ] ];
+        if ( stChildComp != rgstComp[ st ] )
+        {
+          rgprEdges.push_back( pair< size_t, size_t >( rgstComp[ st ], stChildComp ) );
+        }
+      }
+    }
+    sort( rgprEdges.begin(), rgprEdges.end() );
+    rgprEdges.erase( unique( rgprEdges.begin(), rgprEdges.end() ), rgprEdges.end() );
+    vector< size_t > rgstCompOffsets( stComps + 1, 0 );
+    vector< size_t > rgstCompChildren( rgprEdges.size() );
+    for ( size_t st = 0; st < rgprEdges.size(); ++st )
+    {
+      ++rgstCompOffsets[ rgprEdges[ st ].first + 1 ];
+      rgstCompChildren[ st ] = rgprEdges[ st ].second;
+    }
+    for ( size_t st = 0; st < stComps; ++st )
+    {
+      rgstCompOffsets[ st + 1 ] += rgstCompOffsets[ st ];
+    }
+
+    vector< size_t > rgstPre, rgstPost, rgstLow;
+    _Label( rgstCompOffsets, rgstCompChildren, rgstPre, rgstPost, rgstLow );
+
+    // Commit - nothing below throws. The numbering of the components is kept for node lookups:
+    scc.swap_numbering( m_gele );
+    m_rgstComp.swap( rgstComp );
+    m_rgstCompOffsets.swap( rgstCompOffsets );
+    m_rgstCompChildren.swap( rgstCompChildren );
+    m_rgstPre.swap( rgstPre );
+    m_rgstPost.swap( rgstPost );
+    m_rgstLow.swap( rgstLow );
+    m_fStale = false;
+  }
+
+  bool  FStale() const _BIEN_NOTHROW
+  {
+    return m_fStale;
+  }
+  size_t  StComponents() const _BIEN_NOTHROW
+  {
+    return m_rgstPre.size();
+  }
+
+// Mutation reports - made after the mutation:
+  void  link_added( const _TyGraphNode * _pgnParent, const _TyGraphNode * _pgnChild )
+  {
+    if ( !m_fStale )
+    {
+      size_t stParent = _StComponent( _pgnParent );
+      size_t stChild = _StComponent( _pgnChild );
+      // The index still describes the graph without the link:
+      m_fStale = ( s_kstNull == stParent ) || ( s_kstNull == stChild ) ||
+                  !_FReachable( stParent, stChild, m_qs );
+    }
+  }
+  void  invalidate() _BIEN_NOTHROW
+  {
+    m_fStale = true;
+  }
+  void  link_removed() _BIEN_NOTHROW
+  {
+    invalidate();
+  }
+  void  node_destroyed() _BIEN_NOTHROW
+  {
+    invalidate();
+  }
+
+// Queries - each node is a descendant of itself:
+  bool  FReachable( const _TyGraphNode * _pgnFrom, const _TyGraphNode * _pgnTo )
+  {
+    if ( m_fStale )
+    {
+      rebuild();
+    }
+    return FReachable( _pgnFrom, _pgnTo, m_qs );
+  }
+  bool  FReachable( const _TyGraphNode * _pgnFrom, const _TyGraphNode * _pgnTo, _query_scratch & _rqs ) const
+  {
+    if ( _pgnFrom == _pgnTo )
+    {
+      return true;
+    }
+    if ( m_fStale )
+    {
+      return _FSearchGraph( _pgnFrom, _pgnTo );
+    }
+    size_t stFrom = _StComponent( _pgnFrom );
+    size_t stTo = _StComponent( _pgnTo );
+    if ( ( s_kstNull == stFrom ) || ( s_kstNull == stTo ) )
+    {
+      // A node created since the index was built - and not since linked:
+      return false;
+    }
+    return _FReachable( stFrom, stTo, _rqs );
+  }
+
+protected:
+
+  typedef typename _TyScc::_TyNumbering _TyNumbering;
+
+  t_TyGraph const &       m_rg;
+  _TyNumbering            m_gele;             // Node ids.
+  vector< size_t >        m_rgstComp;         // Component by node id.
+  vector< size_t >        m_rgstCompOffsets;  // CSR of the DAG of components.
+  vector< size_t >        m_rgstCompChildren;
+  vector< size_t >        m_rgstPre;          // Labels by component.
+  vector< size_t >        m_rgstPost;
+  vector< size_t >        m_rgstLow;
+  bool                    m_fStale;
+  _query_scratch          m_qs;
+
+  // s_kstNull if the node was not in the graph when the index was built:
+  size_t  _StComponent( const _TyGraphNode * _pgn ) const
+  {
+    size_t stNode = m_gele.StNodeId( _pgn );
+    return ( s_kstNull == stNode ) ? s_kstNull : m_rgstComp[ stNode ];
+  }
+
+  // Depth-first from each component with no parent ( in decreasing id - i.e. topological - order ):
+  static void _Label( vector< size_t > const & _rrgstOffsets, vector< size_t > const & _rrgstChildren,
+                      vector< size_t > & _rrgstPre, vector< size_t > & _rrgstPost, vector< size_t > & _rrgstLow )
+  {
+    size_t stComps = _rrgstOffsets.size() - 1;
+    _rrgstPre.assign( stComps, s_kstNull );
+    _rrgstPost.resize( stComps );
+    _rrgstLow.resize( stComps );
+    vector< pair< size_t, size_t > > rgprStack; // ( component, next edge ).
+    size_t stPre = 0, stPost = 0;
+    for ( size_t stRoot = stComps; stRoot--; )
+    {
+      if ( s_kstNull != _rrgstPre[ stRoot ] )
+      {
+        continue;
+      }
+      _rrgstPre[ stRoot ] = stPre++;
+      rgprStack.push_back( pair< size_t, size_t >( stRoot, _rrgstOffsets[ stRoot ] ) );
+      while ( !rgprStack.empty() )
+      {
+        size_t stV = rgprStack.back().first;
+        size_t & rstEdge = rgprStack.back().second;
+        if ( rstEdge < _rrgstOffsets[ stV + 1 ] )
+        {
+          size_t stW = _rrgstChildren[ rstEdge++ ];
+          if ( s_kstNull == _rrgstPre[ stW ] )
+          {
+            _rrgstPre[ stW ] = stPre++;
+            rgprStack.push_back( pair< size_t, size_t >( stW, _rrgstOffsets[ stW ] ) );
+          }
+        }
+        else
+        {
+          _rrgstPost[ stV ] = stPost++;
+          rgprStack.pop_back();
+        }
+      }
+    }
+    // Children have smaller ids - compute low in increasing id order:
+    for ( size_t st = 0; st < stComps; ++st )
+    {
+      size_t stLow = _rrgstPost[ st ];
+      for ( size_t stEdge = _rrgstOffsets[ st ]; stEdge < _rrgstOffsets[ st + 1 ]; ++stEdge )
+      {
+        stLow = min( stLow, _rrgstLow[ _rrgstChildren[ stEdge ] ] );
+      }
+      _rrgstLow[ st ] = stLow;
+    }
+  }
+
+  bool  _FTreeDescendant( size_t _stFrom, size_t _stTo ) const _BIEN_NOTHROW
+  {
+    return ( m_rgstPre[ _stFrom ] <= m_rgstPre[ _stTo ] ) && ( m_rgstPost[ _stTo ] <= m_rgstPost[ _stFrom ] );
+  }
+  bool  _FMayReach( size_t _stFrom, size_t _stTo ) const _BIEN_NOTHROW
+  {
+    return ( _stFrom > _stTo ) &&
+            ( m_rgstLow[ _stFrom ] <= m_rgstPost[ _stTo ] ) && ( m_rgstPost[ _stTo ] <= m_rgstPost[ _stFrom ] );
+  }
+
+  bool  _FReachable( size_t _stFrom, size_t _stTo, _query_scratch & _rqs ) const
+  {
+    if ( _stFrom == _stTo )
+    {
+      return true;
+    }
+    if ( !_FMayReach( _stFrom, _stTo ) )
+    {
+      return false;
+    }
+    if ( _FTreeDescendant( _stFrom, _stTo ) )
+    {
+      return true;
+    }
+    // Pruned search:
+    if ( _rqs.m_rguStamp.size() != StComponents() )
+    {
+      _rqs.m_rguStamp.assign( StComponents(), 0 );
+      _rqs.m_uStamp = 0;
+    }
+    if ( !++_rqs.m_uStamp )
+    {
+      fill( _rqs.m_rguStamp.begin(), _rqs.m_rguStamp.end(), 0 );
+      ++_rqs.m_uStamp;
+    }
+    _rqs.m_rgstStack.clear();
+    _rqs.m_rgstStack.push_back( _stFrom );
+    _rqs.m_rguStamp[ _stFrom ] = _rqs.m_uStamp;
+    while ( !_rqs.m_rgstStack.empty() )
+    {
+      size_t stV = _rqs.m_rgstStack.back();
+      _rqs.m_rgstStack.pop_back();
+      for ( size_t stEdge = m_rgstCompOffsets[ stV ]; stEdge < m_rgstCompOffsets[ stV + 1 ]; ++stEdge )
+      {
+        size_t stW = m_rgstCompChildren[ stEdge ];
+        if ( ( stW == _stTo ) || _FTreeDescendant( stW, _stTo ) )
+        {
+          return true;
+        }
+        if ( ( _rqs.m_rguStamp[ stW ] != _rqs.m_uStamp ) && _FMayReach( stW, _stTo ) )
+        {
+          _rqs.m_rguStamp[ stW ] = _rqs.m_uStamp;
+          _rqs.m_rgstStack.push_back( stW );
+        }
+      }
+    }
+    return false;
+  }
+
+  // Breadth-first through the child lists of the graph itself:
+  static bool _FSearchGraph( const _TyGraphNode * _pgnFrom, const _TyGraphNode * _pgnTo )
+  {
+    unordered_set< const void * > setSeen;
+    deque< const _TyGraphNode * > dqpgn;
+    setSeen.insert( _pgnFrom );
+    dqpgn.push_back( _pgnFrom );
+    while ( !dqpgn.empty() )
+    {
+      const _TyGraphNode * pgn = dqpgn.front();
+      dqpgn.pop_front();
+      for ( const _TyGraphLinkBaseBase * pglb = *pgn->PPGLBChildHead(); pglb; pglb = pglb->PGLBGetNextChild() )
+      {
+        const _TyGraphNode * pgnChild = static_cast< const _TyGraphNode * >( pglb->PGNBChild() );
+        if ( pgnChild == _pgnTo )
+        {
+          return true;
+        }
+        if ( setSeen.insert( pgnChild ).second )
+        {
+          dqpgn.push_back( pgnChild );
+        }
+      }
+    }
+    return false;
+  }
+};
+
+template < class t_TyGraph >
+const size_t _graph_reachability_index< t_TyGraph >::s_kstNull;
+
+__DGRAPH_END_NAMESPACE
+
+#endif //__GR_RECH_H
@@ -15,13 +15,18 @@
 //  enables constant time path augmentation. Node and link removal will be proportional to
 //  the number of viewers on the link/node.
 
+// The safe graph objects are templatized by the type of the connection link to their viewers -
+//  _graph_connection_link or the thread-safe _graph_connection_link_ts ( see _graph_traits_safe ).
+
+#include <vector>
+#include <unordered_set>
+#include <atomic>
+#include <thread>
+
 __DGRAPH_BEGIN_NAMESPACE
 
 typedef signed char             _TyPositionType;
 
-struct _graph_connection_link;
-typedef _graph_connection_link  _TyGraphConnectionLink;
-
 enum EGraphPositionTypes
 {
   s_egptHeadPosition = 1,
@@ -47,8 +52,7 @@ inline bool PT_FIsParentPosition( _TyPositionType const & _pt )
 // Connection link - this implements referenced viewers of various objects:
 // We need this to be a doubly linked list as clients ( GraphPathNode, graph_point_iterator_base, etc. )
 //  need to be able to remove the link by merely having a pointer to it.
-// TODO: Issue: thread-safe access to this data structure? _graph_connection_link_ts and 
-//                then need to templatize everything by t_TyConnectionLink.
+// _graph_connection_link_ts ( below ) is the thread-safe variant.
 
 // Type of graph connection link.
 enum EGraphConnectionLink
@@ -81,6 +85,8 @@ struct _graph_connection_link
   _graph_connection_link ** m_ppgclPrevNext;// Pointer to address of previous's next pointer ( allows removal with a single pointer ).
   _graph_connection_link *  m_pgclNext;     // Next.
 
+  static const bool s_kfThreadSafe = false;
+
   void  insert_link( _graph_connection_link *& _pgclAfter )
   {
     m_ppgclPrevNext = &_pgclAfter;
@@ -100,6 +106,131 @@ struct _graph_connection_link
     }
     *m_ppgclPrevNext = m_pgclNext;
   }
+
+  // Single threaded - the owner's list needs no lock:
+  struct _list_lock
+  {
+    explicit _list_lock( _graph_connection_link * const & ) _BIEN_NOTHROW
+    {
+    }
+  };
+  // The owner is being deinitialized - nothing to do since the viewer won't call remove_link().
+  void  _owner_deinit() _BIEN_NOTHROW
+  {
+  }
+};
+
+// Thread-safe connection link - allows viewers ( safe iterators, etc. ) to connect and disconnect
+//  on one thread while the viewed node or link is destroyed on another.
+// Each owner's list is protected by a spin lock from a fixed set of stripes chosen by the address
+//  of the owner's list head - the owner needs no extra space and the lock never needs to be
+//  dereferenced through the ( possibly destroyed ) owner. Each link records the list head to
+//  which it is connected. When the owner is deinitialized each link is marked disconnected
+//  under the lock - so a viewer racing to disconnect finds that there is nothing to do.
+// Note: This protects the connection lists only - navigation of the graph itself still requires
+//  that readers not be positioned on an object the writer is destroying at the same time.
+struct _graph_connection_link_ts
+{
+  EGraphConnectionLink          m_egclType;
+  void *                        m_pvConnection; // Connection.
+  _graph_connection_link_ts **  m_ppgclPrevNext;// Pointer to address of previous's next pointer - 0 when disconnected by the owner.
+  _graph_connection_link_ts *   m_pgclNext;     // Next.
+  _graph_connection_link_ts **  m_ppgclHead;    // The owner's list head - selects the lock stripe.
+
+  static const bool s_kfThreadSafe = true;
+  static const size_t s_kstLockStripes = 64; // Power of two.
+
+  // A link that has never been connected may be removed - so a viewer need not consult its own
+  //  ( possibly concurrently cleared ) position to decide whether it is connected:
+  _graph_connection_link_ts() _BIEN_NOTHROW
+    : m_ppgclPrevNext( 0 ),
+      m_ppgclHead( 0 )
+  {
+  }
+
+  // Lock for the list with head _rpgclHead:
+  class _list_lock
+  {
+    std::atomic< bool > & m_rf;
+  public:
+    explicit _list_lock( _graph_connection_link_ts * const & _rpgclHead ) _BIEN_NOTHROW
+      : m_rf( _RFStripe( &_rpgclHead ) )
+    {
+      _Lock();
+    }
+    // Lock by the address of the head only - the owner may already be gone:
+    explicit _list_lock( _graph_connection_link_ts * const * _ppgclHead ) _BIEN_NOTHROW
+      : m_rf( _RFStripe( _ppgclHead ) )
+    {
+      _Lock();
+    }
+    ~_list_lock() _BIEN_NOTHROW
+    {
+      m_rf.store( false, std::memory_order_release );
+    }
+  private:
+    _list_lock( _list_lock const & ) = delete;
+    _list_lock & operator =( _list_lock const & ) = delete;
+    void  _Lock() _BIEN_NOTHROW
+    {
+      for ( unsigned uSpin = 0; m_rf.exchange( true, std::memory_order_acquire ); )
+      {
+        while ( m_rf.load( std::memory_order_relaxed ) )
+        {
+          if ( !( ++uSpin % 1024 ) )
+          {
+            std::this_thread::yield();
+          }
+        }
+      }
+    }
+  };
+
+  void  insert_link( _graph_connection_link_ts *& _pgclAfter ) _BIEN_NOTHROW
+  {
+    _list_lock ll( _pgclAfter );
+    m_ppgclHead = &_pgclAfter;
+    m_ppgclPrevNext = &_pgclAfter;
+    m_pgclNext = _pgclAfter;
+    if ( _pgclAfter )
+    {
+      _pgclAfter->m_ppgclPrevNext = &m_pgclNext;
+    }
+    _pgclAfter = this;
+  }
+
+  void  remove_link() _BIEN_NOTHROW
+  {
+    _list_lock ll( m_ppgclHead );
+    if ( m_ppgclPrevNext )
+    {
+      if ( m_pgclNext )
+      {
+        m_pgclNext->m_ppgclPrevNext = m_ppgclPrevNext;
+      }
+      *m_ppgclPrevNext = m_pgclNext;
+      m_ppgclPrevNext = 0;
+    }
+  }
+
+  // The owner is being deinitialized - called under the owner's _list_lock:
+  void  _owner_deinit() _BIEN_NOTHROW
+  {
+    m_ppgclPrevNext = 0;
+  }
+
+protected:
+  struct _stripe
+  {
+    alignas( 64 ) std::atomic< bool > m_f;
+  };
+  static std::atomic< bool > & _RFStripe( const void * _pvHead ) _BIEN_NOTHROW
+  {
+    static _stripe s_rgstripe[ s_kstLockStripes ]; // zero initialized - all unlocked.
+    size_t st = (size_t)_pvHead;
+    st ^= st >> 12;
+    return s_rgstripe[ ( st >> 4 ) & ( s_kstLockStripes - 1 ) ].m_f;
+  }
 };
 
 // Safe graph link:
@@ -119,6 +250,7 @@ public:
   typedef typename _TyGraphNodeBase::_TyGraphNodeBase _TyGraphNodeBaseBase;
   typedef _TyThis                                     _TyGraphLinkSafe;
   typedef _TyBase                                     _TyGraphLinkBase;
+  typedef typename t_TyGraphNodeSafe::_TyGraphConnectionLink  _TyGraphConnectionLink;
   
   _TyPositionType             m_ptNextParentType; // The type information for the next parent pointer.
   unsigned char               m_rgucDummy[sizeof(void*)-sizeof(_TyPositionType)];// Space for placement.
@@ -216,6 +348,7 @@ public:
 
 // Safe graph node base class - maintains references to viewers.
 // POD
+template < class t_TyConnectionLink >
 class _graph_node_safe_base : public _graph_node_base
 {
 #ifndef NDEBUG
@@ -229,8 +362,12 @@ class _graph_node_safe_base : public _graph_node_base
     class t_TyPathNodeSafeAllocator >
     friend class _graph_safe_base;
 
-  typedef _graph_node_base          _TyBase;
-  typedef _graph_node_safe_base     _TyThis;
+  typedef _graph_node_base                              _TyBase;
+  typedef _graph_node_safe_base< t_TyConnectionLink >   _TyThis;
+
+public:
+  typedef t_TyConnectionLink  _TyGraphConnectionLink;
+private:
 
   _TyPositionType             m_ptNextParentType; // The type information for the next parent pointer.
   unsigned char               m_rgucDummy[sizeof(void*)-sizeof(_TyPositionType)];// Space for placement.
@@ -250,7 +387,7 @@ public:
   typedef _graph_link_safe_base< _TyThis >    _TyGraphLinkSafe;
   // REVIEW: <dbien>: should we make the base the graph link base ?
   typedef _TyGraphLinkSafe                    _TyGraphLinkBase;
-  typedef _TyGraphLinkSafe::_TyGraphLinkBase  _TyGraphLinkBaseBase;
+  typedef typename _TyGraphLinkSafe::_TyGraphLinkBase  _TyGraphLinkBaseBase;
 
   __INLINE void Init() _BIEN_NOTHROW
   { 
@@ -299,6 +436,7 @@ public:
   typedef _TyThis             _TyPathNodeSafe;
   typedef t_TyGraphNodeSafe   _TyGraphNodeSafe;
   typedef t_TyGraphLinkSafe   _TyGraphLinkSafe;
+  typedef typename t_TyGraphNodeSafe::_TyGraphConnectionLink  _TyGraphConnectionLink;
 
   _TyGraphConnectionLink m_gclNode;   // link to this graph_path_node from the graph_node.
   _TyGraphConnectionLink m_gclLink;   // link to this graph_path_node from the graph_link for the next node in the path.
@@ -354,6 +492,7 @@ public:
   typedef typename t_TyPathNodeSafe::_TyGraphNodeSafe   _TyGraphNodeSafe;
   typedef typename t_TyPathNodeSafe::_TyGraphLinkSafe   _TyGraphLinkSafe;
   typedef t_TyPathNodeSafe                              _TyPathNodeSafe;
+  typedef typename _TyGraphNodeSafe::_TyGraphConnectionLink _TyGraphConnectionLink;
 
   // These definitions supercede those from the base class (duh): 
   typedef typename _TyGraphNodeSafe::_TyGraphNodeBase   _TyGraphNodeBaseBase;
@@ -455,6 +594,17 @@ public:
   _TyPathNodeSafeAllocator &        get_safe_path_allocator_ref() _BIEN_NOTHROW { return _TyBaseAllocPathNodeSafe::get_allocator_ref(); }
   _TyPathNodeSafeAllocatorAsPassed  get_safe_path_allocator() const _BIEN_NOTHROW { return _TyBaseAllocPathNodeSafe::get_allocator(); }
 
+  // Batch the invalidation of viewers when a subgraph is destroyed ( see _deinit_subgraph() ) -
+  //  worthwhile only when many viewers are connected to the nodes and links being destroyed:
+  void  set_batch_viewer_deinit( bool _fBatch ) _BIEN_NOTHROW
+  {
+    m_fBatchViewerDeinit = _fBatch;
+  }
+  bool  FBatchViewerDeinit() const _BIEN_NOTHROW
+  {
+    return m_fBatchViewerDeinit;
+  }
+
   // iterator access:
   _TyGraphNodeIterSafePassNonConst  get_safe_node_iterator( _TyGraphNodeBase * _pgnb = 0 )
   {
@@ -493,11 +643,13 @@ protected:
   
   // This is the connection link for the root node:
   _TyGraphConnectionLink  m_gclRoot;
+  bool                    m_fBatchViewerDeinit;
 
   void  _init() _BIEN_NOTHROW
   {
     m_gclRoot.m_pvConnection = (void*)this;
     m_gclRoot.m_egclType = s_egclGraph;
+    m_fBatchViewerDeinit = false;
   }
 
   _TyGraphNodeSafe * _GetRootNode() _BIEN_NOTHROW
@@ -535,17 +687,74 @@ protected:
     _TyBaseGraph::_SetRootNode( 0 );
   }
 
+  // Batched invalidation of the viewers of the connected subgraph containing <_pgnbDestroy> -
+  //  called before the subgraph is destroyed. First the doomed set is marked: the nodes and links
+  //  that have viewers are recorded by viewer type. Then each viewer type is swept in turn.
+  // _deinit_node()/_deinit_link() then find nothing to do for the swept objects. If we run out
+  //  of memory while marking, the remainder are handled by those as before.
+  // Marking walks the subgraph with a visited set - so this is only done when enabled by
+  //  set_batch_viewer_deinit(), else the destruction informs the viewers of each object as it goes.
+  void  _deinit_subgraph( _TyGraphNodeBase * _pgnbDestroy ) _BIEN_NOTHROW
+  {
+    if ( !m_fBatchViewerDeinit )
+    {
+      return;
+    }
+    _viewer_chains vc;
+    try
+    {
+      vector< _TyGraphNodeBase * > rgpgnbStack;
+      unordered_set< _TyGraphNodeBase * > setVisited;
+      __THROWPT( e_ttMemory );
+      setVisited.insert( _pgnbDestroy );
+      rgpgnbStack.push_back( _pgnbDestroy );
+      while ( !rgpgnbStack.empty() )
+      {
+        _TyGraphNodeBase * pgnb = rgpgnbStack.back();
+        rgpgnbStack.pop_back();
+        vc._MarkNode( pgnb );
+        // Each link is marked from its parent's child list:
+        for ( _TyGraphLinkBaseBase * pglb = *pgnb->PPGLBChildHead(); pglb; pglb = pglb->PGLBGetNextChild() )
+        {
+          vc._MarkLink( static_cast< _TyGraphLinkBase * >( pglb ) );
+          _TyGraphNodeBase * pgnbRel = static_cast< _TyGraphNodeBase * >( pglb->PGNBChild() );
+          if ( pgnbRel && setVisited.insert( pgnbRel ).second )
+          {
+            __THROWPT( e_ttMemory );
+            rgpgnbStack.push_back( pgnbRel );
+          }
+        }
+        for ( _TyGraphLinkBaseBase * pglb = *pgnb->PPGLBParentHead(); pglb; pglb = pglb->PGLBGetNextParent() )
+        {
+          _TyGraphNodeBase * pgnbRel = static_cast< _TyGraphNodeBase * >( pglb->PGNBParent() );
+          if ( pgnbRel && setVisited.insert( pgnbRel ).second )
+          {
+            __THROWPT( e_ttMemory );
+            rgpgnbStack.push_back( pgnbRel );
+          }
+        }
+      }
+    }
+    catch( ... )
+    {
+    }
+    vc._Sweep();
+  }
+
   // This method called when any safe node is being destroyed:
   static void _deinit_node( _TyGraphNodeBase * _pgnbDeinit ) _BIEN_NOTHROW
   {
     // The node may have objects connected to it - need to inform them of object destruction.
     // Move through all the connection links - no need to waste time unlinking - just
-    //  deallocate on the fly.
+    //  deallocate on the fly. The viewers' deinit methods only clear state - so they may
+    //  be called under the list lock.
+    typename _TyGraphConnectionLink::_list_lock ll( _pgnbDeinit->m_pgclHead );
     for ( _TyGraphConnectionLink * pgcl = _pgnbDeinit->m_pgclHead;
           pgcl; )
     {
       _TyGraphConnectionLink * pgclCur = pgcl;
       pgcl = pgcl->m_pgclNext;  // advance now, allocation is owned by the viewer.
+      pgclCur->_owner_deinit();
 
       switch( pgclCur->m_egclType )
       {
@@ -610,11 +819,13 @@ protected:
     // The link may have objects connected to it - need to inform them of object destruction.
     // Move through all the connection links - no need to waste time unlinking - just
     //  deallocate on the fly.
+    typename _TyGraphConnectionLink::_list_lock ll( _pgnbDeinit->m_pgclHead );
     for ( _TyGraphConnectionLink * pgcl = _pgnbDeinit->m_pgclHead;
           pgcl; )
     {
       _TyGraphConnectionLink * pgclCur = pgcl;
       pgcl = pgcl->m_pgclNext;  // advance now will be deallocated by the viewer.
+      pgclCur->_owner_deinit();
 
       switch( pgclCur->m_egclType )
       {
@@ -661,6 +872,137 @@ protected:
       }
     }
   }
+
+  // The doomed objects that have viewers - by viewer type:
+  // Each viewer is removed and informed under its owner's list lock - as in _deinit_node()/_deinit_link() -
+  //  so that a viewer disconnecting on another thread waits rather than going away while being informed.
+  struct _viewer_chains
+  {
+    static const size_t s_kstTypes = s_egclShadowGraphObject + 1;
+    typedef vector< _TyGraphConnectionLink ** > _TyRgOwners;
+    _TyRgOwners m_rgrgNode[ s_kstTypes ]; // Heads of the viewer lists of nodes.
+    _TyRgOwners m_rgrgLink[ s_kstTypes ]; // Heads of the viewer lists of links.
+
+    static void _Mark( _TyGraphConnectionLink *& _rpgclHead, _TyRgOwners * _rgrgOwners )
+    {
+      unsigned uTypes = 0;
+      {
+        typename _TyGraphConnectionLink::_list_lock ll( _rpgclHead );
+        for ( _TyGraphConnectionLink * pgcl = _rpgclHead; pgcl; pgcl = pgcl->m_pgclNext )
+        {
+          Assert( size_t( pgcl->m_egclType ) < s_kstTypes );
+          uTypes |= 1u << pgcl->m_egclType;
+        }
+      }
+      for ( size_t st = 0; uTypes; ++st, uTypes >>= 1 )
+      {
+        if ( uTypes & 1 )
+        {
+          _rgrgOwners[ st ].push_back( &_rpgclHead );
+        }
+      }
+    }
+    void  _MarkNode( _TyGraphNodeBase * _pgnb )
+    {
+      _Mark( _pgnb->m_pgclHead, m_rgrgNode );
+    }
+    void  _MarkLink( _TyGraphLinkBase * _pglb )
+    {
+      _Mark( _pglb->m_pgclHead, m_rgrgLink );
+    }
+
+    static void _Sweep( _TyRgOwners const & _rrgOwners, EGraphConnectionLink _egcl, bool _fNode ) _BIEN_NOTHROW
+    {
+      for ( typename _TyRgOwners::const_iterator it = _rrgOwners.begin(); it != _rrgOwners.end(); ++it )
+      {
+        typename _TyGraphConnectionLink::_list_lock ll( **it );
+        for ( _TyGraphConnectionLink ** ppgcl = *it; *ppgcl; )
+        {
+          _TyGraphConnectionLink * pgclCur = *ppgcl;
+          if ( pgclCur->m_egclType != _egcl )
+          {
+            ppgcl = &pgclCur->m_pgclNext;
+            continue;
+          }
+          *ppgcl = pgclCur->m_pgclNext;
+          if ( pgclCur->m_pgclNext )
+          {
+            pgclCur->m_pgclNext->m_ppgclPrevNext = ppgcl;
+          }
+          pgclCur->_owner_deinit();
+          if ( _fNode )
+          {
+            _DeinitNodeViewer( pgclCur );
+          }
+          else
+          {
+            _DeinitLinkViewer( pgclCur );
+          }
+        }
+      }
+    }
+    static void _DeinitNodeViewer( _TyGraphConnectionLink * _pgcl ) _BIEN_NOTHROW
+    {
+      switch( _pgcl->m_egclType )
+      {
+        case s_egclGraph:
+          static_cast< _TyThis * >( _pgcl->m_pvConnection )->_node_deinit();
+        break;
+        case s_egclGraphNodeIterator:
+          static_cast< _TyGraphNodeIterBaseSafe * >( _pgcl->m_pvConnection )->_node_deinit();
+        break;
+        case s_egclLinkPositionIterator:
+          static_cast< _TyGraphLinkPosIterBaseSafe * >( _pgcl->m_pvConnection )->_node_deinit();
+        break;
+        case s_egclGraphPathIterator:
+          static_cast< t_TyPathNodeSafe * >( _pgcl->m_pvConnection )->_node_deinit();
+        break;
+#ifdef __GR_USESHADOWSTUFF
+        case s_egclShadowGraphObject:
+          static_cast< _sgraph_element_base< _TyGraphNodeSafe > * >( _pgcl->m_pvConnection )->_element_deinit();
+        break;
+#endif //__GR_USESHADOWSTUFF
+        default:
+          Assert( 0 );
+        break;
+      }
+    }
+    static void _DeinitLinkViewer( _TyGraphConnectionLink * _pgcl ) _BIEN_NOTHROW
+    {
+      switch( _pgcl->m_egclType )
+      {
+        case s_egclLinkPositionIterator:
+          static_cast< _TyGraphLinkPosIterBaseSafe * >( _pgcl->m_pvConnection )->_link_deinit();
+        break;
+        case s_egclGraphLinkIdentIterator:
+          static_cast< _TyGraphLinkIdentIterBaseSafe * >( _pgcl->m_pvConnection )->_link_deinit();
+        break;
+        case s_egclGraphPathIterator:
+          static_cast< t_TyPathNodeSafe * >( _pgcl->m_pvConnection )->_link_deinit();
+        break;
+#ifdef __GR_USESHADOWSTUFF
+        case s_egclShadowGraphObject:
+          static_cast< _sgraph_element_base< _TyGraphLinkSafe > * >( _pgcl->m_pvConnection )->_element_deinit();
+        break;
+#endif //__GR_USESHADOWSTUFF
+        default:
+          Assert( 0 );
+        break;
+      }
+    }
+
+    void  _Sweep() _BIEN_NOTHROW
+    {
+      for ( size_t st = 0; st < s_kstTypes; ++st )
+      {
+        _Sweep( m_rgrgNode[ st ], EGraphConnectionLink( st ), true );
+      }
+      for ( size_t st = 0; st < s_kstTypes; ++st )
+      {
+        _Sweep( m_rgrgLink[ st ], EGraphConnectionLink( st ), false );
+      }
+    }
+  };
 };
 
 __DGRAPH_END_NAMESPACE
@@ -0,0 +1,515 @@
+#ifndef __GR_SCC_H
+#define __GR_SCC_H
+
+//          Copyright David Lawrence Bien 1997 - 2021.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt).
+
+// _gr_scc.h
+
+// Strongly connected components.
+// The graph is numbered and copied to CSR arrays ( _graph_edge_list_exporter, _gr_bulk.h ) and the
+//  components are then found on the arrays - no recursion, all stacks are vectors sized up front:
+//  compute()           - Tarjan. Component ids are in reverse topological order of the condensation
+//                        ( a component's id is less than that of any component with an edge to it ).
+//  compute_parallel()  - Forward-backward: a pivot's forward and backward reachable sets intersect in
+//                        its component, the three remaining sets are independent and processed as
+//                        separate tasks by a pool of threads. Nodes with no parents or no children
+//                        are trimmed first. Component ids are in no particular order.
+// condensation() then builds the DAG of components as a dgraph.
+// The graph must not be modified while the _graph_scc is in use.
+
+#include <stddef.h>
+#include <vector>
+#include <deque>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+
+__DGRAPH_BEGIN_NAMESPACE
+
+template < class t_TyGraph >
+class _graph_scc
+{
+  typedef _graph_scc< t_TyGraph > _TyThis;
+public:
+  typedef t_TyGraph                               _TyGraph;
+  typedef typename t_TyGraph::_TyGraphNode        _TyGraphNode;
+  typedef _graph_edge_list_exporter< t_TyGraph >  _TyNumbering;
+
+  static const size_t s_kstNull = size_t( -1 );
+
+  explicit _graph_scc( t_TyGraph const & _rg )
+    : m_gele( _rg ),
+      m_stComponents( 0 )
+  {
+    size_t stNodes = m_gele.StNodes();
+    m_rgstOffsets.resize( stNodes + 1 );
+    m_rgstChildren.resize( m_gele.StLinks() );
+    m_gele.CopyCSR( m_rgstOffsets.begin(), m_rgstChildren.begin() );
+    m_rgstComp.assign( stNodes, s_kstNull );
+  }
+
+  _TyNumbering const &  RNumbering() const _BIEN_NOTHROW
+  {
+    return m_gele;
+  }
+  // Take the numbering - StComponent( const _TyGraphNode * ) is then unavailable:
+  void  swap_numbering( _TyNumbering & _rgele ) _BIEN_NOTHROW
+  {
+    m_gele.swap( _rgele );
+  }
+  size_t  StNodes() const _BIEN_NOTHROW
+  {
+    return m_rgstComp.size();
+  }
+  size_t  StComponents() const _BIEN_NOTHROW
+  {
+    return m_stComponents;
+  }
+  // By node id ( RNumbering() ) or node:
+  size_t  StComponent( size_t _stNode ) const _BIEN_NOTHROW
+  {
+    return m_rgstComp[ _stNode ];
+  }
+  size_t  StComponent( const _TyGraphNode * _pgn ) const
+  {
+    size_t stNode = m_gele.StNodeId( _pgn );
+    if ( s_kstNull == stNode )
+    {
+      throw _graph_nav_except( "_graph_scc::StComponent(): Node not in graph." );
+    }
+    return m_rgstComp[ stNode ];
+  }
+  // True if there is no cycle - including self relations:
+  bool  FAcyclic() const _BIEN_NOTHROW
+  {
+    if ( m_stComponents != StNodes() )
+    {
+      return false;
+    }
+    for ( size_t st = 0; st < StNodes(); ++st )
+    {
+      for ( size_t stEdge = m_rgstOffsets[ st ]; stEdge < m_rgstOffsets[ st + 1 ]; ++stEdge )
+      {
+        if ( m_rgstChildren[ stEdge ] == st )
+        {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  // Iterative Tarjan:
+  void  compute()
+  {
+    size_t stNodes = StNodes();
+    vector< size_t > rgstIndex( stNodes, s_kstNull );
+    vector< size_t > rgstLow( stNodes );
+    vector< size_t > rgstCursor( stNodes );
+    vector< bool > rgfOnStack( stNodes, false );
+    vector< size_t > rgstStack;
+    vector< size_t > rgstCall;
+    rgstStack.reserve( stNodes );
+    rgstCall.reserve( stNodes );
+
+    size_t stIndex = 0;
+    m_stComponents = 0;
+    for ( size_t stStart = 0; stStart < stNodes; ++stStart )
+    {
+      if ( s_kstNull != rgstIndex[ stStart ] )
+      {
+        continue;
+      }
+      _Visit( stStart, stIndex, rgstIndex, rgstLow, rgstCursor, rgfOnStack, rgstStack, rgstCall );
+      while ( !rgstCall.empty() )
+      {
+        size_t stV = rgstCall.back();
+        if ( rgstCursor[ stV ] < m_rgstOffsets[ stV + 1 ] )
+        {
+          size_t stW = m_rgstChildren[ rgstCursor[ stV ]++ ];
+          if ( s_kstNull == rgstIndex[ stW ] )
+          {
+            _Visit( stW, stIndex, rgstIndex, rgstLow, rgstCursor, rgfOnStack, rgstStack, rgstCall );
+          }
+          else
+          if ( rgfOnStack[ stW ] )
+          {
+            rgstLow[ stV ] = min( rgstLow[ stV ], rgstIndex[ stW ] );
+          }
+        }
+        else
+        {
+          rgstCall.pop_back();
+          if ( rgstLow[ stV ] == rgstIndex[ stV ] )
+          {
+            size_t stW;
+            do
+            {
+              stW = rgstStack.back();
+              rgstStack.pop_back();
+              rgfOnStack[ stW ] = false;
+              m_rgstComp[ stW ] = m_stComponents;
+            }
+            while ( stW != stV );
+            ++m_stComponents;
+          }
+          if ( !rgstCall.empty() )
+          {
+            size_t stU = rgstCall.back();
+            rgstLow[ stU ] = min( rgstLow[ stU ], rgstLow[ stV ] );
+          }
+        }
+      }
+    }
+  }
+
+  // Forward-backward on up to _uThreads threads ( 0 - hardware concurrency ):
+  void  compute_parallel( unsigned _uThreads = 0 )
+  {
+    size_t stNodes = StNodes();
+    m_rgstComp.assign( stNodes, s_kstNull );
+    m_stComponents = 0;
+    _BuildParents();
+
+    _fb_state fbs( stNodes );
+    _Trim( fbs );
+
+    _fb_task task;
+    task.m_stColor = fbs.m_atNextColor++;
+    for ( size_t st = 0; st < stNodes; ++st )
+    {
+      if ( s_kstNull == m_rgstComp[ st ] )
+      {
+        task.m_rgstNodes.push_back( st );
+        fbs.m_rgatColor[ st ].store( task.m_stColor, memory_order_relaxed );
+      }
+    }
+    if ( !task.m_rgstNodes.empty() )
+    {
+      fbs.m_dqTasks.push_back( std::move( task ) );
+      _RunPool( fbs, _uThreads );
+    }
+    m_stComponents = fbs.m_atComponents.load();
+  }
+
+  // Build the condensation in _rgCond - replacing its contents. Node i of the condensation is
+  //  component i - its element is _rf( i ), by default constructed from the component id - and
+  //  there is one link for each pair of components with at least one relation between them. The
+  //  root is the component of the root.
+  template < class t_TyCondGraph >
+  void  condensation( t_TyCondGraph & _rgCond ) const
+  {
+    condensation( _rgCond, _graph_el_from_id< typename t_TyCondGraph::_TyNodeEl >() );
+  }
+  template < class t_TyCondGraph, class t_TyF >
+  void  condensation( t_TyCondGraph & _rgCond, t_TyF _rf ) const
+  {
+    typedef typename t_TyCondGraph::_TyNodeEl _TyCondNodeEl;
+    typedef typename t_TyCondGraph::_TyLinkEl _TyCondLinkEl;
+    if ( !StNodes() )
+    {
+      _rgCond.destroy();
+      return;
+    }
+    vector< _TyCondNodeEl > rgNodeEls;
+    rgNodeEls.reserve( m_stComponents );
+    for ( size_t st = 0; st < m_stComponents; ++st )
+    {
+      rgNodeEls.push_back( _rf( st ) );
+    }
+    vector< pair< size_t, size_t > > rgpr;
+    for ( size_t st = 0; st < StNodes(); ++st )
+    {
+      for ( size_t stEdge = m_rgstOffsets[ st ]; stEdge < m_rgstOffsets[ st + 1 ]; ++stEdge )
+      {
+        size_t stCompChild = m_rgstComp[ m_rgstChildren[ stEdge ] ];
+        if ( stCompChild != m_rgstComp[ st ] )
+        {
+          rgpr.push_back( make_pair( m_rgstComp[ st ], stCompChild ) );
+        }
+      }
+    }
+    std::sort( rgpr.begin(), rgpr.end() );
+    rgpr.erase( std::unique( rgpr.begin(), rgpr.end() ), rgpr.end() );
+    vector< _graph_edge< _TyCondLinkEl > > rgEdges( rgpr.size() );
+    for ( size_t st = 0; st < rgpr.size(); ++st )
+    {
+      rgEdges[ st ].m_stParent = rgpr[ st ].first;
+      rgEdges[ st ].m_stChild = rgpr[ st ].second;
+    }
+    _rgCond.replace_edge_list( &rgNodeEls[ 0 ], rgNodeEls.size(),
+                               rgEdges.empty() ? 0 : &rgEdges[ 0 ], rgEdges.size(),
+                               m_rgstComp[ 0 ] );
+  }
+
+protected:
+
+  _TyNumbering      m_gele;
+  vector< size_t >  m_rgstOffsets;    // CSR children.
+  vector< size_t >  m_rgstChildren;
+  vector< size_t >  m_rgstParentOffsets;  // CSR parents - built by compute_parallel().
+  vector< size_t >  m_rgstParents;
+  vector< size_t >  m_rgstComp;
+  size_t            m_stComponents;
+
+  void  _Visit( size_t _stV, size_t & _rstIndex,
+                vector< size_t > & _rrgstIndex, vector< size_t > & _rrgstLow,
+                vector< size_t > & _rrgstCursor, vector< bool > & _rrgfOnStack,
+                vector< size_t > & _rrgstStack, vector< size_t > & _rrgstCall ) const _BIEN_NOTHROW
+  {
+    // The stacks are reserved to hold every node - these cannot reallocate:
+    _rrgstIndex[ _stV ] = _rrgstLow[ _stV ] = _rstIndex++;
+    _rrgstCursor[ _stV ] = m_rgstOffsets[ _stV ];
+    _rrgstStack.push_back( _stV );
+    _rrgfOnStack[ _stV ] = true;
+    _rrgstCall.push_back( _stV );
+  }
+
+  void  _BuildParents()
+  {
+    size_t stNodes = StNodes();
+    m_rgstParentOffsets.assign( stNodes + 1, 0 );
+    m_rgstParents.resize( m_rgstChildren.size() );
+    for ( size_t st = 0; st < m_rgstChildren.size(); ++st )
+    {
+      ++m_rgstParentOffsets[ m_rgstChildren[ st ] + 1 ];
+    }
+    for ( size_t st = 1; st <= stNodes; ++st )
+    {
+      m_rgstParentOffsets[ st ] += m_rgstParentOffsets[ st - 1 ];
+    }
+    vector< size_t > rgstFill( m_rgstParentOffsets.begin(), m_rgstParentOffsets.end() - 1 );
+    for ( size_t st = 0; st < stNodes; ++st )
+    {
+      for ( size_t stEdge = m_rgstOffsets[ st ]; stEdge < m_rgstOffsets[ st + 1 ]; ++stEdge )
+      {
+        m_rgstParents[ rgstFill[ m_rgstChildren[ stEdge ] ]++ ] = st;
+      }
+    }
+  }
+
+  struct _fb_task
+  {
+    size_t            m_stColor;
+    vector< size_t >  m_rgstNodes;
+  };
+  // Each task owns the nodes of its color - the colors of other nodes may be changing as they are
+  //  read so they are atomic:
+  struct _fb_state
+  {
+    vector< atomic< size_t > >  m_rgatColor;
+    atomic< size_t >            m_atComponents;
+    atomic< size_t >            m_atNextColor;
+    mutex                       m_mtx;
+    condition_variable          m_cv;
+    deque< _fb_task >           m_dqTasks;
+    size_t                      m_stActive;
+    exception_ptr               m_ep;
+
+    explicit _fb_state( size_t _stNodes )
+      : m_rgatColor( _stNodes ),
+        m_atComponents( 0 ),
+        m_atNextColor( 1 ),
+        m_stActive( 0 )
+    {
+      for ( size_t st = 0; st < _stNodes; ++st )
+      {
+        m_rgatColor[ st ].store( 0, memory_order_relaxed );
+      }
+    }
+  };
+
+  // Remove ( as singleton components ) nodes with no remaining parents or children - repeatedly:
+  void  _Trim( _fb_state & _rfbs )
+  {
+    size_t stNodes = StNodes();
+    vector< size_t > rgstIn( stNodes ), rgstOut( stNodes ), rgstQueue;
+    rgstQueue.reserve( stNodes );
+    for ( size_t st = 0; st < stNodes; ++st )
+    {
+      rgstOut[ st ] = m_rgstOffsets[ st + 1 ] - m_rgstOffsets[ st ];
+      rgstIn[ st ] = m_rgstParentOffsets[ st + 1 ] - m_rgstParentOffsets[ st ];
+      if ( !rgstOut[ st ] || !rgstIn[ st ] )
+      {
+        rgstQueue.push_back( st );
+        m_rgstComp[ st ] = _rfbs.m_atComponents++;
+      }
+    }
+    for ( size_t stQ = 0; stQ < rgstQueue.size(); ++stQ )
+    {
+      size_t stV = rgstQueue[ stQ ];
+      for ( size_t stEdge = m_rgstOffsets[ stV ]; stEdge < m_rgstOffsets[ stV + 1 ]; ++stEdge )
+      {
+        size_t stW = m_rgstChildren[ stEdge ];
+        if ( ( s_kstNull == m_rgstComp[ stW ] ) && !--rgstIn[ stW ] )
+        {
+          rgstQueue.push_back( stW );
+          m_rgstComp[ stW ] = _rfbs.m_atComponents++;
+        }
+      }
+      for ( size_t stEdge = m_rgstParentOffsets[ stV ]; stEdge < m_rgstParentOffsets[ stV + 1 ]; ++stEdge )
+      {
+        size_t stW = m_rgstParents[ stEdge ];
+        if ( ( s_kstNull == m_rgstComp[ stW ] ) && !--rgstOut[ stW ] )
+        {
+          rgstQueue.push_back( stW );
+          m_rgstComp[ stW ] = _rfbs.m_atComponents++;
+        }
+      }
+    }
+  }
+
+  void  _RunPool( _fb_state & _rfbs, unsigned _uThreads )
+  {
+    _graph_workers::run( _uThreads, [this,&_rfbs]( unsigned, unsigned ) { _Worker( _rfbs ); } );
+    if ( _rfbs.m_ep )
+    {
+      rethrow_exception( _rfbs.m_ep );
+    }
+  }
+
+  void  _Worker( _fb_state & _rfbs ) _BIEN_NOTHROW
+  {
+    unique_lock< mutex > lock( _rfbs.m_mtx );
+    for ( ; ; )
+    {
+      while ( _rfbs.m_dqTasks.empty() && _rfbs.m_stActive && !_rfbs.m_ep )
+      {
+        _rfbs.m_cv.wait( lock );
+      }
+      if ( _rfbs.m_dqTasks.empty() || _rfbs.m_ep )
+      {
+        _rfbs.m_cv.notify_all();
+        return;
+      }
+      _fb_task task( std::move( _rfbs.m_dqTasks.front() ) );
+      _rfbs.m_dqTasks.pop_front();
+      ++_rfbs.m_stActive;
+      lock.unlock();
+      try
+      {
+        _fb_task rgtask[ 3 ];
+        size_t stNew = _Split( _rfbs, task, rgtask );
+        lock.lock();
+        for ( size_t st = 0; st < stNew; ++st )
+        {
+          _rfbs.m_dqTasks.push_back( std::move( rgtask[ st ] ) );
+        }
+      }
+      catch( ... )
+      {
+        if ( !lock.owns_lock() )
+        {
+          lock.lock();
+        }
+        if ( !_rfbs.m_ep )
+        {
+          _rfbs.m_ep = current_exception();
+        }
+      }
+      --_rfbs.m_stActive;
+      _rfbs.m_cv.notify_all();
+    }
+  }
+
+  // Find the component of the first node of the task - returns the non-empty remaining sets:
+  size_t  _Split( _fb_state & _rfbs, _fb_task const & _rtask, _fb_task (&_rgtask)[ 3 ] )
+  {
+    vector< atomic< size_t > > & rgatColor = _rfbs.m_rgatColor;
+    size_t stColor = _rtask.m_stColor;
+    size_t stColorFwd = _rfbs.m_atNextColor++;
+    size_t stColorBwd = _rfbs.m_atNextColor++;
+    size_t stPivot = _rtask.m_rgstNodes[ 0 ];
+    vector< size_t > rgstQueue;
+    rgstQueue.reserve( _rtask.m_rgstNodes.size() );
+
+    // Forward:
+    rgatColor[ stPivot ].store( stColorFwd, memory_order_relaxed );
+    rgstQueue.push_back( stPivot );
+    for ( size_t stQ = 0; stQ < rgstQueue.size(); ++stQ )
+    {
+      size_t stV = rgstQueue[ stQ ];
+      for ( size_t stEdge = m_rgstOffsets[ stV ]; stEdge < m_rgstOffsets[ stV + 1 ]; ++stEdge )
+      {
+        size_t stW = m_rgstChildren[ stEdge ];
+        if ( rgatColor[ stW ].load( memory_order_relaxed ) == stColor )
+        {
+          rgatColor[ stW ].store( stColorFwd, memory_order_relaxed );
+          rgstQueue.push_back( stW );
+        }
+      }
+    }
+
+    // Backward - forward nodes reached are the component:
+    size_t stComp = _rfbs.m_atComponents++;
+    size_t stColorDone = 0; // No task has color 0 - so component nodes are never revisited.
+    rgstQueue.clear();
+    rgatColor[ stPivot ].store( stColorDone, memory_order_relaxed );
+    m_rgstComp[ stPivot ] = stComp;
+    rgstQueue.push_back( stPivot );
+    for ( size_t stQ = 0; stQ < rgstQueue.size(); ++stQ )
+    {
+      size_t stV = rgstQueue[ stQ ];
+      for ( size_t stEdge = m_rgstParentOffsets[ stV ]; stEdge < m_rgstParentOffsets[ stV + 1 ]; ++stEdge )
+      {
+        size_t stW = m_rgstParents[ stEdge ];
+        size_t stColorW = rgatColor[ stW ].load( memory_order_relaxed );
+        if ( stColorW == stColorFwd )
+        {
+          rgatColor[ stW ].store( stColorDone, memory_order_relaxed );
+          m_rgstComp[ stW ] = stComp;
+          rgstQueue.push_back( stW );
+        }
+        else
+        if ( stColorW == stColor )
+        {
+          rgatColor[ stW ].store( stColorBwd, memory_order_relaxed );
+          rgstQueue.push_back( stW );
+        }
+      }
+    }
+
+    // Partition the rest:
+    _rgtask[ 0 ].m_stColor = stColorFwd;
+    _rgtask[ 1 ].m_stColor = stColorBwd;
+    _rgtask[ 2 ].m_stColor = stColor;
+    for ( size_t st = 0; st < _rtask.m_rgstNodes.size(); ++st )
+    {
+      size_t stV = _rtask.m_rgstNodes[ st ];
+      size_t stColorV = rgatColor[ stV ].load( memory_order_relaxed );
+      for ( size_t stTask = 0; stTask < 3; ++stTask )
+      {
+        if ( stColorV == _rgtask[ stTask ].m_stColor )
+        {
+          _rgtask[ stTask ].m_rgstNodes.push_back( stV );
+          break;
+        }
+      }
+    }
+    size_t stNew = 0;
+    for ( size_t stTask = 0; stTask < 3; ++stTask )
+    {
+      if ( !_rgtask[ stTask ].m_rgstNodes.empty() )
+      {
+        if ( stNew != stTask )
+        {
+          _rgtask[ stNew ] = std::move( _rgtask[ stTask ] );
+        }
+        ++stNew;
+      }
+    }
+    return stNew;
+  }
+};
+
+template < class t_TyGraph >
+const size_t _graph_scc< t_TyGraph >::s_kstNull;
+
+__DGRAPH_END_NAMESPACE
+
+#endif //__GR_SCC_H
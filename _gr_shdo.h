@@ -25,8 +25,10 @@ struct _sgraph_element_base
 private:
   typedef _sgraph_element_base< t_TyShadowObjectSafe >  _TyThis;
 public:
+  typedef typename t_TyShadowObjectSafe::_TyGraphConnectionLink  _TyGraphConnectionLink;
+
   t_TyShadowObjectSafe *  m_psos;
-  _TyConnectionLink       m_gcl;
+  _TyGraphConnectionLink  m_gcl;
 
   explicit _sgraph_element_base( t_TyShadowObjectSafe * _psos )
     : m_psos( _psos )
@@ -0,0 +1,542 @@
+#ifndef __GR_SHMT_H
+#define __GR_SHMT_H
+
+//          Copyright David Lawrence Bien 1997 - 2021.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt).
+
+// _gr_shmt.h
+
+// Lazy shadow graph maintainer.
+// A shadow graph mirrors the structure of a main graph but carries its own ( typically derived )
+//  elements. The writer of the main graph posts each change it makes to the maintainer, which
+//  queues it and returns at once. A worker thread applies the queued changes to the shadow in
+//  batches - after each batch the hook is called once for every shadow node whose element or
+//  relations changed - this is where derived data ( aggregates, etc. ) are recomputed.
+// sync() waits until every change posted so far has been applied. The shadow may only be accessed
+//  between a sync() and the next post.
+// If applying a change throws, the shadow no longer mirrors the main graph: the rest of that batch and
+//  everything posted later is discarded, and every later sync() and post throws that exception until
+//  reset(). reset() empties the shadow - the writer then posts the main graph's current contents again.
+// Main graph nodes and links are used only as keys - the worker never dereferences them - so the
+//  main graph may continue to be modified ( or destroyed ) while changes are applied.
+// The worker runs at normal priority - lower its priority with the platform's thread API if desired.
+// This does not use the shadow elements of _gr_shdo.h ( _sgraph_element<>, s_egclShadowGraphObject ).
+//  Those have the main graph's element types and read through to the main graph's elements, and they
+//  connect to the main graph's ( safe ) objects to be told synchronously, on the writer's thread, when
+//  those are destroyed. Here the shadow has its own derived elements and is updated on the worker
+//  thread - so it must never touch the main graph, which may be of any type.
+
+#include <deque>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+
+__DGRAPH_BEGIN_NAMESPACE
+
+// Default hook - no derived data:
+struct _shadow_graph_null_hook
+{
+  template < class t_TyShadowGraph >
+  void operator()( t_TyShadowGraph &, typename t_TyShadowGraph::_TyGraphNode * ) const _BIEN_NOTHROW
+  {
+  }
+};
+
+template <  class t_TyGraph, class t_TyShadowGraph,
+            class t_TyHook = _shadow_graph_null_hook >
+class _shadow_graph_maintainer
+{
+  typedef _shadow_graph_maintainer< t_TyGraph, t_TyShadowGraph, t_TyHook > _TyThis;
+public:
+
+  typedef t_TyGraph                                           _TyGraph;
+  typedef typename t_TyGraph::_TyGraphNode                    _TyGraphNode;
+  typedef typename t_TyGraph::_TyGraphLink                    _TyGraphLink;
+  typedef t_TyShadowGraph                                     _TyShadowGraph;
+  typedef typename t_TyShadowGraph::_TyGraphNode              _TyShadowNode;
+  typedef typename t_TyShadowGraph::_TyGraphLink              _TyShadowLink;
+  typedef typename t_TyShadowGraph::_TyNodeEl                 _TyShadowNodeEl;
+  typedef typename t_TyShadowGraph::_TyLinkEl                 _TyShadowLinkEl;
+  typedef typename _TyShadowNode::_TyGraphLinkBaseBase        _TyGraphLinkBaseBase;
+  typedef t_TyHook                                            _TyHook;
+
+  // The shadow graph should be empty - it is populated only through posted changes:
+  _shadow_graph_maintainer( _TyShadowGraph & _rgShadow, _TyHook const & _rhook = _TyHook() )
+    : m_rgShadow( _rgShadow ),
+      m_hook( _rhook ),
+      m_fStop( false ),
+      m_fBusy( false )
+  {
+    if ( !m_workers.start( 1, [this]( unsigned, unsigned ) { _Worker(); } ) )
+    {
+      throw bad_graph( "_shadow_graph_maintainer: Couldn't start the worker thread." );
+    }
+  }
+  ~_shadow_graph_maintainer()
+  {
+    {
+      std::lock_guard< std::mutex > lock( m_mtx );
+      m_fStop = true;
+    }
+    m_cvWork.notify_one();
+    m_workers.join();
+  }
+
+// Posting - called by the writer of the main graph after making the corresponding change:
+  void node_created( const _TyGraphNode * _pgn, _TyShadowNodeEl const & _rel )
+  {
+    _PostEl( m_pending.m_dqNodeEls, _rel, _change( e_scNodeCreate, _pgn ) );
+  }
+  void link_created( const _TyGraphLink * _pgl, _TyShadowLinkEl const & _rel )
+  {
+    _PostEl( m_pending.m_dqLinkEls, _rel, _change( e_scLinkCreate, _pgl ) );
+  }
+  void node_updated( const _TyGraphNode * _pgn, _TyShadowNodeEl const & _rel )
+  {
+    _PostEl( m_pending.m_dqNodeEls, _rel, _change( e_scNodeUpdate, _pgn ) );
+  }
+  void link_updated( const _TyGraphLink * _pgl, _TyShadowLinkEl const & _rel )
+  {
+    _PostEl( m_pending.m_dqLinkEls, _rel, _change( e_scLinkUpdate, _pgl ) );
+  }
+  // <_pgl> was inserted at index <_uChild> of <_pgnParent>'s children and <_uParent> of <_pgnChild>'s parents:
+  void relation_added(  const _TyGraphNode * _pgnParent, const _TyGraphNode * _pgnChild,
+                        const _TyGraphLink * _pgl, _TyGNIndex _uChild, _TyGNIndex _uParent )
+  {
+    _Post( _change( e_scRelationAdd, _pgl, _pgnParent, _pgnChild, _uChild, _uParent ) );
+  }
+  void relation_removed( const _TyGraphLink * _pgl )
+  {
+    _Post( _change( e_scRelationRemove, _pgl ) );
+  }
+  void child_moved( const _TyGraphNode * _pgn, _TyGNIndex _uRemove, _TyGNIndex _uInsert )
+  {
+    _Post( _change( e_scChildMove, _pgn, 0, 0, _uRemove, _uInsert ) );
+  }
+  void parent_moved( const _TyGraphNode * _pgn, _TyGNIndex _uRemove, _TyGNIndex _uInsert )
+  {
+    _Post( _change( e_scParentMove, _pgn, 0, 0, _uRemove, _uInsert ) );
+  }
+  // A single node/link was destroyed ( destroy_single_node()/destroy_link() ):
+  void node_destroyed( const _TyGraphNode * _pgn )
+  {
+    _Post( _change( e_scNodeDestroy, _pgn ) );
+  }
+  void link_destroyed( const _TyGraphLink * _pgl )
+  {
+    _Post( _change( e_scLinkDestroy, _pgl ) );
+  }
+  // The connected subgraph containing <_pgn> was destroyed ( destroy_node() ):
+  void subgraph_destroyed( const _TyGraphNode * _pgn )
+  {
+    _Post( _change( e_scSubgraphDestroy, _pgn ) );
+  }
+  void root_set( const _TyGraphNode * _pgn )
+  {
+    _Post( _change( e_scSetRoot, _pgn ) );
+  }
+
+  // Wait until all posted changes have been applied - throws the failure, if any, until reset():
+  void sync()
+  {
+    std::unique_lock< std::mutex > lock( m_mtx );
+    m_cvIdle.wait( lock, [this]{ return m_pending.m_dqChanges.empty() && !m_fBusy; } );
+    _ThrowFailed();
+  }
+  bool FFailed()
+  {
+    std::lock_guard< std::mutex > lock( m_mtx );
+    return !!m_exp;
+  }
+
+  // Empty the shadow and clear a failure - the main graph's contents must then be posted again:
+  void reset()
+  {
+    std::unique_lock< std::mutex > lock( m_mtx );
+    m_cvIdle.wait( lock, [this]{ return m_pending.m_dqChanges.empty() && !m_fBusy; } );
+    m_rgShadow.set_root_node( 0 );
+    while ( !m_mapNodes.empty() )
+    {
+      _TyShadowNode * pgn = m_mapNodes.begin()->second;
+      _ForgetSubgraph( pgn );
+      m_rgShadow.destroy_node( pgn );
+    }
+    // What remains are links that aren't in any relation:
+    for ( typename _TyMapLinks::iterator it = m_mapLinks.begin(); it != m_mapLinks.end(); ++it )
+    {
+      m_rgShadow.destroy_link( it->second );
+    }
+    m_mapLinks.clear();
+    m_mapNodesRev.clear();
+    m_mapLinksRev.clear();
+    m_setDirty.clear();
+    m_exp = std::exception_ptr();
+  }
+
+  // Access - only valid after sync():
+  _TyShadowGraph & RShadow() _BIEN_NOTHROW
+  {
+    return m_rgShadow;
+  }
+  _TyShadowNode * PGNShadow( const _TyGraphNode * _pgn ) const _BIEN_NOTHROW
+  {
+    typename _TyMapNodes::const_iterator it = m_mapNodes.find( _pgn );
+    return it == m_mapNodes.end() ? 0 : it->second;
+  }
+  _TyShadowLink * PGLShadow( const _TyGraphLink * _pgl ) const _BIEN_NOTHROW
+  {
+    typename _TyMapLinks::const_iterator it = m_mapLinks.find( _pgl );
+    return it == m_mapLinks.end() ? 0 : it->second;
+  }
+
+protected:
+
+  enum EShadowChange
+  {
+    e_scNodeCreate,
+    e_scLinkCreate,
+    e_scNodeUpdate,
+    e_scLinkUpdate,
+    e_scRelationAdd,
+    e_scRelationRemove,
+    e_scChildMove,
+    e_scParentMove,
+    e_scNodeDestroy,
+    e_scLinkDestroy,
+    e_scSubgraphDestroy,
+    e_scSetRoot
+  };
+  struct _change
+  {
+    EShadowChange m_esc;
+    const void * m_pv;        // The node or link changed.
+    const void * m_pvParent;
+    const void * m_pvChild;
+    _TyGNIndex m_u1;
+    _TyGNIndex m_u2;
+
+    _change( EShadowChange _esc, const void * _pv, const void * _pvParent = 0, const void * _pvChild = 0,
+             _TyGNIndex _u1 = 0, _TyGNIndex _u2 = 0 )
+      : m_esc( _esc ), m_pv( _pv ), m_pvParent( _pvParent ), m_pvChild( _pvChild ), m_u1( _u1 ), m_u2( _u2 )
+    {
+    }
+  };
+  // A batch of changes - the elements are consumed in order by the records that carry them:
+  struct _batch
+  {
+    deque< _change > m_dqChanges;
+    deque< _TyShadowNodeEl > m_dqNodeEls;
+    deque< _TyShadowLinkEl > m_dqLinkEls;
+
+    void swap( _batch & _r )
+    {
+      m_dqChanges.swap( _r.m_dqChanges );
+      m_dqNodeEls.swap( _r.m_dqNodeEls );
+      m_dqLinkEls.swap( _r.m_dqLinkEls );
+    }
+    void clear()
+    {
+      m_dqChanges.clear();
+      m_dqNodeEls.clear();
+      m_dqLinkEls.clear();
+    }
+  };
+
+  typedef unordered_map< const void *, _TyShadowNode * > _TyMapNodes;
+  typedef unordered_map< const void *, _TyShadowLink * > _TyMapLinks;
+  typedef unordered_map< const void *, const void * > _TyMapRev; // shadow object -> main object.
+  typedef unordered_set< _TyShadowNode * > _TySetDirty;
+
+  _TyShadowGraph & m_rgShadow;
+  _TyHook m_hook;
+  // Guarded by m_mtx:
+  std::mutex m_mtx;
+  std::condition_variable m_cvWork;
+  std::condition_variable m_cvIdle;
+  _batch m_pending;
+  bool m_fStop;
+  bool m_fBusy;             // The worker is applying a batch.
+  std::exception_ptr m_exp; // Failure applying changes - sticks until reset().
+  // Worker only ( and readers after sync() ):
+  _TyMapNodes m_mapNodes;
+  _TyMapLinks m_mapLinks;
+  _TyMapRev m_mapNodesRev;
+  _TyMapRev m_mapLinksRev;
+  _TySetDirty m_setDirty;
+  _graph_workers m_workers; // Declared last - started once everything else is initialized.
+
+  void _ThrowFailed()
+  {
+    if ( m_exp )
+    {
+      std::rethrow_exception( m_exp );
+    }
+  }
+  void _Post( _change const & _rc )
+  {
+    std::lock_guard< std::mutex > lock( m_mtx );
+    _ThrowFailed();
+    _PushLocked( _rc );
+  }
+  template < class t_TyEl >
+  void _PostEl( deque< t_TyEl > & _rdqEls, t_TyEl const & _rel, _change const & _rc )
+  {
+    std::lock_guard< std::mutex > lock( m_mtx );
+    _ThrowFailed();
+    _rdqEls.push_back( _rel );
+    _BIEN_TRY
+    {
+      _PushLocked( _rc );
+    }
+    _BIEN_UNWIND( _rdqEls.pop_back() );
+  }
+  void _PushLocked( _change const & _rc )
+  {
+    m_pending.m_dqChanges.push_back( _rc );
+    if ( m_pending.m_dqChanges.size() == 1 )
+    {
+      m_cvWork.notify_one();
+    }
+  }
+
+  void _Worker()
+  {
+    _batch b;
+    for ( ; ; )
+    {
+      bool fFailed;
+      {
+        std::unique_lock< std::mutex > lock( m_mtx );
+        m_fBusy = false;
+        if ( m_pending.m_dqChanges.empty() )
+        {
+          m_cvIdle.notify_all();
+        }
+        m_cvWork.wait( lock, [this]{ return m_fStop || !m_pending.m_dqChanges.empty(); } );
+        if ( m_pending.m_dqChanges.empty() )
+        {
+          return; // stopping.
+        }
+        b.swap( m_pending );
+        m_fBusy = true;
+        fFailed = !!m_exp;
+      }
+      // Once failed the shadow is out of sync - changes posted before the failure was seen are dropped:
+      if ( !fFailed )
+      {
+        try
+        {
+          _Apply( b );
+        }
+        catch( ... )
+        {
+          std::lock_guard< std::mutex > lock( m_mtx );
+          m_exp = std::current_exception();
+        }
+      }
+      b.clear();
+      m_setDirty.clear();
+    }
+  }
+
+  template < class t_TyMap >
+  static typename t_TyMap::mapped_type _PFind( t_TyMap const & _rmap, const void * _pv )
+  {
+    typename t_TyMap::const_iterator it = _rmap.find( _pv );
+    if ( it == _rmap.end() )
+    {
+      throw bad_graph( "_shadow_graph_maintainer: Change refers to an unknown node or link." );
+    }
+    return it->second;
+  }
+  void _Dirty( _TyShadowNode * _pgn )
+  {
+    if ( _pgn )
+    {
+      m_setDirty.insert( _pgn );
+    }
+  }
+
+  void _Apply( _batch & _rb )
+  {
+    for ( ; !_rb.m_dqChanges.empty(); _rb.m_dqChanges.pop_front() )
+    {
+      _change const & rc = _rb.m_dqChanges.front();
+      switch( rc.m_esc )
+      {
+        case e_scNodeCreate:
+        {
+          _TyShadowNode * pgn = m_rgShadow.template create_node1< _TyShadowNodeEl const & >( _rb.m_dqNodeEls.front() );
+          _rb.m_dqNodeEls.pop_front();
+          _BIEN_TRY
+          {
+            m_mapNodes[ rc.m_pv ] = pgn;
+            m_mapNodesRev[ pgn ] = rc.m_pv;
+          }
+          _BIEN_UNWIND( ( m_mapNodes.erase( rc.m_pv ), m_rgShadow.destroy_single_node( pgn ) ) );
+          _Dirty( pgn );
+        }
+        break;
+        case e_scLinkCreate:
+        {
+          _TyShadowLink * pgl = m_rgShadow.template create_link1< _TyShadowLinkEl const & >( _rb.m_dqLinkEls.front() );
+          _rb.m_dqLinkEls.pop_front();
+          _BIEN_TRY
+          {
+            m_mapLinks[ rc.m_pv ] = pgl;
+            m_mapLinksRev[ pgl ] = rc.m_pv;
+          }
+          _BIEN_UNWIND( ( m_mapLinks.erase( rc.m_pv ), m_rgShadow.destroy_link( pgl ) ) );
+        }
+        break;
+        case e_scNodeUpdate:
+        {
+          _TyShadowNode * pgn = _PFind( m_mapNodes, rc.m_pv );
+          pgn->RElNonConst() = _rb.m_dqNodeEls.front();
+          _rb.m_dqNodeEls.pop_front();
+          _Dirty( pgn );
+        }
+        break;
+        case e_scLinkUpdate:
+        {
+          _TyShadowLink * pgl = _PFind( m_mapLinks, rc.m_pv );
+          pgl->RElNonConst() = _rb.m_dqLinkEls.front();
+          _rb.m_dqLinkEls.pop_front();
+          _Dirty( pgl->PGNParent() );
+          _Dirty( pgl->PGNChild() );
+        }
+        break;
+        case e_scRelationAdd:
+        {
+          _TyShadowLink * pgl = _PFind( m_mapLinks, rc.m_pv );
+          _TyShadowNode * pgnParent = _PFind( m_mapNodes, rc.m_pvParent );
+          _TyShadowNode * pgnChild = _PFind( m_mapNodes, rc.m_pvChild );
+          if ( ( rc.m_u1 > pgnParent->UChildren() ) || ( rc.m_u2 > pgnChild->UParents() ) )
+          {
+            throw _graph_nav_except( "_shadow_graph_maintainer: relation index beyond end." );
+          }
+          _TyGraphLinkBaseBase ** ppglbChild = _TyGraphLinkBaseBase::PPGLBGetNthChild( pgnParent->PPGLBChildHead(), rc.m_u1 );
+          _TyGraphLinkBaseBase ** ppglbParent = _TyGraphLinkBaseBase::PPGLBGetNthParent( pgnChild->PPGLBParentHead(), rc.m_u2 );
+          pgnParent->AddChild( *pgnChild, *pgl, *ppglbChild, *ppglbParent );
+          _Dirty( pgnParent );
+          _Dirty( pgnChild );
+        }
+        break;
+        case e_scRelationRemove:
+        {
+          _TyShadowLink * pgl = _PFind( m_mapLinks, rc.m_pv );
+          _Dirty( pgl->PGNParent() );
+          _Dirty( pgl->PGNChild() );
+          pgl->RemoveChild();
+          pgl->RemoveParent();
+        }
+        break;
+        case e_scChildMove:
+        case e_scParentMove:
+        {
+          _TyShadowNode * pgn = _PFind( m_mapNodes, rc.m_pv );
+          if ( rc.m_esc == e_scChildMove )
+          {
+            pgn->MoveChild( rc.m_u1, rc.m_u2 );
+          }
+          else
+          {
+            pgn->MoveParent( rc.m_u1, rc.m_u2 );
+          }
+          _Dirty( pgn );
+        }
+        break;
+        case e_scNodeDestroy:
+        {
+          _TyShadowNode * pgn = _PFind( m_mapNodes, rc.m_pv );
+          m_mapNodes.erase( rc.m_pv );
+          m_mapNodesRev.erase( pgn );
+          m_setDirty.erase( pgn );
+          m_rgShadow.destroy_single_node( pgn );
+        }
+        break;
+        case e_scLinkDestroy:
+        {
+          _TyShadowLink * pgl = _PFind( m_mapLinks, rc.m_pv );
+          m_mapLinks.erase( rc.m_pv );
+          m_mapLinksRev.erase( pgl );
+          m_rgShadow.destroy_link( pgl );
+        }
+        break;
+        case e_scSubgraphDestroy:
+        {
+          _TyShadowNode * pgn = _PFind( m_mapNodes, rc.m_pv );
+          _ForgetSubgraph( pgn );
+          m_rgShadow.destroy_node( pgn );
+        }
+        break;
+        case e_scSetRoot:
+        {
+          m_rgShadow.set_root_node( rc.m_pv ? _PFind( m_mapNodes, rc.m_pv ) : 0 );
+        }
+        break;
+        default:
+        {
+          Assert( 0 );
+        }
+        break;
+      }
+    }
+    for ( typename _TySetDirty::iterator it = m_setDirty.begin(); it != m_setDirty.end(); ++it )
+    {
+      m_hook( m_rgShadow, *it );
+    }
+  }
+
+  // Remove the mappings for the connected subgraph containing <_pgnStart> before it is destroyed:
+  void _ForgetSubgraph( _TyShadowNode * _pgnStart )
+  {
+    unordered_set< _TyShadowNode * > setVisited;
+    vector< _TyShadowNode * > rgpgnStack;
+    setVisited.insert( _pgnStart );
+    rgpgnStack.push_back( _pgnStart );
+    while ( !rgpgnStack.empty() )
+    {
+      _TyShadowNode * pgn = rgpgnStack.back();
+      rgpgnStack.pop_back();
+      _Forget( m_mapNodes, m_mapNodesRev, pgn );
+      m_setDirty.erase( pgn );
+      for ( _TyGraphLinkBaseBase * pglb = *pgn->PPGLBChildHead(); pglb; pglb = pglb->PGLBGetNextChild() )
+      {
+        _Forget( m_mapLinks, m_mapLinksRev, static_cast< _TyShadowLink * >( pglb ) );
+        _TyShadowNode * pgnRel = static_cast< _TyShadowNode * >( pglb->PGNBChild() );
+        if ( pgnRel && setVisited.insert( pgnRel ).second )
+        {
+          rgpgnStack.push_back( pgnRel );
+        }
+      }
+      for ( _TyGraphLinkBaseBase * pglb = *pgn->PPGLBParentHead(); pglb; pglb = pglb->PGLBGetNextParent() )
+      {
+        _TyShadowNode * pgnRel = static_cast< _TyShadowNode * >( pglb->PGNBParent() );
+        if ( pgnRel && setVisited.insert( pgnRel ).second )
+        {
+          rgpgnStack.push_back( pgnRel );
+        }
+      }
+    }
+  }
+  template < class t_TyMap >
+  static void _Forget( t_TyMap & _rmap, _TyMapRev & _rmapRev, const void * _pvShadow ) _BIEN_NOTHROW
+  {
+    typename _TyMapRev::iterator it = _rmapRev.find( _pvShadow );
+    if ( it != _rmapRev.end() )
+    {
+      _rmap.erase( it->second );
+      _rmapRev.erase( it );
+    }
+  }
+};
+
+__DGRAPH_END_NAMESPACE
+
+#endif //__GR_SHMT_H
@@ -22,7 +22,7 @@
 // Could allow user data and callback function 
 template < class t_TyGraphNodeSafe, class t_TyGraphLinkSafe, class t_TyConnLinkAlloc >
 class _graph_node_iterator_base_safe
-	: public _alloc_base< _TyGraphConnectionLink, t_TyConnLinkAlloc >,
+	: public _alloc_base< typename t_TyGraphNodeSafe::_TyGraphConnectionLink, t_TyConnLinkAlloc >,
 		public _graph_node_iterator_base_notsafe< typename t_TyGraphNodeSafe::__TyGraphNodeBase, 
 																							typename t_TyGraphLinkSafe::__TyGraphLinkBase >
 {
@@ -30,6 +30,7 @@ protected:
 	// Get the base classes from the safe classes:
 	typedef typename t_TyGraphNodeSafe::__TyGraphNodeBase	_TyGraphNodeBase;
 	typedef typename t_TyGraphLinkSafe::__TyGraphLinkBase	_TyGraphLinkBase;
+	typedef typename t_TyGraphNodeSafe::_TyGraphConnectionLink	_TyGraphConnectionLink;
 
 private:
 	typedef _alloc_base< _TyGraphConnectionLink, t_TyConnLinkAlloc >																_TyAllocConnLinkBase;
@@ -243,7 +244,7 @@ class _graph_link_ident_iterator_base_notsafe;
 // It also has an end() position that is a valid insert before position.
 template < class t_TyGraphNodeSafe, class t_TyGraphLinkSafe, class t_TyConnLinkAlloc >
 class _graph_link_pos_iterator_base_safe
-	: public _alloc_base< _TyGraphConnectionLink, t_TyConnLinkAlloc >,
+	: public _alloc_base< typename t_TyGraphNodeSafe::_TyGraphConnectionLink, t_TyConnLinkAlloc >,
 		public _graph_link_pos_iterator_base_notsafe< typename t_TyGraphNodeSafe::__TyGraphNodeBase, 
 																									typename t_TyGraphLinkSafe::__TyGraphLinkBase >
 {
@@ -251,6 +252,7 @@ protected:
 	// Get the base classes from the safe classes:
 	typedef typename t_TyGraphNodeSafe::__TyGraphNodeBase	_TyGraphNodeBase;
 	typedef typename t_TyGraphLinkSafe::__TyGraphLinkBase	_TyGraphLinkBase;
+	typedef typename t_TyGraphNodeSafe::_TyGraphConnectionLink	_TyGraphConnectionLink;
 
 private:
 	typedef _alloc_base< _TyGraphConnectionLink, t_TyConnLinkAlloc >																		_TyAllocConnLinkBase;
@@ -634,7 +636,7 @@ public:
 // It also has an end() position that is a valid insert before position.
 template < class t_TyGraphNodeSafe, class t_TyGraphLinkSafe, class t_TyConnLinkAlloc >
 class _graph_link_ident_iterator_base_safe
-	: public _alloc_base< _TyGraphConnectionLink, t_TyConnLinkAlloc >,
+	: public _alloc_base< typename t_TyGraphNodeSafe::_TyGraphConnectionLink, t_TyConnLinkAlloc >,
 		public _graph_link_ident_iterator_base_notsafe< typename t_TyGraphNodeSafe::__TyGraphNodeBase, 
 																										typename t_TyGraphLinkSafe::__TyGraphLinkBase >
 {
@@ -642,6 +644,7 @@ protected:
 	// Get the base classes from the safe classes:
 	typedef typename t_TyGraphNodeSafe::__TyGraphNodeBase	_TyGraphNodeBase;
 	typedef typename t_TyGraphLinkSafe::__TyGraphLinkBase	_TyGraphLinkBase;
+	typedef typename t_TyGraphNodeSafe::_TyGraphConnectionLink	_TyGraphConnectionLink;
 
 private:
 	typedef _alloc_base< _TyGraphConnectionLink, t_TyConnLinkAlloc >																			_TyAllocConnLinkBase;
@@ -860,7 +863,7 @@ template <	class t_TyGraphNodeSafe, class t_TyGraphLinkSafe,
 						class t_TyConnLinkAlloc >
 class _graph_path_iterator_base_safe
 	: public _alloc_base< t_TyPathNodeSafe, t_TyPathNodeSafeAllocator >,	// This allocates safe path nodes for us.
-		public _alloc_base< _TyGraphConnectionLink, t_TyConnLinkAlloc >,	// This allocates connection links for us.
+		public _alloc_base< typename t_TyGraphNodeSafe::_TyGraphConnectionLink, t_TyConnLinkAlloc >,	// This allocates connection links for us.
 
 // NOTE: there is a significant design decision here - we could base on the safe types - but that would cause
 //	multiple implementations of the same code - one for non-safe and one for safe. However, this way, we have
@@ -879,6 +882,7 @@ protected:
 	// Get the base classes from the safe classes:
 	typedef typename t_TyGraphNodeSafe::__TyGraphNodeBase	_TyGraphNodeBase;
 	typedef typename t_TyGraphLinkSafe::__TyGraphLinkBase	_TyGraphLinkBase;
+	typedef typename t_TyGraphNodeSafe::_TyGraphConnectionLink	_TyGraphConnectionLink;
 	typedef typename t_TyPathNodeSafe::__TyPathNodeBase		_TyPathNodeBase;
 
 	// Get the allocator for the base from that of the safe - the base class's
@@ -29,6 +29,7 @@ protected:
 	// Get the base classes from the safe classes:
 	typedef typename t_TyGraphNodeSafe::__TyGraphNodeBase	_TyGraphNodeBase;
 	typedef typename t_TyGraphLinkSafe::__TyGraphLinkBase	_TyGraphLinkBase;
+	typedef typename t_TyGraphNodeSafe::_TyGraphConnectionLink	_TyGraphConnectionLink;
 
 private:
 	typedef _graph_node_iterator_base_notsafe< _TyGraphNodeBase, _TyGraphLinkBase >	_TyIterBase;
@@ -244,6 +245,7 @@ protected:
 	// Get the base classes from the safe classes:
 	typedef typename t_TyGraphNodeSafe::__TyGraphNodeBase	_TyGraphNodeBase;
 	typedef typename t_TyGraphLinkSafe::__TyGraphLinkBase	_TyGraphLinkBase;
+	typedef typename t_TyGraphNodeSafe::_TyGraphConnectionLink	_TyGraphConnectionLink;
 
 private:
 	typedef _graph_link_pos_iterator_base_notsafe< _TyGraphNodeBase, _TyGraphLinkBase >		_TyIterBase;
@@ -640,6 +642,7 @@ protected:
 	// Get the base classes from the safe classes:
 	typedef typename t_TyGraphNodeSafe::__TyGraphNodeBase	_TyGraphNodeBase;
 	typedef typename t_TyGraphLinkSafe::__TyGraphLinkBase	_TyGraphLinkBase;
+	typedef typename t_TyGraphNodeSafe::_TyGraphConnectionLink	_TyGraphConnectionLink;
 
 private:
 	typedef _graph_link_ident_iterator_base_notsafe< _TyGraphNodeBase, _TyGraphLinkBase >		_TyIterBase;
@@ -874,6 +877,7 @@ protected:
 	// Get the base classes from the safe classes:
 	typedef typename t_TyGraphNodeSafe::__TyGraphNodeBase	_TyGraphNodeBase;
 	typedef typename t_TyGraphLinkSafe::__TyGraphLinkBase	_TyGraphLinkBase;
+	typedef typename t_TyGraphNodeSafe::_TyGraphConnectionLink	_TyGraphConnectionLink;
 	typedef typename t_TyPathNodeSafe::__TyPathNodeBase		_TyPathNodeBase;
 
 	// Get the allocator for the base from that of the safe:
@@ -31,6 +31,7 @@ protected:
   // Get the base classes from the safe classes:
   typedef typename t_TyGraphNodeSafe::_TyGraphNodeBase  _TyGraphNodeBase;
   typedef typename t_TyGraphLinkSafe::_TyGraphLinkBase  _TyGraphLinkBase;
+  typedef typename t_TyGraphNodeSafe::_TyGraphConnectionLink  _TyGraphConnectionLink;
 
 private:
   typedef _graph_node_iterator_base_notsafe< _TyGraphNodeBase, _TyGraphLinkBase > _TyIterBase;
@@ -49,7 +50,8 @@ protected:
 
   void  _Dereference() _BIEN_NOTHROW
   {
-    if ( _TyIterBase::PGNBCur() )
+    // A thread-safe link knows whether it is connected - the owner may clear our position at any time:
+    if ( _TyGraphConnectionLink::s_kfThreadSafe || _TyIterBase::PGNBCur() )
     {
       m_gclNode.remove_link();
     }
@@ -227,6 +229,7 @@ protected:
   // Get the base classes from the safe classes:
   typedef typename t_TyGraphNodeSafe::_TyGraphNodeBase  _TyGraphNodeBase;
   typedef typename t_TyGraphLinkSafe::_TyGraphLinkBase  _TyGraphLinkBase;
+  typedef typename t_TyGraphNodeSafe::_TyGraphConnectionLink  _TyGraphConnectionLink;
 
 private:
   typedef _graph_link_pos_iterator_base_notsafe< _TyGraphNodeBase, _TyGraphLinkBase >   _TyIterBase;
@@ -266,7 +269,7 @@ protected:
 
   void  _Dereference() _BIEN_NOTHROW
   {
-    if ( _TyIterBase::PPGLBCur() )
+    if ( _TyGraphConnectionLink::s_kfThreadSafe || _TyIterBase::PPGLBCur() )
     {
       m_gclObj.remove_link();
     }
@@ -580,6 +583,7 @@ protected:
   // Get the base classes from the safe classes:
   typedef typename t_TyGraphNodeSafe::_TyGraphNodeBase  _TyGraphNodeBase;
   typedef typename t_TyGraphLinkSafe::_TyGraphLinkBase  _TyGraphLinkBase;
+  typedef typename t_TyGraphNodeSafe::_TyGraphConnectionLink  _TyGraphConnectionLink;
 
 private:
   typedef _graph_link_ident_iterator_base_notsafe< _TyGraphNodeBase, _TyGraphLinkBase >   _TyIterBase;
@@ -604,7 +608,7 @@ protected:
 
   void  _Dereference() _BIEN_NOTHROW
   {
-    if ( PGLSCur() )
+    if ( _TyGraphConnectionLink::s_kfThreadSafe || PGLSCur() )
     {
       m_gclLink.remove_link();
     }
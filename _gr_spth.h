@@ -0,0 +1,549 @@
+#ifndef __GR_SPTH_H
+#define __GR_SPTH_H
+
+//          Copyright David Lawrence Bien 1997 - 2021.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt).
+
+// _gr_spth.h
+
+// Weighted shortest paths - the weight of a link is obtained from its element by a weight extractor.
+// The nodes are numbered with _graph_edge_list_exporter ( _gr_bulk.h ) and the links and their
+//  weights are captured at construction in compressed arrays by node id - by parent ( forward ) and,
+//  by counting sort of the forward arrays, by child ( backward ) - the searches only index arrays.
+//  The structure and the weights must not be modified while the object is used.
+// dijkstra() - single source, optionally stopping at a target - uses an indexed d-ary heap.
+// bidirectional() - a single pair - searches from the source through the child lists and from the
+//  target through the parent lists until the two searches meet.
+// bellman_ford() - single source - allows negative weights and reports a negative cycle reachable
+//  from the source.
+// Dijkstra requires that no weight be negative. Only the nodes touched by a query are reset by the
+//  next so a query costs in proportion to the part of the graph it visits.
+// A found path may be had as node ids or as its links - either runs from the source to the target.
+
+#include <stddef.h>
+#include <vector>
+#include <algorithm>
+
+__DGRAPH_BEGIN_NAMESPACE
+
+// The default weight extractor - the link element converted to the weight:
+template < class t_TyLinkEl, class t_TyWeight = t_TyLinkEl >
+struct _graph_link_weight
+{
+  typedef t_TyWeight _TyWeight;
+
+  _TyWeight operator()( t_TyLinkEl const & _rel ) const
+  {
+    return _TyWeight( _rel );
+  }
+};
+
+template <  class t_TyGraph,
+            class t_TyWeightExtractor = _graph_link_weight< typename t_TyGraph::_TyLinkEl >,
+            unsigned t_kuArity = 4 >
+class _graph_shortest_paths
+{
+  typedef _graph_shortest_paths< t_TyGraph, t_TyWeightExtractor, t_kuArity > _TyThis;
+public:
+  typedef t_TyGraph                                     _TyGraph;
+  typedef typename t_TyGraph::_TyGraphNode              _TyGraphNode;
+  typedef typename t_TyGraph::_TyGraphLink              _TyGraphLink;
+  typedef typename _TyGraphNode::_TyGraphLinkBaseBase   _TyGraphLinkBaseBase;
+  typedef _graph_edge_list_exporter< t_TyGraph >        _TyNumbering;
+  typedef typename t_TyWeightExtractor::_TyWeight       _TyWeight;
+
+  static const size_t s_kstNull = size_t( -1 );
+
+  explicit _graph_shortest_paths( t_TyGraph const & _rg,
+                                  t_TyWeightExtractor const & _rwx = t_TyWeightExtractor() )
+    : m_gele( _rg ),
+      m_fNegativeCycle( false )
+  {
+    size_t stNodes = m_gele.StNodes();
+    size_t stLinks = m_gele.StLinks();
+    m_rgstOffsets.resize( stNodes + 1 );
+    m_rgstTo.resize( stLinks );
+    m_gele.CopyCSR( m_rgstOffsets.begin(), m_rgstTo.begin() );
+    m_rgstFrom.reserve( stLinks );
+    m_rgwt.reserve( stLinks );
+    m_rgpgl.reserve( stLinks );
+    for ( size_t st = 0; st < stNodes; ++st )
+    {
+      for ( const _TyGraphLinkBaseBase * pglb = *m_gele.PGNNode( st )->PPGLBChildHead(); pglb; pglb = pglb->PGLBGetNextChild() )
+      {
+        const _TyGraphLink * pgl = static_cast< const _TyGraphLink * >( pglb );
+        m_rgstFrom.push_back( st );
+        m_rgwt.push_back( _rwx( pgl->RElConst() ) );
+        m_rgpgl.push_back( pgl );
+      }
+    }
+
+    // The backward arrays:
+    vector< size_t > rgstParents;
+    _ReverseCSR( m_rgstOffsets, m_rgstTo, m_rgstROffsets, rgstParents, &m_rgstREdges );
+
+    m_rgstPathPos.assign( stNodes, s_kstNull );
+    m_sdF.resize( stNodes );
+    m_sdB.resize( stNodes );
+    m_heapF.resize( stNodes, m_sdF.m_rgwtDist );
+    m_heapB.resize( stNodes, m_sdB.m_rgwtDist );
+  }
+  // The heaps refer to the distance arrays:
+  _graph_shortest_paths( _TyThis const & ) = delete;
+  _TyThis & operator =( _TyThis const & ) = delete;
+
+  _TyNumbering const &  RNumbering() const _BIEN_NOTHROW
+  {
+    return m_gele;
+  }
+
+  // Shortest paths from _stSource ( node id of RNumbering() ). If _stTarget is given the search
+  //  stops once the target's distance is known - returns whether the target was reached.
+  bool  dijkstra( size_t _stSource, size_t _stTarget = s_kstNull )
+  {
+    _Reset();
+    m_sdF.touch( _stSource, _TyWeight(), s_kstNull );
+    m_heapF.push( _stSource );
+    while ( !m_heapF.empty() )
+    {
+      size_t stV = m_heapF.pop();
+      if ( stV == _stTarget )
+      {
+        break;
+      }
+      for ( size_t stEdge = m_rgstOffsets[ stV ]; stEdge < m_rgstOffsets[ stV + 1 ]; ++stEdge )
+      {
+        Assert( !( m_rgwt[ stEdge ] < _TyWeight() ) );
+        _Relax( m_sdF, m_heapF, m_rgstTo[ stEdge ], m_sdF.m_rgwtDist[ stV ] + m_rgwt[ stEdge ], stEdge );
+      }
+    }
+    return ( s_kstNull == _stTarget ) || m_sdF.m_rgfReached[ _stTarget ];
+  }
+
+  // Shortest path from _stSource to _stTarget - returns whether a path exists. Only the distance
+  //  and path of the target are meaningful after this query.
+  bool  bidirectional( size_t _stSource, size_t _stTarget )
+  {
+    if ( _stSource == _stTarget )
+    {
+      return dijkstra( _stSource, _stTarget );
+    }
+    _Reset();
+    m_sdF.touch( _stSource, _TyWeight(), s_kstNull );
+    m_heapF.push( _stSource );
+    m_sdB.touch( _stTarget, _TyWeight(), s_kstNull );
+    m_heapB.push( _stTarget );
+
+    bool fFound = false;
+    _TyWeight wtBest = _TyWeight();
+    size_t stMeet = s_kstNull;
+    while ( !m_heapF.empty() && !m_heapB.empty() )
+    {
+      _TyWeight wtTopF = m_sdF.m_rgwtDist[ m_heapF.top() ];
+      _TyWeight wtTopB = m_sdB.m_rgwtDist[ m_heapB.top() ];
+      if ( fFound && !( wtTopF + wtTopB < wtBest ) )
+      {
+        break;
+      }
+      if ( !( wtTopB < wtTopF ) )
+      {
+        size_t stV = m_heapF.pop();
+        for ( size_t stEdge = m_rgstOffsets[ stV ]; stEdge < m_rgstOffsets[ stV + 1 ]; ++stEdge )
+        {
+          Assert( !( m_rgwt[ stEdge ] < _TyWeight() ) );
+          size_t stW = m_rgstTo[ stEdge ];
+          _TyWeight wt = m_sdF.m_rgwtDist[ stV ] + m_rgwt[ stEdge ];
+          _Relax( m_sdF, m_heapF, stW, wt, stEdge );
+          if ( m_sdB.m_rgfReached[ stW ] && ( !fFound || ( wt + m_sdB.m_rgwtDist[ stW ] < wtBest ) ) )
+          {
+            fFound = true;
+            wtBest = wt + m_sdB.m_rgwtDist[ stW ];
+            stMeet = stW;
+          }
+        }
+      }
+      else
+      {
+        size_t stV = m_heapB.pop();
+        for ( size_t stR = m_rgstROffsets[ stV ]; stR < m_rgstROffsets[ stV + 1 ]; ++stR )
+        {
+          size_t stEdge = m_rgstREdges[ stR ];
+          Assert( !( m_rgwt[ stEdge ] < _TyWeight() ) );
+          size_t stW = m_rgstFrom[ stEdge ];
+          _TyWeight wt = m_sdB.m_rgwtDist[ stV ] + m_rgwt[ stEdge ];
+          _Relax( m_sdB, m_heapB, stW, wt, stEdge );
+          if ( m_sdF.m_rgfReached[ stW ] && ( !fFound || ( wt + m_sdF.m_rgwtDist[ stW ] < wtBest ) ) )
+          {
+            fFound = true;
+            wtBest = wt + m_sdF.m_rgwtDist[ stW ];
+            stMeet = stW;
+          }
+        }
+      }
+    }
+    if ( fFound )
+    {
+      _Splice( stMeet, _stTarget );
+    }
+    return fFound;
+  }
+
+  // Shortest paths from _stSource allowing negative weights. Returns false if a negative cycle
+  //  is reachable from the source - the distances are then meaningless.
+  bool  bellman_ford( size_t _stSource )
+  {
+    _Reset();
+    size_t stNodes = m_gele.StNodes();
+    m_sdF.touch( _stSource, _TyWeight(), s_kstNull );
+    bool fChanged = true;
+    for ( size_t stRound = 0; fChanged && ( stRound < stNodes ); ++stRound )
+    {
+      fChanged = false;
+      for ( size_t stV = 0; stV < stNodes; ++stV )
+      {
+        if ( !m_sdF.m_rgfReached[ stV ] )
+        {
+          continue;
+        }
+        for ( size_t stEdge = m_rgstOffsets[ stV ]; stEdge < m_rgstOffsets[ stV + 1 ]; ++stEdge )
+        {
+          size_t stW = m_rgstTo[ stEdge ];
+          _TyWeight wt = m_sdF.m_rgwtDist[ stV ] + m_rgwt[ stEdge ];
+          if ( !m_sdF.m_rgfReached[ stW ] )
+          {
+            m_sdF.touch( stW, wt, stEdge );
+            fChanged = true;
+          }
+          else
+          if ( wt < m_sdF.m_rgwtDist[ stW ] )
+          {
+            m_sdF.m_rgwtDist[ stW ] = wt;
+            m_sdF.m_rgstPred[ stW ] = stEdge;
+            fChanged = true;
+          }
+        }
+      }
+    }
+    // Still relaxing after |V| rounds:
+    m_fNegativeCycle = fChanged;
+    return !m_fNegativeCycle;
+  }
+
+  // Results of the last query - by node id:
+  bool  FReached( size_t _stNode ) const _BIEN_NOTHROW
+  {
+    return !!m_sdF.m_rgfReached[ _stNode ];
+  }
+  _TyWeight const & WtDistance( size_t _stNode ) const _BIEN_NOTHROW
+  {
+    Assert( FReached( _stNode ) );
+    return m_sdF.m_rgwtDist[ _stNode ];
+  }
+  // The last link of the path to the node - 0 for the source:
+  const _TyGraphLink *  PGLPred( size_t _stNode ) const _BIEN_NOTHROW
+  {
+    size_t stEdge = m_sdF.m_rgstPred[ _stNode ];
+    return ( s_kstNull == stEdge ) ? 0 : m_rgpgl[ stEdge ];
+  }
+  bool  FNegativeCycle() const _BIEN_NOTHROW
+  {
+    return m_fNegativeCycle;
+  }
+
+  // The path to _stTo as node ids - source first. Returns false if the node wasn't reached:
+  bool  GetPath( size_t _stTo, vector< size_t > & _rrgstNodes ) const
+  {
+    _rrgstNodes.clear();
+    if ( !FReached( _stTo ) || m_fNegativeCycle )
+    {
+      return false;
+    }
+    for ( size_t stV = _stTo; ; stV = m_rgstFrom[ m_sdF.m_rgstPred[ stV ] ] )
+    {
+      _rrgstNodes.push_back( stV );
+      if ( s_kstNull == m_sdF.m_rgstPred[ stV ] )
+      {
+        break;
+      }
+    }
+    reverse( _rrgstNodes.begin(), _rrgstNodes.end() );
+    return true;
+  }
+
+  // The links of the path to _stTo - source first. Returns false if the node wasn't reached:
+  bool  GetPathLinks( size_t _stTo, vector< const _TyGraphLink * > & _rrgpgl ) const
+  {
+    _rrgpgl.clear();
+    if ( !FReached( _stTo ) || m_fNegativeCycle )
+    {
+      return false;
+    }
+    for ( size_t stEdge = m_sdF.m_rgstPred[ _stTo ]; s_kstNull != stEdge;
+          stEdge = m_sdF.m_rgstPred[ m_rgstFrom[ stEdge ] ] )
+    {
+      _rrgpgl.push_back( m_rgpgl[ stEdge ] );
+    }
+    reverse( _rrgpgl.begin(), _rrgpgl.end() );
+    return true;
+  }
+
+protected:
+
+  // Search state - one direction:
+  struct _search_dir
+  {
+    vector< _TyWeight > m_rgwtDist;
+    vector< size_t >    m_rgstPred;     // Edge by which the node was reached.
+    vector< char >      m_rgfReached;
+    vector< size_t >    m_rgstTouched;
+
+    void  resize( size_t _stNodes )
+    {
+      m_rgwtDist.resize( _stNodes );
+      m_rgstPred.resize( _stNodes, s_kstNull );
+      m_rgfReached.resize( _stNodes );
+      m_rgstTouched.reserve( _stNodes );
+    }
+    void  touch( size_t _stNode, _TyWeight const & _rwt, size_t _stPred )
+    {
+      Assert( !m_rgfReached[ _stNode ] );
+      m_rgstTouched.push_back( _stNode );
+      m_rgwtDist[ _stNode ] = _rwt;
+      m_rgstPred[ _stNode ] = _stPred;
+      m_rgfReached[ _stNode ] = true;
+    }
+    void  reset() _BIEN_NOTHROW
+    {
+      for ( size_t st = 0; st < m_rgstTouched.size(); ++st )
+      {
+        size_t stNode = m_rgstTouched[ st ];
+        m_rgwtDist[ stNode ] = _TyWeight();
+        m_rgstPred[ stNode ] = s_kstNull;
+        m_rgfReached[ stNode ] = false;
+      }
+      m_rgstTouched.clear();
+    }
+  };
+
+  // Indexed d-ary min heap of node ids keyed by a distance array - supports decrease-key:
+  struct _heap
+  {
+    vector< size_t >            m_rgst;
+    vector< size_t >            m_rgstPos;  // Position in the heap of each node - s_kstNull if not present.
+    const vector< _TyWeight > * m_prgwt;
+
+    _heap()
+      : m_prgwt( 0 )
+    {
+    }
+    void  resize( size_t _stNodes, vector< _TyWeight > const & _rrgwt )
+    {
+      m_rgst.reserve( _stNodes );
+      m_rgstPos.resize( _stNodes, s_kstNull );
+      m_prgwt = &_rrgwt;
+    }
+    bool  empty() const _BIEN_NOTHROW
+    {
+      return m_rgst.empty();
+    }
+    bool  contains( size_t _stNode ) const _BIEN_NOTHROW
+    {
+      return s_kstNull != m_rgstPos[ _stNode ];
+    }
+    size_t  top() const _BIEN_NOTHROW
+    {
+      return m_rgst[ 0 ];
+    }
+    void  push( size_t _stNode )
+    {
+      m_rgst.push_back( _stNode );
+      _Up( m_rgst.size() - 1 );
+    }
+    size_t  pop() _BIEN_NOTHROW
+    {
+      size_t stTop = m_rgst[ 0 ];
+      m_rgstPos[ stTop ] = s_kstNull;
+      size_t stLast = m_rgst.back();
+      m_rgst.pop_back();
+      if ( !m_rgst.empty() )
+      {
+        m_rgst[ 0 ] = stLast;
+        _Down( 0 );
+      }
+      return stTop;
+    }
+    // The key of _stNode has decreased:
+    void  decrease( size_t _stNode ) _BIEN_NOTHROW
+    {
+      _Up( m_rgstPos[ _stNode ] );
+    }
+    void  clear() _BIEN_NOTHROW
+    {
+      for ( size_t st = 0; st < m_rgst.size(); ++st )
+      {
+        m_rgstPos[ m_rgst[ st ] ] = s_kstNull;
+      }
+      m_rgst.clear();
+    }
+
+    void  _Up( size_t _stPos ) _BIEN_NOTHROW
+    {
+      size_t stNode = m_rgst[ _stPos ];
+      _TyWeight const & rwt = (*m_prgwt)[ stNode ];
+      while ( _stPos )
+      {
+        size_t stParent = ( _stPos - 1 ) / t_kuArity;
+        if ( !( rwt < (*m_prgwt)[ m_rgst[ stParent ] ] ) )
+        {
+          break;
+        }
+        m_rgst[ _stPos ] = m_rgst[ stParent ];
+        m_rgstPos[ m_rgst[ _stPos ] ] = _stPos;
+        _stPos = stParent;
+      }
+      m_rgst[ _stPos ] = stNode;
+      m_rgstPos[ stNode ] = _stPos;
+    }
+    void  _Down( size_t _stPos ) _BIEN_NOTHROW
+    {
+      size_t stNode = m_rgst[ _stPos ];
+      _TyWeight const & rwt = (*m_prgwt)[ stNode ];
+      size_t stSize = m_rgst.size();
+      for ( ; ; )
+      {
+        size_t stFirst = _stPos * t_kuArity + 1;
+        if ( stFirst >= stSize )
+        {
+          break;
+        }
+        size_t stEnd = ( stSize - stFirst > t_kuArity ) ? stFirst + t_kuArity : stSize;
+        size_t stMin = stFirst;
+        for ( size_t st = stFirst + 1; st < stEnd; ++st )
+        {
+          if ( (*m_prgwt)[ m_rgst[ st ] ] < (*m_prgwt)[ m_rgst[ stMin ] ] )
+          {
+            stMin = st;
+          }
+        }
+        if ( !( (*m_prgwt)[ m_rgst[ stMin ] ] < rwt ) )
+        {
+          break;
+        }
+        m_rgst[ _stPos ] = m_rgst[ stMin ];
+        m_rgstPos[ m_rgst[ _stPos ] ] = _stPos;
+        _stPos = stMin;
+      }
+      m_rgst[ _stPos ] = stNode;
+      m_rgstPos[ stNode ] = _stPos;
+    }
+  };
+
+  _TyNumbering        m_gele;
+  // Forward - the links by parent in child list order:
+  vector< size_t >    m_rgstOffsets;
+  vector< size_t >    m_rgstFrom;
+  vector< size_t >    m_rgstTo;
+  vector< _TyWeight > m_rgwt;
+  vector< const _TyGraphLink * > m_rgpgl;
+  // Backward - forward edge indices by child in parent id order:
+  vector< size_t >    m_rgstROffsets;
+  vector< size_t >    m_rgstREdges;
+  vector< size_t >    m_rgstPathPos;  // _Splice() - s_kstNull between calls.
+
+  _search_dir         m_sdF;
+  _search_dir         m_sdB;
+  _heap               m_heapF;
+  _heap               m_heapB;
+  bool                m_fNegativeCycle;
+
+  void  _Reset() _BIEN_NOTHROW
+  {
+    m_sdF.reset();
+    m_sdB.reset();
+    m_heapF.clear();
+    m_heapB.clear();
+    m_fNegativeCycle = false;
+  }
+
+  static void _Relax( _search_dir & _rsd, _heap & _rheap, size_t _stNode, _TyWeight const & _rwt, size_t _stEdge )
+  {
+    if ( !_rsd.m_rgfReached[ _stNode ] )
+    {
+      _rsd.touch( _stNode, _rwt, _stEdge );
+      _rheap.push( _stNode );
+    }
+    else
+    if ( _rheap.contains( _stNode ) && ( _rwt < _rsd.m_rgwtDist[ _stNode ] ) )
+    {
+      _rsd.m_rgwtDist[ _stNode ] = _rwt;
+      _rsd.m_rgstPred[ _stNode ] = _stEdge;
+      _rheap.decrease( _stNode );
+    }
+  }
+
+  // Join the backward path from _stMeet to the target onto the forward path - the forward
+  //  predecessors along it are overwritten. A node appearing in both halves ( only possible
+  //  through a cycle of weight zero ) has the loop between its appearances dropped.
+  void  _Splice( size_t _stMeet, size_t _stTarget )
+  {
+    vector< size_t > rgstEdges;
+    for ( size_t stV = _stMeet; s_kstNull != m_sdF.m_rgstPred[ stV ]; stV = m_rgstFrom[ m_sdF.m_rgstPred[ stV ] ] )
+    {
+      rgstEdges.push_back( m_sdF.m_rgstPred[ stV ] );
+    }
+    reverse( rgstEdges.begin(), rgstEdges.end() );
+    for ( size_t stV = _stMeet; stV != _stTarget; stV = m_rgstTo[ m_sdB.m_rgstPred[ stV ] ] )
+    {
+      rgstEdges.push_back( m_sdB.m_rgstPred[ stV ] );
+    }
+    // Drop loops - m_rgstPathPos holds the position on the path of each node on it:
+    vector< size_t > rgstPath;
+    rgstPath.reserve( rgstEdges.size() ); // no throw while m_rgstPathPos is in use.
+    size_t stSource = m_rgstFrom[ rgstEdges[ 0 ] ];
+    m_rgstPathPos[ stSource ] = 0;
+    for ( size_t st = 0; st < rgstEdges.size(); ++st )
+    {
+      size_t stW = m_rgstTo[ rgstEdges[ st ] ];
+      size_t stAt = m_rgstPathPos[ stW ];
+      if ( s_kstNull != stAt )
+      {
+        for ( size_t stDrop = stAt; stDrop < rgstPath.size(); ++stDrop )
+        {
+          m_rgstPathPos[ m_rgstTo[ rgstPath[ stDrop ] ] ] = s_kstNull;
+        }
+        rgstPath.resize( stAt );
+      }
+      else
+      {
+        rgstPath.push_back( rgstEdges[ st ] );
+      }
+      m_rgstPathPos[ stW ] = rgstPath.size();
+    }
+    m_rgstPathPos[ stSource ] = s_kstNull;
+    for ( size_t st = 0; st < rgstPath.size(); ++st )
+    {
+      size_t stEdge = rgstPath[ st ];
+      size_t stW = m_rgstTo[ stEdge ];
+      m_rgstPathPos[ stW ] = s_kstNull;
+      _TyWeight wt = m_sdF.m_rgwtDist[ m_rgstFrom[ stEdge ] ] + m_rgwt[ stEdge ];
+      if ( !m_sdF.m_rgfReached[ stW ] )
+      {
+        m_sdF.touch( stW, wt, stEdge );
+      }
+      else
+      {
+        m_sdF.m_rgwtDist[ stW ] = wt;
+        m_sdF.m_rgstPred[ stW ] = stEdge;
+      }
+    }
+  }
+};
+
+template < class t_TyGraph, class t_TyWeightExtractor, unsigned t_kuArity >
+const size_t _graph_shortest_paths< t_TyGraph, t_TyWeightExtractor, t_kuArity >::s_kstNull;
+
+__DGRAPH_END_NAMESPACE
+
+#endif //__GR_SPTH_H
@@ -70,6 +70,27 @@ struct _iostream_RawElIO
   }
 };
 
+// Portable element IO - fixed width little-endian ( see _gr_port.h ):
+struct _iostream_PortableElIO
+{
+  template < class t_TyEl >
+  void Write( ostream & _ros, t_TyEl const & _rel )
+  {
+    typedef _portable_el_io< t_TyEl > _TyPortableIO;
+    uint8_t rgby[ _TyPortableIO::s_kstSize ];
+    _TyPortableIO::Store( rgby, _rel );
+    _ros.write( reinterpret_cast< const char* >( rgby ), sizeof( rgby ) );
+  }
+  template < class t_TyEl >
+  void Read( istream & _ris, t_TyEl & _rel )
+  {
+    typedef _portable_el_io< t_TyEl > _TyPortableIO;
+    uint8_t rgby[ _TyPortableIO::s_kstSize ];
+    _ris.read( reinterpret_cast< char* >( rgby ), sizeof( rgby ) );
+    _TyPortableIO::Load( rgby, _rel );
+  }
+};
+
 template <  class t_TyOutputNodeEl,
             class t_TyOutputLinkEl = t_TyOutputNodeEl >
 struct _ostream_object
@@ -0,0 +1,1444 @@
+
+//          Copyright David Lawrence Bien 1997 - 2021.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt).
+
+// _gr_tal.cpp
+
+// Tests of bulk import and export and of the graph algorithms: each result on random graphs is
+//  compared to that of a brute force computation - mostly over the exported CSR arrays
+//  ( _graph_edge_list_exporter ).
+// Returns non-zero if any check fails.
+
+#include "_gr_inc.h"
+#include "_gr_tst1.h"
+#include <stdio.h>
+#include <math.h>
+#include <vector>
+#include <set>
+#include <atomic>
+#include <algorithm>
+#include <random>
+
+using namespace ns_dgraph;
+using namespace std;
+
+typedef dgraph< int, int, false > _TyGraph;
+
+static int s_nFailures = 0;
+
+static void
+_Check( bool _f, const char * _pszWhat, unsigned _uSeed )
+{
+  if ( !_f )
+  {
+    ++s_nFailures;
+    fprintf( stderr, "FAILED: %s ( seed %u ).\n", _pszWhat, _uSeed );
+  }
+}
+
+// Sizes of the random graphs - the small ones exercise the edge cases:
+static const size_t s_krgstNodes[] = { 1, 2, 3, 5, 10, 30, 100 };
+static const size_t s_kstSizes = sizeof( s_krgstNodes ) / sizeof( s_krgstNodes[ 0 ] );
+static const unsigned s_kuSeeds = 8 * s_kstSizes;
+
+// The graph as CSR arrays in the exporter's numbering:
+struct _csr
+{
+  vector< size_t > m_rgstOffsets;
+  vector< size_t > m_rgstChildren;
+  vector< int > m_rgiLinkEls;   // By edge - in the order of m_rgstChildren.
+
+  explicit _csr( _TyGraph const & _rg )
+  {
+    _graph_edge_list_exporter< _TyGraph > gele( _rg );
+    m_rgstOffsets.resize( gele.StNodes() + 1 );
+    m_rgstChildren.resize( gele.StLinks() );
+    gele.CopyCSR( m_rgstOffsets.begin(), m_rgstChildren.begin() );
+    vector< _graph_edge< int > > rgEdges( gele.StLinks() );
+    gele.CopyEdgesWithEls( rgEdges.begin() );
+    for ( size_t st = 0; st < rgEdges.size(); ++st )
+    {
+      m_rgiLinkEls.push_back( rgEdges[ st ].m_el );
+    }
+  }
+  size_t  StNodes() const
+  {
+    return m_rgstOffsets.size() - 1;
+  }
+};
+
+// Random graph <_uSeed> - the size cycles through s_krgstNodes and every other one is acyclic:
+static void
+_CreateGraph( _TyGraph & _rg, unsigned _uSeed )
+{
+  size_t stNodes = s_krgstNodes[ _uSeed % s_kstSizes ];
+  CreateTestGraphRandom( _rg, stNodes, stNodes + _uSeed % 7, !!( ( _uSeed / s_kstSizes ) % 2 ), _uSeed );
+}
+
+// Brute force: _rgrgf[ a ][ b ] if b is reachable from a ( by a path of zero or more links ).
+static void
+_Reachability( _csr const & _rcsr, vector< vector< bool > > & _rgrgf )
+{
+  size_t stNodes = _rcsr.StNodes();
+  _rgrgf.assign( stNodes, vector< bool >( stNodes ) );
+  for ( size_t stFrom = 0; stFrom < stNodes; ++stFrom )
+  {
+    vector< size_t > rgstStack( 1, stFrom );
+    _rgrgf[ stFrom ][ stFrom ] = true;
+    while ( !rgstStack.empty() )
+    {
+      size_t st = rgstStack.back();
+      rgstStack.pop_back();
+      for ( size_t stEdge = _rcsr.m_rgstOffsets[ st ]; stEdge < _rcsr.m_rgstOffsets[ st + 1 ]; ++stEdge )
+      {
+        size_t stChild = _rcsr.m_rgstChildren[ stEdge ];
+        if ( !_rgrgf[ stFrom ][ stChild ] )
+        {
+          _rgrgf[ stFrom ][ stChild ] = true;
+          rgstStack.push_back( stChild );
+        }
+      }
+    }
+  }
+}
+
+// Brute force: whether <_stTo> is reachable from <_stFrom> in <_rgrgst> ( the successors of each
+//  node ) by a path that avoids <_stSkip>:
+static bool
+_FReachesAvoiding( vector< vector< size_t > > const & _rgrgst, size_t _stFrom, size_t _stTo, size_t _stSkip )
+{
+  if ( _stFrom == _stSkip )
+  {
+    return false;
+  }
+  vector< bool > rgfSeen( _rgrgst.size() );
+  vector< size_t > rgstStack( 1, _stFrom );
+  rgfSeen[ _stFrom ] = true;
+  while ( !rgstStack.empty() )
+  {
+    size_t st = rgstStack.back();
+    rgstStack.pop_back();
+    if ( st == _stTo )
+    {
+      return true;
+    }
+    for ( size_t stSucc = 0; stSucc < _rgrgst[ st ].size(); ++stSucc )
+    {
+      size_t stNext = _rgrgst[ st ][ stSucc ];
+      if ( ( stNext != _stSkip ) && !rgfSeen[ stNext ] )
+      {
+        rgfSeen[ stNext ] = true;
+        rgstStack.push_back( stNext );
+      }
+    }
+  }
+  return false;
+}
+
+// Random arrays - node i has element i so the loaded nodes can be told apart - with a random root.
+//  Every other case leaves some nodes unconnected, and some cases have an id out of range.
+//  replace_edge_list() must throw bad_graph exactly when the arrays are bad, otherwise each node's
+//  child and parent lists must be its edges in edge array order:
+static void
+_TestEdgeListIngestion()
+{
+  typedef _TyGraph::_TyGraphNode _TyGraphNode;
+  typedef _TyGraph::_TyGraphLink _TyGraphLink;
+  typedef _TyGraphNode::_TyGraphLinkBaseBase _TyGraphLinkBaseBase;
+  for ( unsigned uSeed = 0; uSeed < s_kuSeeds; ++uSeed )
+  {
+    mt19937 gen( uSeed );
+    size_t stNodes = s_krgstNodes[ uSeed % s_kstSizes ] - ( uSeed % 5 == 4 );
+    vector< int > rgiNodeEls;
+    for ( size_t st = 0; st < stNodes; ++st )
+    {
+      rgiNodeEls.push_back( int( st ) );
+    }
+    vector< _graph_edge< int > > rgEdges;
+    for ( size_t st = ( uSeed % 2 ) ? 2 : 1; st < stNodes; ++st )
+    {
+      _graph_edge< int > e = { gen() % st, st, int( gen() % 1000 ) };
+      if ( gen() % 2 )
+      {
+        swap( e.m_stParent, e.m_stChild );
+      }
+      rgEdges.push_back( e );
+    }
+    for ( size_t st = gen() % ( stNodes + 1 ); st--; )
+    {
+      _graph_edge< int > e = { gen() % stNodes, gen() % stNodes, int( gen() % 1000 ) };
+      rgEdges.push_back( e );
+    }
+    if ( ( uSeed % 7 == 3 ) && !rgEdges.empty() )
+    {
+      rgEdges[ gen() % rgEdges.size() ].m_stChild = stNodes;
+    }
+    size_t stRoot = ( uSeed % 11 == 5 ) ? stNodes : ( stNodes ? gen() % stNodes : 0 );
+
+    // Brute force - the ids are valid and every node is connected to the root ignoring direction:
+    bool fValid = !stNodes ? rgEdges.empty() : ( stRoot < stNodes );
+    vector< vector< size_t > > rgrgstAdjacent( stNodes );
+    for ( size_t st = 0; fValid && ( st < rgEdges.size() ); ++st )
+    {
+      fValid = ( rgEdges[ st ].m_stParent < stNodes ) && ( rgEdges[ st ].m_stChild < stNodes );
+      if ( fValid )
+      {
+        rgrgstAdjacent[ rgEdges[ st ].m_stParent ].push_back( rgEdges[ st ].m_stChild );
+        rgrgstAdjacent[ rgEdges[ st ].m_stChild ].push_back( rgEdges[ st ].m_stParent );
+      }
+    }
+    for ( size_t st = 0; fValid && ( st < stNodes ); ++st )
+    {
+      fValid = _FReachesAvoiding( rgrgstAdjacent, stRoot, st, size_t( -1 ) );
+    }
+
+    _TyGraph g;
+    bool fThrew = false;
+    try
+    {
+      g.replace_edge_list( rgiNodeEls.empty() ? 0 : &rgiNodeEls[ 0 ], stNodes,
+                           rgEdges.empty() ? 0 : &rgEdges[ 0 ], rgEdges.size(), stRoot );
+    }
+    catch( bad_graph const & )
+    {
+      fThrew = true;
+    }
+    _Check( fThrew == !fValid, "replace_edge_list() throws bad_graph exactly for bad arrays", uSeed );
+    if ( fThrew || !stNodes )
+    {
+      _Check( !g.get_root(), "a graph that failed to load is empty", uSeed );
+      continue;
+    }
+
+    _graph_edge_list_exporter< _TyGraph > gele( g );
+    bool fLists = ( gele.StNodes() == stNodes ) && ( gele.StLinks() == rgEdges.size() ) &&
+                  ( g.get_root()->RElConst() == int( stRoot ) );
+    for ( size_t stNode = 0; fLists && ( stNode < stNodes ); ++stNode )
+    {
+      const _TyGraphNode * pgn = gele.PGNNode( stNode );
+      size_t stId = size_t( pgn->RElConst() );
+      const _TyGraphLinkBaseBase * pglbChild = *pgn->PPGLBChildHead();
+      const _TyGraphLinkBaseBase * pglbParent = *pgn->PPGLBParentHead();
+      for ( size_t st = 0; fLists && ( st < rgEdges.size() ); ++st )
+      {
+        if ( rgEdges[ st ].m_stParent == stId )
+        {
+          fLists = pglbChild && ( static_cast< const _TyGraphLink * >( pglbChild )->RElConst() == rgEdges[ st ].m_el ) &&
+                   ( size_t( static_cast< const _TyGraphNode * >( pglbChild->PGNBChild() )->RElConst() ) == rgEdges[ st ].m_stChild );
+          pglbChild = fLists ? pglbChild->PGLBGetNextChild() : 0;
+        }
+        if ( fLists && ( rgEdges[ st ].m_stChild == stId ) )
+        {
+          fLists = pglbParent && ( static_cast< const _TyGraphLink * >( pglbParent )->RElConst() == rgEdges[ st ].m_el ) &&
+                   ( size_t( static_cast< const _TyGraphNode * >( pglbParent->PGNBParent() )->RElConst() ) == rgEdges[ st ].m_stParent );
+          pglbParent = fLists ? pglbParent->PGLBGetNextParent() : 0;
+        }
+      }
+      fLists = fLists && !pglbChild && !pglbParent;
+    }
+    _Check( fLists, "the relation lists are the edges in order", uSeed );
+  }
+}
+
+// Brute force: the canonical walk of <_rg> written out - breadth-first from the root, each node's
+//  children and then - with <_fParents> - its parents in order, nodes and links numbered at first
+//  encounter:
+static void
+_CanonicalWalk( _TyGraph const & _rg, bool _fParents, vector< long > & _rgl )
+{
+  typedef _TyGraph::_TyGraphNode _TyGraphNode;
+  typedef _TyGraph::_TyGraphLink _TyGraphLink;
+  typedef _TyGraphNode::_TyGraphLinkBaseBase _TyGraphLinkBaseBase;
+  _rgl.clear();
+  vector< const _TyGraphNode * > rgpgn;
+  vector< const _TyGraphLinkBaseBase * > rgpglb;
+  if ( _rg.get_root() )
+  {
+    rgpgn.push_back( _rg.get_root() );
+  }
+  for ( size_t stCur = 0; stCur < rgpgn.size(); ++stCur )
+  {
+    _rgl.push_back( rgpgn[ stCur ]->RElConst() );
+    for ( int iDir = 0; iDir < ( _fParents ? 2 : 1 ); ++iDir )
+    {
+      _rgl.push_back( -1 - iDir );
+      for ( const _TyGraphLinkBaseBase * pglb = iDir ? *rgpgn[ stCur ]->PPGLBParentHead() : *rgpgn[ stCur ]->PPGLBChildHead();
+            pglb; pglb = iDir ? pglb->PGLBGetNextParent() : pglb->PGLBGetNextChild() )
+      {
+        const _TyGraphNode * pgn = static_cast< const _TyGraphNode * >( iDir ? pglb->PGNBParent() : pglb->PGNBChild() );
+        size_t stLink = find( rgpglb.begin(), rgpglb.end(), pglb ) - rgpglb.begin();
+        if ( stLink == rgpglb.size() )
+        {
+          rgpglb.push_back( pglb );
+        }
+        size_t stNode = find( rgpgn.begin(), rgpgn.end(), pgn ) - rgpgn.begin();
+        if ( stNode == rgpgn.size() )
+        {
+          rgpgn.push_back( pgn );
+        }
+        _rgl.push_back( long( stLink ) );
+        _rgl.push_back( static_cast< const _TyGraphLink * >( pglb )->RElConst() );
+        _rgl.push_back( long( stNode ) );
+      }
+    }
+  }
+}
+
+// export_edge_list() and export_csr() against a brute force numbering - breadth-first from the
+//  root, each node's children and then its parents in order - and the edges by parent and child
+//  list position. Loading the export builds a graph with the same child lists - the parent lists
+//  are in edge order rather than the original order:
+static void
+_TestEdgeListExport()
+{
+  typedef _TyGraph::_TyGraphNode _TyGraphNode;
+  typedef _TyGraph::_TyGraphLink _TyGraphLink;
+  typedef _TyGraphNode::_TyGraphLinkBaseBase _TyGraphLinkBaseBase;
+  for ( unsigned uSeed = 0; uSeed < s_kuSeeds; ++uSeed )
+  {
+    _TyGraph g;
+    _CreateGraph( g, uSeed );
+    vector< const _TyGraphNode * > rgpgn( 1, g.get_root() );
+    for ( size_t stCur = 0; stCur < rgpgn.size(); ++stCur )
+    {
+      for ( int iDir = 0; iDir < 2; ++iDir )
+      {
+        for ( const _TyGraphLinkBaseBase * pglb = iDir ? *rgpgn[ stCur ]->PPGLBParentHead() : *rgpgn[ stCur ]->PPGLBChildHead();
+              pglb; pglb = iDir ? pglb->PGLBGetNextParent() : pglb->PGLBGetNextChild() )
+        {
+          const _TyGraphNode * pgn = static_cast< const _TyGraphNode * >( iDir ? pglb->PGNBParent() : pglb->PGNBChild() );
+          if ( find( rgpgn.begin(), rgpgn.end(), pgn ) == rgpgn.end() )
+          {
+            rgpgn.push_back( pgn );
+          }
+        }
+      }
+    }
+    vector< int > rgiNodeElsExpected;
+    vector< int > rgiLinkElsExpected;
+    vector< _graph_edge_pos > rgEdgesExpected;
+    for ( size_t stParent = 0; stParent < rgpgn.size(); ++stParent )
+    {
+      rgiNodeElsExpected.push_back( rgpgn[ stParent ]->RElConst() );
+      _TyGNIndex u = 0;
+      for ( const _TyGraphLinkBaseBase * pglb = *rgpgn[ stParent ]->PPGLBChildHead(); pglb; pglb = pglb->PGLBGetNextChild(), ++u )
+      {
+        size_t stChild = find( rgpgn.begin(), rgpgn.end(), static_cast< const _TyGraphNode * >( pglb->PGNBChild() ) ) - rgpgn.begin();
+        _graph_edge_pos ep = { stParent, stChild, u };
+        rgEdgesExpected.push_back( ep );
+        rgiLinkElsExpected.push_back( static_cast< const _TyGraphLink * >( pglb )->RElConst() );
+      }
+    }
+
+    vector< int > rgiNodeEls;
+    vector< int > rgiLinkEls;
+    vector< _graph_edge_pos > rgEdges;
+    g.export_edge_list( rgiNodeEls, rgiLinkEls, rgEdges );
+    bool fEdges = ( rgiNodeEls == rgiNodeElsExpected ) && ( rgiLinkEls == rgiLinkElsExpected ) &&
+                  ( rgEdges.size() == rgEdgesExpected.size() );
+    for ( size_t st = 0; fEdges && ( st < rgEdges.size() ); ++st )
+    {
+      fEdges = ( rgEdges[ st ].m_stParent == rgEdgesExpected[ st ].m_stParent ) &&
+               ( rgEdges[ st ].m_stChild == rgEdgesExpected[ st ].m_stChild ) &&
+               ( rgEdges[ st ].m_uPosition == rgEdgesExpected[ st ].m_uPosition );
+    }
+    _Check( fEdges, "export_edge_list() numbers breadth-first and lists the edges by parent", uSeed );
+
+    vector< int > rgiCSRNodeEls;
+    vector< size_t > rgstOffsets;
+    vector< size_t > rgstChildren;
+    g.export_csr( rgiCSRNodeEls, rgstOffsets, rgstChildren, rgiLinkEls );
+    bool fCSR = ( rgiCSRNodeEls == rgiNodeElsExpected ) && ( rgiLinkEls == rgiLinkElsExpected ) &&
+                ( rgstOffsets.size() == rgpgn.size() + 1 ) && !rgstOffsets[ 0 ] &&
+                ( rgstOffsets.back() == rgEdgesExpected.size() ) && ( rgstChildren.size() == rgEdgesExpected.size() );
+    for ( size_t st = 0; fCSR && ( st < rgEdgesExpected.size() ); ++st )
+    {
+      size_t stParent = rgEdgesExpected[ st ].m_stParent;
+      fCSR = ( rgstChildren[ st ] == rgEdgesExpected[ st ].m_stChild ) &&
+             ( rgstOffsets[ stParent ] + rgEdgesExpected[ st ].m_uPosition == st ) && ( st < rgstOffsets[ stParent + 1 ] );
+    }
+    _Check( fCSR, "export_csr() agrees with the edges", uSeed );
+
+    vector< _graph_edge< int > > rgEdgesLoad;
+    for ( size_t st = 0; st < rgEdges.size(); ++st )
+    {
+      _graph_edge< int > e = { rgEdges[ st ].m_stParent, rgEdges[ st ].m_stChild, rgiLinkElsExpected[ st ] };
+      rgEdgesLoad.push_back( e );
+    }
+    _TyGraph gLoad;
+    gLoad.replace_edge_list( &rgiNodeEls[ 0 ], rgiNodeEls.size(), rgEdgesLoad.empty() ? 0 : &rgEdgesLoad[ 0 ], rgEdgesLoad.size() );
+    vector< long > rglWalk;
+    vector< long > rglWalkLoad;
+    _CanonicalWalk( g, false, rglWalk );
+    _CanonicalWalk( gLoad, false, rglWalkLoad );
+    bool fSame = ( rglWalk == rglWalkLoad );
+    _Check( fSame, "the loaded export has the same child lists", uSeed );
+  }
+}
+
+// Two nodes are in the same component exactly when each reaches the other. Serial component ids
+//  are in reverse topological order and the condensation has one link per related pair of components:
+static void
+_TestSCC()
+{
+  for ( unsigned uSeed = 0; uSeed < s_kuSeeds; ++uSeed )
+  {
+    _TyGraph g;
+    _CreateGraph( g, uSeed );
+    _csr csr( g );
+    vector< vector< bool > > rgrgfReach;
+    _Reachability( csr, rgrgfReach );
+    for ( unsigned uThreads = 0; uThreads <= 3; ++uThreads )
+    {
+      _graph_scc< _TyGraph > scc( g );
+      if ( uThreads )
+      {
+        scc.compute_parallel( uThreads );
+      }
+      else
+      {
+        scc.compute();
+      }
+      bool fSame = true;
+      bool fAcyclic = true;
+      for ( size_t stA = 0; stA < csr.StNodes(); ++stA )
+      {
+        for ( size_t stB = 0; stB < csr.StNodes(); ++stB )
+        {
+          bool fMutual = rgrgfReach[ stA ][ stB ] && rgrgfReach[ stB ][ stA ];
+          fSame = fSame && ( ( scc.StComponent( stA ) == scc.StComponent( stB ) ) == fMutual );
+          fAcyclic = fAcyclic && ( ( stA == stB ) || !fMutual );
+        }
+        for ( size_t stEdge = csr.m_rgstOffsets[ stA ]; stEdge < csr.m_rgstOffsets[ stA + 1 ]; ++stEdge )
+        {
+          fAcyclic = fAcyclic && ( csr.m_rgstChildren[ stEdge ] != stA );
+        }
+      }
+      _Check( fSame, "components are the mutually reachable nodes", uSeed );
+      _Check( scc.FAcyclic() == fAcyclic, "FAcyclic()", uSeed );
+
+      vector< pair< size_t, size_t > > rgpr;
+      bool fOrder = true;
+      for ( size_t st = 0; st < csr.StNodes(); ++st )
+      {
+        for ( size_t stEdge = csr.m_rgstOffsets[ st ]; stEdge < csr.m_rgstOffsets[ st + 1 ]; ++stEdge )
+        {
+          size_t stCompParent = scc.StComponent( st );
+          size_t stCompChild = scc.StComponent( csr.m_rgstChildren[ stEdge ] );
+          fOrder = fOrder && ( stCompChild <= stCompParent );
+          if ( stCompChild != stCompParent )
+          {
+            rgpr.push_back( make_pair( stCompParent, stCompChild ) );
+          }
+        }
+      }
+      if ( !uThreads )
+      {
+        _Check( fOrder, "serial component ids are in reverse topological order", uSeed );
+      }
+      sort( rgpr.begin(), rgpr.end() );
+      rgpr.erase( unique( rgpr.begin(), rgpr.end() ), rgpr.end() );
+      dgraph< size_t, int, false > gCond;
+      scc.condensation( gCond );
+      _graph_edge_list_exporter< dgraph< size_t, int, false > > geleCond( gCond );
+      _Check( ( geleCond.StNodes() == scc.StComponents() ) && ( geleCond.StLinks() == rgpr.size() ),
+              "the condensation has a link for each related pair of components", uSeed );
+      _Check( gCond.get_root() && ( gCond.get_root()->RElConst() == scc.StComponent( size_t( 0 ) ) ),
+              "the condensation's root is the root's component", uSeed );
+      _graph_scc< dgraph< size_t, int, false > > sccCond( gCond );
+      sccCond.compute();
+      _Check( sccCond.FAcyclic(), "the condensation is acyclic", uSeed );
+    }
+  }
+}
+
+// Brute force: _rgf[ v ] if v is on a cycle - a relation from v leads back to v:
+static void
+_OnCycle( _csr const & _rcsr, vector< vector< bool > > const & _rgrgfReach, vector< bool > & _rgf )
+{
+  _rgf.assign( _rcsr.StNodes(), false );
+  for ( size_t st = 0; st < _rcsr.StNodes(); ++st )
+  {
+    for ( size_t stEdge = _rcsr.m_rgstOffsets[ st ]; stEdge < _rcsr.m_rgstOffsets[ st + 1 ]; ++stEdge )
+    {
+      if ( _rgrgfReach[ _rcsr.m_rgstChildren[ stEdge ] ][ st ] )
+      {
+        _rgf[ st ] = true;
+      }
+    }
+  }
+}
+
+// Acyclic: the order is a permutation with each parent before its children, and a node's level is
+//  the length of the longest path to it from a node with no parents. Cyclic: the order holds exactly
+//  the nodes not reachable from a cycle and RgstCycle() is a cycle:
+static void
+_TestTopologicalSort()
+{
+  for ( unsigned uSeed = 0; uSeed < s_kuSeeds; ++uSeed )
+  {
+    _TyGraph g;
+    _CreateGraph( g, uSeed );
+    _csr csr( g );
+    size_t stNodes = csr.StNodes();
+    vector< vector< bool > > rgrgfReach;
+    _Reachability( csr, rgrgfReach );
+    vector< bool > rgfOnCycle;
+    _OnCycle( csr, rgrgfReach, rgfOnCycle );
+    bool fAcyclic = ( find( rgfOnCycle.begin(), rgfOnCycle.end(), true ) == rgfOnCycle.end() );
+
+    _graph_topological_sort< _TyGraph > gts( g );
+    _Check( gts.compute() == fAcyclic, "compute() returns whether the graph is acyclic", uSeed );
+    vector< size_t > const & rgstOrder = gts.RgstOrder();
+    vector< size_t > rgstPos( stNodes, stNodes );
+    for ( size_t st = 0; st < rgstOrder.size(); ++st )
+    {
+      rgstPos[ rgstOrder[ st ] ] = st;
+    }
+    bool fOrdered = true;
+    for ( size_t st = 0; st < stNodes; ++st )
+    {
+      bool fReachedFromCycle = false;
+      for ( size_t stFrom = 0; stFrom < stNodes; ++stFrom )
+      {
+        fReachedFromCycle = fReachedFromCycle || ( rgfOnCycle[ stFrom ] && rgrgfReach[ stFrom ][ st ] );
+      }
+      fOrdered = fOrdered && ( ( rgstPos[ st ] < stNodes ) == !fReachedFromCycle );
+    }
+    _Check( fOrdered, "the order holds the nodes not reachable from a cycle", uSeed );
+
+    if ( fAcyclic )
+    {
+      // Longest path levels, computed in the order found:
+      vector< size_t > rgstLevel( stNodes, 0 );
+      bool fParentsFirst = true;
+      for ( size_t stOrder = 0; stOrder < rgstOrder.size(); ++stOrder )
+      {
+        size_t st = rgstOrder[ stOrder ];
+        for ( size_t stEdge = csr.m_rgstOffsets[ st ]; stEdge < csr.m_rgstOffsets[ st + 1 ]; ++stEdge )
+        {
+          size_t stChild = csr.m_rgstChildren[ stEdge ];
+          fParentsFirst = fParentsFirst && ( rgstPos[ st ] < rgstPos[ stChild ] );
+          rgstLevel[ stChild ] = max( rgstLevel[ stChild ], rgstLevel[ st ] + 1 );
+        }
+      }
+      _Check( fParentsFirst, "each parent precedes its children", uSeed );
+      bool fLevels = true;
+      for ( size_t stLevel = 0; stLevel < gts.StLevels(); ++stLevel )
+      {
+        for ( size_t st = gts.StLevelBegin( stLevel ); st < gts.StLevelBegin( stLevel + 1 ); ++st )
+        {
+          fLevels = fLevels && ( rgstLevel[ rgstOrder[ st ] ] == stLevel ) &&
+                    ( gts.StLevel( rgstOrder[ st ] ) == stLevel );
+        }
+      }
+      _Check( fLevels && ( gts.StLevelBegin( gts.StLevels() ) == stNodes ),
+              "the level sets are the longest path levels", uSeed );
+    }
+    else
+    {
+      vector< size_t > const & rgstCycle = gts.RgstCycle();
+      bool fCycle = !rgstCycle.empty();
+      for ( size_t st = 0; st < rgstCycle.size(); ++st )
+      {
+        size_t stParent = rgstCycle[ st ];
+        size_t stChild = rgstCycle[ ( st + 1 ) % rgstCycle.size() ];
+        fCycle = fCycle && ( find( csr.m_rgstChildren.begin() + csr.m_rgstOffsets[ stParent ],
+                                   csr.m_rgstChildren.begin() + csr.m_rgstOffsets[ stParent + 1 ],
+                                   stChild ) != csr.m_rgstChildren.begin() + csr.m_rgstOffsets[ stParent + 1 ] );
+      }
+      _Check( fCycle, "RgstCycle() is a cycle", uSeed );
+    }
+  }
+}
+
+// Each node runs once and only after all of its parents have completed - checked by a sequence
+//  number taken at the start and end of each run. A cycle throws bad_graph and the nodes reachable
+//  from it never run. cancel() from the functor stops the run, and an exception from the functor is
+//  rethrown from run():
+static void
+_TestDagExecutor()
+{
+  for ( unsigned uSeed = 0; uSeed < s_kuSeeds; ++uSeed )
+  {
+    _TyGraph g;
+    _CreateGraph( g, uSeed );
+    _csr csr( g );
+    size_t stNodes = csr.StNodes();
+    vector< vector< bool > > rgrgfReach;
+    _Reachability( csr, rgrgfReach );
+    vector< bool > rgfOnCycle;
+    _OnCycle( csr, rgrgfReach, rgfOnCycle );
+    bool fAcyclic = ( find( rgfOnCycle.begin(), rgfOnCycle.end(), true ) == rgfOnCycle.end() );
+
+    _graph_dag_executor< _TyGraph > gde( g );
+    for ( unsigned uThreads = 1; uThreads <= 4; ++uThreads )
+    {
+      atomic< size_t > atSeq( 0 );
+      vector< atomic< size_t > > rgatStart( stNodes );
+      vector< atomic< size_t > > rgatEnd( stNodes );
+      vector< atomic< unsigned > > rgatRuns( stNodes );
+      for ( size_t st = 0; st < stNodes; ++st )
+      {
+        rgatStart[ st ] = rgatEnd[ st ] = 0;
+        rgatRuns[ st ] = 0;
+      }
+      bool fThrew = false;
+      bool fRan = false;
+      try
+      {
+        fRan = gde.run( [&]( const _TyGraph::_TyGraphNode *, size_t _stNode )
+          {
+            rgatStart[ _stNode ] = ++atSeq;
+            ++rgatRuns[ _stNode ];
+            rgatEnd[ _stNode ] = ++atSeq;
+          }, uThreads );
+      }
+      catch( bad_graph const & )
+      {
+        fThrew = true;
+      }
+      _Check( fThrew == !fAcyclic, "run() throws bad_graph exactly for a cycle", uSeed );
+      _Check( fRan == fAcyclic, "an acyclic run completes", uSeed );
+      bool fOnce = true;
+      bool fParentsFirst = true;
+      for ( size_t st = 0; st < stNodes; ++st )
+      {
+        bool fReachedFromCycle = false;
+        for ( size_t stFrom = 0; stFrom < stNodes; ++stFrom )
+        {
+          fReachedFromCycle = fReachedFromCycle || ( rgfOnCycle[ stFrom ] && rgrgfReach[ stFrom ][ st ] );
+        }
+        fOnce = fOnce && ( rgatRuns[ st ] == ( fReachedFromCycle ? 0u : 1u ) ) &&
+                ( !!gde.FRan( st ) == !fReachedFromCycle );
+        for ( size_t stEdge = csr.m_rgstOffsets[ st ]; rgatRuns[ st ] && ( stEdge < csr.m_rgstOffsets[ st + 1 ] ); ++stEdge )
+        {
+          size_t stChild = csr.m_rgstChildren[ stEdge ];
+          fParentsFirst = fParentsFirst && ( !rgatRuns[ stChild ] || ( rgatEnd[ st ] < rgatStart[ stChild ] ) );
+        }
+      }
+      _Check( fOnce, "each node not reachable from a cycle runs once", uSeed );
+      _Check( fParentsFirst, "each node runs after its parents have completed", uSeed );
+    }
+
+    if ( fAcyclic )
+    {
+      // The root is the only node without parents - cancelling from it runs nothing else:
+      atomic< size_t > atRuns( 0 );
+      bool fRan = gde.run( [&]( const _TyGraph::_TyGraphNode *, size_t )
+        {
+          ++atRuns;
+          gde.cancel();
+        }, 4 );
+      _Check( !fRan && gde.FCancelled() && ( atRuns == 1 ), "cancel() stops the run", uSeed );
+      bool fRethrown = false;
+      try
+      {
+        gde.run( []( const _TyGraph::_TyGraphNode *, size_t _stNode )
+          {
+            if ( _stNode == 0 )
+            {
+              throw _graph_nav_except( "_TestDagExecutor()" );
+            }
+          }, 4 );
+      }
+      catch( _graph_nav_except const & )
+      {
+        fRethrown = true;
+      }
+      _Check( fRethrown, "an exception from the functor is rethrown from run()", uSeed );
+    }
+  }
+}
+
+// Weights for the negative weight tests - about a tenth of the links are negative:
+struct _shifted_weight
+{
+  typedef long _TyWeight;
+
+  _TyWeight operator()( int _iEl ) const
+  {
+    return _TyWeight( _iEl ) - 100;
+  }
+};
+
+static const long s_klInfinite = 1L << 40;
+
+// Brute force: Floyd-Warshall over the link weights _rwx( el ):
+template < class t_TyWeightExtractor >
+static void
+_Floyd( _csr const & _rcsr, t_TyWeightExtractor const & _rwx, vector< vector< long > > & _rgrglDist )
+{
+  size_t stNodes = _rcsr.StNodes();
+  _rgrglDist.assign( stNodes, vector< long >( stNodes, s_klInfinite ) );
+  for ( size_t st = 0; st < stNodes; ++st )
+  {
+    _rgrglDist[ st ][ st ] = 0;
+  }
+  for ( size_t st = 0; st < stNodes; ++st )
+  {
+    for ( size_t stEdge = _rcsr.m_rgstOffsets[ st ]; stEdge < _rcsr.m_rgstOffsets[ st + 1 ]; ++stEdge )
+    {
+      long & rl = _rgrglDist[ st ][ _rcsr.m_rgstChildren[ stEdge ] ];
+      rl = min( rl, long( _rwx( _rcsr.m_rgiLinkEls[ stEdge ] ) ) );
+    }
+  }
+  for ( size_t stK = 0; stK < stNodes; ++stK )
+  {
+    for ( size_t stI = 0; stI < stNodes; ++stI )
+    {
+      for ( size_t stJ = 0; ( _rgrglDist[ stI ][ stK ] < s_klInfinite ) && ( stJ < stNodes ); ++stJ )
+      {
+        if ( ( _rgrglDist[ stK ][ stJ ] < s_klInfinite ) &&
+             ( _rgrglDist[ stI ][ stK ] + _rgrglDist[ stK ][ stJ ] < _rgrglDist[ stI ][ stJ ] ) )
+        {
+          _rgrglDist[ stI ][ stJ ] = _rgrglDist[ stI ][ stK ] + _rgrglDist[ stK ][ stJ ];
+        }
+      }
+    }
+  }
+}
+
+// The result of the last query for the target - reached as brute force says, at the brute force
+//  distance, and by a path of that weight from the source:
+template < class t_TyShortestPaths, class t_TyWeightExtractor >
+static bool
+_FShortestPath( t_TyShortestPaths const & _rsp, t_TyWeightExtractor const & _rwx, bool _fReached,
+                size_t _stSource, size_t _stTarget, vector< vector< long > > const & _rgrglDist )
+{
+  typedef typename t_TyShortestPaths::_TyGraphNode _TyGraphNode;
+  typedef typename t_TyShortestPaths::_TyGraphLink _TyGraphLink;
+  long lDist = _rgrglDist[ _stSource ][ _stTarget ];
+  if ( _fReached != ( lDist < s_klInfinite ) )
+  {
+    return false;
+  }
+  if ( !_fReached )
+  {
+    return true;
+  }
+  vector< size_t > rgstNodes;
+  vector< const _TyGraphLink * > rgpgl;
+  if ( ( long( _rsp.WtDistance( _stTarget ) ) != lDist ) ||
+       !_rsp.GetPath( _stTarget, rgstNodes ) || !_rsp.GetPathLinks( _stTarget, rgpgl ) ||
+       ( rgstNodes.size() != rgpgl.size() + 1 ) ||
+       ( rgstNodes.front() != _stSource ) || ( rgstNodes.back() != _stTarget ) )
+  {
+    return false;
+  }
+  long lPath = 0;
+  for ( size_t st = 0; st < rgpgl.size(); ++st )
+  {
+    if ( ( _rsp.RNumbering().StNodeId( static_cast< const _TyGraphNode * >( rgpgl[ st ]->PGNBParent() ) ) != rgstNodes[ st ] ) ||
+         ( _rsp.RNumbering().StNodeId( static_cast< const _TyGraphNode * >( rgpgl[ st ]->PGNBChild() ) ) != rgstNodes[ st + 1 ] ) )
+    {
+      return false;
+    }
+    lPath += long( _rwx( rgpgl[ st ]->RElConst() ) );
+  }
+  return lPath == lDist;
+}
+
+// Dijkstra - to all nodes and stopping at a target - and the bidirectional search against Floyd-Warshall
+//  with the link elements as weights. Bellman-Ford also with weights that may be negative - a
+//  negative cycle is reported exactly when one is reachable from the source:
+static void
+_TestShortestPaths()
+{
+  typedef _graph_link_weight< int, long > _TyWeight;
+  for ( unsigned uSeed = 0; uSeed < s_kuSeeds; ++uSeed )
+  {
+    _TyGraph g;
+    _CreateGraph( g, uSeed );
+    _csr csr( g );
+    size_t stNodes = csr.StNodes();
+    vector< vector< long > > rgrglDist;
+    _Floyd( csr, _TyWeight(), rgrglDist );
+    _graph_shortest_paths< _TyGraph, _TyWeight > gsp( g );
+    bool fDijkstra = true;
+    bool fTarget = true;
+    bool fBidirectional = true;
+    bool fBellmanFord = true;
+    for ( size_t stSource = 0; stSource < stNodes; ++stSource )
+    {
+      gsp.dijkstra( stSource );
+      for ( size_t stTarget = 0; stTarget < stNodes; ++stTarget )
+      {
+        fDijkstra = fDijkstra && _FShortestPath( gsp, _TyWeight(), gsp.FReached( stTarget ), stSource, stTarget, rgrglDist );
+      }
+      gsp.bellman_ford( stSource );
+      for ( size_t stTarget = 0; stTarget < stNodes; ++stTarget )
+      {
+        fBellmanFord = fBellmanFord && _FShortestPath( gsp, _TyWeight(), gsp.FReached( stTarget ), stSource, stTarget, rgrglDist );
+      }
+      for ( size_t stTarget = 0; stTarget < stNodes; ++stTarget )
+      {
+        bool fReached = gsp.dijkstra( stSource, stTarget );
+        fTarget = fTarget && _FShortestPath( gsp, _TyWeight(), fReached, stSource, stTarget, rgrglDist );
+        fReached = gsp.bidirectional( stSource, stTarget );
+        fBidirectional = fBidirectional && _FShortestPath( gsp, _TyWeight(), fReached, stSource, stTarget, rgrglDist );
+      }
+    }
+    _Check( fDijkstra, "dijkstra() finds the shortest paths", uSeed );
+    _Check( fTarget, "dijkstra() to a target finds the shortest path", uSeed );
+    _Check( fBidirectional, "bidirectional() finds the shortest path", uSeed );
+    _Check( fBellmanFord, "bellman_ford() finds the shortest paths", uSeed );
+
+    _Floyd( csr, _shifted_weight(), rgrglDist );
+    _graph_shortest_paths< _TyGraph, _shifted_weight > gspShifted( g );
+    bool fNegativeCycle = true;
+    fBellmanFord = true;
+    for ( size_t stSource = 0; stSource < stNodes; ++stSource )
+    {
+      bool fReachesNegativeCycle = false;
+      for ( size_t st = 0; st < stNodes; ++st )
+      {
+        fReachesNegativeCycle = fReachesNegativeCycle ||
+          ( ( rgrglDist[ stSource ][ st ] < s_klInfinite ) && ( rgrglDist[ st ][ st ] < 0 ) );
+      }
+      bool fNoCycle = gspShifted.bellman_ford( stSource );
+      fNegativeCycle = fNegativeCycle && ( fNoCycle == !fReachesNegativeCycle ) &&
+                       ( gspShifted.FNegativeCycle() == fReachesNegativeCycle );
+      for ( size_t stTarget = 0; fNoCycle && ( stTarget < stNodes ); ++stTarget )
+      {
+        fBellmanFord = fBellmanFord && _FShortestPath( gspShifted, _shifted_weight(), gspShifted.FReached( stTarget ),
+                                                       stSource, stTarget, rgrglDist );
+      }
+    }
+    _Check( fNegativeCycle, "bellman_ford() reports a reachable negative cycle", uSeed );
+    _Check( fBellmanFord, "bellman_ford() finds the shortest paths with negative weights", uSeed );
+  }
+}
+
+// Whether the index - through both the non-const and the const query - agrees with brute force
+//  reachability over the node ids of <_rgele>:
+template < class t_TyIndex, class t_TyNumbering >
+static bool
+_FIndexAgrees( t_TyIndex & _rri, t_TyNumbering const & _rgele, vector< vector< bool > > const & _rgrgfReach )
+{
+  typename t_TyIndex::_query_scratch qs;
+  bool fAgrees = true;
+  for ( size_t stFrom = 0; stFrom < _rgele.StNodes(); ++stFrom )
+  {
+    for ( size_t stTo = 0; stTo < _rgele.StNodes(); ++stTo )
+    {
+      const _TyGraph::_TyGraphNode * pgnFrom = _rgele.PGNNode( stFrom );
+      const _TyGraph::_TyGraphNode * pgnTo = _rgele.PGNNode( stTo );
+      fAgrees = fAgrees && ( static_cast< t_TyIndex const & >( _rri ).FReachable( pgnFrom, pgnTo, qs ) == _rgrgfReach[ stFrom ][ stTo ] );
+    }
+  }
+  for ( size_t stFrom = 0; stFrom < _rgele.StNodes(); ++stFrom )
+  {
+    for ( size_t stTo = 0; stTo < _rgele.StNodes(); ++stTo )
+    {
+      fAgrees = fAgrees && ( _rri.FReachable( _rgele.PGNNode( stFrom ), _rgele.PGNNode( stTo ) ) == _rgrgfReach[ stFrom ][ stTo ] );
+    }
+  }
+  return fAgrees;
+}
+
+// Every query against brute force - as built, then after each of a series of links is added and
+//  some removed again. link_added() leaves the index valid exactly when the parent already reached
+//  the child - the const query of a stale index searches the graph:
+static void
+_TestReachabilityIndex()
+{
+  typedef _TyGraph::_TyGraphNode _TyGraphNode;
+  typedef _TyGraph::_TyGraphLink _TyGraphLink;
+  typedef _TyGraphNode::_TyGraphLinkBaseBase _TyGraphLinkBaseBase;
+  typedef _graph_edge_list_exporter< _TyGraph > _TyNumbering;
+  for ( unsigned uSeed = 0; uSeed < s_kuSeeds; ++uSeed )
+  {
+    _TyGraph g;
+    _CreateGraph( g, uSeed );
+    vector< vector< bool > > rgrgfReach;
+    _Reachability( _csr( g ), rgrgfReach );
+    _graph_reachability_index< _TyGraph > gri( g );
+    _Check( !gri.FStale() && _FIndexAgrees( gri, _TyNumbering( g ), rgrgfReach ), "the index answers as built", uSeed );
+
+    // The brute force is by the node ids of a numbering of the current graph - as is _csr:
+    mt19937 gen( uSeed );
+    bool fStale = true;
+    bool fAgrees = true;
+    for ( unsigned uStep = 0; uStep < 16; ++uStep )
+    {
+      _TyNumbering gele( g );
+      size_t stParent = gen() % gele.StNodes();
+      size_t stChild = gen() % gele.StNodes();
+      bool fReached = rgrgfReach[ stParent ][ stChild ];
+      _TyGraphNode * pgnParent = const_cast< _TyGraphNode * >( gele.PGNNode( stParent ) );
+      _TyGraphNode * pgnChild = const_cast< _TyGraphNode * >( gele.PGNNode( stChild ) );
+      _TyGraphLink * pgl = g.create_link1< int >( 0 );
+      pgnParent->AddChild( *pgnChild, *pgl, *_TyGraphLinkBaseBase::PPGLBGetNthChild( pgnParent->PPGLBChildHead(), 0 ),
+                           *_TyGraphLinkBaseBase::PPGLBGetNthParent( pgnChild->PPGLBParentHead(), 0 ) );
+      gri.link_added( pgnParent, pgnChild );
+      fStale = fStale && ( gri.FStale() == !fReached );
+      _Reachability( _csr( g ), rgrgfReach );
+      fAgrees = fAgrees && _FIndexAgrees( gri, _TyNumbering( g ), rgrgfReach );
+      if ( gen() % 2 )
+      {
+        // The link is not needed to reach any node from the root:
+        pgl->RemoveChild();
+        pgl->RemoveParent();
+        g.destroy_link( pgl );
+        gri.link_removed();
+        fStale = fStale && gri.FStale();
+        _Reachability( _csr( g ), rgrgfReach );
+        fAgrees = fAgrees && _FIndexAgrees( gri, _TyNumbering( g ), rgrgfReach );
+      }
+    }
+    _Check( fStale, "link_added() and link_removed() make the index stale exactly when needed", uSeed );
+    _Check( fAgrees, "the index answers after mutation", uSeed );
+  }
+}
+
+// Brute force: the nodes reachable from <_stFrom> by one or more links:
+static void
+_Descendants( _csr const & _rcsr, size_t _stFrom, vector< bool > & _rgf )
+{
+  _rgf.assign( _rcsr.StNodes(), false );
+  vector< size_t > rgstStack( 1, _stFrom );
+  while ( !rgstStack.empty() )
+  {
+    size_t st = rgstStack.back();
+    rgstStack.pop_back();
+    for ( size_t stEdge = _rcsr.m_rgstOffsets[ st ]; stEdge < _rcsr.m_rgstOffsets[ st + 1 ]; ++stEdge )
+    {
+      size_t stChild = _rcsr.m_rgstChildren[ stEdge ];
+      if ( !_rgf[ stChild ] )
+      {
+        _rgf[ stChild ] = true;
+        rgstStack.push_back( stChild );
+      }
+    }
+  }
+}
+
+// The compressed bitset against set< uint32_t > - sparse, and dense enough that containers become
+//  bitmaps and bitmaps are joined by the bitmap kernels. Then the closure of each acyclic random
+//  graph against brute force - plus a graph large enough for its sets to hold bitmaps. A cyclic
+//  graph throws bad_graph:
+static void
+_TestTransitiveClosure()
+{
+  for ( unsigned uSeed = 0; uSeed < 16; ++uSeed )
+  {
+    mt19937 gen( uSeed );
+    _graph_compressed_bitset rgcbs[ 2 ];
+    set< uint32_t > rgset[ 2 ];
+    for ( unsigned u = 0; u < 2; ++u )
+    {
+      // The range per set is 2^16 to 2^20 values, the count up to 2^15:
+      uint32_t uRange = uint32_t( 1 ) << ( 16 + gen() % 5 );
+      for ( size_t st = gen() % 32768; st--; )
+      {
+        uint32_t uValue = gen() % uRange;
+        rgcbs[ u ].insert( uValue );
+        rgset[ u ].insert( uValue );
+      }
+    }
+    rgcbs[ 0 ].union_with( rgcbs[ 1 ] );
+    rgset[ 0 ].insert( rgset[ 1 ].begin(), rgset[ 1 ].end() );
+    bool fContains = true;
+    for ( unsigned u = 0; u < 4096; ++u )
+    {
+      uint32_t uValue = gen() % ( uint32_t( 1 ) << 20 );
+      fContains = fContains && ( rgcbs[ 0 ].FContains( uValue ) == !!rgset[ 0 ].count( uValue ) );
+    }
+    _Check( ( rgcbs[ 0 ].size() == rgset[ 0 ].size() ) &&
+            equal( rgcbs[ 0 ].begin(), rgcbs[ 0 ].end(), rgset[ 0 ].begin() ) && fContains,
+            "the union of compressed bitsets", uSeed );
+  }
+
+  for ( unsigned uSeed = 0; uSeed <= s_kuSeeds; ++uSeed )
+  {
+    _TyGraph g;
+    if ( uSeed < s_kuSeeds )
+    {
+      _CreateGraph( g, uSeed );
+    }
+    else
+    {
+      CreateTestGraphRandom( g, 20000, 20000, true, uSeed );
+    }
+    _csr csr( g );
+    size_t stNodes = csr.StNodes();
+    vector< vector< bool > > rgrgfReach;
+    if ( stNodes <= 1000 )
+    {
+      _Reachability( csr, rgrgfReach );
+    }
+    _graph_transitive_closure< _TyGraph > gtc( g );
+    bool fThrew = false;
+    try
+    {
+      gtc.compute();
+    }
+    catch( bad_graph const & )
+    {
+      fThrew = true;
+    }
+    if ( fThrew )
+    {
+      vector< bool > rgfOnCycle;
+      _OnCycle( csr, rgrgfReach, rgfOnCycle );
+      _Check( find( rgfOnCycle.begin(), rgfOnCycle.end(), true ) != rgfOnCycle.end(),
+              "compute() throws bad_graph only for a cycle", uSeed );
+      continue;
+    }
+    bool fDescendants = true;
+    vector< bool > rgfDescendants;
+    for ( size_t stFrom = 0; stFrom < stNodes; stFrom += ( stNodes <= 1000 ) ? 1 : 97 )
+    {
+      _Descendants( csr, stFrom, rgfDescendants );
+      size_t stDescendants = 0;
+      for ( size_t stTo = 0; stTo < stNodes; ++stTo )
+      {
+        stDescendants += rgfDescendants[ stTo ];
+        fDescendants = fDescendants && ( gtc.FDescendant( stFrom, stTo ) == rgfDescendants[ stTo ] );
+      }
+      vector< size_t > rgst;
+      gtc.CopyDescendants( stFrom, back_inserter( rgst ) );
+      fDescendants = fDescendants && ( gtc.StDescendants( stFrom ) == stDescendants ) && ( rgst.size() == stDescendants );
+      for ( size_t st = 0; fDescendants && ( st < rgst.size() ); ++st )
+      {
+        fDescendants = rgfDescendants[ rgst[ st ] ] &&
+                       ( !st || ( gtc.StPosition( rgst[ st - 1 ] ) < gtc.StPosition( rgst[ st ] ) ) );
+      }
+    }
+    _Check( fDescendants, "the closure holds the descendants of each node", uSeed );
+  }
+}
+
+// Whether the last computation of <_rgd> agrees with brute force over <_rgrgst> from <_stEntry>:
+//  d dominates v exactly when v is reached and every path from the entry to v passes d, the
+//  immediate dominator is the strict dominator that all others dominate, and the dominator tree
+//  links each reached node from its immediate dominator:
+template < class t_TyDominators >
+static bool
+_FDominatorsAgree( t_TyDominators const & _rgd, vector< vector< size_t > > const & _rgrgst, size_t _stEntry )
+{
+  size_t stNodes = _rgrgst.size();
+  vector< bool > rgfReached( stNodes );
+  for ( size_t st = 0; st < stNodes; ++st )
+  {
+    rgfReached[ st ] = _FReachesAvoiding( _rgrgst, _stEntry, st, t_TyDominators::s_kstNull );
+  }
+  // The virtual exit - if any - is the last node and has no id of its own:
+  size_t stIds = _rgd.StNodes();
+  bool fAgree = ( _rgd.StEntry() == _stEntry );
+  vector< vector< bool > > rgrgfDom( stNodes, vector< bool >( stNodes ) );
+  for ( size_t stV = 0; stV < stNodes; ++stV )
+  {
+    for ( size_t stD = 0; stD < stNodes; ++stD )
+    {
+      rgrgfDom[ stD ][ stV ] = rgfReached[ stV ] && ( ( stD == stV ) || !_FReachesAvoiding( _rgrgst, _stEntry, stV, stD ) );
+      if ( ( stD < stIds ) && ( stV < stIds ) )
+      {
+        fAgree = fAgree && ( _rgd.FDominates( stD, stV ) == rgrgfDom[ stD ][ stV ] );
+      }
+    }
+  }
+  for ( size_t stV = 0; stV < stIds; ++stV )
+  {
+    fAgree = fAgree && ( _rgd.FReached( stV ) == rgfReached[ stV ] );
+    size_t stIDom = _rgd.StIDom( stV );
+    if ( !rgfReached[ stV ] || ( stV == _stEntry ) )
+    {
+      fAgree = fAgree && ( stIDom == t_TyDominators::s_kstNull );
+      continue;
+    }
+    fAgree = fAgree && ( stIDom < stNodes ) && ( stIDom != stV ) && rgrgfDom[ stIDom ][ stV ];
+    for ( size_t stD = 0; fAgree && ( stD < stNodes ); ++stD )
+    {
+      fAgree = ( stD == stV ) || !rgrgfDom[ stD ][ stV ] || rgrgfDom[ stD ][ stIDom ];
+    }
+  }
+
+  typedef dgraph< size_t, int, false > _TyTree;
+  _TyTree gTree;
+  _rgd.dominator_tree( gTree );
+  _graph_edge_list_exporter< _TyTree > geleTree( gTree );
+  fAgree = fAgree && ( geleTree.StNodes() == size_t( count( rgfReached.begin(), rgfReached.end(), true ) ) ) &&
+           ( gTree.get_root()->RElConst() == _stEntry );
+  for ( size_t st = 0; fAgree && ( st < geleTree.StNodes() ); ++st )
+  {
+    const _TyTree::_TyGraphNode * pgn = geleTree.PGNNode( st );
+    const _TyTree::_TyGraphNode::_TyGraphLinkBaseBase * pglb = *pgn->PPGLBParentHead();
+    if ( pgn->RElConst() == _stEntry )
+    {
+      fAgree = !pglb;
+    }
+    else
+    {
+      fAgree = pglb && !pglb->PGLBGetNextParent() && ( pgn->RElConst() < stIds ) &&
+               ( static_cast< const _TyTree::_TyGraphNode * >( pglb->PGNBParent() )->RElConst() == _rgd.StIDom( pgn->RElConst() ) );
+    }
+  }
+  return fAgree;
+}
+
+// Dominators from the root, post-dominators from a given exit and from the virtual exit - each
+//  against brute force on the graph, the reversed graph and the reversed graph with the virtual exit:
+static void
+_TestDominators()
+{
+  for ( unsigned uSeed = 0; uSeed < s_kuSeeds; ++uSeed )
+  {
+    _TyGraph g;
+    _CreateGraph( g, uSeed );
+    _csr csr( g );
+    size_t stNodes = csr.StNodes();
+    vector< vector< size_t > > rgrgstChildren( stNodes );
+    vector< vector< size_t > > rgrgstParents( stNodes );
+    for ( size_t st = 0; st < stNodes; ++st )
+    {
+      for ( size_t stEdge = csr.m_rgstOffsets[ st ]; stEdge < csr.m_rgstOffsets[ st + 1 ]; ++stEdge )
+      {
+        rgrgstChildren[ st ].push_back( csr.m_rgstChildren[ stEdge ] );
+        rgrgstParents[ csr.m_rgstChildren[ stEdge ] ].push_back( st );
+      }
+    }
+    _graph_dominators< _TyGraph > gd( g );
+    gd.compute();
+    _Check( !gd.FPost() && _FDominatorsAgree( gd, rgrgstChildren, 0 ), "dominators from the root", uSeed );
+
+    size_t stExit = mt19937( uSeed )() % stNodes;
+    gd.compute_post( gd.RNumbering().PGNNode( stExit ) );
+    _Check( gd.FPost() && _FDominatorsAgree( gd, rgrgstParents, stExit ), "post-dominators from an exit", uSeed );
+
+    // The virtual exit is the parent of every node without children:
+    rgrgstParents.push_back( vector< size_t >() );
+    for ( size_t st = 0; st < stNodes; ++st )
+    {
+      if ( rgrgstChildren[ st ].empty() )
+      {
+        rgrgstParents[ stNodes ].push_back( st );
+      }
+    }
+    gd.compute_post();
+    _Check( gd.FPost() && _FDominatorsAgree( gd, rgrgstParents, stNodes ), "post-dominators from the virtual exit", uSeed );
+  }
+}
+
+// Small graphs over few element values, so that graphs built independently are sometimes equal,
+//  and copies with one element changed. equal_structure() - with and without hashes, and against
+//  a safe graph - must agree with a comparison of the canonical walks, and equal graphs must hash
+//  equally:
+static void
+_TestStructuralEquality()
+{
+  const unsigned kuGraphs = 64;
+  vector< _TyGraph > rgg( 2 * kuGraphs );
+  mt19937 gen( 0 );
+  for ( unsigned u = 0; u < kuGraphs; ++u )
+  {
+    size_t stNodes = 1 + gen() % 4;
+    vector< int > rgiNodeEls;
+    vector< _graph_edge< int > > rgEdges;
+    for ( size_t st = 0; st < stNodes; ++st )
+    {
+      rgiNodeEls.push_back( int( gen() % 2 ) );
+    }
+    for ( size_t st = 1; st < stNodes; ++st )
+    {
+      _graph_edge< int > e = { gen() % st, st, int( gen() % 2 ) };
+      rgEdges.push_back( e );
+    }
+    for ( size_t st = gen() % 3; st--; )
+    {
+      _graph_edge< int > e = { gen() % stNodes, gen() % stNodes, int( gen() % 2 ) };
+      rgEdges.push_back( e );
+    }
+    rgg[ u ].replace_edge_list( &rgiNodeEls[ 0 ], stNodes, rgEdges.empty() ? 0 : &rgEdges[ 0 ], rgEdges.size() );
+    // A copy with one element changed - of a node or of a link:
+    size_t stChange = gen() % ( stNodes + rgEdges.size() );
+    if ( stChange < stNodes )
+    {
+      rgiNodeEls[ stChange ] += 2;
+    }
+    else
+    {
+      rgEdges[ stChange - stNodes ].m_el += 2;
+    }
+    rgg[ kuGraphs + u ].replace_edge_list( &rgiNodeEls[ 0 ], stNodes, rgEdges.empty() ? 0 : &rgEdges[ 0 ], rgEdges.size() );
+  }
+
+  vector< vector< long > > rgrglWalks( rgg.size() );
+  vector< size_t > rgstHashes;
+  for ( size_t st = 0; st < rgg.size(); ++st )
+  {
+    _CanonicalWalk( rgg[ st ], true, rgrglWalks[ st ] );
+    rgstHashes.push_back( rgg[ st ].structural_hash() );
+  }
+  unsigned uEqual = 0;
+  bool fEqual = true;
+  bool fHashes = true;
+  for ( size_t stA = 0; stA < rgg.size(); ++stA )
+  {
+    for ( size_t stB = 0; stB < rgg.size(); ++stB )
+    {
+      bool fSame = ( rgrglWalks[ stA ] == rgrglWalks[ stB ] );
+      uEqual += ( stA != stB ) && fSame;
+      fEqual = fEqual && ( rgg[ stA ].equal_structure( rgg[ stB ] ) == fSame ) &&
+               ( rgg[ stA ].equal_structure( rgg[ stB ], rgstHashes[ stA ], rgstHashes[ stB ] ) == fSame );
+      fHashes = fHashes && ( !fSame || ( rgstHashes[ stA ] == rgstHashes[ stB ] ) );
+    }
+    _TyGraph gCopy( rgg[ stA ] );
+    dgraph< int, int, true > gSafe( rgg[ stA ] );
+    fEqual = fEqual && rgg[ stA ].equal_structure( gCopy ) && rgg[ stA ].equal_structure( gSafe ) &&
+             ( gCopy.structural_hash() == rgstHashes[ stA ] );
+  }
+  _Check( fEqual, "equal_structure() agrees with the canonical walk", 0 );
+  _Check( fHashes, "equal graphs hash equally", 0 );
+  _Check( uEqual > 0, "independently built graphs are sometimes equal", 0 );
+}
+
+// Trees - answered from the Euler tour - then the random graphs with their extra links, where
+//  the nodes that aren't tree exact fall back to the ancestor sets. Brute force: the lowest common
+//  ancestors are the common ancestors none of whose children is one - if every common ancestor
+//  has such a child a single common ancestor is returned:
+static void
+_TestLowestCommonAncestors()
+{
+  for ( unsigned uSeed = 0; uSeed < 2 * s_kuSeeds; ++uSeed )
+  {
+    _TyGraph g;
+    bool fTree = ( uSeed < s_kuSeeds );
+    if ( fTree )
+    {
+      CreateTestGraphRandom( g, s_krgstNodes[ uSeed % s_kstSizes ], 0, true, uSeed );
+    }
+    else
+    {
+      _CreateGraph( g, uSeed - s_kuSeeds );
+    }
+    _csr csr( g );
+    size_t stNodes = csr.StNodes();
+    vector< vector< bool > > rgrgfReach;
+    _Reachability( csr, rgrgfReach );
+    _graph_lca_index< _TyGraph > gli( g );
+    bool fExact = true;
+    bool fAncestor = true;
+    bool fLcas = true;
+    for ( size_t stA = 0; stA < stNodes; ++stA )
+    {
+      fExact = fExact && ( !fTree || gli.FTreeExact( stA ) );
+      for ( size_t stB = 0; stB < stNodes; ++stB )
+      {
+        fAncestor = fAncestor && ( gli.FAncestor( stA, stB ) == rgrgfReach[ stA ][ stB ] );
+        vector< size_t > rgstCommon;
+        vector< size_t > rgstLcas;
+        for ( size_t st = 0; st < stNodes; ++st )
+        {
+          if ( rgrgfReach[ st ][ stA ] && rgrgfReach[ st ][ stB ] )
+          {
+            rgstCommon.push_back( st );
+            bool fLowest = true;
+            for ( size_t stEdge = csr.m_rgstOffsets[ st ]; stEdge < csr.m_rgstOffsets[ st + 1 ]; ++stEdge )
+            {
+              size_t stChild = csr.m_rgstChildren[ stEdge ];
+              fLowest = fLowest && !( rgrgfReach[ stChild ][ stA ] && rgrgfReach[ stChild ][ stB ] );
+            }
+            if ( fLowest )
+            {
+              rgstLcas.push_back( st );
+            }
+          }
+        }
+        vector< size_t > rgstGot;
+        gli.GetLcas( stA, stB, rgstGot );
+        size_t stLca = gli.StLca( stA, stB );
+        const _TyGraph::_TyGraphNode * pgnLca = gli.PGNLca( gli.RNumbering().PGNNode( stA ), gli.RNumbering().PGNNode( stB ) );
+        fLcas = fLcas && ( pgnLca == ( ( stLca == gli.s_kstNull ) ? 0 : gli.RNumbering().PGNNode( stLca ) ) );
+        if ( !rgstLcas.empty() )
+        {
+          fLcas = fLcas && ( rgstGot == rgstLcas ) && ( find( rgstLcas.begin(), rgstLcas.end(), stLca ) != rgstLcas.end() );
+        }
+        else
+        if ( !rgstCommon.empty() )
+        {
+          fLcas = fLcas && ( rgstGot.size() == 1 ) && ( stLca == rgstGot[ 0 ] ) &&
+                  ( find( rgstCommon.begin(), rgstCommon.end(), stLca ) != rgstCommon.end() );
+        }
+        else
+        {
+          fLcas = fLcas && rgstGot.empty() && ( stLca == gli.s_kstNull );
+        }
+      }
+    }
+    _Check( fExact, "the nodes of a tree are tree exact", uSeed );
+    _Check( fAncestor, "FAncestor()", uSeed );
+    _Check( fLcas, "the lowest common ancestors", uSeed );
+  }
+}
+
+// Brute force: the ranks by power iteration over the CSR arrays - teleporting by <_rrgdblTeleport>,
+//  the rank of nodes without children redistributed by it too:
+static void
+_PowerIteration( _csr const & _rcsr, double _dblDamping, vector< double > const & _rrgdblTeleport,
+                 vector< double > & _rrgdblRank )
+{
+  size_t stNodes = _rcsr.StNodes();
+  _rrgdblRank = _rrgdblTeleport;
+  for ( unsigned uIteration = 0; uIteration < 2000; ++uIteration )
+  {
+    vector< double > rgdblNext( stNodes, 0.0 );
+    double dblDangling = 0.0;
+    for ( size_t st = 0; st < stNodes; ++st )
+    {
+      size_t stChildren = _rcsr.m_rgstOffsets[ st + 1 ] - _rcsr.m_rgstOffsets[ st ];
+      if ( !stChildren )
+      {
+        dblDangling += _rrgdblRank[ st ];
+      }
+      for ( size_t stEdge = _rcsr.m_rgstOffsets[ st ]; stEdge < _rcsr.m_rgstOffsets[ st + 1 ]; ++stEdge )
+      {
+        rgdblNext[ _rcsr.m_rgstChildren[ stEdge ] ] += _dblDamping * _rrgdblRank[ st ] / double( stChildren );
+      }
+    }
+    for ( size_t st = 0; st < stNodes; ++st )
+    {
+      rgdblNext[ st ] += ( 1.0 - _dblDamping + _dblDamping * dblDangling ) * _rrgdblTeleport[ st ];
+    }
+    _rrgdblRank.swap( rgdblNext );
+  }
+}
+
+static bool
+_FRanksAgree( vector< double > const & _rrgdbl, vector< double > const & _rrgdblExpected )
+{
+  bool fAgree = ( _rrgdbl.size() == _rrgdblExpected.size() );
+  double dblSum = 0.0;
+  for ( size_t st = 0; fAgree && ( st < _rrgdbl.size() ); ++st )
+  {
+    fAgree = ( fabs( _rrgdbl[ st ] - _rrgdblExpected[ st ] ) < 1.0e-8 );
+    dblSum += _rrgdbl[ st ];
+  }
+  return fAgree && ( fabs( dblSum - 1.0 ) < 1.0e-9 );
+}
+
+// The view's arrays and degree statistics against the exported CSR arrays, then PageRank and
+//  personalized PageRank on 1 to 4 threads against power iteration. The ranks are written back
+//  to the elements:
+static void
+_TestFrozenViewRanks()
+{
+  for ( unsigned uSeed = 0; uSeed < s_kuSeeds; ++uSeed )
+  {
+    _TyGraph g;
+    _CreateGraph( g, uSeed );
+    _csr csr( g );
+    size_t stNodes = csr.StNodes();
+    _graph_frozen_view< _TyGraph > gfv( g );
+    vector< vector< size_t > > rgrgstParents( stNodes );
+    for ( size_t st = 0; st < stNodes; ++st )
+    {
+      for ( size_t stEdge = csr.m_rgstOffsets[ st ]; stEdge < csr.m_rgstOffsets[ st + 1 ]; ++stEdge )
+      {
+        rgrgstParents[ csr.m_rgstChildren[ stEdge ] ].push_back( st );
+      }
+    }
+    bool fView = ( gfv.StNodes() == stNodes ) && ( gfv.StLinks() == csr.m_rgstChildren.size() ) &&
+                 ( gfv.RgstChildOffsets() == csr.m_rgstOffsets ) && ( gfv.RgstChildren() == csr.m_rgstChildren );
+    _graph_degree_stats gdsExpected = { stNodes, csr.m_rgstChildren.size(), 0, 0, 0, 0, double( csr.m_rgstChildren.size() ) / double( stNodes ) };
+    for ( size_t st = 0; fView && ( st < stNodes ); ++st )
+    {
+      fView = ( gfv.StParents( st ) == rgrgstParents[ st ].size() ) &&
+              equal( rgrgstParents[ st ].begin(), rgrgstParents[ st ].end(),
+                     gfv.RgstParents().begin() + gfv.RgstParentOffsets()[ st ] );
+      size_t stChildren = csr.m_rgstOffsets[ st + 1 ] - csr.m_rgstOffsets[ st ];
+      gdsExpected.m_stMaxChildren = max( gdsExpected.m_stMaxChildren, stChildren );
+      gdsExpected.m_stMaxParents = max( gdsExpected.m_stMaxParents, rgrgstParents[ st ].size() );
+      gdsExpected.m_stSources += rgrgstParents[ st ].empty();
+      gdsExpected.m_stSinks += !stChildren;
+    }
+    _Check( fView, "the view's child and parent arrays", uSeed );
+    _graph_degree_stats gds;
+    gfv.GetDegreeStats( gds );
+    _Check( ( gds.m_stNodes == gdsExpected.m_stNodes ) && ( gds.m_stLinks == gdsExpected.m_stLinks ) &&
+            ( gds.m_stMaxChildren == gdsExpected.m_stMaxChildren ) && ( gds.m_stMaxParents == gdsExpected.m_stMaxParents ) &&
+            ( gds.m_stSources == gdsExpected.m_stSources ) && ( gds.m_stSinks == gdsExpected.m_stSinks ) &&
+            ( gds.m_dblMeanDegree == gdsExpected.m_dblMeanDegree ), "GetDegreeStats()", uSeed );
+
+    mt19937 gen( uSeed );
+    vector< double > rgdblUniform( stNodes, 1.0 / double( stNodes ) );
+    vector< double > rgdblWeights( stNodes );
+    double dblWeights = 0.0;
+    for ( size_t st = 0; st < stNodes; ++st )
+    {
+      dblWeights += ( rgdblWeights[ st ] = double( gen() % 3 ) );
+    }
+    if ( !( dblWeights > 0.0 ) )
+    {
+      dblWeights = rgdblWeights[ 0 ] = 1.0;
+    }
+    vector< double > rgdblTeleport( stNodes );
+    for ( size_t st = 0; st < stNodes; ++st )
+    {
+      rgdblTeleport[ st ] = rgdblWeights[ st ] / dblWeights;
+    }
+    vector< double > rgdblExpected;
+    vector< double > rgdblExpectedPersonal;
+    _PowerIteration( csr, 0.85, rgdblUniform, rgdblExpected );
+    _PowerIteration( csr, 0.85, rgdblTeleport, rgdblExpectedPersonal );
+    _graph_pagerank< _TyGraph > gpr( gfv );
+    bool fRanks = true;
+    bool fPersonal = true;
+    vector< double > rgdblRank;
+    for ( unsigned uThreads = 1; uThreads <= 4; ++uThreads )
+    {
+      gpr.set_parameters( 0.85, 1.0e-13, 1000, uThreads );
+      fRanks = fRanks && ( gpr.pagerank( rgdblRank ) < 1000 ) && _FRanksAgree( rgdblRank, rgdblExpected );
+      fPersonal = fPersonal && ( gpr.personalized_pagerank( rgdblWeights, rgdblRank ) < 1000 ) &&
+                  _FRanksAgree( rgdblRank, rgdblExpectedPersonal );
+    }
+    _Check( fRanks, "pagerank() converges to the power iteration", uSeed );
+    _Check( fPersonal, "personalized_pagerank() converges to the power iteration", uSeed );
+    bool fThrew = false;
+    try
+    {
+      gpr.personalized_pagerank( vector< double >( stNodes, 0.0 ), rgdblRank );
+    }
+    catch( bad_graph const & )
+    {
+      fThrew = true;
+    }
+    _Check( fThrew, "personalized_pagerank() throws bad_graph for zero weights", uSeed );
+
+    gpr.pagerank( rgdblRank );
+    gfv.assign_to_elements( g, rgdblRank, []( int & _ri, double _dbl ) { _ri = int( _dbl * 1.0e6 ); } );
+    bool fAssigned = true;
+    for ( size_t st = 0; st < stNodes; ++st )
+    {
+      fAssigned = fAssigned && ( gfv.PGNNode( st )->RElConst() == int( rgdblRank[ st ] * 1.0e6 ) );
+    }
+    _Check( fAssigned, "assign_to_elements()", uSeed );
+  }
+}
+
+int
+main()
+{
+  _TestEdgeListIngestion();
+  _TestEdgeListExport();
+  _TestSCC();
+  _TestTopologicalSort();
+  _TestDagExecutor();
+  _TestShortestPaths();
+  _TestReachabilityIndex();
+  _TestTransitiveClosure();
+  _TestDominators();
+  _TestStructuralEquality();
+  _TestLowestCommonAncestors();
+  _TestFrozenViewRanks();
+  if ( s_nFailures )
+  {
+    fprintf( stderr, "%d check(s) failed.\n", s_nFailures );
+    return 1;
+  }
+  printf( "All checks passed.\n" );
+  return 0;
+}
@@ -0,0 +1,627 @@
+#ifndef __GR_TCLS_H
+#define __GR_TCLS_H
+
+//          Copyright David Lawrence Bien 1997 - 2021.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt).
+
+// _gr_tcls.h
+
+// Transitive closure of a DAG as compressed bitsets.
+// _graph_compressed_bitset: a set of 32 bit values split by the high 16 bits into containers -
+//  a container holds a sorted array of the low 16 bits while it has at most s_kstArrayMax values,
+//  else a bitmap of 2^16 bits. Unions of bitmaps are a vector at a time with the count kept as
+//  they go - AVX2 and POPCNT on x86-64, NEON on AArch64 - else plain loops over 64 bit words. On
+//  x86-64 builds that don't target AVX2 the kernels are chosen at runtime by CPU detection.
+// _graph_transitive_closure: the descendants of each node. The bits of a set are the positions of
+//  the nodes in a topological order ( _graph_topological_sort, _gr_topo.h ) - the descendants of a
+//  node follow it in that order so the sets are dense in few containers. The sets are computed
+//  in reverse topological order, each the union of its children and their sets.
+// The graph must be acyclic ( bad_graph is thrown ) and must not be modified while the closure is
+//  in use.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include <bitset>
+#include <algorithm>
+#include <iterator>
+
+#if ( defined( __x86_64__ ) || defined( _M_X64 ) ) && defined( __POPCNT__ ) && defined( __AVX2__ )
+#include <immintrin.h>
+#define __GR_TCLS_POPCNT
+#define __GR_TCLS_AVX2
+#define __GR_TCLS_TARGET_POPCNT
+#define __GR_TCLS_TARGET_AVX2
+#elif ( defined( __x86_64__ ) && defined( __GNUC__ ) ) || defined( _M_X64 )
+#include <immintrin.h>
+#if defined( __POPCNT__ )
+#define __GR_TCLS_POPCNT
+#endif
+#define __GR_TCLS_DISPATCH
+#if defined( _MSC_VER )
+#include <intrin.h>
+#define __GR_TCLS_TARGET_POPCNT
+#define __GR_TCLS_TARGET_AVX2
+#else //_MSC_VER
+#define __GR_TCLS_TARGET_POPCNT __attribute__(( target( "popcnt" ) ))
+#define __GR_TCLS_TARGET_AVX2 __attribute__(( target( "avx2,popcnt" ) ))
+#endif //_MSC_VER
+#elif defined( __aarch64__ ) && defined( __ARM_NEON )
+#include <arm_neon.h>
+#define __GR_TCLS_NEON
+#endif
+
+__DGRAPH_BEGIN_NAMESPACE
+
+class _graph_compressed_bitset
+{
+  typedef _graph_compressed_bitset _TyThis;
+public:
+  static const size_t s_kstArrayMax = 4096;
+  static const size_t s_kstWords = 1024;   // 64 bit words per bitmap.
+
+  class const_iterator;
+
+  bool  empty() const _BIEN_NOTHROW
+  {
+    return m_rgc.empty();
+  }
+  size_t  size() const _BIEN_NOTHROW
+  {
+    size_t st = 0;
+    for ( size_t stC = 0; stC < m_rgc.size(); ++stC )
+    {
+      st += m_rgc[ stC ].m_uCard;
+    }
+    return st;
+  }
+  void  clear() _BIEN_NOTHROW
+  {
+    m_rgc.clear();
+  }
+  // Approximate memory used:
+  size_t  StBytes() const _BIEN_NOTHROW
+  {
+    size_t st = sizeof( *this ) + m_rgc.capacity() * sizeof( _container );
+    for ( size_t stC = 0; stC < m_rgc.size(); ++stC )
+    {
+      st += m_rgc[ stC ].m_rgu.capacity() * sizeof( uint16_t ) + m_rgc[ stC ].m_rgw.capacity() * sizeof( uint64_t );
+    }
+    return st;
+  }
+
+  bool  FContains( uint32_t _u ) const _BIEN_NOTHROW
+  {
+    const _container * pc = _PCFind( uint16_t( _u >> 16 ) );
+    if ( !pc )
+    {
+      return false;
+    }
+    uint16_t uLow = uint16_t( _u );
+    if ( pc->FBitmap() )
+    {
+      return !!( pc->m_rgw[ uLow >> 6 ] & ( uint64_t( 1 ) << ( uLow & 63 ) ) );
+    }
+    return binary_search( pc->m_rgu.begin(), pc->m_rgu.end(), uLow );
+  }
+
+  void  insert( uint32_t _u )
+  {
+    uint16_t uKey = uint16_t( _u >> 16 );
+    uint16_t uLow = uint16_t( _u );
+    vector< _container >::iterator it = lower_bound( m_rgc.begin(), m_rgc.end(), uKey, _container::FLessKey );
+    if ( ( it == m_rgc.end() ) || ( it->m_uKey != uKey ) )
+    {
+      it = m_rgc.insert( it, _container( uKey ) );
+    }
+    if ( it->FBitmap() )
+    {
+      uint64_t & rw = it->m_rgw[ uLow >> 6 ];
+      uint64_t w = uint64_t( 1 ) << ( uLow & 63 );
+      it->m_uCard += !( rw & w );
+      rw |= w;
+      return;
+    }
+    vector< uint16_t >::iterator itLow = lower_bound( it->m_rgu.begin(), it->m_rgu.end(), uLow );
+    if ( ( itLow != it->m_rgu.end() ) && ( *itLow == uLow ) )
+    {
+      return;
+    }
+    if ( it->m_rgu.size() == s_kstArrayMax )
+    {
+      it->_ToBitmap();
+      insert( _u );
+      return;
+    }
+    it->m_rgu.insert( itLow, uLow );
+    ++it->m_uCard;
+  }
+
+  // this |= _r. If this throws the set is left empty:
+  void  union_with( _TyThis const & _r )
+  {
+    vector< _container > rgc;
+    _BIEN_TRY
+    {
+      rgc.reserve( m_rgc.size() + _r.m_rgc.size() );
+      size_t stThis = 0, stOther = 0;
+      while ( ( stThis < m_rgc.size() ) || ( stOther < _r.m_rgc.size() ) )
+      {
+        if ( ( stOther == _r.m_rgc.size() ) ||
+              ( ( stThis < m_rgc.size() ) && ( m_rgc[ stThis ].m_uKey < _r.m_rgc[ stOther ].m_uKey ) ) )
+        {
+          rgc.push_back( std::move( m_rgc[ stThis++ ] ) );
+        }
+        else
+        if ( ( stThis == m_rgc.size() ) || ( _r.m_rgc[ stOther ].m_uKey < m_rgc[ stThis ].m_uKey ) )
+        {
+          rgc.push_back( _r.m_rgc[ stOther++ ] );
+        }
+        else
+        {
+          rgc.push_back( std::move( m_rgc[ stThis++ ] ) );
+          rgc.back()._Union( _r.m_rgc[ stOther++ ] );
+        }
+      }
+    }
+    _BIEN_UNWIND( m_rgc.clear() );
+    m_rgc.swap( rgc );
+  }
+
+  const_iterator  begin() const _BIEN_NOTHROW;
+  const_iterator  end() const _BIEN_NOTHROW;
+
+protected:
+
+  struct _container
+  {
+    uint16_t            m_uKey;
+    uint32_t            m_uCard;
+    vector< uint16_t >  m_rgu;  // Sorted - when not a bitmap.
+    vector< uint64_t >  m_rgw;  // s_kstWords - when a bitmap.
+
+    explicit _container( uint16_t _uKey )
+      : m_uKey( _uKey ),
+        m_uCard( 0 )
+    {
+    }
+    static bool FLessKey( _container const & _rc, uint16_t _uKey ) _BIEN_NOTHROW
+    {
+      return _rc.m_uKey < _uKey;
+    }
+    bool  FBitmap() const _BIEN_NOTHROW
+    {
+      return !m_rgw.empty();
+    }
+    void  _ToBitmap()
+    {
+      vector< uint64_t > rgw( s_kstWords, 0 );
+      for ( size_t st = 0; st < m_rgu.size(); ++st )
+      {
+        rgw[ m_rgu[ st ] >> 6 ] |= uint64_t( 1 ) << ( m_rgu[ st ] & 63 );
+      }
+      m_rgw.swap( rgw );
+      vector< uint16_t >().swap( m_rgu );
+    }
+    void  _Union( _container const & _r )
+    {
+      if ( !FBitmap() && !_r.FBitmap() )
+      {
+        vector< uint16_t > rgu;
+        rgu.reserve( m_rgu.size() + _r.m_rgu.size() );
+        set_union( m_rgu.begin(), m_rgu.end(), _r.m_rgu.begin(), _r.m_rgu.end(), back_inserter( rgu ) );
+        if ( rgu.size() <= s_kstArrayMax )
+        {
+          m_rgu.swap( rgu );
+          m_uCard = uint32_t( m_rgu.size() );
+          return;
+        }
+        m_rgu.swap( rgu );
+        _ToBitmap();
+        m_uCard = uint32_t( _UCount( &m_rgw[ 0 ] ) );
+        return;
+      }
+      if ( !FBitmap() )
+      {
+        m_rgw = _r.m_rgw;
+        _SetArray();
+        return;
+      }
+      if ( !_r.FBitmap() )
+      {
+        for ( size_t st = 0; st < _r.m_rgu.size(); ++st )
+        {
+          uint64_t & rw = m_rgw[ _r.m_rgu[ st ] >> 6 ];
+          uint64_t w = uint64_t( 1 ) << ( _r.m_rgu[ st ] & 63 );
+          m_uCard += !( rw & w );
+          rw |= w;
+        }
+        return;
+      }
+      m_uCard = uint32_t( _UOr( &m_rgw[ 0 ], &_r.m_rgw[ 0 ] ) );
+    }
+    // Set the bits of the array in the bitmap - then drop the array:
+    void  _SetArray() _BIEN_NOTHROW
+    {
+      for ( size_t st = 0; st < m_rgu.size(); ++st )
+      {
+        m_rgw[ m_rgu[ st ] >> 6 ] |= uint64_t( 1 ) << ( m_rgu[ st ] & 63 );
+      }
+      vector< uint16_t >().swap( m_rgu );
+      m_uCard = uint32_t( _UCount( &m_rgw[ 0 ] ) );
+    }
+  };
+
+  // The word kernels - returns the count of the result:
+  static size_t _UPopCount( uint64_t _w ) _BIEN_NOTHROW
+  {
+#if defined( __GR_TCLS_POPCNT )
+    return size_t( _mm_popcnt_u64( _w ) );
+#elif defined( __GR_TCLS_NEON )
+    return vaddv_u8( vcnt_u8( vcreate_u8( _w ) ) );
+#else // portable.
+    return bitset< 64 >( _w ).count();
+#endif
+  }
+  static size_t _UOr( uint64_t * _pwTo, const uint64_t * _pwFrom ) _BIEN_NOTHROW
+  {
+#if defined( __GR_TCLS_DISPATCH )
+    switch( _EGetKernels() )
+    {
+      case e_kAvx2:
+        return _UOrAvx2( _pwTo, _pwFrom );
+      case e_kPopcnt:
+        return _UOrPopcnt( _pwTo, _pwFrom );
+      default:
+        return _UOrPortable( _pwTo, _pwFrom );
+    }
+#elif defined( __GR_TCLS_AVX2 )
+    return _UOrAvx2( _pwTo, _pwFrom );
+#elif defined( __GR_TCLS_NEON )
+    size_t st = 0;
+    for ( size_t stW = 0; stW < s_kstWords; stW += 2 )
+    {
+      uint64x2_t v = vorrq_u64( vld1q_u64( _pwTo + stW ), vld1q_u64( _pwFrom + stW ) );
+      vst1q_u64( _pwTo + stW, v );
+      st += vaddvq_u8( vcntq_u8( vreinterpretq_u8_u64( v ) ) );
+    }
+    return st;
+#else // portable.
+    return _UOrPortable( _pwTo, _pwFrom );
+#endif
+  }
+  static size_t _UCount( const uint64_t * _pw ) _BIEN_NOTHROW
+  {
+#if defined( __GR_TCLS_DISPATCH ) && !defined( __GR_TCLS_POPCNT )
+    if ( e_kPortable != _EGetKernels() )
+    {
+      return _UCountPopcnt( _pw );
+    }
+#endif //__GR_TCLS_DISPATCH && !__GR_TCLS_POPCNT
+    size_t st = 0;
+    for ( size_t stW = 0; stW < s_kstWords; ++stW )
+    {
+      st += _UPopCount( _pw[ stW ] );
+    }
+    return st;
+  }
+  static size_t _UOrPortable( uint64_t * _pwTo, const uint64_t * _pwFrom ) _BIEN_NOTHROW
+  {
+    size_t st = 0;
+    for ( size_t stW = 0; stW < s_kstWords; ++stW )
+    {
+      uint64_t w = _pwTo[ stW ] | _pwFrom[ stW ];
+      _pwTo[ stW ] = w;
+      st += _UPopCount( w );
+    }
+    return st;
+  }
+#if defined( __GR_TCLS_AVX2 ) || defined( __GR_TCLS_DISPATCH )
+  __GR_TCLS_TARGET_AVX2 static size_t _UOrAvx2( uint64_t * _pwTo, const uint64_t * _pwFrom ) _BIEN_NOTHROW
+  {
+    size_t st = 0;
+    for ( size_t stW = 0; stW < s_kstWords; stW += 4 )
+    {
+      __m256i v = _mm256_or_si256( _mm256_loadu_si256( (const __m256i *)( _pwTo + stW ) ),
+                                   _mm256_loadu_si256( (const __m256i *)( _pwFrom + stW ) ) );
+      _mm256_storeu_si256( (__m256i *)( _pwTo + stW ), v );
+      st += size_t( _mm_popcnt_u64( _pwTo[ stW ] ) + _mm_popcnt_u64( _pwTo[ stW + 1 ] ) +
+                    _mm_popcnt_u64( _pwTo[ stW + 2 ] ) + _mm_popcnt_u64( _pwTo[ stW + 3 ] ) );
+    }
+    return st;
+  }
+#endif //__GR_TCLS_AVX2 || __GR_TCLS_DISPATCH
+#if defined( __GR_TCLS_DISPATCH )
+  __GR_TCLS_TARGET_POPCNT static size_t _UOrPopcnt( uint64_t * _pwTo, const uint64_t * _pwFrom ) _BIEN_NOTHROW
+  {
+    size_t st = 0;
+    for ( size_t stW = 0; stW < s_kstWords; ++stW )
+    {
+      uint64_t w = _pwTo[ stW ] | _pwFrom[ stW ];
+      _pwTo[ stW ] = w;
+      st += size_t( _mm_popcnt_u64( w ) );
+    }
+    return st;
+  }
+  __GR_TCLS_TARGET_POPCNT static size_t _UCountPopcnt( const uint64_t * _pw ) _BIEN_NOTHROW
+  {
+    size_t st = 0;
+    for ( size_t stW = 0; stW < s_kstWords; ++stW )
+    {
+      st += size_t( _mm_popcnt_u64( _pw[ stW ] ) );
+    }
+    return st;
+  }
+
+  // The kernels this CPU supports - detected once:
+  enum EKernels
+  {
+    e_kPortable,
+    e_kPopcnt,
+    e_kAvx2
+  };
+  static EKernels _EGetKernels() _BIEN_NOTHROW
+  {
+    static const EKernels s_kek = _EDetectKernels();
+    return s_kek;
+  }
+  static EKernels _EDetectKernels() _BIEN_NOTHROW
+  {
+#if defined( _MSC_VER )
+    int rgi[ 4 ];
+    __cpuid( rgi, 1 );
+    if ( !( rgi[ 2 ] & ( 1 << 23 ) ) )
+    {
+      return e_kPortable;
+    }
+    // AVX2 also needs the OS to save the YMM registers ( OSXSAVE and XCR0 bits 1 and 2 ):
+    bool fYmm = ( rgi[ 2 ] & ( 1 << 27 ) ) && ( 6 == ( _xgetbv( 0 ) & 6 ) );
+    __cpuidex( rgi, 7, 0 );
+    return ( fYmm && ( rgi[ 1 ] & ( 1 << 5 ) ) ) ? e_kAvx2 : e_kPopcnt;
+#else //_MSC_VER
+    __builtin_cpu_init();
+    if ( !__builtin_cpu_supports( "popcnt" ) )
+    {
+      return e_kPortable;
+    }
+    return __builtin_cpu_supports( "avx2" ) ? e_kAvx2 : e_kPopcnt;
+#endif //_MSC_VER
+  }
+#endif //__GR_TCLS_DISPATCH
+
+  const _container *  _PCFind( uint16_t _uKey ) const _BIEN_NOTHROW
+  {
+    vector< _container >::const_iterator it = lower_bound( m_rgc.begin(), m_rgc.end(), _uKey, _container::FLessKey );
+    return ( ( it == m_rgc.end() ) || ( it->m_uKey != _uKey ) ) ? 0 : &*it;
+  }
+
+  vector< _container >  m_rgc;  // By key.
+};
+
+// Forward iteration of the values in increasing order:
+class _graph_compressed_bitset::const_iterator
+{
+  typedef const_iterator _TyThis;
+  friend class _graph_compressed_bitset;
+public:
+  typedef forward_iterator_tag  iterator_category;
+  typedef uint32_t              value_type;
+  typedef ptrdiff_t             difference_type;
+  typedef const uint32_t *      pointer;
+  typedef uint32_t              reference;
+
+  const_iterator() _BIEN_NOTHROW
+    : m_pcbs( 0 ),
+      m_stC( 0 ),
+      m_stPos( 0 )
+  {
+  }
+
+  reference operator *() const _BIEN_NOTHROW
+  {
+    _container const & rc = m_pcbs->m_rgc[ m_stC ];
+    return ( uint32_t( rc.m_uKey ) << 16 ) | uint32_t( rc.FBitmap() ? m_stPos : rc.m_rgu[ m_stPos ] );
+  }
+  _TyThis & operator ++() _BIEN_NOTHROW
+  {
+    ++m_stPos;
+    _Settle();
+    return *this;
+  }
+  _TyThis operator ++( int ) _BIEN_NOTHROW
+  {
+    _TyThis it( *this );
+    ++*this;
+    return it;
+  }
+  bool  operator ==( _TyThis const & _r ) const _BIEN_NOTHROW
+  {
+    return ( m_stC == _r.m_stC ) && ( m_stPos == _r.m_stPos );
+  }
+  bool  operator !=( _TyThis const & _r ) const _BIEN_NOTHROW
+  {
+    return !( *this == _r );
+  }
+
+protected:
+  typedef _graph_compressed_bitset::_container _container;
+
+  const _graph_compressed_bitset *  m_pcbs;
+  size_t                            m_stC;    // Container.
+  size_t                            m_stPos;  // Index in the array - or bit in the bitmap.
+
+  const_iterator( const _graph_compressed_bitset * _pcbs, size_t _stC ) _BIEN_NOTHROW
+    : m_pcbs( _pcbs ),
+      m_stC( _stC ),
+      m_stPos( 0 )
+  {
+    _Settle();
+  }
+
+  // Move to the first value at or after the current position:
+  void  _Settle() _BIEN_NOTHROW
+  {
+    for ( ; m_stC < m_pcbs->m_rgc.size(); ++m_stC, m_stPos = 0 )
+    {
+      _container const & rc = m_pcbs->m_rgc[ m_stC ];
+      if ( !rc.FBitmap() )
+      {
+        if ( m_stPos < rc.m_rgu.size() )
+        {
+          return;
+        }
+        continue;
+      }
+      size_t stW = m_stPos >> 6;
+      if ( stW < _graph_compressed_bitset::s_kstWords )
+      {
+        uint64_t w = rc.m_rgw[ stW ] & ( ~uint64_t( 0 ) << ( m_stPos & 63 ) );
+        while ( !w && ( ++stW < _graph_compressed_bitset::s_kstWords ) )
+        {
+          w = rc.m_rgw[ stW ];
+        }
+        if ( w )
+        {
+          // Index of the lowest set bit:
+          m_stPos = ( stW << 6 ) + _graph_compressed_bitset::_UPopCount( ( w & ( 0 - w ) ) - 1 );
+          return;
+        }
+      }
+    }
+    m_stPos = 0;
+  }
+};
+
+inline _graph_compressed_bitset::const_iterator
+_graph_compressed_bitset::begin() const _BIEN_NOTHROW
+{
+  return const_iterator( this, 0 );
+}
+inline _graph_compressed_bitset::const_iterator
+_graph_compressed_bitset::end() const _BIEN_NOTHROW
+{
+  return const_iterator( this, m_rgc.size() );
+}
+
+template < class t_TyGraph >
+class _graph_transitive_closure
+{
+  typedef _graph_transitive_closure< t_TyGraph > _TyThis;
+public:
+  typedef t_TyGraph                                     _TyGraph;
+  typedef typename t_TyGraph::_TyGraphNode              _TyGraphNode;
+  typedef typename _TyGraphNode::_TyGraphLinkBaseBase   _TyGraphLinkBaseBase;
+  typedef _graph_topological_sort< t_TyGraph >          _TyTopologicalSort;
+  typedef _graph_edge_list_exporter< t_TyGraph >        _TyNumbering;
+  typedef _graph_compressed_bitset                      _TyBitset;
+
+  explicit _graph_transitive_closure( t_TyGraph const & _rg )
+    : m_gts( _rg )
+  {
+  }
+
+  _TyNumbering const &  RNumbering() const _BIEN_NOTHROW
+  {
+    return m_gts.RNumbering();
+  }
+
+  void  compute()
+  {
+    if ( !m_gts.compute() )
+    {
+      throw bad_graph( "_graph_transitive_closure::compute(): Graph has a cycle." );
+    }
+    vector< size_t > const & rgstOrder = m_gts.RgstOrder();
+    size_t stNodes = rgstOrder.size();
+    m_rgstPos.resize( stNodes );
+    for ( size_t st = 0; st < stNodes; ++st )
+    {
+      m_rgstPos[ rgstOrder[ st ] ] = st;
+    }
+    vector< size_t > const & rgstOffsets = m_gts.RgstChildOffsets();
+    vector< size_t > const & rgstChildren = m_gts.RgstChildren();
+    m_rgbs.clear();
+    m_rgbs.resize( stNodes );
+    for ( size_t stPos = stNodes; stPos--; )
+    {
+      _TyBitset & rbs = m_rgbs[ stPos ];
+      size_t stNode = rgstOrder[ stPos ];
+      for ( size_t stEdge = rgstOffsets[ stNode ]; stEdge < rgstOffsets[ stNode + 1 ]; ++stEdge )
+      {
+        size_t stChildPos = m_rgstPos[ rgstChildren[ stEdge ] ];
+        rbs.insert( uint32_t( stChildPos ) );
+        rbs.union_with( m_rgbs[ stChildPos ] );
+      }
+    }
+  }
+
+  // By node id ( RNumbering() ) - a node is not its own descendant:
+  bool  FDescendant( size_t _stFrom, size_t _stTo ) const _BIEN_NOTHROW
+  {
+    return m_rgbs[ m_rgstPos[ _stFrom ] ].FContains( uint32_t( m_rgstPos[ _stTo ] ) );
+  }
+  bool  FDescendant( const _TyGraphNode * _pgnFrom, const _TyGraphNode * _pgnTo ) const
+  {
+    return FDescendant( _StIdChecked( _pgnFrom ), _StIdChecked( _pgnTo ) );
+  }
+  size_t  StDescendants( size_t _stNode ) const _BIEN_NOTHROW
+  {
+    return m_rgbs[ m_rgstPos[ _stNode ] ].size();
+  }
+  // The ids of the descendants - in topological order:
+  template < class t_TyOutputIter >
+  t_TyOutputIter  CopyDescendants( size_t _stNode, t_TyOutputIter _oit ) const
+  {
+    _TyBitset const & rbs = m_rgbs[ m_rgstPos[ _stNode ] ];
+    vector< size_t > const & rgstOrder = m_gts.RgstOrder();
+    for ( _TyBitset::const_iterator it = rbs.begin(); it != rbs.end(); ++it, ++_oit )
+    {
+      *_oit = rgstOrder[ *it ];
+    }
+    return _oit;
+  }
+  // The set itself - its values are positions in the topological order:
+  _TyBitset const & RDescendantPositions( size_t _stNode ) const _BIEN_NOTHROW
+  {
+    return m_rgbs[ m_rgstPos[ _stNode ] ];
+  }
+  size_t  StPosition( size_t _stNode ) const _BIEN_NOTHROW
+  {
+    return m_rgstPos[ _stNode ];
+  }
+  size_t  StNodeAt( size_t _stPos ) const _BIEN_NOTHROW
+  {
+    return m_gts.RgstOrder()[ _stPos ];
+  }
+  size_t  StBytes() const _BIEN_NOTHROW
+  {
+    size_t st = 0;
+    for ( size_t stPos = 0; stPos < m_rgbs.size(); ++stPos )
+    {
+      st += m_rgbs[ stPos ].StBytes();
+    }
+    return st;
+  }
+
+protected:
+
+  _TyTopologicalSort    m_gts;
+  vector< size_t >      m_rgstPos;  // Topological position of each node id.
+  vector< _TyBitset >   m_rgbs;     // By position.
+
+  size_t  _StIdChecked( const _TyGraphNode * _pgn ) const
+  {
+    size_t stNode = RNumbering().StNodeId( _pgn );
+    if ( _TyNumbering::s_kstNull == stNode )
+    {
+      throw _graph_nav_except( "_graph_transitive_closure::FDescendant(): Node not in graph." );
+    }
+    return stNode;
+  }
+};
+
+__DGRAPH_END_NAMESPACE
+
+#endif //__GR_TCLS_H
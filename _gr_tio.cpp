@@ -0,0 +1,410 @@
+
+//          Copyright David Lawrence Bien 1997 - 2021.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt).
+
+// _gr_tio.cpp
+
+// Round trip tests of graph persistence: each graph is written and read back by every path
+//  and must compare equal ( dgraph::equal_structure() ) to the original.
+// Returns non-zero if any check fails. The async save uses a POSIX temporary file.
+
+#include "_gr_inc.h"
+#include "_gr_tst0.h"
+#include "_gr_tst1.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <random>
+#include <unordered_set>
+#include <algorithm>
+
+using namespace ns_dgraph;
+using namespace std;
+
+typedef dgraph< int, int, false > _TyGraph;
+
+static int s_nFailures = 0;
+
+static void
+_Check( bool _f, const char * _pszWhat, unsigned _uSeed )
+{
+  if ( !_f )
+  {
+    ++s_nFailures;
+    fprintf( stderr, "FAILED: %s ( seed %u ).\n", _pszWhat, _uSeed );
+  }
+}
+
+// Sizes of the random graphs - the small ones exercise the edge cases:
+static const size_t s_krgstNodes[] = { 1, 2, 3, 10, 100, 1000 };
+static const size_t s_kstSizes = sizeof( s_krgstNodes ) / sizeof( s_krgstNodes[ 0 ] );
+
+static void
+_TestParallelLoad()
+{
+  for ( unsigned uSeed = 0; uSeed < s_kstSizes; ++uSeed )
+  {
+    _TyGraph g;
+    CreateTestGraphRandom( g, s_krgstNodes[ uSeed ], s_krgstNodes[ uSeed ], false, uSeed );
+    stringstream ss;
+    g.save( ss );
+    string strImage = ss.str();
+    for ( unsigned nWorkers = 1; nWorkers <= 4; ++nWorkers )
+    {
+      _TyGraph gLoad;
+      gLoad.replace_load_parallel( strImage.data(), strImage.size(), nWorkers );
+      _Check( gLoad.equal_structure( g ), "replace_load_parallel() round trip", uSeed );
+    }
+    bool fThrew = false;
+    try
+    {
+      _TyGraph gLoad;
+      gLoad.replace_load_parallel( strImage.data(), strImage.size() / 2, 2 );
+    }
+    catch ( std::exception const & )
+    {
+      fThrew = true;
+    }
+    _Check( fThrew, "replace_load_parallel() of a truncated image throws", uSeed );
+  }
+}
+
+static void
+_TestAsyncSave()
+{
+  for ( unsigned uSeed = 0; uSeed < s_kstSizes; ++uSeed )
+  {
+    _TyGraph g;
+    CreateTestGraphRandom( g, s_krgstNodes[ uSeed ], s_krgstNodes[ uSeed ], false, uSeed );
+    char szFile[] = "/tmp/_gr_tio_XXXXXX";
+    int fd = mkstemp( szFile );
+    if ( -1 == fd )
+    {
+      _Check( false, "mkstemp()", uSeed );
+      return;
+    }
+    g.save_async( fd );
+    close( fd );
+    ifstream ifs( szFile, ios::binary );
+    _TyGraph gLoad;
+    gLoad.replace_load( ifs );
+    _Check( gLoad.equal_structure( g ), "save_async() round trip", uSeed );
+    stringstream ss;
+    g.save( ss );
+    ifs.clear();
+    ifs.seekg( 0 );
+    stringstream ssFile;
+    ssFile << ifs.rdbuf();
+    _Check( ssFile.str() == ss.str(), "save_async() writes the same bytes as save()", uSeed );
+    unlink( szFile );
+  }
+}
+
+typedef _graph_mutation_log< _TyGraph > _TyMutationLog;
+typedef _TyGraph::_TyGraphNode _TyGraphNode;
+typedef _TyGraph::_TyGraphLink _TyGraphLink;
+typedef _TyGraphNode::_TyGraphLinkBaseBase _TyGraphLinkBaseBase;
+
+static _TyGraphLink *
+_PGLNthChild( _TyGraphNode * _pgn, _TyGNIndex _u )
+{
+  return static_cast< _TyGraphLink * >( *_TyGraphLinkBaseBase::PPGLBGetNthChild( _pgn->PPGLBChildHead(), _u ) );
+}
+static _TyGraphLink *
+_PGLNthParent( _TyGraphNode * _pgn, _TyGNIndex _u )
+{
+  return static_cast< _TyGraphLink * >( *_TyGraphLinkBaseBase::PPGLBGetNthParent( _pgn->PPGLBParentHead(), _u ) );
+}
+
+// Whether <_pgnTarget> is reachable downward from the root of <_rg> without crossing <_pglSkip>:
+static bool
+_FReachableWithout( _TyGraph const & _rg, const _TyGraphNode * _pgnTarget, const _TyGraphLink * _pglSkip )
+{
+  unordered_set< const _TyGraphNode * > setVisited;
+  vector< const _TyGraphNode * > rgpgnStack( 1, _rg.get_root() );
+  setVisited.insert( _rg.get_root() );
+  while ( !rgpgnStack.empty() )
+  {
+    const _TyGraphNode * pgn = rgpgnStack.back();
+    rgpgnStack.pop_back();
+    if ( pgn == _pgnTarget )
+    {
+      return true;
+    }
+    for ( const _TyGraphLinkBaseBase * pglb = *pgn->PPGLBChildHead(); pglb; pglb = pglb->PGLBGetNextChild() )
+    {
+      const _TyGraphNode * pgnChild = static_cast< const _TyGraphNode * >( pglb->PGNBChild() );
+      if ( ( pglb != _pglSkip ) && setVisited.insert( pgnChild ).second )
+      {
+        rgpgnStack.push_back( pgnChild );
+      }
+    }
+  }
+  return false;
+}
+
+// Random mutations of every kind through the log - <_rrgpgn> holds the nodes of <_rg>.
+// Every node stays reachable downward from the root - iteration, and so save() and the log's
+//  numbering, only visit those nodes:
+static void
+_Mutate( _TyGraph const & _rg, _TyMutationLog & _rml, vector< _TyGraphNode * > & _rrgpgn, mt19937 & _rgen,
+         size_t _stMutations, unsigned _uSeed )
+{
+  for ( size_t st = 0; st < _stMutations; ++st )
+  {
+    _TyGraphNode * pgn = _rrgpgn[ _rgen() % _rrgpgn.size() ];
+    switch ( _rgen() % 7 )
+    {
+      case 0:
+      {
+        _TyGraphNode * pgnChild = _rml.create_node1< int >( int( _rgen() % 1000 ) );
+        _rrgpgn.push_back( pgnChild );
+        _rml.add_relation( pgn, pgnChild, _rml.create_link1< int >( int( _rgen() % 1000 ) ),
+                           _TyGNIndex( _rgen() % ( pgn->UChildren() + 1 ) ), 0 );
+      }
+      break;
+      case 1:
+      {
+        _TyGraphNode * pgnChild = _rrgpgn[ _rgen() % _rrgpgn.size() ];
+        _rml.add_relation( pgn, pgnChild, _rml.create_link1< int >( int( _rgen() % 1000 ) ),
+                           _TyGNIndex( _rgen() % ( pgn->UChildren() + 1 ) ),
+                           _TyGNIndex( _rgen() % ( pgnChild->UParents() + 1 ) ) );
+      }
+      break;
+      case 2:
+      {
+        if ( pgn->UChildren() )
+        {
+          _TyGraphLink * pgl = _PGLNthChild( pgn, _TyGNIndex( _rgen() % pgn->UChildren() ) );
+          _TyGraphNode * pgnChild = static_cast< _TyGraphNode * >( pgl->PGNBChild() );
+          // A leaf whose only relation this is goes with it:
+          bool fDestroyChild = ( pgnChild != pgn ) && !pgnChild->FChildren() && ( 1 == pgnChild->UParents() );
+          if ( fDestroyChild || _FReachableWithout( _rg, pgnChild, pgl ) )
+          {
+            _rml.remove_relation( pgl );
+            _rml.destroy_link( pgl );
+            if ( fDestroyChild )
+            {
+              _rrgpgn.erase( find( _rrgpgn.begin(), _rrgpgn.end(), pgnChild ) );
+              _rml.destroy_node( pgnChild );
+            }
+          }
+        }
+      }
+      break;
+      case 3:
+      {
+        pgn->RElNonConst() = int( _rgen() % 1000 );
+        _rml.update_node( pgn );
+      }
+      break;
+      case 4:
+      {
+        if ( pgn->UChildren() )
+        {
+          _TyGraphLink * pgl = _PGLNthChild( pgn, _TyGNIndex( _rgen() % pgn->UChildren() ) );
+          pgl->RElNonConst() = int( _rgen() % 1000 );
+          _rml.update_link( pgl );
+        }
+      }
+      break;
+      case 5:
+      {
+        if ( pgn->UChildren() > 1 )
+        {
+          _TyGNIndex uRemove = _TyGNIndex( _rgen() % pgn->UChildren() );
+          _TyGNIndex uInsert = _TyGNIndex( _rgen() % ( pgn->UChildren() - 1 ) );
+          uInsert += ( uInsert >= uRemove );
+          _TyGraphLink * pgl = _PGLNthChild( pgn, uRemove );
+          _rml.move_child( pgn, uRemove, uInsert );
+          _Check( _PGLNthChild( pgn, uInsert ) == pgl, "move_child() moves the child to the insert index", _uSeed );
+        }
+      }
+      break;
+      case 6:
+      {
+        if ( pgn->UParents() > 1 )
+        {
+          _TyGNIndex uRemove = _TyGNIndex( _rgen() % pgn->UParents() );
+          _TyGNIndex uInsert = _TyGNIndex( _rgen() % ( pgn->UParents() - 1 ) );
+          uInsert += ( uInsert >= uRemove );
+          _TyGraphLink * pgl = _PGLNthParent( pgn, uRemove );
+          _rml.move_parent( pgn, uRemove, uInsert );
+          _Check( _PGLNthParent( pgn, uInsert ) == pgl, "move_parent() moves the parent to the insert index", _uSeed );
+        }
+      }
+      break;
+    }
+  }
+}
+
+// Load <_rssSnapshot> and replay <_rssLog> onto it - the result must equal <_rg>:
+static void
+_CheckReplay( _TyGraph const & _rg, stringstream & _rssSnapshot, stringstream & _rssLog,
+              const char * _pszWhat, unsigned _uSeed )
+{
+  _TyGraph gReplay;
+  _rssSnapshot.clear();
+  _rssSnapshot.seekg( 0 );
+  gReplay.replace_load( _rssSnapshot );
+  _TyMutationLog ml( gReplay );
+  stringstream ssLog( _rssLog.str() );
+  ml.replay( ssLog );
+  _Check( gReplay.equal_structure( _rg ), _pszWhat, _uSeed );
+}
+
+static void
+_TestMutationLog()
+{
+  for ( unsigned uSeed = 0; uSeed < 2 * s_kstSizes; ++uSeed )
+  {
+    EMutationLogFlush emlf = ( uSeed % 2 ) ? e_mlfCommit : e_mlfRecord;
+    _TyGraph g;
+    CreateTestGraphRandom( g, s_krgstNodes[ uSeed / 2 ], s_krgstNodes[ uSeed / 2 ], false, uSeed );
+    _graph_edge_list_exporter< _TyGraph > gele( g );
+    vector< _TyGraphNode * > rgpgn;
+    for ( size_t st = 0; st < gele.StNodes(); ++st )
+    {
+      rgpgn.push_back( const_cast< _TyGraphNode * >( gele.PGNNode( st ) ) );
+    }
+    mt19937 gen( uSeed );
+
+    stringstream ssSnapshot;
+    g.save( ssSnapshot );
+    stringstream ssLog;
+    _TyMutationLog ml( g, _iostream_RawElIO(), _iostream_RawElIO(), emlf );
+    ml.start_log( ssLog );
+    _Mutate( g, ml, rgpgn, gen, 200, uSeed );
+    ml.commit();
+    _CheckReplay( g, ssSnapshot, ssLog, "mutation log replay", uSeed );
+
+    // Compact and continue:
+    stringstream ssSnapshot2;
+    stringstream ssLog2;
+    ml.compact( ssSnapshot2, ssLog2 );
+    _Mutate( g, ml, rgpgn, gen, 200, uSeed );
+    ml.commit();
+    _CheckReplay( g, ssSnapshot2, ssLog2, "mutation log replay after compact()", uSeed );
+
+    // A truncated final record is ignored - the last record updates the root, which replays
+    //  to its prior value:
+    _TyGraphNode * pgnRoot = g.get_root();
+    int iRootEl = pgnRoot->RElConst();
+    pgnRoot->RElNonConst() = iRootEl + 1;
+    ml.update_node( pgnRoot );
+    ml.commit();
+    pgnRoot->RElNonConst() = iRootEl;
+    string strLog = ssLog2.str();
+    stringstream ssTruncated( strLog.substr( 0, strLog.size() - 1 ) );
+    _TyGraph gReplay;
+    ssSnapshot2.clear();
+    ssSnapshot2.seekg( 0 );
+    gReplay.replace_load( ssSnapshot2 );
+    _TyMutationLog mlReplay( gReplay );
+    bool fThrew = false;
+    try
+    {
+      mlReplay.replay( ssTruncated );
+    }
+    catch ( std::exception const & )
+    {
+      fThrew = true;
+    }
+    _Check( !fThrew && gReplay.equal_structure( g ), "mutation log replay ignores a truncated record", uSeed );
+  }
+}
+
+static void
+_TestChecksums()
+{
+  _Check( 0xe3069283 == UCrc32c( 0, "123456789", 9 ), "UCrc32c() check value", 0 );
+  mt19937 gen( 0 );
+  vector< uint8_t > rgby( 4096 );
+  for ( size_t st = 0; st < rgby.size(); ++st )
+  {
+    rgby[ st ] = uint8_t( gen() );
+  }
+  // Every alignment and length - continued CRCs match the single pass and the portable code:
+  for ( size_t stOffset = 0; stOffset < 8; ++stOffset )
+  {
+    for ( size_t st = 0; st < 1024; st += 13 )
+    {
+      uint32_t uCrc = UCrc32c( 0, &rgby[ stOffset ], st );
+      _Check( uCrc == ~_UCrc32cPortable( ~uint32_t( 0 ), &rgby[ stOffset ], st ), "UCrc32c() matches the portable CRC", unsigned( st ) );
+      _Check( uCrc == UCrc32c( UCrc32c( 0, &rgby[ stOffset ], st / 3 ), &rgby[ stOffset + st / 3 ], st - st / 3 ),
+              "UCrc32c() continues a CRC", unsigned( st ) );
+    }
+  }
+
+  for ( unsigned uSeed = 0; uSeed < s_kstSizes; ++uSeed )
+  {
+    _TyGraph g;
+    CreateTestGraphRandom( g, s_krgstNodes[ uSeed ], s_krgstNodes[ uSeed ], false, uSeed );
+    stringstream ss;
+    g.save_checksummed( ss, 64 );
+    string strImage = ss.str();
+    _Check( FValidateGraphChecksums( strImage.data(), strImage.size() ), "FValidateGraphChecksums() of an image", uSeed );
+    _Check( FValidateGraphChecksums( ss ), "FValidateGraphChecksums() of a stream", uSeed );
+    ss.clear();
+    ss.seekg( 0 );
+    _TyGraph gLoad;
+    gLoad.replace_load( ss );
+    _Check( gLoad.equal_structure( g ), "save_checksummed() round trip", uSeed );
+
+    string strCorrupt( strImage );
+    strCorrupt[ gen() % strCorrupt.size() ] ^= char( 1 + gen() % 255 );
+    _Check( !FValidateGraphChecksums( strCorrupt.data(), strCorrupt.size() ), "FValidateGraphChecksums() detects a changed byte", uSeed );
+    stringstream ssCorrupt( strCorrupt );
+    _Check( !FValidateGraphChecksums( ssCorrupt ), "FValidateGraphChecksums() of a stream detects a changed byte", uSeed );
+    _Check( !FValidateGraphChecksums( strImage.data(), strImage.size() - 1 ), "FValidateGraphChecksums() detects truncation", uSeed );
+  }
+}
+
+static void
+_TestPortable()
+{
+  for ( unsigned uSeed = 0; uSeed <= s_kstSizes; ++uSeed )
+  {
+    _TyGraph g;
+    if ( uSeed < s_kstSizes )
+    {
+      CreateTestGraphRandom( g, s_krgstNodes[ uSeed ], s_krgstNodes[ uSeed ], false, uSeed );
+    }
+    else
+    {
+      CreateTestGraph0( g );
+    }
+    stringstream ss;
+    g.save_portable( ss );
+    _TyGraph gLoad;
+    gLoad.replace_load_portable( ss );
+    _Check( gLoad.equal_structure( g ), "save_portable() round trip", uSeed );
+    // The format is canonical - saving the loaded graph writes the same bytes:
+    stringstream ssResave;
+    gLoad.save_portable( ssResave );
+    _Check( ssResave.str() == ss.str(), "save_portable() of the loaded graph writes the same bytes", uSeed );
+  }
+}
+
+int
+main()
+{
+  _TestParallelLoad();
+  _TestAsyncSave();
+  _TestMutationLog();
+  _TestChecksums();
+  _TestPortable();
+  if ( s_nFailures )
+  {
+    fprintf( stderr, "%d check(s) failed.\n", s_nFailures );
+    return 1;
+  }
+  printf( "All checks passed.\n" );
+  return 0;
+}
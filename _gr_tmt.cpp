@@ -0,0 +1,794 @@
+
+//          Copyright David Lawrence Bien 1997 - 2021.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt).
+
+// _gr_tmt.cpp
+
+// Multithreaded tests of the concurrent parts of the graph - build with -fsanitize=thread to
+//  have data races reported as well.
+// Returns non-zero if any check fails.
+
+#include "_gr_inc.h"
+#include "_gr_tst1.h"
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <unordered_set>
+#include <algorithm>
+#include <random>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+
+using namespace ns_dgraph;
+using namespace std;
+
+static const unsigned s_kuThreads = 4;
+
+static atomic< int > s_nFailures( 0 );
+
+static void
+_Check( bool _f, const char * _pszWhat )
+{
+  if ( !_f )
+  {
+    ++s_nFailures;
+    fprintf( stderr, "FAILED: %s.\n", _pszWhat );
+  }
+}
+
+// Count the nodes and links visited by a full iteration:
+template < class t_TyGraph >
+size_t
+_StIterate( t_TyGraph & _rg )
+{
+  size_t st = 0;
+  for ( typename t_TyGraph::iterator it( _rg.begin() ); !it.FAtEnd(); ++it )
+  {
+    ++st;
+  }
+  return st;
+}
+
+// Safe node iterators walk, are copied and are destroyed on many threads at once - each
+//  connects to and disconnects from the viewer lists of the nodes it visits. Then the graph is
+//  destroyed under node iterators that other threads hold:
+static void
+_TestThreadSafeViewers()
+{
+  typedef dgraph< int, int, true, allocator< char >, _graph_traits_safe_ts< int, int > > _TyGraph;
+  typedef _TyGraph::_TyNodeIterNonConstSafe _TyNodeIter;
+  static_assert( _TyGraph::_TyGraphTraits::ms_fThreadSafeConnections, "Expected thread-safe connections." );
+  for ( unsigned uSeed = 0; uSeed < 4; ++uSeed )
+  {
+    _TyGraph g;
+    CreateTestGraphRandom( g, 50, 100, false, uSeed );
+    size_t stVisits = _StIterate( g );
+    atomic< unsigned > uHolding( 0 );
+    atomic< bool > fDestroyed( false );
+    vector< thread > rgthr;
+    for ( unsigned u = 0; u < s_kuThreads; ++u )
+    {
+      rgthr.push_back( thread( [&g,stVisits,&uHolding,&fDestroyed,uSeed,u]()
+        {
+          mt19937 gen( uSeed * s_kuThreads + u );
+          _Check( _StIterate( g ) == stVisits, "concurrent iterations visit the whole graph" );
+          vector< _TyNodeIter > rgit;
+          for ( size_t st = 0; st < 4; ++st )
+          {
+            _TyNodeIter it( g.get_root() );
+            for ( size_t stStep = 0; stStep < 2000; ++stStep )
+            {
+              if ( it.PGNCur()->UChildren() )
+              {
+                it.GoChild( _TyGNIndex( gen() % it.PGNCur()->UChildren() ) );
+              }
+              else
+              {
+                it.GoParent( _TyGNIndex( gen() % it.PGNCur()->UParents() ) );
+              }
+              _TyNodeIter itCopy( it );
+              _Check( itCopy.PGNCur() == it.PGNCur(), "a copied node iterator is at the same node" );
+            }
+            rgit.push_back( it );
+          }
+          ++uHolding;
+          while ( !fDestroyed )
+          {
+            this_thread::yield();
+          }
+          for ( size_t st = 0; st < rgit.size(); ++st )
+          {
+            _Check( !rgit[ st ].PGNCur(), "node iterators are cleared when the graph is destroyed" );
+          }
+        } ) );
+    }
+    while ( uHolding < s_kuThreads )
+    {
+      this_thread::yield();
+    }
+    g.destroy();
+    fDestroyed = true;
+    for ( size_t st = 0; st < rgthr.size(); ++st )
+    {
+      rgthr[ st ].join();
+    }
+  }
+}
+
+// Readers walk the graph from the root while a writer adds and destroys leaves. Each reader step
+//  holds the shared mutex shared - the writer holds it exclusive while it relinks - and the epoch
+//  read section keeps the nodes a reader holds allocated, so their elements may be read after the
+//  writer has destroyed them:
+static void
+_TestEpochReaders()
+{
+  typedef dgraph< int, int, false > _TyGraph;
+  typedef _TyGraph::_TyGraphNode _TyGraphNode;
+  typedef _TyGraph::_TyGraphLink _TyGraphLink;
+  typedef _TyGraphNode::_TyGraphLinkBaseBase _TyGraphLinkBaseBase;
+  _graph_epoch_domain ged;
+  {
+    _TyGraph g;
+    CreateTestGraphRandom( g, 100, 0, true, 0 );
+    g.set_epoch_domain( &ged );
+    shared_timed_mutex smtx;
+    atomic< bool > fStop( false );
+    vector< thread > rgthr;
+    for ( unsigned u = 0; u < s_kuThreads; ++u )
+    {
+      rgthr.push_back( thread( [&g,&ged,&smtx,&fStop,u]()
+        {
+          mt19937 gen( u );
+          _graph_epoch_reader ger( ged );
+          while ( !fStop )
+          {
+            _graph_epoch_read_lock erl( ger );
+            const _TyGraphNode * pgn = g.get_root();
+            for ( size_t stStep = 0; stStep < 64; ++stStep )
+            {
+              {
+                shared_lock< shared_timed_mutex > lock( smtx );
+                if ( !pgn->UChildren() )
+                {
+                  break;
+                }
+                const _TyGraphLinkBaseBase * pglb = *_TyGraphLinkBaseBase::PPGLBGetNthChild(
+                  pgn->PPGLBChildHead(), _TyGNIndex( gen() % pgn->UChildren() ) );
+                pgn = static_cast< const _TyGraphNode * >( pglb->PGNBChild() );
+              }
+              // Outside the step - the writer may destroy this node meanwhile:
+              this_thread::yield();
+              _Check( ( pgn->RElConst() >= 0 ) && ( pgn->RElConst() < 1000 ), "a reader sees a held node's element" );
+            }
+          }
+        } ) );
+    }
+
+    // The writer - the nodes other than the root that it may destroy:
+    mt19937 gen( 0 );
+    _graph_edge_list_exporter< _TyGraph > gele( g );
+    vector< _TyGraphNode * > rgpgn;
+    for ( size_t st = 1; st < gele.StNodes(); ++st )
+    {
+      rgpgn.push_back( const_cast< _TyGraphNode * >( gele.PGNNode( st ) ) );
+    }
+    for ( size_t st = 0; st < 20000; ++st )
+    {
+      this_thread::yield(); // let the readers overlap.
+      if ( rgpgn.empty() || ( gen() % 2 ) )
+      {
+        _TyGraphNode * pgnParent = rgpgn.empty() ? g.get_root() : rgpgn[ gen() % rgpgn.size() ];
+        _TyGraphNode * pgn = g.create_node1< int >( int( gen() % 1000 ) );
+        _TyGraphLink * pgl = g.create_link1< int >( int( gen() % 1000 ) );
+        {
+          lock_guard< shared_timed_mutex > lock( smtx );
+          pgnParent->AddChild( *pgn, *pgl, *pgnParent->PPGLBChildHead(), *pgn->PPGLBParentHead() );
+        }
+        rgpgn.push_back( pgn );
+      }
+      else
+      {
+        size_t stNode = gen() % rgpgn.size();
+        _TyGraphNode * pgn = rgpgn[ stNode ];
+        if ( !pgn->FChildren() )
+        {
+          {
+            lock_guard< shared_timed_mutex > lock( smtx );
+            while ( pgn->FParents() )
+            {
+              _TyGraphLink * pgl = static_cast< _TyGraphLink * >( *pgn->PPGLBParentHead() );
+              pgl->RemoveChild();
+              pgl->RemoveParent();
+              g.destroy_link( pgl );
+            }
+          }
+          g.destroy_single_node( pgn );
+          rgpgn[ stNode ] = rgpgn.back();
+          rgpgn.pop_back();
+        }
+      }
+    }
+    fStop = true;
+    for ( size_t st = 0; st < rgthr.size(); ++st )
+    {
+      rgthr[ st ].join();
+    }
+    _Check( _graph_edge_list_exporter< _TyGraph >( g ).StNodes() == rgpgn.size() + 1, "the writer's nodes are all in the graph" );
+  }
+  ged.synchronize();
+  _Check( !ged.NRetired(), "synchronize() reclaims every retired object" );
+}
+
+// A block held by a thread_local - freed in thread exit, possibly after the thread's pool cache
+//  has been destroyed:
+struct _pool_block_holder
+{
+  void * m_pv;
+  _pool_block_holder()
+    : m_pv( 0 )
+  {
+  }
+  ~_pool_block_holder()
+  {
+    if ( m_pv )
+    {
+      _graph_pool_allocator< char >().deallocate( (char*)m_pv, 40 );
+    }
+    // Allocating after the cache is gone draws on the shared list:
+    char * pc = _graph_pool_allocator< char >().allocate( 40 );
+    _graph_pool_allocator< char >().deallocate( pc, 40 );
+  }
+};
+
+// Threads allocate pooled blocks of each size, hand them to one another and free blocks that other
+//  threads allocated. Safe iterators with pooled path nodes traverse a shared graph meanwhile:
+static void
+_TestPoolAllocator()
+{
+  typedef dgraph< int, int, true, allocator< char >, _graph_traits_safe_pooled< int, int > > _TyGraph;
+  _TyGraph g;
+  CreateTestGraphRandom( g, 200, 200, false, 0 );
+  size_t stVisits = _StIterate( g );
+  mutex mtx;
+  vector< pair< unsigned char *, size_t > > rgprBlocks; // Blocks in transit - under <mtx>.
+  vector< thread > rgthr;
+  for ( unsigned u = 0; u < s_kuThreads; ++u )
+  {
+    rgthr.push_back( thread( [&g,stVisits,&mtx,&rgprBlocks,u]()
+      {
+        static thread_local _pool_block_holder s_pbh;
+        s_pbh.m_pv = _graph_pool_allocator< char >().allocate( 40 );
+        mt19937 gen( u );
+        for ( size_t st = 0; st < 20000; ++st )
+        {
+          size_t stSize = 1 + gen() % 300;
+          unsigned char * pby = (unsigned char *)_graph_pool_allocator< char >().allocate( stSize );
+          memset( pby, int( stSize & 0xff ), stSize );
+          pair< unsigned char *, size_t > pr( pby, stSize );
+          {
+            lock_guard< mutex > lock( mtx );
+            rgprBlocks.push_back( pr );
+            size_t stTake = gen() % rgprBlocks.size();
+            pr = rgprBlocks[ stTake ];
+            rgprBlocks[ stTake ] = rgprBlocks.back();
+            rgprBlocks.pop_back();
+          }
+          _Check( pr.first[ 0 ] == ( pr.second & 0xff ) && pr.first[ pr.second - 1 ] == ( pr.second & 0xff ),
+                  "a pooled block keeps its contents until freed" );
+          _graph_pool_allocator< char >().deallocate( (char*)pr.first, pr.second );
+          if ( !( st % 1000 ) )
+          {
+            _Check( _StIterate( g ) == stVisits, "iterations with pooled path nodes visit the whole graph" );
+          }
+        }
+      } ) );
+  }
+  for ( size_t st = 0; st < rgthr.size(); ++st )
+  {
+    rgthr[ st ].join();
+  }
+  for ( size_t st = 0; st < rgprBlocks.size(); ++st )
+  {
+    _graph_pool_allocator< char >().deallocate( (char*)rgprBlocks[ st ].first, rgprBlocks[ st ].second );
+  }
+}
+
+// The graph is destroyed - with and without batched viewer invalidation - while other threads
+//  drop half of the node iterators they hold. The rest must be cleared:
+static void
+_TestBatchViewerDeinit()
+{
+  typedef dgraph< int, int, true, allocator< char >, _graph_traits_safe_ts< int, int > > _TyGraph;
+  typedef _TyGraph::_TyNodeIterNonConstSafe _TyNodeIter;
+  for ( unsigned uSeed = 0; uSeed < 8; ++uSeed )
+  {
+    _TyGraph g;
+    g.set_batch_viewer_deinit( !!( uSeed % 2 ) );
+    CreateTestGraphRandom( g, 300, 300, false, uSeed );
+    _graph_edge_list_exporter< _TyGraph > gele( g );
+    atomic< unsigned > uHolding( 0 );
+    atomic< bool > fDestroying( false );
+    atomic< bool > fDestroyed( false );
+    vector< thread > rgthr;
+    for ( unsigned u = 0; u < s_kuThreads; ++u )
+    {
+      rgthr.push_back( thread( [&gele,&uHolding,&fDestroying,&fDestroyed,uSeed,u]()
+        {
+          mt19937 gen( uSeed * s_kuThreads + u );
+          vector< unique_ptr< _TyNodeIter > > rgpit;
+          for ( size_t st = 0; st < 256; ++st )
+          {
+            rgpit.push_back( unique_ptr< _TyNodeIter >( new _TyNodeIter(
+              const_cast< _TyGraph::_TyGraphNode * >( gele.PGNNode( gen() % gele.StNodes() ) ) ) ) );
+          }
+          ++uHolding;
+          while ( !fDestroying )
+          {
+            this_thread::yield();
+          }
+          // Disconnect while the owner's viewers are being informed:
+          for ( size_t st = 1; st < rgpit.size(); st += 2 )
+          {
+            rgpit[ st ].reset();
+          }
+          while ( !fDestroyed )
+          {
+            this_thread::yield();
+          }
+          for ( size_t st = 0; st < rgpit.size(); st += 2 )
+          {
+            _Check( !rgpit[ st ]->PGNCur(), "node iterators are cleared when the graph is destroyed" );
+          }
+        } ) );
+    }
+    while ( uHolding < s_kuThreads )
+    {
+      this_thread::yield();
+    }
+    fDestroying = true;
+    g.destroy();
+    fDestroyed = true;
+    for ( size_t st = 0; st < rgthr.size(); ++st )
+    {
+      rgthr[ st ].join();
+    }
+  }
+}
+
+// Counts the hook calls - on the worker thread:
+struct _shadow_count_hook
+{
+  atomic< size_t > * m_pstCalls;
+  template < class t_TyShadowGraph >
+  void operator()( t_TyShadowGraph &, typename t_TyShadowGraph::_TyGraphNode * ) const _BIEN_NOTHROW
+  {
+    ++*m_pstCalls;
+  }
+};
+
+// Whether <_pgnTarget> is reachable downward from the root of <_rg> without crossing <_pglbSkip>:
+template < class t_TyGraph >
+bool
+_FReachableWithout( t_TyGraph const & _rg, const typename t_TyGraph::_TyGraphNode * _pgnTarget,
+                    const typename t_TyGraph::_TyGraphNode::_TyGraphLinkBaseBase * _pglbSkip )
+{
+  typedef typename t_TyGraph::_TyGraphNode _TyGraphNode;
+  typedef typename _TyGraphNode::_TyGraphLinkBaseBase _TyGraphLinkBaseBase;
+  vector< const _TyGraphNode * > rgpgnStack( 1, _rg.get_root() );
+  unordered_set< const _TyGraphNode * > setVisited( rgpgnStack.begin(), rgpgnStack.end() );
+  while ( !rgpgnStack.empty() )
+  {
+    const _TyGraphNode * pgn = rgpgnStack.back();
+    rgpgnStack.pop_back();
+    if ( pgn == _pgnTarget )
+    {
+      return true;
+    }
+    for ( const _TyGraphLinkBaseBase * pglb = *pgn->PPGLBChildHead(); pglb; pglb = pglb->PGLBGetNextChild() )
+    {
+      const _TyGraphNode * pgnChild = static_cast< const _TyGraphNode * >( pglb->PGNBChild() );
+      if ( ( pglb != _pglbSkip ) && setVisited.insert( pgnChild ).second )
+      {
+        rgpgnStack.push_back( pgnChild );
+      }
+    }
+  }
+  return false;
+}
+
+// The writer mutates a graph and posts each change to the maintainer while its worker applies
+//  them. At each sync() the shadow must equal the graph:
+static void
+_TestShadowMaintainer()
+{
+  typedef dgraph< int, int, false > _TyGraph;
+  typedef _TyGraph::_TyGraphNode _TyGraphNode;
+  typedef _TyGraph::_TyGraphLink _TyGraphLink;
+  typedef _TyGraphNode::_TyGraphLinkBaseBase _TyGraphLinkBaseBase;
+  typedef _shadow_graph_maintainer< _TyGraph, _TyGraph, _shadow_count_hook > _TyMaintainer;
+  atomic< size_t > stHookCalls( 0 );
+  _TyGraph gShadow;
+  _TyGraph g;
+  {
+    _shadow_count_hook sch = { &stHookCalls };
+    _TyMaintainer sgm( gShadow, sch );
+    mt19937 gen( 0 );
+    vector< _TyGraphNode * > rgpgn( 1, g.create_node1< int >( int( gen() % 1000 ) ) );
+    g.set_root_node( rgpgn[ 0 ] );
+    sgm.node_created( rgpgn[ 0 ], rgpgn[ 0 ]->RElConst() );
+    sgm.root_set( rgpgn[ 0 ] );
+    for ( size_t st = 0; st < 20000; ++st )
+    {
+      _TyGraphNode * pgn = rgpgn[ gen() % rgpgn.size() ];
+      switch ( gen() % 5 )
+      {
+        case 0:
+        case 1:
+        {
+          // A new child - or a relation to an existing node:
+          _TyGraphNode * pgnChild = ( gen() % 2 ) ? rgpgn[ gen() % rgpgn.size() ] : 0;
+          if ( !pgnChild )
+          {
+            pgnChild = g.create_node1< int >( int( gen() % 1000 ) );
+            rgpgn.push_back( pgnChild );
+            sgm.node_created( pgnChild, pgnChild->RElConst() );
+          }
+          _TyGraphLink * pgl = g.create_link1< int >( int( gen() % 1000 ) );
+          sgm.link_created( pgl, pgl->RElConst() );
+          _TyGNIndex uChild = _TyGNIndex( gen() % ( pgn->UChildren() + 1 ) );
+          _TyGNIndex uParent = _TyGNIndex( gen() % ( pgnChild->UParents() + 1 ) );
+          pgn->AddChild( *pgnChild, *pgl,
+                         *_TyGraphLinkBaseBase::PPGLBGetNthChild( pgn->PPGLBChildHead(), uChild ),
+                         *_TyGraphLinkBaseBase::PPGLBGetNthParent( pgnChild->PPGLBParentHead(), uParent ) );
+          sgm.relation_added( pgn, pgnChild, pgl, uChild, uParent );
+        }
+        break;
+        case 2:
+        {
+          // Remove a relation - keeping every node reachable from the root:
+          if ( !pgn->UChildren() )
+          {
+            break;
+          }
+          _TyGraphLink * pgl = static_cast< _TyGraphLink * >( *_TyGraphLinkBaseBase::PPGLBGetNthChild(
+            pgn->PPGLBChildHead(), _TyGNIndex( gen() % pgn->UChildren() ) ) );
+          _TyGraphNode * pgnChild = pgl->PGNChild();
+          bool fDestroyChild = ( pgnChild != pgn ) && !pgnChild->FChildren() && ( 1 == pgnChild->UParents() );
+          if ( !fDestroyChild && !_FReachableWithout( g, pgnChild, pgl ) )
+          {
+            break;
+          }
+          pgl->RemoveChild();
+          pgl->RemoveParent();
+          sgm.relation_removed( pgl );
+          sgm.link_destroyed( pgl );
+          g.destroy_link( pgl );
+          if ( fDestroyChild )
+          {
+            rgpgn.erase( find( rgpgn.begin(), rgpgn.end(), pgnChild ) );
+            sgm.node_destroyed( pgnChild );
+            g.destroy_single_node( pgnChild );
+          }
+        }
+        break;
+        case 3:
+        {
+          pgn->RElNonConst() = int( gen() % 1000 );
+          sgm.node_updated( pgn, pgn->RElConst() );
+        }
+        break;
+        case 4:
+        {
+          if ( pgn->UChildren() > 1 )
+          {
+            _TyGNIndex uRemove = _TyGNIndex( gen() % pgn->UChildren() );
+            _TyGNIndex uInsert = _TyGNIndex( gen() % ( pgn->UChildren() - 1 ) );
+            uInsert += ( uInsert >= uRemove );
+            pgn->MoveChild( uRemove, uInsert );
+            sgm.child_moved( pgn, uRemove, uInsert );
+          }
+        }
+        break;
+      }
+      if ( !( st % 2000 ) )
+      {
+        sgm.sync();
+        _Check( gShadow.equal_structure( g ), "the shadow equals the graph at sync()" );
+      }
+    }
+    sgm.sync();
+    _Check( gShadow.equal_structure( g ), "the shadow equals the graph at the final sync()" );
+    _Check( !sgm.FFailed(), "the shadow maintainer has not failed" );
+    sgm.reset();
+    _Check( !gShadow.get_root(), "reset() empties the shadow" );
+  }
+  _Check( !!stHookCalls, "the hook is called for changed shadow nodes" );
+}
+
+// Threads copy a graph of copy-on-write elements at once - the copies share the elements - and
+//  then write every element of their copy. The original must keep its values:
+static void
+_TestCopyOnWriteElements()
+{
+  typedef _cpwt_element< int > _TyEl;
+  typedef dgraph< _TyEl, _TyEl, false > _TyGraph;
+  typedef _TyGraph::_TyGraphNode _TyGraphNode;
+  _TyGraph g;
+  CreateTestGraphRandom( g, 300, 300, false, 0 );
+  _graph_edge_list_exporter< _TyGraph > gele( g );
+  vector< int > rgiEls;
+  for ( size_t st = 0; st < gele.StNodes(); ++st )
+  {
+    rgiEls.push_back( gele.PGNNode( st )->RElConst().RElConst() );
+  }
+  vector< thread > rgthr;
+  for ( unsigned u = 0; u < s_kuThreads; ++u )
+  {
+    rgthr.push_back( thread( [&g,u]()
+      {
+        for ( unsigned uPass = 0; uPass < 4; ++uPass )
+        {
+          _TyGraph gCopy( g );
+          _Check( gCopy.equal_structure( g ), "a copy equals the original" );
+          _graph_edge_list_exporter< _TyGraph > geleCopy( gCopy );
+          for ( size_t st = 0; st < geleCopy.StNodes(); ++st )
+          {
+            _TyGraphNode * pgn = const_cast< _TyGraphNode * >( geleCopy.PGNNode( st ) );
+            _Check( pgn->RElConst().FShared(), "a copied element is shared until written" );
+            pgn->RElNonConst().RElNonConst() = int( 1000 + u );
+            _Check( !pgn->RElConst().FShared(), "a written element is no longer shared" );
+          }
+        }
+      } ) );
+  }
+  for ( size_t st = 0; st < rgthr.size(); ++st )
+  {
+    rgthr[ st ].join();
+  }
+  bool fUnchanged = true;
+  for ( size_t st = 0; st < gele.StNodes(); ++st )
+  {
+    fUnchanged = fUnchanged && ( rgiEls[ st ] == gele.PGNNode( st )->RElConst().RElConst() )
+                            && !gele.PGNNode( st )->RElConst().FShared();
+  }
+  _Check( fUnchanged, "the original's elements are unchanged and no longer shared" );
+}
+
+// Sum of the elements reached from the root of a version:
+template < class t_TyVersion >
+long
+_LVersionSum( t_TyVersion const & _rv )
+{
+  long l = 0;
+  size_t stRoot = _rv.StRoot();
+  for ( size_t u = 0; u < _rv.UChildren( stRoot ); ++u )
+  {
+    size_t stLink = _rv.StChildLink( stRoot, u );
+    l += _rv.RLinkEl( stLink ) + _rv.RNodeEl( _rv.StLinkChild( stLink ) );
+  }
+  return l;
+}
+
+// A writer commits versions while readers take them. In every version the root's element is its
+//  number of children, and a version that a reader holds doesn't change as later ones are committed:
+static void
+_TestVersionedReaders()
+{
+  typedef dgraph< int, int, false > _TyGraph;
+  typedef _versioned_graph< _TyGraph > _TyVersioned;
+  typedef _TyVersioned::_TyVersion _TyVersion;
+  _TyVersioned vg;
+  vg.set_root( vg.create_node( 0 ) );
+  vg.commit();
+  atomic< bool > fStop( false );
+  vector< thread > rgthr;
+  for ( unsigned u = 0; u < s_kuThreads; ++u )
+  {
+    rgthr.push_back( thread( [&vg,&fStop]()
+      {
+        size_t uLastId = 0;
+        while ( !fStop )
+        {
+          _TyVersion v = vg.get_version();
+          _Check( v.UId() >= uLastId, "version ids don't decrease" );
+          uLastId = v.UId();
+          size_t stRoot = v.StRoot();
+          _Check( size_t( v.RNodeEl( stRoot ) ) == v.UChildren( stRoot ), "a version is consistent" );
+          long lSum = _LVersionSum( v );
+          this_thread::yield();
+          _Check( _LVersionSum( v ) == lSum, "a held version is unchanged by later commits" );
+          if ( !( uLastId % 64 ) )
+          {
+            _TyGraph g;
+            v.materialize( g );
+            _Check( _graph_edge_list_exporter< _TyGraph >( g ).StNodes() == v.UChildren( stRoot ) + 1,
+                    "a materialized version has the version's nodes" );
+          }
+        }
+      } ) );
+  }
+  mt19937 gen( 0 );
+  size_t stRoot = vg.get_version().StRoot();
+  vector< size_t > rgstChildren;
+  for ( size_t st = 0; st < 5000; ++st )
+  {
+    unsigned uOp = gen() % 3;
+    if ( ( 0 == uOp ) || rgstChildren.empty() )
+    {
+      size_t stChild = vg.create_node( int( gen() % 1000 ) );
+      vg.add_child( stRoot, stChild, int( gen() % 1000 ) );
+      rgstChildren.push_back( stChild );
+    }
+    else
+    if ( 1 == uOp )
+    {
+      size_t stIndex = gen() % rgstChildren.size();
+      vg.destroy_node( rgstChildren[ stIndex ] );
+      rgstChildren[ stIndex ] = rgstChildren.back();
+      rgstChildren.pop_back();
+    }
+    else
+    {
+      vg.set_node_el( rgstChildren[ gen() % rgstChildren.size() ], int( gen() % 1000 ) );
+    }
+    vg.set_node_el( stRoot, int( rgstChildren.size() ) );
+    vg.commit();
+  }
+  fStop = true;
+  for ( size_t st = 0; st < rgthr.size(); ++st )
+  {
+    rgthr[ st ].join();
+  }
+  _Check( vg.get_version().UChildren( stRoot ) == rgstChildren.size(), "the last version has the writer's nodes" );
+}
+
+// Threads create chains of nodes and queue relations through their locals, then commit() connects
+//  them all in parallel. Each node's children must be in the order queued, and each node's parents
+//  must be those queued. A builder destroyed without commit() destroys what was created through it:
+static void
+_TestConcurrentBuilder()
+{
+  typedef dgraph< int, int, false, _graph_pool_allocator< char > > _TyGraph;
+  typedef _TyGraph::_TyGraphNode _TyGraphNode;
+  typedef _TyGraphNode::_TyGraphLinkBaseBase _TyGraphLinkBaseBase;
+  typedef _graph_concurrent_builder< _TyGraph > _TyBuilder;
+  static const int s_kiNodes = 500;
+  _TyGraph g;
+  _TyGraphNode * pgnHub = g.create_node1< int >( -1 );
+  g.set_root_node( pgnHub );
+  // Expected relations by node element:
+  vector< vector< int > > rgrgiChildren( s_kuThreads * s_kiNodes );
+  vector< vector< int > > rgrgiParents( s_kuThreads * s_kiNodes );
+  {
+    _TyBuilder gcb( g );
+    vector< thread > rgthr;
+    for ( unsigned u = 0; u < s_kuThreads; ++u )
+    {
+      rgthr.push_back( thread( [&gcb,pgnHub,&rgrgiChildren,&rgrgiParents,u]()
+        {
+          mt19937 gen( u );
+          _TyBuilder::_TyLocal & rl = gcb.get_local();
+          int iBase = int( u ) * s_kiNodes;
+          vector< _TyGraphNode * > rgpgn;
+          for ( int i = 0; i < s_kiNodes; ++i )
+          {
+            rgpgn.push_back( rl.create_node( iBase + i ) );
+          }
+          rl.add_child( pgnHub, rgpgn[ 0 ], 0 );
+          rgrgiParents[ iBase ].push_back( -1 );
+          for ( int i = 0; i < s_kiNodes; ++i )
+          {
+            if ( i + 1 < s_kiNodes )
+            {
+              rl.add_child( rgpgn[ i ], rgpgn[ i + 1 ], 0 );
+              rgrgiChildren[ iBase + i ].push_back( iBase + i + 1 );
+              rgrgiParents[ iBase + i + 1 ].push_back( iBase + i );
+            }
+            for ( unsigned uChildren = gen() % 4; uChildren--; )
+            {
+              int iChild = i + 1 + int( gen() % ( s_kiNodes - i ) );
+              if ( iChild < s_kiNodes )
+              {
+                rl.add_child( rgpgn[ i ], rgpgn[ iChild ], 0 );
+                rgrgiChildren[ iBase + i ].push_back( iBase + iChild );
+                rgrgiParents[ iBase + iChild ].push_back( iBase + i );
+              }
+            }
+          }
+        } ) );
+    }
+    for ( size_t st = 0; st < rgthr.size(); ++st )
+    {
+      rgthr[ st ].join();
+    }
+    gcb.commit( 4 );
+  }
+  vector< int > rgiHubChildren;
+  for ( const _TyGraphLinkBaseBase * pglb = *pgnHub->PPGLBChildHead(); pglb; pglb = pglb->PGLBGetNextChild() )
+  {
+    rgiHubChildren.push_back( static_cast< const _TyGraphNode * >( pglb->PGNBChild() )->RElConst() );
+  }
+  sort( rgiHubChildren.begin(), rgiHubChildren.end() );
+  bool fHub = ( rgiHubChildren.size() == s_kuThreads );
+  for ( size_t st = 0; fHub && ( st < rgiHubChildren.size() ); ++st )
+  {
+    fHub = ( rgiHubChildren[ st ] == int( st ) * s_kiNodes );
+  }
+  _Check( fHub, "the hub has the first node of each thread as children" );
+
+  _graph_edge_list_exporter< _TyGraph > gele( g );
+  _Check( gele.StNodes() == 1 + s_kuThreads * s_kiNodes, "commit() connects every node" );
+  bool fChildren = true;
+  bool fParents = true;
+  for ( size_t st = 0; st < gele.StNodes(); ++st )
+  {
+    const _TyGraphNode * pgn = gele.PGNNode( st );
+    if ( pgn == pgnHub )
+    {
+      continue;
+    }
+    vector< int > rgi;
+    for ( const _TyGraphLinkBaseBase * pglb = *pgn->PPGLBChildHead(); pglb; pglb = pglb->PGLBGetNextChild() )
+    {
+      rgi.push_back( static_cast< const _TyGraphNode * >( pglb->PGNBChild() )->RElConst() );
+    }
+    fChildren = fChildren && ( rgi == rgrgiChildren[ pgn->RElConst() ] );
+    rgi.clear();
+    for ( const _TyGraphLinkBaseBase * pglb = *pgn->PPGLBParentHead(); pglb; pglb = pglb->PGLBGetNextParent() )
+    {
+      rgi.push_back( static_cast< const _TyGraphNode * >( pglb->PGNBParent() )->RElConst() );
+    }
+    sort( rgi.begin(), rgi.end() );
+    sort( rgrgiParents[ pgn->RElConst() ].begin(), rgrgiParents[ pgn->RElConst() ].end() );
+    fParents = fParents && ( rgi == rgrgiParents[ pgn->RElConst() ] );
+  }
+  _Check( fChildren, "children are connected in the order queued" );
+  _Check( fParents, "parents are connected as queued" );
+
+  // Abandoned - the builder destroys what it created:
+  {
+    _TyBuilder gcb( g );
+    vector< thread > rgthr;
+    for ( unsigned u = 0; u < s_kuThreads; ++u )
+    {
+      rgthr.push_back( thread( [&gcb,pgnHub]()
+        {
+          _TyBuilder::_TyLocal & rl = gcb.get_local();
+          for ( int i = 0; i < 100; ++i )
+          {
+            rl.add_child( pgnHub, rl.create_node( i ), i );
+          }
+        } ) );
+    }
+    for ( size_t st = 0; st < rgthr.size(); ++st )
+    {
+      rgthr[ st ].join();
+    }
+  }
+  _Check( pgnHub->UChildren() == s_kuThreads, "an abandoned builder connects nothing" );
+}
+
+int
+main()
+{
+  _TestThreadSafeViewers();
+  _TestEpochReaders();
+  _TestPoolAllocator();
+  _TestBatchViewerDeinit();
+  _TestShadowMaintainer();
+  _TestCopyOnWriteElements();
+  _TestVersionedReaders();
+  _TestConcurrentBuilder();
+  if ( s_nFailures )
+  {
+    fprintf( stderr, "%d check(s) failed.\n", int( s_nFailures ) );
+    return 1;
+  }
+  printf( "All checks passed.\n" );
+  return 0;
+}
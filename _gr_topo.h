@@ -0,0 +1,182 @@
+#ifndef __GR_TOPO_H
+#define __GR_TOPO_H
+
+//          Copyright David Lawrence Bien 1997 - 2021.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt).
+
+// _gr_topo.h
+
+// Topological order ( Kahn ).
+// The nodes are numbered with _graph_edge_list_exporter ( _gr_bulk.h ) - this covers every node
+//  of the graph as the graph owns exactly the nodes connected to its root. The child lists are
+//  copied once to CSR arrays by node id - the sort itself only indexes arrays. In-degrees are
+//  counted from the CSR and the order is produced a level at a time: level 0 is the
+//  nodes with no parents, level n+1 the nodes all of whose parents are in levels 0..n. The nodes
+//  of a level may be processed in parallel.
+// If the graph has a cycle compute() returns false, the order holds only the nodes that precede
+//  every cycle and RgstCycle() holds the nodes of one cycle - each a parent of the next, the last a
+//  parent of the first.
+// The result remains valid until the graph is modified - compute() once and reuse the order.
+
+#include <stddef.h>
+#include <vector>
+#include <algorithm>
+
+__DGRAPH_BEGIN_NAMESPACE
+
+template < class t_TyGraph >
+class _graph_topological_sort
+{
+  typedef _graph_topological_sort< t_TyGraph > _TyThis;
+public:
+  typedef t_TyGraph                                     _TyGraph;
+  typedef typename t_TyGraph::_TyGraphNode              _TyGraphNode;
+  typedef typename _TyGraphNode::_TyGraphLinkBaseBase   _TyGraphLinkBaseBase;
+  typedef _graph_edge_list_exporter< t_TyGraph >        _TyNumbering;
+
+  explicit _graph_topological_sort( t_TyGraph const & _rg )
+    : m_gele( _rg )
+  {
+    m_rgstOffsets.resize( m_gele.StNodes() + 1 );
+    m_rgstChildren.resize( m_gele.StLinks() );
+    m_gele.CopyCSR( m_rgstOffsets.begin(), m_rgstChildren.begin() );
+  }
+
+  _TyNumbering const &  RNumbering() const _BIEN_NOTHROW
+  {
+    return m_gele;
+  }
+
+  // Returns true if the graph is acyclic:
+  bool  compute()
+  {
+    size_t stNodes = m_gele.StNodes();
+    vector< size_t > rgstIn( stNodes );
+    m_rgstOrder.clear();
+    m_rgstOrder.reserve( stNodes );
+    m_rgstLevelOffsets.clear();
+    m_rgstCycle.clear();
+    m_rgstLevel.assign( stNodes, 0 );
+
+    for ( size_t stEdge = 0; stEdge < m_rgstChildren.size(); ++stEdge )
+    {
+      ++rgstIn[ m_rgstChildren[ stEdge ] ];
+    }
+    for ( size_t st = 0; st < stNodes; ++st )
+    {
+      if ( !rgstIn[ st ] )
+      {
+        m_rgstOrder.push_back( st );
+      }
+    }
+
+    size_t stLevelBegin = 0;
+    for ( size_t stLevel = 0; stLevelBegin < m_rgstOrder.size(); ++stLevel )
+    {
+      m_rgstLevelOffsets.push_back( stLevelBegin );
+      size_t stLevelEnd = m_rgstOrder.size();
+      for ( size_t stCur = stLevelBegin; stCur < stLevelEnd; ++stCur )
+      {
+        size_t stV = m_rgstOrder[ stCur ];
+        m_rgstLevel[ stV ] = stLevel;
+        for ( size_t stEdge = m_rgstOffsets[ stV ]; stEdge < m_rgstOffsets[ stV + 1 ]; ++stEdge )
+        {
+          size_t stW = m_rgstChildren[ stEdge ];
+          if ( !--rgstIn[ stW ] )
+          {
+            m_rgstOrder.push_back( stW );
+          }
+        }
+      }
+      stLevelBegin = stLevelEnd;
+    }
+    m_rgstLevelOffsets.push_back( m_rgstOrder.size() );
+
+    if ( m_rgstOrder.size() == stNodes )
+    {
+      return true;
+    }
+    _FindCycle( rgstIn );
+    return false;
+  }
+
+  // The order - node ids of RNumbering():
+  vector< size_t > const &  RgstOrder() const _BIEN_NOTHROW
+  {
+    return m_rgstOrder;
+  }
+  const _TyGraphNode *  PGNOrder( size_t _st ) const _BIEN_NOTHROW
+  {
+    return m_gele.PGNNode( m_rgstOrder[ _st ] );
+  }
+  // Level sets - level i is RgstOrder()[ StLevelBegin( i ) .. StLevelBegin( i+1 ) ):
+  size_t  StLevels() const _BIEN_NOTHROW
+  {
+    return m_rgstLevelOffsets.empty() ? 0 : m_rgstLevelOffsets.size() - 1;
+  }
+  size_t  StLevelBegin( size_t _stLevel ) const _BIEN_NOTHROW
+  {
+    return m_rgstLevelOffsets[ _stLevel ];
+  }
+  // The level of an ordered node:
+  size_t  StLevel( size_t _stNode ) const _BIEN_NOTHROW
+  {
+    return m_rgstLevel[ _stNode ];
+  }
+  // Empty if acyclic:
+  vector< size_t > const &  RgstCycle() const _BIEN_NOTHROW
+  {
+    return m_rgstCycle;
+  }
+  // The children of node i are RgstChildren()[ RgstChildOffsets()[ i ] .. RgstChildOffsets()[ i+1 ] ):
+  vector< size_t > const &  RgstChildOffsets() const _BIEN_NOTHROW
+  {
+    return m_rgstOffsets;
+  }
+  vector< size_t > const &  RgstChildren() const _BIEN_NOTHROW
+  {
+    return m_rgstChildren;
+  }
+
+protected:
+
+  _TyNumbering      m_gele;
+  vector< size_t >  m_rgstOffsets;    // CSR of the child lists.
+  vector< size_t >  m_rgstChildren;
+  vector< size_t >  m_rgstOrder;
+  vector< size_t >  m_rgstLevelOffsets;
+  vector< size_t >  m_rgstLevel;
+  vector< size_t >  m_rgstCycle;
+
+  // Every unordered node has an unordered parent - walk unordered parents until a node repeats:
+  void  _FindCycle( vector< size_t > const & _rrgstIn )
+  {
+    size_t stNodes = m_gele.StNodes();
+    vector< size_t > rgstParentOffsets, rgstParents;
+    _ReverseCSR( m_rgstOffsets, m_rgstChildren, rgstParentOffsets, rgstParents );
+    vector< size_t > rgstStep( stNodes, size_t( -1 ) );
+    size_t stV = 0;
+    while ( !_rrgstIn[ stV ] )
+    {
+      ++stV;
+    }
+    vector< size_t > rgstPath;
+    for ( size_t stStep = 0; size_t( -1 ) == rgstStep[ stV ]; ++stStep )
+    {
+      rgstStep[ stV ] = stStep;
+      rgstPath.push_back( stV );
+      size_t stEdge = rgstParentOffsets[ stV ];
+      for ( ; _rrgstIn[ rgstParents[ stEdge ] ] == 0; ++stEdge )
+        ;
+      stV = rgstParents[ stEdge ];
+    }
+    // rgstPath[ rgstStep[ stV ] .. ] is the cycle - child before parent - reverse it:
+    m_rgstCycle.assign( rgstPath.rbegin(), rgstPath.rend() - rgstStep[ stV ] );
+  }
+};
+
+__DGRAPH_END_NAMESPACE
+
+#endif //__GR_TOPO_H
@@ -24,6 +24,7 @@
 
 #include "_aloctrt.h"
 
+#include "_gr_pool.h"
 #include "_gr_alst.h"
 #include "_gr_iter.h"
 #include "_gr_type.h"
@@ -35,6 +36,7 @@
 #include "_gr_gitr.h"
 #include "_gr_sril.h"
 #include "_gr_dump.h"
+#include "_gr_port.h"
 #include "_gr_outp.h"
 #include "_gr_inpt.h"
 #include "_gr_stin.h"
@@ -44,6 +46,10 @@
 #include "_gr_stio.h"
 #include "_gr_fdio.h"
 #include "_gr_mmio.h"
+#include "_gr_para.h"
+#include "_gr_aout.h"
+#include "_gr_pldr.h"
+#include "_gr_crc.h"
 #ifdef __GR_DEFINEOLEIO
 #include "_gr_olio.h"
 #endif //__GR_DEFINEOLEIO
@@ -162,6 +168,8 @@ private:
                                       true, t_TyGraphNode, t_TyGraphLink, t_TyPathNode >  _TyThis;
 public:
   static const bool ms_fIsSafeGraph = true;
+  typedef typename t_TyGraphNode::_TyGraphConnectionLink  _TyConnectionLink; // Viewer connection link type.
+  static const bool ms_fThreadSafeConnections = _TyConnectionLink::s_kfThreadSafe;
 
   typedef typename _TyBase::_TyPathNodeBase _TyPathNodeBase;
   typedef typename _TyBase::_TyPathNodeBaseBase _TyPathNodeBaseBase;
@@ -888,6 +896,31 @@ public:
                                     true > /*use seek*/             _TyBinaryMemMappedOutputIterBase;
   typedef _graph_output_iterator< _TyGraphNode, _TyGraphLink, _TyBinaryMemMappedOutput,
                                   _TyBinaryMemMappedOutputIterBase, std::true_type >   _TyBinaryMemMappedOuputIterConst;
+  // Asynchronous fd (file descriptor) iterator - the traversal fills a ring of buffers which
+  //  are written to the file by a writer thread:
+  // Default is const and doesn't allow unconstructed ( unconnected ) links to be written:
+  typedef _binary_output_object<  _TyGraphNode, _TyGraphLink, 
+                                  _async_file_out_object< _mm_RawElIO >,
+                                  t_TyAllocatorPathNodeBase, 
+                                  false, false >                    _TyBinaryAsyncFiledesOutput;
+  typedef typename _TyBinaryAsyncFiledesOutput::_TyOutputStreamBase _TyBinaryAsyncFiledesOutputBase;
+  typedef _graph_output_iter_base<  _TyBinaryAsyncFiledesOutputBase, 
+                                    t_TyAllocatorPathNodeBase,
+                                    true > /*use seek*/             _TyBinaryAsyncFiledesOutputIterBase;
+  typedef _graph_output_iterator< _TyGraphNode, _TyGraphLink, _TyBinaryAsyncFiledesOutput,
+                                  _TyBinaryAsyncFiledesOutputIterBase, std::true_type >   _TyBinaryAsyncFiledesOutputIterConst;
+
+  // Portable ostream iterator - fixed width little-endian, names are ids ( see _gr_port.h ):
+  typedef _binary_output_object<  _TyGraphNode, _TyGraphLink, 
+                                  _ostream_object< _iostream_PortableElIO >,
+                                  t_TyAllocatorPathNodeBase, 
+                                  false, false, true >              _TyBinaryPortableOstreamOutput;
+  typedef typename _TyBinaryPortableOstreamOutput::_TyOutputStreamBase _TyBinaryPortableOstreamBase;
+  typedef _graph_output_iter_base<  _TyBinaryPortableOstreamBase, 
+                                    t_TyAllocatorPathNodeBase,
+                                    true > /*use seek*/             _TyBinaryPortableOstreamIterBase;
+  typedef _graph_output_iterator< _TyGraphNode, _TyGraphLink, _TyBinaryPortableOstreamOutput,
+                                  _TyBinaryPortableOstreamIterBase, std::true_type >   _TyBinaryPortableOstreamIterConst;
 
   // binary input iterators:
   // istream iterator: Default is const and doesn't allow unconstructed ( unconnected ) links to be read:
@@ -916,6 +949,17 @@ public:
   typedef _graph_input_iter_base< _TyBinaryMemMappedInputBase, _TyGraphBaseBase, 
                                   t_TyAllocatorPathNodeBase,
                                   true, false >                             _TyBinaryMemMappedInputIterBase;
+  // Portable istream iterator:
+  typedef _binary_input_object< _TyGraphNode, _TyGraphLink, 
+                                _istream_object< _iostream_PortableElIO >, 
+                                false,
+                                const typename _TyGraphNode::_TyGraphNodeBaseBase *,
+                                const typename _TyGraphLink::_TyGraphLinkBaseBase *,
+                                true >                                      _TyBinaryPortableIstreamInput;
+  typedef typename _TyBinaryPortableIstreamInput::_TyInputObjectBase        _TyBinaryPortableIstreamBase;
+  typedef _graph_input_iter_base< _TyBinaryPortableIstreamBase, _TyGraphBaseBase, 
+                                  t_TyAllocatorPathNodeBase,
+                                  true, false >                             _TyBinaryPortableIstreamIterBase;
   // Define a template to access the full type of the input iterator:
   // Need to have the most derived graph type to declare the input iterator itself.
   template <  class t_TyMostDerivedGraph, 
@@ -978,19 +1022,22 @@ struct _graph_traits_notsafe
 {
 };
 
+// t_TyConnectionLink is the type of the links from the nodes and links to their viewers - use
+//  _graph_connection_link_ts when viewers are connected and disconnected on other threads.
 template <  class t_TyNodeEl, class t_TyLinkEl,
             class t_TyAllocatorGraphNode = allocator<char>,   // Cascade the default allocators.
             class t_TyAllocatorGraphLink = t_TyAllocatorGraphNode,
             class t_TyAllocatorPathNodeBase = t_TyAllocatorGraphLink, 
-            class t_TyAllocatorPathNodeSafe = t_TyAllocatorPathNodeBase >
+            class t_TyAllocatorPathNodeSafe = t_TyAllocatorPathNodeBase,
+            class t_TyConnectionLink = _graph_connection_link >
 struct _graph_traits_safe
   : public _graph_traits< t_TyNodeEl, t_TyLinkEl, true,
                           t_TyAllocatorGraphNode, t_TyAllocatorGraphLink,
                           t_TyAllocatorPathNodeBase, t_TyAllocatorPathNodeSafe,
-                          _graph_node< t_TyNodeEl, t_TyLinkEl, _graph_node_safe_base >, 
-                          _graph_link< t_TyLinkEl, t_TyNodeEl, _graph_link_safe_base< _graph_node_safe_base > >,
-                          _graph_path_node_safe_base< _graph_node_safe_base, 
-                            _graph_link_safe_base< _graph_node_safe_base > > >
+                          _graph_node< t_TyNodeEl, t_TyLinkEl, _graph_node_safe_base< t_TyConnectionLink > >, 
+                          _graph_link< t_TyLinkEl, t_TyNodeEl, _graph_link_safe_base< _graph_node_safe_base< t_TyConnectionLink > > >,
+                          _graph_path_node_safe_base< _graph_node_safe_base< t_TyConnectionLink >, 
+                            _graph_link_safe_base< _graph_node_safe_base< t_TyConnectionLink > > > >
 {
 #ifdef __GR_USESHADOWSTUFF
   // Define graph traits for a shadow graph of this graph:
@@ -1004,13 +1051,40 @@ struct _graph_traits_safe
   typedef _graph_traits< t_TyNodeEl, t_TyLinkEl, true,
                           t_TyAllocatorGraphNode, t_TyAllocatorGraphLink,
                           t_TyAllocatorPathNodeBase, t_TyAllocatorPathNodeSafe,
-                          _sgraph_node< t_TyNodeEl, t_TyLinkEl, _graph_node_safe_base >, 
-                          _sgraph_link< t_TyLinkEl, t_TyNodeEl, _graph_link_safe_base< _graph_node_safe_base > >,
-                          _graph_path_node_safe_base< _graph_node_safe_base, 
-                            _graph_link_safe_base< _graph_node_safe_base > >  _TyShadowTraitsSafe;
+                          _sgraph_node< t_TyNodeEl, t_TyLinkEl, _graph_node_safe_base< t_TyConnectionLink > >, 
+                          _sgraph_link< t_TyLinkEl, t_TyNodeEl, _graph_link_safe_base< _graph_node_safe_base< t_TyConnectionLink > > >,
+                          _graph_path_node_safe_base< _graph_node_safe_base< t_TyConnectionLink >, 
+                            _graph_link_safe_base< _graph_node_safe_base< t_TyConnectionLink > > >  _TyShadowTraitsSafe;
 #endif //__GR_USESHADOWSTUFF
 };
 
+// Safe graph traits with path nodes drawn from the per-thread pool ( _gr_pool.h ) - for graphs
+//  whose clients create and destroy many path iterators:
+template <  class t_TyNodeEl, class t_TyLinkEl,
+            class t_TyAllocatorGraphNode = allocator<char>,
+            class t_TyAllocatorGraphLink = t_TyAllocatorGraphNode >
+struct _graph_traits_safe_pooled
+  : public _graph_traits_safe< t_TyNodeEl, t_TyLinkEl,
+                               t_TyAllocatorGraphNode, t_TyAllocatorGraphLink,
+                               _graph_pool_allocator< char >, _graph_pool_allocator< char > >
+{
+};
+
+// Safe graph traits whose viewers may be connected and disconnected on threads other than the one
+//  destroying the viewed nodes and links ( see _graph_connection_link_ts ):
+template <  class t_TyNodeEl, class t_TyLinkEl,
+            class t_TyAllocatorGraphNode = allocator<char>,
+            class t_TyAllocatorGraphLink = t_TyAllocatorGraphNode,
+            class t_TyAllocatorPathNodeBase = t_TyAllocatorGraphLink, 
+            class t_TyAllocatorPathNodeSafe = t_TyAllocatorPathNodeBase >
+struct _graph_traits_safe_ts
+  : public _graph_traits_safe< t_TyNodeEl, t_TyLinkEl,
+                               t_TyAllocatorGraphNode, t_TyAllocatorGraphLink,
+                               t_TyAllocatorPathNodeBase, t_TyAllocatorPathNodeSafe,
+                               _graph_connection_link_ts >
+{
+};
+
 // Now declare a mapping type given the default graph parameters:
 template <  class t_TyNodeEl, class t_TyLinkEl, bool t_fIsSafeGraph, class t_TyAllocator >
 struct _graph_traits_map
@@ -0,0 +1,70 @@
+#ifndef __GR_TST1_H
+#define __GR_TST1_H
+
+//          Copyright David Lawrence Bien 1997 - 2021.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt).
+
+// _gr_tst1.h
+
+// Random test graphs - built with dgraph::replace_edge_list() so node i is the i'th node element.
+// Node 0 is the root and a random spanning tree from it keeps every node connected to the root.
+//  <_stExtraLinks> further links join random nodes - with <_fAcyclic> each goes from the lesser
+//  to the greater node number, so the graph is a DAG. Elements are random in [ 0, 1000 ).
+// The generator is seeded - the same arguments give the same graph on every platform.
+
+#include "_gr_inc.h"
+#include <stddef.h>
+#include <vector>
+#include <random>
+
+template < class t_TyGraph >
+void
+CreateTestGraphRandom( t_TyGraph & g, size_t _stNodes, size_t _stExtraLinks, bool _fAcyclic, unsigned _uSeed )
+{
+  typedef typename t_TyGraph::_TyNodeEl _TyNodeEl;
+  typedef typename t_TyGraph::_TyLinkEl _TyLinkEl;
+  typedef ns_dgraph::_graph_edge< _TyLinkEl > _TyEdge;
+
+  g.destroy();
+  if ( !_stNodes )
+  {
+    return;
+  }
+  std::mt19937 gen( _uSeed );
+  std::vector< _TyNodeEl > rgNodeEls;
+  rgNodeEls.reserve( _stNodes );
+  for ( size_t st = 0; st < _stNodes; ++st )
+  {
+    rgNodeEls.push_back( _TyNodeEl( gen() % 1000 ) );
+  }
+  std::vector< _TyEdge > rgEdges;
+  for ( size_t st = 1; st < _stNodes; ++st )
+  {
+    _TyEdge e = { gen() % st, st, _TyLinkEl( gen() % 1000 ) };
+    rgEdges.push_back( e );
+  }
+  for ( size_t st = 0; st < _stExtraLinks; ++st )
+  {
+    size_t stParent = gen() % _stNodes;
+    size_t stChild = gen() % _stNodes;
+    if ( _fAcyclic )
+    {
+      if ( stParent == stChild )
+      {
+        continue;
+      }
+      if ( stParent > stChild )
+      {
+        std::swap( stParent, stChild );
+      }
+    }
+    _TyEdge e = { stParent, stChild, _TyLinkEl( gen() % 1000 ) };
+    rgEdges.push_back( e );
+  }
+  g.replace_edge_list( &rgNodeEls[ 0 ], rgNodeEls.size(),
+                       rgEdges.empty() ? 0 : &rgEdges[ 0 ], rgEdges.size() );
+}
+
+#endif //__GR_TST1_H
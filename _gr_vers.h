@@ -0,0 +1,890 @@
+#ifndef __GR_VERS_H
+#define __GR_VERS_H
+
+//          Copyright David Lawrence Bien 1997 - 2021.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt).
+
+// _gr_vers.h
+
+// Persistent versioned graph.
+// Nodes and links are named by ids ( dense, not reused ) and kept in two level tables of fixed
+//  size chunks. Each node holds its element and its child and parent lists ( as link ids ), each
+//  link holds its element and its parent and child node ids. All of these are shared between
+//  versions - a change copies only the chunk table, the chunk and the record ( or relation list )
+//  touched - and only once per commit.
+// A single writer modifies the working version and then commit()s it - this publishes a new
+//  version with the next version id. Any number of readers may hold versions ( get_version() ) -
+//  a version and whatever it alone references is reclaimed when the last reader lets go of it.
+//  The most recent set_retain() versions are also kept by the versioned graph itself so that
+//  they may be looked up by id.
+// Versions are read through the accessors on _TyVersion or traversed with its iterators: a
+//  _TyNodeIterConst navigates from node to node as the graph's node iterators do, and a
+//  const_iterator ( begin() ) visits each node connected to the root once. Or materialize() a
+//  version into a dgraph ( of the type given as t_TyGraph ) to use the graph iterators on it.
+// A dgraph is brought in with assign() - after the commit() each version a reader holds is a
+//  consistent snapshot that costs only what the writer has since changed.
+
+#include <stddef.h>
+#include <memory>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <algorithm>
+#include <unordered_map>
+
+__DGRAPH_BEGIN_NAMESPACE
+
+template < class t_TyGraph >
+class _versioned_graph
+{
+  typedef _versioned_graph< t_TyGraph > _TyThis;
+public:
+
+  typedef t_TyGraph                                     _TyGraph;
+  typedef typename t_TyGraph::_TyGraphNode              _TyGraphNode;
+  typedef typename t_TyGraph::_TyGraphLink              _TyGraphLink;
+  typedef typename t_TyGraph::_TyNodeEl                 _TyNodeEl;
+  typedef typename t_TyGraph::_TyLinkEl                 _TyLinkEl;
+  typedef typename _TyGraphNode::_TyGraphLinkBaseBase   _TyGraphLinkBaseBase;
+
+  static const size_t s_kstNull = size_t( -1 );       // null node or link id.
+  static const size_t s_kstEnd = size_t( -1 );        // relation position - append.
+  static const size_t s_kstChunkShift = 6;
+  static const size_t s_kstChunkSize = size_t( 1 ) << s_kstChunkShift;
+
+protected:
+
+  // Every shared object is tagged with the version that created it - the writer may modify
+  //  those tagged with the working version in place and must copy any others.
+  struct _relations
+  {
+    size_t          m_uVersion;
+    vector< size_t > m_rgst;
+  };
+  typedef shared_ptr< _relations > _TyPtrRelations;
+
+  struct _node_rec
+  {
+    size_t          m_uVersion;
+    _TyNodeEl       m_el;
+    _TyPtrRelations m_prelChildren;
+    _TyPtrRelations m_prelParents;
+
+    _node_rec( size_t _uVersion, _TyNodeEl const & _rel, _TyPtrRelations const & _prelEmpty )
+      : m_uVersion( _uVersion ),
+        m_el( _rel ),
+        m_prelChildren( _prelEmpty ),
+        m_prelParents( _prelEmpty )
+    {
+    }
+  };
+
+  struct _link_rec
+  {
+    size_t    m_uVersion;
+    _TyLinkEl m_el;
+    size_t    m_stParent;
+    size_t    m_stChild;
+
+    _link_rec( size_t _uVersion, _TyLinkEl const & _rel, size_t _stParent, size_t _stChild )
+      : m_uVersion( _uVersion ),
+        m_el( _rel ),
+        m_stParent( _stParent ),
+        m_stChild( _stChild )
+    {
+    }
+  };
+
+  template < class t_TyRec >
+  struct _chunk
+  {
+    size_t                m_uVersion;
+    shared_ptr< t_TyRec > m_rgprec[ s_kstChunkSize ];
+  };
+
+  template < class t_TyRec >
+  struct _table
+  {
+    typedef shared_ptr< _chunk< t_TyRec > > _TyPtrChunk;
+    size_t                  m_uVersion;
+    size_t                  m_stSize;     // ids allocated.
+    vector< _TyPtrChunk >   m_rgpch;
+
+    const t_TyRec * PRec( size_t _st ) const _BIEN_NOTHROW
+    {
+      return ( _st < m_stSize ) ? m_rgpch[ _st >> s_kstChunkShift ]->m_rgprec[ _st & ( s_kstChunkSize - 1 ) ].get() : 0;
+    }
+  };
+  typedef _table< _node_rec > _TyNodeTable;
+  typedef _table< _link_rec > _TyLinkTable;
+
+  struct _version
+  {
+    size_t                    m_uId;
+    shared_ptr< _TyNodeTable > m_ptblNodes;
+    shared_ptr< _TyLinkTable > m_ptblLinks;
+    size_t                    m_stRoot;
+  };
+
+public:
+
+  class _TyNodeIterConst;
+  class const_iterator;
+
+  // A reader's handle on one version - cheap to copy:
+  class _TyVersion
+  {
+    friend class _versioned_graph< t_TyGraph >;
+    shared_ptr< const _version > m_pv;
+    explicit _TyVersion( shared_ptr< const _version > const & _pv )
+      : m_pv( _pv )
+    {
+    }
+  public:
+    _TyVersion()
+    {
+    }
+
+    bool    FIsNull() const _BIEN_NOTHROW
+    {
+      return !m_pv;
+    }
+    size_t  UId() const _BIEN_NOTHROW
+    {
+      return m_pv->m_uId;
+    }
+    size_t  StRoot() const _BIEN_NOTHROW
+    {
+      return m_pv->m_stRoot;
+    }
+
+    // Ids are less than these - ids of destroyed nodes and links remain invalid:
+    size_t  StNodeIdLimit() const _BIEN_NOTHROW
+    {
+      return m_pv->m_ptblNodes->m_stSize;
+    }
+    size_t  StLinkIdLimit() const _BIEN_NOTHROW
+    {
+      return m_pv->m_ptblLinks->m_stSize;
+    }
+    bool    FNode( size_t _stNode ) const _BIEN_NOTHROW
+    {
+      return !!m_pv->m_ptblNodes->PRec( _stNode );
+    }
+    bool    FLink( size_t _stLink ) const _BIEN_NOTHROW
+    {
+      return !!m_pv->m_ptblLinks->PRec( _stLink );
+    }
+
+    const _TyNodeEl & RNodeEl( size_t _stNode ) const
+    {
+      return _RNode( _stNode ).m_el;
+    }
+    size_t  UChildren( size_t _stNode ) const
+    {
+      return _RNode( _stNode ).m_prelChildren->m_rgst.size();
+    }
+    size_t  UParents( size_t _stNode ) const
+    {
+      return _RNode( _stNode ).m_prelParents->m_rgst.size();
+    }
+    // The link to the _u'th child/parent:
+    size_t  StChildLink( size_t _stNode, size_t _u ) const
+    {
+      return _RNth( _RNode( _stNode ).m_prelChildren->m_rgst, _u );
+    }
+    size_t  StParentLink( size_t _stNode, size_t _u ) const
+    {
+      return _RNth( _RNode( _stNode ).m_prelParents->m_rgst, _u );
+    }
+
+    const _TyLinkEl & RLinkEl( size_t _stLink ) const
+    {
+      return _RLink( _stLink ).m_el;
+    }
+    size_t  StLinkParent( size_t _stLink ) const
+    {
+      return _RLink( _stLink ).m_stParent;
+    }
+    size_t  StLinkChild( size_t _stLink ) const
+    {
+      return _RLink( _stLink ).m_stChild;
+    }
+
+    // Iteration - the iterators hold this version:
+    _TyNodeIterConst  get_node_iterator( size_t _stNode ) const;
+    const_iterator    begin() const;
+
+    // Build the connected subgraph containing the root of this version in _rg - replacing its
+    //  contents. Relation order is preserved.
+    void  materialize( _TyGraph & _rg ) const;
+
+  protected:
+    const _node_rec & _RNode( size_t _stNode ) const
+    {
+      const _node_rec * pnr = m_pv->m_ptblNodes->PRec( _stNode );
+      if ( !pnr )
+      {
+        throw _graph_nav_except( "_versioned_graph: Invalid node id." );
+      }
+      return *pnr;
+    }
+    const _link_rec & _RLink( size_t _stLink ) const
+    {
+      const _link_rec * plr = m_pv->m_ptblLinks->PRec( _stLink );
+      if ( !plr )
+      {
+        throw _graph_nav_except( "_versioned_graph: Invalid link id." );
+      }
+      return *plr;
+    }
+    static size_t _RNth( vector< size_t > const & _rrgst, size_t _u )
+    {
+      if ( _u >= _rrgst.size() )
+      {
+        throw _graph_nav_except( "_versioned_graph: Relation index beyond end." );
+      }
+      return _rrgst[ _u ];
+    }
+  };
+
+  // Navigation of a version by node - as with the graph's node iterators ( _gr_iter.h ):
+  class _TyNodeIterConst
+    : public _TyVersion
+  {
+    typedef _TyVersion _TyBase;
+  protected:
+    size_t  m_stCur;
+  public:
+    _TyNodeIterConst()
+      : m_stCur( s_kstNull )
+    {
+    }
+    _TyNodeIterConst( _TyVersion const & _rv, size_t _stNode )
+      : _TyBase( _rv ),
+        m_stCur( _stNode )
+    {
+    }
+
+    size_t  StNodeCur() const _BIEN_NOTHROW
+    {
+      return m_stCur;
+    }
+    void    SetStNodeCur( size_t _stNode ) _BIEN_NOTHROW
+    {
+      m_stCur = _stNode;
+    }
+    void    Clear() _BIEN_NOTHROW
+    {
+      m_stCur = s_kstNull;
+    }
+    bool operator ! () const _BIEN_NOTHROW
+    {
+      return s_kstNull == m_stCur;
+    }
+
+    const _TyNodeEl & operator * () const
+    {
+      return _TyBase::RNodeEl( m_stCur );
+    }
+    const _TyNodeEl * operator -> () const
+    {
+      return &_TyBase::RNodeEl( m_stCur );
+    }
+
+    _TyGNIndex  UParents() const
+    {
+      return _TyGNIndex( _TyBase::UParents( m_stCur ) );
+    }
+    bool        FParents() const
+    {
+      return !!UParents();
+    }
+    _TyGNIndex  UChildren() const
+    {
+      return _TyGNIndex( _TyBase::UChildren( m_stCur ) );
+    }
+    bool        FChildren() const
+    {
+      return !!UChildren();
+    }
+    const _TyLinkEl & RParentLinkEl( _TyGNIndex _u ) const
+    {
+      return _TyBase::RLinkEl( _TyBase::StParentLink( m_stCur, _u ) );
+    }
+    const _TyLinkEl & RChildLinkEl( _TyGNIndex _u ) const
+    {
+      return _TyBase::RLinkEl( _TyBase::StChildLink( m_stCur, _u ) );
+    }
+    void  GoParent( _TyGNIndex _u )
+    {
+      m_stCur = _TyBase::StLinkParent( _TyBase::StParentLink( m_stCur, _u ) );
+    }
+    void  GoChild( _TyGNIndex _u )
+    {
+      m_stCur = _TyBase::StLinkChild( _TyBase::StChildLink( m_stCur, _u ) );
+    }
+  };
+
+  // Visits each node of the connected subgraph containing the root once - through parents
+  //  and children alike:
+  class const_iterator
+    : public _TyNodeIterConst
+  {
+    typedef _TyNodeIterConst _TyBase;
+    vector< size_t >  m_rgstStack;
+    vector< char >    m_rgfVisited;
+  public:
+    const_iterator()
+    {
+    }
+    explicit const_iterator( _TyVersion const & _rv )
+      : _TyBase( _rv, s_kstNull )
+    {
+      if ( !_rv.FIsNull() && ( s_kstNull != _rv.StRoot() ) )
+      {
+        m_rgfVisited.resize( _rv.StNodeIdLimit() );
+        _Push( _rv.StRoot() );
+        ++*this;
+      }
+    }
+
+    bool  FAtEnd() const _BIEN_NOTHROW
+    {
+      return s_kstNull == this->m_stCur;
+    }
+    const_iterator & operator ++ ()
+    {
+      if ( m_rgstStack.empty() )
+      {
+        this->m_stCur = s_kstNull;
+        return *this;
+      }
+      this->m_stCur = m_rgstStack.back();
+      m_rgstStack.pop_back();
+      for ( _TyGNIndex u = 0, uEnd = _TyBase::UChildren(); u < uEnd; ++u )
+      {
+        _Push( _TyVersion::StLinkChild( _TyVersion::StChildLink( this->m_stCur, u ) ) );
+      }
+      for ( _TyGNIndex u = 0, uEnd = _TyBase::UParents(); u < uEnd; ++u )
+      {
+        _Push( _TyVersion::StLinkParent( _TyVersion::StParentLink( this->m_stCur, u ) ) );
+      }
+      return *this;
+    }
+  protected:
+    void  _Push( size_t _stNode )
+    {
+      if ( !m_rgfVisited[ _stNode ] )
+      {
+        m_rgfVisited[ _stNode ] = true;
+        m_rgstStack.push_back( _stNode );
+      }
+    }
+  };
+
+  explicit _versioned_graph( size_t _stRetain = 1 )
+    : m_stRetain( _stRetain ? _stRetain : 1 ),
+      m_uWork( 0 )
+  {
+    __THROWPT( e_ttMemory );
+    m_prelEmpty = make_shared< _relations >();
+    m_prelEmpty->m_uVersion = 0;
+    shared_ptr< _version > pv = make_shared< _version >();
+    pv->m_uId = 0;
+    pv->m_ptblNodes = make_shared< _TyNodeTable >();
+    pv->m_ptblNodes->m_uVersion = 0;
+    pv->m_ptblNodes->m_stSize = 0;
+    pv->m_ptblLinks = make_shared< _TyLinkTable >();
+    pv->m_ptblLinks->m_uVersion = 0;
+    pv->m_ptblLinks->m_stSize = 0;
+    pv->m_stRoot = s_kstNull;
+    m_pvHead = pv;
+    m_dqRetained.push_back( m_pvHead );
+  }
+
+// Readers - may be called from any thread:
+
+  // The latest committed version:
+  _TyVersion  get_version() const
+  {
+    lock_guard< mutex > lock( m_mtx );
+    return _TyVersion( m_pvHead );
+  }
+  // A retained version by id - throws if it is no longer retained:
+  _TyVersion  get_version( size_t _uId ) const
+  {
+    lock_guard< mutex > lock( m_mtx );
+    for ( typename _TyRetained::const_iterator it = m_dqRetained.begin(); it != m_dqRetained.end(); ++it )
+    {
+      if ( (*it)->m_uId == _uId )
+      {
+        return _TyVersion( *it );
+      }
+    }
+    throw bad_graph( "_versioned_graph::get_version(): Version not retained." );
+  }
+  size_t  UHeadId() const
+  {
+    lock_guard< mutex > lock( m_mtx );
+    return m_pvHead->m_uId;
+  }
+  // Keep the _stRetain latest versions available to get_version( _uId ):
+  void  set_retain( size_t _stRetain )
+  {
+    lock_guard< mutex > lock( m_mtx );
+    m_stRetain = _stRetain ? _stRetain : 1;
+    _Trim();
+  }
+
+// Writer - one thread at a time. Changes are made to the working version - which starts as a
+//  copy of the latest committed version at the first change after a commit():
+
+  size_t  create_node( _TyNodeEl const & _rel = _TyNodeEl() )
+  {
+    _version & rv = _RWork();
+    _TyNodeTable & rtbl = _ROwn( rv.m_ptblNodes );
+    size_t st = rtbl.m_stSize;
+    _PPRecAppend( rtbl ) = make_shared< _node_rec >( m_uWork, _rel, m_prelEmpty );
+    ++rtbl.m_stSize;
+    return st;
+  }
+  // Add a link from _stParent to _stChild - at the given positions in the child list of the parent
+  //  and the parent list of the child:
+  size_t  add_child( size_t _stParent, size_t _stChild, _TyLinkEl const & _rel = _TyLinkEl(),
+                     size_t _uChildPos = s_kstEnd, size_t _uParentPos = s_kstEnd )
+  {
+    _version & rv = _RWork();
+    (void)_RNodeRead( rv, _stParent );
+    (void)_RNodeRead( rv, _stChild );
+    _TyLinkTable & rtblLinks = _ROwn( rv.m_ptblLinks );
+    size_t stLink = rtblLinks.m_stSize;
+    shared_ptr< _link_rec > & rplr = _PPRecAppend( rtblLinks );
+    rplr = make_shared< _link_rec >( m_uWork, _rel, _stParent, _stChild );
+    _BIEN_TRY
+    {
+      vector< size_t > & rrgstChildren = _RRelationsWrite( _RNodeWrite( rv, _stParent ).m_prelChildren );
+      vector< size_t > & rrgstParents = _RRelationsWrite( _RNodeWrite( rv, _stChild ).m_prelParents );
+      _Insert( rrgstChildren, _uChildPos, stLink );
+      _BIEN_TRY
+      {
+        _Insert( rrgstParents, _uParentPos, stLink );
+      }
+      _BIEN_UNWIND( rrgstChildren.erase( std::find( rrgstChildren.begin(), rrgstChildren.end(), stLink ) ) );
+    }
+    _BIEN_UNWIND( rplr.reset() );
+    ++rtblLinks.m_stSize;
+    return stLink;
+  }
+  void  remove_link( size_t _stLink )
+  {
+    _version & rv = _RWork();
+    const _link_rec & rlr = _RLinkRead( rv, _stLink );
+    size_t stParent = rlr.m_stParent;
+    size_t stChild = rlr.m_stChild;
+    vector< size_t > & rrgstChildren = _RRelationsWrite( _RNodeWrite( rv, stParent ).m_prelChildren );
+    vector< size_t > & rrgstParents = _RRelationsWrite( _RNodeWrite( rv, stChild ).m_prelParents );
+    shared_ptr< _link_rec > & rplr = _PPSlotWrite( rv.m_ptblLinks, _stLink );
+    rrgstChildren.erase( std::find( rrgstChildren.begin(), rrgstChildren.end(), _stLink ) );
+    rrgstParents.erase( std::find( rrgstParents.begin(), rrgstParents.end(), _stLink ) );
+    rplr.reset();
+  }
+  // Destroy the node and all links to and from it:
+  void  destroy_node( size_t _stNode )
+  {
+    _version & rv = _RWork();
+    for ( ; ; )
+    {
+      const _node_rec & rnr = _RNodeRead( rv, _stNode );
+      if ( !rnr.m_prelChildren->m_rgst.empty() )
+      {
+        remove_link( rnr.m_prelChildren->m_rgst.back() );
+      }
+      else
+      if ( !rnr.m_prelParents->m_rgst.empty() )
+      {
+        remove_link( rnr.m_prelParents->m_rgst.back() );
+      }
+      else
+      {
+        break;
+      }
+    }
+    _PPSlotWrite( rv.m_ptblNodes, _stNode ).reset();
+    if ( rv.m_stRoot == _stNode )
+    {
+      rv.m_stRoot = s_kstNull;
+    }
+  }
+  void  set_node_el( size_t _stNode, _TyNodeEl const & _rel )
+  {
+    _version & rv = _RWork();
+    (void)_RNodeRead( rv, _stNode );
+    _RNodeWrite( rv, _stNode ).m_el = _rel;
+  }
+  void  set_link_el( size_t _stLink, _TyLinkEl const & _rel )
+  {
+    _version & rv = _RWork();
+    (void)_RLinkRead( rv, _stLink );
+    _PPRecWrite( rv.m_ptblLinks, _stLink )->m_el = _rel;
+  }
+  void  set_root( size_t _stNode )
+  {
+    _version & rv = _RWork();
+    if ( s_kstNull != _stNode )
+    {
+      (void)_RNodeRead( rv, _stNode );
+    }
+    rv.m_stRoot = _stNode;
+  }
+
+  // Replace the working version with the component of the root of _rg - following relations in
+  //  both directions. Relation order is preserved. Changes since the last commit() are discarded.
+  // The ids start again from zero ( the root ) in breadth first order - they don't correspond to
+  //  the ids of earlier versions.
+  void  assign( _TyGraph const & _rg );
+
+  // The working version - for reading by the writer. Valid until the next commit() or abort():
+  _TyVersion  get_working_version()
+  {
+    return _TyVersion( shared_ptr< const _version >( m_pvWork ? m_pvWork : _PVHead() ) );
+  }
+
+  // Publish the working version - returns its id:
+  size_t  commit()
+  {
+    if ( !m_pvWork )
+    {
+      return _PVHead()->m_uId;
+    }
+    {
+      lock_guard< mutex > lock( m_mtx );
+      m_dqRetained.push_back( m_pvWork );
+      m_pvHead = m_pvWork;
+      _Trim();
+    }
+    m_pvWork.reset();
+    return m_pvHead->m_uId;
+  }
+  // Discard the changes made since the last commit():
+  void  abort() _BIEN_NOTHROW
+  {
+    m_pvWork.reset();
+  }
+
+protected:
+
+  typedef deque< shared_ptr< const _version > > _TyRetained;
+
+  mutable mutex                 m_mtx;          // Guards m_pvHead and m_dqRetained.
+  shared_ptr< const _version >  m_pvHead;
+  _TyRetained                   m_dqRetained;
+  size_t                        m_stRetain;
+  shared_ptr< _version >        m_pvWork;       // Writer only.
+  size_t                        m_uWork;        // Id of the working version.
+  _TyPtrRelations               m_prelEmpty;    // Shared by every node with no relations.
+
+  shared_ptr< const _version > _PVHead() const
+  {
+    lock_guard< mutex > lock( m_mtx );
+    return m_pvHead;
+  }
+  void  _Trim() _BIEN_NOTHROW
+  {
+    while ( m_dqRetained.size() > m_stRetain )
+    {
+      m_dqRetained.pop_front();
+    }
+  }
+
+  _version &  _RWork()
+  {
+    if ( !m_pvWork )
+    {
+      shared_ptr< const _version > pvHead = _PVHead();
+      __THROWPT( e_ttMemory );
+      m_pvWork = make_shared< _version >( *pvHead );
+      m_pvWork->m_uId = pvHead->m_uId + 1;
+      m_uWork = m_pvWork->m_uId;
+    }
+    return *m_pvWork;
+  }
+
+  // Make the object owned by the working version - copying if shared with a committed version:
+  template < class t_Ty >
+  t_Ty &  _ROwn( shared_ptr< t_Ty > & _rp )
+  {
+    if ( _rp->m_uVersion != m_uWork )
+    {
+      __THROWPT( e_ttMemory );
+      _rp = make_shared< t_Ty >( *_rp );
+      _rp->m_uVersion = m_uWork;
+    }
+    return *_rp;
+  }
+  // The slot of an existing id - the record itself is still shared:
+  template < class t_TyRec >
+  shared_ptr< t_TyRec > &  _PPSlotWrite( shared_ptr< _table< t_TyRec > > & _rptbl, size_t _st )
+  {
+    _table< t_TyRec > & rtbl = _ROwn( _rptbl );
+    return _ROwn( rtbl.m_rgpch[ _st >> s_kstChunkShift ] ).m_rgprec[ _st & ( s_kstChunkSize - 1 ) ];
+  }
+  template < class t_TyRec >
+  shared_ptr< t_TyRec > &  _PPRecWrite( shared_ptr< _table< t_TyRec > > & _rptbl, size_t _st )
+  {
+    shared_ptr< t_TyRec > & rprec = _PPSlotWrite( _rptbl, _st );
+    (void)_ROwn( rprec );
+    return rprec;
+  }
+  // The slot for the next id of an owned table:
+  template < class t_TyRec >
+  shared_ptr< t_TyRec > &  _PPRecAppend( _table< t_TyRec > & _rtbl )
+  {
+    size_t stChunk = _rtbl.m_stSize >> s_kstChunkShift;
+    if ( stChunk == _rtbl.m_rgpch.size() )
+    {
+      __THROWPT( e_ttMemory );
+      typename _table< t_TyRec >::_TyPtrChunk pch = make_shared< _chunk< t_TyRec > >();
+      pch->m_uVersion = m_uWork;
+      _rtbl.m_rgpch.push_back( pch );
+    }
+    return _ROwn( _rtbl.m_rgpch[ stChunk ] ).m_rgprec[ _rtbl.m_stSize & ( s_kstChunkSize - 1 ) ];
+  }
+
+  static const _node_rec &  _RNodeRead( _version const & _rv, size_t _stNode )
+  {
+    const _node_rec * pnr = _rv.m_ptblNodes->PRec( _stNode );
+    if ( !pnr )
+    {
+      throw _graph_nav_except( "_versioned_graph: Invalid node id." );
+    }
+    return *pnr;
+  }
+  static const _link_rec &  _RLinkRead( _version const & _rv, size_t _stLink )
+  {
+    const _link_rec * plr = _rv.m_ptblLinks->PRec( _stLink );
+    if ( !plr )
+    {
+      throw _graph_nav_except( "_versioned_graph: Invalid link id." );
+    }
+    return *plr;
+  }
+  _node_rec &  _RNodeWrite( _version & _rv, size_t _stNode )
+  {
+    return *_PPRecWrite( _rv.m_ptblNodes, _stNode );
+  }
+  vector< size_t > &  _RRelationsWrite( _TyPtrRelations & _rprel )
+  {
+    return _ROwn( _rprel ).m_rgst;
+  }
+  static void  _Insert( vector< size_t > & _rrgst, size_t _uPos, size_t _st )
+  {
+    if ( s_kstEnd == _uPos )
+    {
+      _rrgst.push_back( _st );
+    }
+    else
+    {
+      if ( _uPos > _rrgst.size() )
+      {
+        throw _graph_nav_except( "_versioned_graph: Relation index beyond end." );
+      }
+      _rrgst.insert( _rrgst.begin() + _uPos, _st );
+    }
+  }
+};
+
+template < class t_TyGraph >
+typename _versioned_graph< t_TyGraph >::_TyNodeIterConst
+_versioned_graph< t_TyGraph >::_TyVersion::get_node_iterator( size_t _stNode ) const
+{
+  return _TyNodeIterConst( *this, _stNode );
+}
+
+template < class t_TyGraph >
+typename _versioned_graph< t_TyGraph >::const_iterator
+_versioned_graph< t_TyGraph >::_TyVersion::begin() const
+{
+  return const_iterator( *this );
+}
+
+template < class t_TyGraph >
+void
+_versioned_graph< t_TyGraph >::_TyVersion::materialize( _TyGraph & _rg ) const
+{
+  _rg.destroy();
+  if ( s_kstNull == StRoot() )
+  {
+    return;
+  }
+
+  // Find the component of the root - following relations in both directions:
+  vector< size_t > rgstNodes;
+  vector< _TyGraphNode * > rgpgn( StNodeIdLimit(), (_TyGraphNode*)0 );
+  vector< _TyGraphLink * > rgpgl( StLinkIdLimit(), (_TyGraphLink*)0 );
+  vector< bool > rgfSeen( StNodeIdLimit(), false );
+  rgstNodes.push_back( StRoot() );
+  rgfSeen[ StRoot() ] = true;
+  for ( size_t stCur = 0; stCur < rgstNodes.size(); ++stCur )
+  {
+    const _node_rec & rnr = _RNode( rgstNodes[ stCur ] );
+    for ( int iRel = 0; iRel < 2; ++iRel )
+    {
+      vector< size_t > const & rrgst = ( iRel ? rnr.m_prelParents : rnr.m_prelChildren )->m_rgst;
+      for ( size_t u = 0; u < rrgst.size(); ++u )
+      {
+        const _link_rec & rlr = _RLink( rrgst[ u ] );
+        size_t stOther = iRel ? rlr.m_stParent : rlr.m_stChild;
+        if ( !rgfSeen[ stOther ] )
+        {
+          rgfSeen[ stOther ] = true;
+          rgstNodes.push_back( stOther );
+        }
+      }
+    }
+  }
+
+  // Create the nodes and links - until connected they are destroyed individually on throw:
+  _BIEN_TRY
+  {
+    for ( size_t st = 0; st < rgstNodes.size(); ++st )
+    {
+      const _node_rec & rnr = _RNode( rgstNodes[ st ] );
+      rgpgn[ rgstNodes[ st ] ] = _rg.template create_node1< _TyNodeEl const & >( rnr.m_el );
+      vector< size_t > const & rrgst = rnr.m_prelChildren->m_rgst;
+      for ( size_t u = 0; u < rrgst.size(); ++u )
+      {
+        rgpgl[ rrgst[ u ] ] = _rg.template create_link1< _TyLinkEl const & >( _RLink( rrgst[ u ] ).m_el );
+      }
+    }
+  }
+  catch( ... )
+  {
+    for ( size_t st = 0; st < rgpgl.size(); ++st )
+    {
+      if ( rgpgl[ st ] )
+      {
+        _rg.destroy_link( rgpgl[ st ] );
+      }
+    }
+    for ( size_t st = 0; st < rgpgn.size(); ++st )
+    {
+      if ( rgpgn[ st ] )
+      {
+        _rg.destroy_single_node( rgpgn[ st ] );
+      }
+    }
+    throw;
+  }
+
+  // Connect - in child order - then relink each parent list in parent order:
+  for ( size_t st = 0; st < rgstNodes.size(); ++st )
+  {
+    _TyGraphNode * pgn = rgpgn[ rgstNodes[ st ] ];
+    _TyGraphLinkBaseBase ** ppglbTail = pgn->PPGLBChildHead();
+    vector< size_t > const & rrgst = _RNode( rgstNodes[ st ] ).m_prelChildren->m_rgst;
+    for ( size_t u = 0; u < rrgst.size(); ++u )
+    {
+      _TyGraphLinkBaseBase * pglb = rgpgl[ rrgst[ u ] ];
+      _TyGraphNode * pgnChild = rgpgn[ _RLink( rrgst[ u ] ).m_stChild ];
+      pgn->AddChild( *pgnChild, *pglb, *ppglbTail, *pgnChild->PPGLBParentHead() );
+      ppglbTail = pglb->PPGLBGetNextChild();
+    }
+  }
+  for ( size_t st = 0; st < rgstNodes.size(); ++st )
+  {
+    _TyGraphNode * pgn = rgpgn[ rgstNodes[ st ] ];
+    vector< size_t > const & rrgst = _RNode( rgstNodes[ st ] ).m_prelParents->m_rgst;
+    *pgn->PPGLBParentHead() = 0;
+    for ( size_t u = rrgst.size(); u--; )
+    {
+      static_cast< _TyGraphLinkBaseBase * >( rgpgl[ rrgst[ u ] ] )->InsertParent( pgn->PPGLBParentHead() );
+    }
+  }
+  _rg.set_root_node( rgpgn[ StRoot() ] );
+}
+
+template < class t_TyGraph >
+void
+_versioned_graph< t_TyGraph >::assign( _TyGraph const & _rg )
+{
+  typedef unordered_map< const void *, size_t > _TyIdMap;
+  abort();
+  _BIEN_TRY
+  {
+    _version & rv = _RWork();
+    __THROWPT( e_ttMemory );
+    rv.m_ptblNodes = make_shared< _TyNodeTable >();
+    rv.m_ptblNodes->m_uVersion = m_uWork;
+    rv.m_ptblNodes->m_stSize = 0;
+    rv.m_ptblLinks = make_shared< _TyLinkTable >();
+    rv.m_ptblLinks->m_uVersion = m_uWork;
+    rv.m_ptblLinks->m_stSize = 0;
+    rv.m_stRoot = s_kstNull;
+    const _TyGraphNode * pgnRoot = _rg.get_root();
+    if ( !pgnRoot )
+    {
+      return;
+    }
+
+    // Number the component of the root - creating the nodes as they are found:
+    _TyIdMap mapNodes;
+    vector< const _TyGraphNode * > rgpgn;
+    mapNodes.insert( typename _TyIdMap::value_type( pgnRoot, create_node( pgnRoot->RElConst() ) ) );
+    rgpgn.push_back( pgnRoot );
+    for ( size_t stCur = 0; stCur < rgpgn.size(); ++stCur )
+    {
+      for ( int iRel = 0; iRel < 2; ++iRel )
+      {
+        const _TyGraphLinkBaseBase * pglb = iRel ? *rgpgn[ stCur ]->PPGLBParentHead() : *rgpgn[ stCur ]->PPGLBChildHead();
+        for ( ; pglb; pglb = iRel ? pglb->PGLBGetNextParent() : pglb->PGLBGetNextChild() )
+        {
+          const _TyGraphNode * pgnOther = static_cast< const _TyGraphNode * >( iRel ? pglb->PGNBParent() : pglb->PGNBChild() );
+          if ( mapNodes.find( pgnOther ) == mapNodes.end() )
+          {
+            mapNodes.insert( typename _TyIdMap::value_type( pgnOther, create_node( pgnOther->RElConst() ) ) );
+            rgpgn.push_back( pgnOther );
+          }
+        }
+      }
+    }
+
+    // Add the links in child order - then set each parent list to the graph's parent order:
+    _TyIdMap mapLinks;
+    for ( size_t st = 0; st < rgpgn.size(); ++st )
+    {
+      for ( const _TyGraphLinkBaseBase * pglb = *rgpgn[ st ]->PPGLBChildHead(); pglb; pglb = pglb->PGLBGetNextChild() )
+      {
+        const _TyGraphLink * pgl = static_cast< const _TyGraphLink * >( pglb );
+        mapLinks.insert( typename _TyIdMap::value_type( pgl,
+          add_child( st, mapNodes[ static_cast< const _TyGraphNode * >( pglb->PGNBChild() ) ], pgl->RElConst() ) ) );
+      }
+    }
+    for ( size_t st = 0; st < rgpgn.size(); ++st )
+    {
+      vector< size_t > & rrgst = _RRelationsWrite( _RNodeWrite( rv, st ).m_prelParents );
+      size_t u = 0;
+      for ( const _TyGraphLinkBaseBase * pglb = *rgpgn[ st ]->PPGLBParentHead(); pglb; pglb = pglb->PGLBGetNextParent() )
+      {
+        rrgst[ u++ ] = mapLinks[ static_cast< const _TyGraphLink * >( pglb ) ];
+      }
+    }
+    rv.m_stRoot = 0;
+  }
+  _BIEN_UNWIND( abort() );
+}
+
+template < class t_TyGraph >
+const size_t _versioned_graph< t_TyGraph >::s_kstNull;
+template < class t_TyGraph >
+const size_t _versioned_graph< t_TyGraph >::s_kstEnd;
+template < class t_TyGraph >
+const size_t _versioned_graph< t_TyGraph >::s_kstChunkShift;
+template < class t_TyGraph >
+const size_t _versioned_graph< t_TyGraph >::s_kstChunkSize;
+
+__DGRAPH_END_NAMESPACE
+
+#endif //__GR_VERS_H
@@ -108,6 +108,10 @@ public:
   typedef typename _TyGraphTraits::_TyBinaryFiledesOuputIterConst _TyBinaryFiledesOuputIterConst;
   // Output to memory mapped file descriptor:
   typedef typename _TyGraphTraits::_TyBinaryMemMappedOuputIterConst _TyBinaryMemMappedOuputIterConst;
+  // Portable output to ostream:
+  typedef typename _TyGraphTraits::_TyBinaryPortableOstreamIterConst _TyBinaryPortableOstreamIterConst;
+  // Output to file descriptor through a ring of buffers written by a writer thread:
+  typedef typename _TyGraphTraits::_TyBinaryAsyncFiledesOutputIterConst _TyBinaryAsyncFiledesOutputIterConst;
 
   // Binary input iterators - this type supports input from istream:
   typedef typename _TyGraphTraits:: template _get_input_iterator< _TyThis,
@@ -117,6 +121,10 @@ public:
   typedef typename _TyGraphTraits:: template _get_input_iterator< _TyThis,
     typename _TyGraphTraits::_TyBinaryFiledesInput,
     typename _TyGraphTraits::_TyBinaryFiledesInputIterBase >::_TyBinaryInputIterNonConst _TyBinaryFiledesInputIterNonConst;
+  // Portable input from istream:
+  typedef typename _TyGraphTraits:: template _get_input_iterator< _TyThis,
+    typename _TyGraphTraits::_TyBinaryPortableIstreamInput,
+    typename _TyGraphTraits::_TyBinaryPortableIstreamIterBase >::_TyBinaryInputIterNonConst _TyBinaryPortableIstreamIterNonConst;
   // Input from memory mapped file descriptor:
   typedef typename _TyGraphTraits:: template _get_input_iterator< _TyThis,
     typename _TyGraphTraits::_TyBinaryMemMappedInput,
@@ -148,14 +156,18 @@ public:
   explicit dgraph( _TyAllocatorSet const & _rAllocSet = _TyAllocatorSet() ) _BIEN_NOTHROW
     : _TyBaseAllocGraphNode( _rAllocSet.m_allocGraphNode ),
       _TyBaseAllocGraphLink( _rAllocSet.m_allocGraphLink ),
-      _TyBaseGraph( static_cast< typename _TyAllocatorSet::_TyBaseAllocatorSetSafety const & >( _rAllocSet ) )
+      _TyBaseGraph( static_cast< typename _TyAllocatorSet::_TyBaseAllocatorSetSafety const & >( _rAllocSet ) ),
+      m_pged( 0 ),
+      m_per( 0 )
   {
   }
   
   explicit dgraph( _TyThis const & _r )
     : _TyBaseAllocGraphNode( _r.get_node_allocator() ),
       _TyBaseAllocGraphLink( _r.get_link_allocator() ),
-      _TyBaseGraph( static_cast< const _TyGraphBase & >( _r ) )
+      _TyBaseGraph( static_cast< const _TyGraphBase & >( _r ) ),
+      m_pged( 0 ),
+      m_per( 0 )
   {
     replace_copy( _r );
   }
@@ -166,7 +178,9 @@ public:
   explicit dgraph( t_TyGraph const & _r )
     : _TyBaseAllocGraphNode( _r.get_node_allocator() ),
       _TyBaseAllocGraphLink( _r.get_link_allocator() ),
-      _TyBaseGraph( static_cast< typename t_TyGraph::_TyGraphBase const & >( _r ) )
+      _TyBaseGraph( static_cast< typename t_TyGraph::_TyGraphBase const & >( _r ) ),
+      m_pged( 0 ),
+      m_per( 0 )
   {
     replace_copy( _r );
   }
@@ -177,7 +191,9 @@ public:
           _TyAllocatorSet const & _rAllocSet )
     : _TyBaseAllocGraphNode( _rAllocSet.m_allocGraphNode ),
       _TyBaseAllocGraphLink( _rAllocSet.m_allocGraphLink ),
-      _TyBaseGraph( _rAllocSet )
+      _TyBaseGraph( _rAllocSet ),
+      m_pged( 0 ),
+      m_per( 0 )
   {
     replace_copy( _r );
   }
@@ -185,6 +201,7 @@ public:
   ~dgraph()
   {
     destroy();
+    _ReleaseEpochDomain();
   }
 
   void  clear()
@@ -285,7 +302,7 @@ public:
   //  forward iteration in a child-wise depth-first manner.
   // NOTE: Forward iterators do not have methods to modify the graph - this is because modification
   //  will result in undefined bahavior ( currently potentially even crashing ).
-  // When thread-safety is added is issue will be addressed.
+  // For concurrent reading while a writer modifies the graph see set_epoch_domain().
   _TyGraphFwdIterPosConst begin() const _BIEN_NOTHROW
   {
     return _TyGraphFwdIterPosConst( get_root(), 0, false, true, 
@@ -451,6 +468,25 @@ public:
     return _TyResult( itThis, itOther );
   }
 
+  // Hash of the structure and values - equal graphs hash equally - see _gr_hash.h:
+  size_t  structural_hash() const
+  {
+    return _graph_structural_hash< _TyThis >::compute( *this );
+  }
+  // Compare both structure and values - see _gr_hash.h. The structural hashes are compared first
+  //  when the graphs are of this type and the elements have a hash:
+  template < class t_TyGraph >
+  bool  equal_structure( t_TyGraph const & _r ) const
+  {
+    return _graph_structure_equal_hashed( *this, _r );
+  }
+  // As above - with hashes from structural_hash() - unequal hashes decide without comparing:
+  template < class t_TyGraph >
+  bool  equal_structure( t_TyGraph const & _r, size_t _stHash, size_t _stHashOther ) const
+  {
+    return ( _stHash == _stHashOther ) && _graph_structure_equal( *this, _r );
+  }
+
   template < class t_TyGraph >
   void  replace_copy( t_TyGraph const & _r )
   {
@@ -500,6 +536,63 @@ public:
     }
   }
 
+  // Save/load in the portable format ( see _gr_port.h ) - files may be shared between
+  //  machines of different byte order and word size:
+  void save_portable( ostream & _ros ) const
+  {
+    _TyBinaryPortableOstreamIterConst boi( _ros, begin() );
+    __DEBUG_STMT( int _i = 0 )
+    while ( !boi.FAtEnd() )
+    {
+      ++boi;
+      __DEBUG_STMT( ++_i );
+    }
+  }
+  void replace_load_portable( istream & _ris )
+  {
+    destroy();
+
+    _TyBinaryPortableIstreamIterNonConst bii( *this, _ris, _TyBaseGraph::get_base_path_allocator()  );
+
+    __DEBUG_STMT( int _i = 0 )
+    do
+    {
+      ++bii;
+      __DEBUG_STMT( ++_i );
+    }
+    while( !bii.FAtEnd() );
+
+    set_root_node( bii.PGNTransferNewRoot() );
+  }
+
+  // Save followed by a trailer of per-block CRC32C checksums ( see _gr_crc.h ) - the result
+  //  can be validated with FValidateGraphChecksums() before loading.
+  void save_checksummed( ostream & _ros, size_t _stBlockBytes = s_kstCrcDefaultBlockBytes ) const
+  {
+    _graph_crc_ostreambuf gcsb( _ros.rdbuf(), _stBlockBytes );
+    ostream osCrc( &gcsb );
+    save( osCrc );
+    if ( osCrc.fail() )
+    {
+      throw bad_graph( "dgraph::save_checksummed(): Write failed." );
+    }
+    gcsb.Finish();
+  }
+
+  // Save to a file - the traversal encodes into a ring of buffers while a writer thread
+  //  writes them ( see _gr_aout.h ). The graph must not be modified during the save.
+  void save_async( vtyFileHandle _hFile ) const
+  {
+    _TyBinaryAsyncFiledesOutputIterConst boi( _hFile, begin() );
+    __DEBUG_STMT( int _i = 0 )
+    while ( !boi.FAtEnd() )
+    {
+      ++boi;
+      __DEBUG_STMT( ++_i );
+    }
+    boi.m_os.m_ros.Close(); // throws any write error.
+  }
+
   void replace_load( istream & _ris )
   {
     // Again we destroy the current graph first, this could happen
@@ -519,6 +612,26 @@ public:
     set_root_node( bii.PGNTransferNewRoot() );
   }
 
+  // Load from a contiguous image ( i.e. a memory mapped file ) written by the memory mapped
+  //  binary output iterator. Element payloads are deserialized by <_nWorkers> threads
+  //  ( zero -> one per hardware thread ) while the structure is linked - see _gr_pldr.h.
+  void replace_load_parallel( const void * _pvImage, size_t _stImage, unsigned _nWorkers = 0 )
+  {
+    replace_load_parallel( _pvImage, _stImage, _mm_RawElIO(), _mm_RawElIO(), _nWorkers );
+  }
+  template < class t_TyIONodeEl, class t_TyIOLinkEl >
+  void replace_load_parallel( const void * _pvImage, size_t _stImage,
+                              t_TyIONodeEl const & _rione,
+                              t_TyIOLinkEl const & _riole,
+                              unsigned _nWorkers = 0 )
+  {
+    destroy();
+
+    _graph_parallel_loader< _TyThis, t_TyIONodeEl, t_TyIOLinkEl >
+      gpl( _pvImage, _stImage, _nWorkers, _TyBaseGraph::get_base_path_allocator(), _rione, _riole );
+    set_root_node( gpl.PGNLoad( *this ) );
+  }
+
 #ifdef __GR_DEFINEOLEIO
   void save( IStream * _pis ) const
   {
@@ -651,14 +764,61 @@ public:
     set_root_node( rgg.PGNTransferNewRoot() );
   }
 
+  // Build the graph from arrays - see _gr_bulk.h. Node ids index _pNodeEls - the child and parent
+  //  lists of each node are in the order of the node's edges in _pEdges.
+  void  replace_edge_list(  const _TyNodeEl * _pNodeEls, size_t _stNodes,
+                            const _graph_edge< _TyLinkEl > * _pEdges, size_t _stEdges,
+                            size_t _stRoot = 0 )
+  {
+    destroy();
+
+    _graph_edge_list_loader< _TyThis >
+      gell( *this, _pNodeEls, _stNodes, _pEdges, _stEdges, _stRoot );
+
+    set_root_node( gell.PGNTransferNewRoot() );
+  }
+
+  // Export the graph to arrays - see _graph_edge_list_exporter in _gr_bulk.h for the numbering.
+  // Link element i belongs to edge i:
+  void  export_edge_list( vector< _TyNodeEl > & _rrgNodeEls,
+                          vector< _TyLinkEl > & _rrgLinkEls,
+                          vector< _graph_edge_pos > & _rrgEdges ) const
+  {
+    _graph_edge_list_exporter< _TyThis > gele( *this );
+    _rrgNodeEls.resize( gele.StNodes() );
+    _rrgLinkEls.resize( gele.StLinks() );
+    _rrgEdges.resize( gele.StLinks() );
+    gele.CopyNodeEls( _rrgNodeEls.begin() );
+    gele.CopyLinkEls( _rrgLinkEls.begin() );
+    gele.CopyEdges( _rrgEdges.begin() );
+  }
+  // Export to CSR - the children of node i are _rrgstChildren[ _rrgstOffsets[i] .. _rrgstOffsets[i+1] )
+  //  and the element of the link to _rrgstChildren[j] is _rrgLinkEls[j]:
+  void  export_csr( vector< _TyNodeEl > & _rrgNodeEls,
+                    vector< size_t > & _rrgstOffsets,
+                    vector< size_t > & _rrgstChildren,
+                    vector< _TyLinkEl > & _rrgLinkEls ) const
+  {
+    _graph_edge_list_exporter< _TyThis > gele( *this );
+    _rrgNodeEls.resize( gele.StNodes() );
+    _rrgstOffsets.resize( gele.StNodes() + 1 );
+    _rrgstChildren.resize( gele.StLinks() );
+    _rrgLinkEls.resize( gele.StLinks() );
+    gele.CopyNodeEls( _rrgNodeEls.begin() );
+    gele.CopyCSR( _rrgstOffsets.begin(), _rrgstChildren.begin() );
+    gele.CopyLinkEls( _rrgLinkEls.begin() );
+  }
+
   // Destroy the graph nodes starting at the root.
   void
   destroy() _BIEN_NOTHROW
   {
     if ( get_root() )
     {
-      _graph_destroy_struct<_TyThis>  gds( *this, get_root() );
+      _TyGraphNode * pgnRoot = get_root();
+      _graph_destroy_struct<_TyThis>  gds( *this, pgnRoot );
       set_root_node( 0 );
+      _TyBaseGraph::_deinit_subgraph( pgnRoot );
       gds.destroy();
     }
   }
@@ -674,17 +834,25 @@ public:
 #ifdef __GRAPH_DEBUG_DTOR
     gds.SetCheckNode( get_root() );
 #endif //__GRAPH_DEBUG_DTOR
+    _TyBaseGraph::_deinit_subgraph( _pgn );
     gds.destroy();
   }
 
   // Destroy a single node.
   // If connected then connections are ignored.
+  // With instanced allocators this and destroy_link() retire to the graph's epoch domain - if any.
+  //  With static allocators there is no graph to consult and they destroy immediately.
   __DGRAPH_STATIC_ALLOC_DECL void
   destroy_single_node( _TyGraphNode * _pgn ) _BIEN_NOTHROW
   {
     Assert( _pgn );
+#ifdef __DGRAPH_INSTANCED_ALLOCATORS
+    _epoch_destruct_node( _pgn );
+    _epoch_deallocate_node( _pgn );
+#else //__DGRAPH_INSTANCED_ALLOCATORS
     _destruct_node( _pgn );
     _deallocate_node( _pgn );
+#endif //__DGRAPH_INSTANCED_ALLOCATORS
   }
 
   // Destroy only the link passed ( i.e. not any connect parent/child ).
@@ -692,8 +860,45 @@ public:
   destroy_link( _TyGraphLink * _pgl ) _BIEN_NOTHROW
   {
     Assert( _pgl );
+#ifdef __DGRAPH_INSTANCED_ALLOCATORS
+    _epoch_destruct_link( _pgl );
+    _epoch_deallocate_link( _pgl );
+#else //__DGRAPH_INSTANCED_ALLOCATORS
     _destruct_link( _pgl );
     _deallocate_link( _pgl );
+#endif //__DGRAPH_INSTANCED_ALLOCATORS
+  }
+
+  // Concurrent reading - see _gr_epoc.h. While an epoch domain is set destroyed nodes and links
+  //  are retired to it rather than destructed and deallocated - the domain must outlive the graph.
+  // The domain only defers frees - it does not make navigation safe. The intrusive node/link
+  //  pointers are plain ( non-atomic ) data, so a reader must never load a pointer the writer is
+  //  storing: each navigation step must exclude the writer's relinking ( e.g. readers hold a
+  //  shared_mutex shared per step, the writer holds it exclusive while it links/unlinks ). The read
+  //  section spans the whole traversal, so what a reader has reached stays allocated between steps
+  //  even if the writer unlinks and destroys it meanwhile.
+  // Neither this nor the destructor waits for readers - objects already retired stay with the
+  //  domain, which reclaims them with a copy of our allocators. So either may be called from
+  //  within a read section ( unless the domain is out of memory - see _gr_epoc.h ).
+  void  set_epoch_domain( _graph_epoch_domain * _pged )
+  {
+    if ( _pged == m_pged )
+    {
+      return;
+    }
+    _epoch_reclaimer * per = 0;
+    if ( _pged )
+    {
+      __THROWPT( e_ttMemory );
+      per = new _epoch_reclaimer( get_node_allocator(), get_link_allocator() );
+    }
+    _ReleaseEpochDomain();
+    m_pged = _pged;
+    m_per = per;
+  }
+  _graph_epoch_domain * get_epoch_domain() const _BIEN_NOTHROW
+  {
+    return m_pged;
   }
 
   // Dump a human-readable version of the graph to the given ostream:
@@ -871,6 +1076,55 @@ public:
 #endif //__DGRAPH_COUNT_EL_ALLOC_LIFETIME
   }
 
+  // destruction through the epoch domain - if any. Safe viewers are informed immediately - they
+  //  belong to the writer. Element destruction and deallocation are retired in the order called:
+  void  _epoch_destruct_node( _TyGraphNode * _pgn ) _BIEN_NOTHROW
+  {
+    if ( m_pged )
+    {
+      _TyBaseGraph::_deinit_node( _pgn );
+      m_pged->retire( _pgn, &_TyThis::_ReclaimDestructNodeEl, 0 );
+    }
+    else
+    {
+      _destruct_node( _pgn );
+    }
+  }
+  void  _epoch_deallocate_node( _TyGraphNode * _pgn ) _BIEN_NOTHROW
+  {
+    if ( m_pged )
+    {
+      m_pged->retire( _pgn, &_TyThis::_ReclaimDeallocateNode, m_per );
+    }
+    else
+    {
+      _deallocate_node( _pgn );
+    }
+  }
+  void  _epoch_destruct_link( _TyGraphLink * _pgl ) _BIEN_NOTHROW
+  {
+    if ( m_pged )
+    {
+      _TyBaseGraph::_deinit_link( _pgl );
+      m_pged->retire( _pgl, &_TyThis::_ReclaimDestructLinkEl, 0 );
+    }
+    else
+    {
+      _destruct_link( _pgl );
+    }
+  }
+  void  _epoch_deallocate_link( _TyGraphLink * _pgl ) _BIEN_NOTHROW
+  {
+    if ( m_pged )
+    {
+      m_pged->retire( _pgl, &_TyThis::_ReclaimDeallocateLink, m_per );
+    }
+    else
+    {
+      _deallocate_link( _pgl );
+    }
+  }
+
   // destruction:
   static void _destruct_node( _TyGraphNode * _pgn )
   {
@@ -897,6 +1151,62 @@ public:
 #endif //__DGRAPH_COUNT_EL_ALLOC_LIFETIME
     _pgl->RElObject()._TyLinkEl::~_TyLinkEl();
   }
+
+protected:
+
+  // The allocators with which the epoch domain deallocates our retired nodes and links - owned
+  //  by the domain once retired itself ( after all that use it ), so it may outlive the graph:
+  struct _epoch_reclaimer
+    : public _TyBaseAllocGraphNode,
+      public _TyBaseAllocGraphLink
+  {
+    _epoch_reclaimer( _TyGraphNodeAllocatorAsPassed const & _allocNode,
+                      _TyGraphLinkAllocatorAsPassed const & _allocLink )
+      : _TyBaseAllocGraphNode( _allocNode ),
+        _TyBaseAllocGraphLink( _allocLink )
+    {
+    }
+  };
+
+  _graph_epoch_domain * m_pged; // When set we are in concurrent reader mode.
+  _epoch_reclaimer *    m_per;  // Set with m_pged.
+
+  void  _ReleaseEpochDomain() _BIEN_NOTHROW
+  {
+    if ( m_pged )
+    {
+      m_pged->retire( m_per, &_TyThis::_ReclaimReclaimer, 0 );
+      m_pged = 0;
+      m_per = 0;
+    }
+  }
+
+  static void _ReclaimDestructNodeEl( void * _pv, void * )
+  {
+    _destruct_node_el( static_cast< _TyGraphNode * >( _pv ) );
+  }
+  static void _ReclaimDeallocateNode( void * _pv, void * _pvReclaimer )
+  {
+#ifdef __DGRAPH_COUNT_EL_ALLOC_LIFETIME
+    gs_iNodesAllocated--;
+#endif //__DGRAPH_COUNT_EL_ALLOC_LIFETIME
+    static_cast< _epoch_reclaimer * >( _pvReclaimer )->_TyBaseAllocGraphNode::deallocate_type( static_cast< _TyGraphNode * >( _pv ) );
+  }
+  static void _ReclaimDestructLinkEl( void * _pv, void * )
+  {
+    _destruct_link_el( static_cast< _TyGraphLink * >( _pv ) );
+  }
+  static void _ReclaimDeallocateLink( void * _pv, void * _pvReclaimer )
+  {
+#ifdef __DGRAPH_COUNT_EL_ALLOC_LIFETIME
+    gs_iLinksAllocated--;
+#endif //__DGRAPH_COUNT_EL_ALLOC_LIFETIME
+    static_cast< _epoch_reclaimer * >( _pvReclaimer )->_TyBaseAllocGraphLink::deallocate_type( static_cast< _TyGraphLink * >( _pv ) );
+  }
+  static void _ReclaimReclaimer( void * _pv, void * )
+  {
+    delete static_cast< _epoch_reclaimer * >( _pv );
+  }
 };
 
 __DGRAPH_END_NAMESPACE